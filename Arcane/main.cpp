@@ -1,17 +1,69 @@
 #include "arcpch.h"
 #include "Core/Application.h"
 #include "Core/Core.h"
+#include "Core/JobSystem.h"
 #include "Core/Logger.h"
+#include "Benchmarks/Benchmarks.h"
+#include "Graphics/ShaderCompiler.h"
+#include "Graphics/Renderer/VulkanAPI.h"
 #include "Layers/ImGuiLayer.h"
 
+static bool HasArgument(int argc, char **argv, const char *argument)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], argument) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+static const char* GetArgumentValue(int argc, char **argv, const char *argument)
+{
+	for (int i = 1; i < argc - 1; i++)
+	{
+		if (strcmp(argv[i], argument) == 0)
+			return argv[i + 1];
+	}
+
+	return nullptr;
+}
+
 int main(int argc, char **argv)
 {
 	// Pre-Engine Initialization
 	Arcane::Logger::GetInstance();
 	ARC_LOG_INFO("Initialized Logger");
+	Arcane::JobSystem::Initialize(0, HasArgument(argc, argv, "--pin-main-thread"));
+
+	int result = EXIT_SUCCESS;
+	if (HasArgument(argc, argv, "--compile-shaders"))
+	{
+		// Offline shader build for CI and build scripts, exits without starting the engine
+		// Usage: Arcane --compile-shaders [--release] [--force]
+		Arcane::ShaderCompileSettings settings;
+		settings.Optimize = HasArgument(argc, argv, "--release");
+		settings.ForceRebuild = HasArgument(argc, argv, "--force");
 
-	Arcane::Application::GetInstance().PushOverlay(new Arcane::ImGuiLayer());
-	Arcane::Application::GetInstance().Run();
+		result = Arcane::ShaderCompiler::CompileShaders(settings) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	else if (const char *benchmark = GetArgumentValue(argc, argv, "--benchmark"))
+	{
+		// Usage: Arcane --benchmark <name>
+		result = Arcane::Benchmarks::Run(benchmark) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	else
+	{
+		// Usage: Arcane [--indirect-draws] [--depth-prepass] [--software-occlusion] [--software-occlusion-accuracy]
+		Arcane::Application::GetInstance().GetVulkanAPI()->SetIndirectDrawing(HasArgument(argc, argv, "--indirect-draws"));
+		Arcane::Application::GetInstance().GetVulkanAPI()->SetDepthPrepass(HasArgument(argc, argv, "--depth-prepass"));
+		Arcane::Application::GetInstance().GetVulkanAPI()->SetSoftwareOcclusion(HasArgument(argc, argv, "--software-occlusion") || HasArgument(argc, argv, "--software-occlusion-accuracy"),
+			HasArgument(argc, argv, "--software-occlusion-accuracy"));
+		Arcane::Application::GetInstance().PushOverlay(new Arcane::ImGuiLayer());
+		Arcane::Application::GetInstance().Run();
+	}
 
-	return EXIT_SUCCESS;
+	Arcane::JobSystem::Shutdown();
+	return result;
 }
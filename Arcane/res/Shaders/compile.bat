@@ -1,4 +0,0 @@
-del *.spv
-C:/VulkanSDK/1.2.135.0/Bin32/glslc.exe simple.vert -o simple_vert.spv
-C:/VulkanSDK/1.2.135.0/Bin32/glslc.exe simple.frag -o simple_frag.spv
-@pause
@@ -0,0 +1,28 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// Depth prepass, drawn without a fragment shader from the position stream alone. The position has to come out bit for bit the same as in the
+// shaders of the main pass, which test against this depth with VK_COMPARE_OP_EQUAL
+layout(location = 0) in vec3 inPosition;
+
+// Per instance
+layout(location = 3) in vec4 inTransform0;
+layout(location = 4) in vec4 inTransform1;
+layout(location = 5) in vec4 inTransform2;
+layout(location = 6) in vec4 inTransform3;
+layout(location = 7) in vec4 inTint;
+layout(location = 8) in vec4 inCustomData;
+
+layout(binding = 0) uniform UniformBufferObject {
+	mat4 model;
+	mat4 view;
+	mat4 projection;
+} ubo;
+
+invariant gl_Position;
+
+void main()
+{
+	mat4 instanceTransform = mat4(inTransform0, inTransform1, inTransform2, inTransform3);
+	gl_Position = ubo.projection * ubo.view * ubo.model * instanceTransform * vec4(inPosition, 1.0);
+}
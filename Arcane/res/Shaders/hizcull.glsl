@@ -0,0 +1,61 @@
+// Hierarchical Z tests shared by the culling shaders. The including shader defines DEPTH_PYRAMID_BINDING, the binding of set 0 the farthest depth pyramid
+// is read from
+
+// Farthest depth of the area every texel covers
+layout(set = 0, binding = DEPTH_PYRAMID_BINDING) uniform sampler2D depthPyramid;
+
+// Projects the corners of the sphere's bounding box. The rectangle and nearest depth are only valid if the box is entirely in front of the camera
+bool ProjectSphere(vec4 sphere, mat4 viewProjection, out bool inFrustum, out vec2 minUV, out vec2 maxUV, out float nearestDepth)
+{
+	// A box is outside the frustum when all of its corners are outside the same clip plane, the tests work in clip space so corners behind the camera are handled too
+	ivec3 outsideMinCount = ivec3(0), outsideMaxCount = ivec3(0);
+	bool inFrontOfCamera = true;
+	vec3 minNDC = vec3(1.0), maxNDC = vec3(-1.0);
+	for (int i = 0; i < 8; i++)
+	{
+		vec3 corner = sphere.xyz + sphere.w * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+		vec4 clip = viewProjection * vec4(corner, 1.0);
+
+		outsideMinCount += ivec3(lessThan(clip.xyz, vec3(-clip.w, -clip.w, 0.0)));
+		outsideMaxCount += ivec3(greaterThan(clip.xyz, vec3(clip.w)));
+
+		if (clip.w <= 0.0 || clip.z < 0.0)
+		{
+			inFrontOfCamera = false;
+			continue;
+		}
+		vec3 ndc = clip.xyz / clip.w;
+		minNDC = min(minNDC, ndc);
+		maxNDC = max(maxNDC, ndc);
+	}
+
+	inFrustum = !any(equal(outsideMinCount, ivec3(8))) && !any(equal(outsideMaxCount, ivec3(8)));
+	minUV = clamp(minNDC.xy * 0.5 + 0.5, 0.0, 1.0);
+	maxUV = clamp(maxNDC.xy * 0.5 + 0.5, 0.0, 1.0);
+	nearestDepth = minNDC.z;
+	return inFrontOfCamera;
+}
+
+bool IsOccluded(vec2 minUV, vec2 maxUV, float nearestDepth, uint depthPyramidLevelCount)
+{
+	// Picks the level where the rectangle is at most a texel wide so the four corner texels cover all of it, levels are rounded up
+	// when halving so the level can end up slightly too detailed and has to go up once more
+	vec2 rectSize = (maxUV - minUV) * vec2(textureSize(depthPyramid, 0));
+	int maxLevel = int(depthPyramidLevelCount) - 1;
+	int level = clamp(int(ceil(log2(max(max(rectSize.x, rectSize.y), 1.0)))), 0, maxLevel);
+
+	ivec2 levelSize = textureSize(depthPyramid, level);
+	ivec2 minTexel = min(ivec2(minUV * vec2(levelSize)), levelSize - 1);
+	ivec2 maxTexel = min(ivec2(maxUV * vec2(levelSize)), levelSize - 1);
+	if (any(greaterThan(maxTexel - minTexel, ivec2(1))) && level < maxLevel)
+	{
+		level++;
+		levelSize = textureSize(depthPyramid, level);
+		minTexel = min(ivec2(minUV * vec2(levelSize)), levelSize - 1);
+		maxTexel = min(ivec2(maxUV * vec2(levelSize)), levelSize - 1);
+	}
+
+	float farthestDepth = max(max(texelFetch(depthPyramid, minTexel, level).r, texelFetch(depthPyramid, ivec2(maxTexel.x, minTexel.y), level).r),
+		max(texelFetch(depthPyramid, ivec2(minTexel.x, maxTexel.y), level).r, texelFetch(depthPyramid, maxTexel, level).r));
+	return nearestDepth > farthestDepth;
+}
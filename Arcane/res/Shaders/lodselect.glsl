@@ -0,0 +1,32 @@
+// Level of detail selection shared by the culling shaders, the same selection as LodSelection::SelectLod() on the CPU.
+// The including shader defines LOD_BINDING, the binding of set 0 the levels are read from
+
+struct MeshLod
+{
+	uint firstIndex; // Absolute, into the geometry pool
+	uint indexCount;
+	float error; // Mesh units
+	uint padding;
+};
+
+layout(set = 0, binding = LOD_BINDING) readonly buffer Lods {
+	MeshLod lods[];
+} lodData;
+
+// Distance is from the camera to the nearest point of the bounds, the error scale includes the object's scale and is divided by the allowed pixel error
+uint SelectLod(uint firstLod, uint lodCount, float distance, float errorScale, float hysteresis, uint currentLod)
+{
+	if (distance <= 0.0)
+		return 0;
+
+	uint lod = min(currentLod, lodCount - 1);
+	while (lod > 0 && lodData.lods[firstLod + lod].error * errorScale > distance)
+	{
+		lod--;
+	}
+	while (lod + 1 < lodCount && lodData.lods[firstLod + lod + 1].error * errorScale <= distance * (1.0 - hysteresis))
+	{
+		lod++;
+	}
+	return lod;
+}
@@ -0,0 +1,37 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// VertexLayout::MESH
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inUV;
+layout(location = 9) in vec4 inTangent; // w is the bitangent sign
+layout(location = 10) in vec2 inUV1;
+
+// Per instance
+layout(location = 3) in vec4 inTransform0;
+layout(location = 4) in vec4 inTransform1;
+layout(location = 5) in vec4 inTransform2;
+layout(location = 6) in vec4 inTransform3;
+layout(location = 7) in vec4 inTint;
+layout(location = 8) in vec4 inCustomData;
+
+layout(location = 0) out vec3 fragColour;
+layout(location = 1) out vec2 fragTexCoord;
+
+layout(binding = 0) uniform UniformBufferObject {
+	mat4 model;
+	mat4 view;
+	mat4 projection;
+} ubo;
+
+void main()
+{
+	mat4 model = ubo.model * mat4(inTransform0, inTransform1, inTransform2, inTransform3);
+	gl_Position = ubo.projection * ubo.view * model * vec4(inPosition, 1.0);
+
+	// Until there is lighting the normal shades the mesh so its orientation is visible
+	vec3 normal = normalize(mat3(model) * inNormal);
+	fragColour = (normal * 0.5 + 0.5) * inTint.rgb;
+	fragTexCoord = inUV;
+}
@@ -0,0 +1,46 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// VertexLayout::MESH_QUANTIZED, the fetch already turns the snorm16 and half float data into floats
+layout(location = 0) in vec4 inPosition; // Inside the mesh bounds, the instance transform includes the mesh's dequantize transform. w is the bitangent sign
+layout(location = 1) in vec2 inNormal;   // Octahedral
+layout(location = 2) in vec2 inUV;
+layout(location = 9) in vec2 inTangent;  // Octahedral
+layout(location = 10) in vec2 inUV1;
+
+// Per instance
+layout(location = 3) in vec4 inTransform0;
+layout(location = 4) in vec4 inTransform1;
+layout(location = 5) in vec4 inTransform2;
+layout(location = 6) in vec4 inTransform3;
+layout(location = 7) in vec4 inTint;
+layout(location = 8) in vec4 inCustomData;
+
+layout(location = 0) out vec3 fragColour;
+layout(location = 1) out vec2 fragTexCoord;
+
+layout(binding = 0) uniform UniformBufferObject {
+	mat4 model;
+	mat4 view;
+	mat4 projection;
+} ubo;
+
+// Inverse of VertexQuantizer::EncodeOctahedral
+vec3 DecodeOctahedral(vec2 encoded)
+{
+	vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-direction.z, 0.0);
+	direction.xy += mix(vec2(fold), vec2(-fold), greaterThanEqual(direction.xy, vec2(0.0)));
+	return normalize(direction);
+}
+
+void main()
+{
+	mat4 model = ubo.model * mat4(inTransform0, inTransform1, inTransform2, inTransform3);
+	gl_Position = ubo.projection * ubo.view * model * vec4(inPosition.xyz, 1.0);
+
+	// The dequantize transform only scales uniformly, so the normal keeps its direction through the model matrix
+	vec3 normal = normalize(mat3(model) * DecodeOctahedral(inNormal));
+	fragColour = (normal * 0.5 + 0.5) * inTint.rgb;
+	fragTexCoord = inUV;
+}
@@ -5,6 +5,14 @@ layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColour;
 layout(location = 2) in vec2 inUV;
 
+// Per instance
+layout(location = 3) in vec4 inTransform0;
+layout(location = 4) in vec4 inTransform1;
+layout(location = 5) in vec4 inTransform2;
+layout(location = 6) in vec4 inTransform3;
+layout(location = 7) in vec4 inTint;
+layout(location = 8) in vec4 inCustomData;
+
 layout(location = 0) out vec3 fragColour;
 layout(location = 1) out vec2 fragTexCoord;
 
@@ -14,9 +22,13 @@ layout(binding = 0) uniform UniformBufferObject {
 	mat4 projection;
 } ubo;
 
+// Computed the same way as in depth.vert, so it matches the depth prepass exactly
+invariant gl_Position;
+
 void main()
 {
-	gl_Position = ubo.projection * ubo.view * ubo.model * vec4(inPosition, 1.0);
-	fragColour = inColour;
+	mat4 instanceTransform = mat4(inTransform0, inTransform1, inTransform2, inTransform3);
+	gl_Position = ubo.projection * ubo.view * ubo.model * instanceTransform * vec4(inPosition, 1.0);
+	fragColour = inColour * inTint.rgb;
 	fragTexCoord = inUV;
 }
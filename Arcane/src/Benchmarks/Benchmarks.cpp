@@ -0,0 +1,1333 @@
+#include "arcpch.h"
+#include "Benchmarks.h"
+
+#include "Core/Application.h"
+#include "Core/JobSystem.h"
+#include "Core/Profiler.h"
+#include "Graphics/ComputeShader.h"
+#include "Graphics/ShaderCompiler.h"
+#include "Graphics/ShaderLoader.h"
+#include "Graphics/VertexLayouts.h"
+#include "Graphics/Buffer/GeometryPool.h"
+#include "Graphics/Mesh/Mesh.h"
+#include "Graphics/Mesh/MeshletBuilder.h"
+#include "Graphics/Mesh/MeshOptimizer.h"
+#include "Graphics/Mesh/MeshSimplifier.h"
+#include "Graphics/Mesh/VertexQuantizer.h"
+#include "Graphics/Renderer/AsyncCompute.h"
+#include "Graphics/Renderer/ComputePipeline.h"
+#include "Graphics/Renderer/CpuCulling.h"
+#include "Graphics/Renderer/GpuCulling.h"
+#include "Graphics/Renderer/LodSelection.h"
+#include "Graphics/Renderer/Renderer.h"
+#include "Graphics/Renderer/SoftwareOcclusion.h"
+#include "Graphics/Renderer/VulkanAPI.h"
+
+namespace Arcane
+{
+	struct BenchmarkEntry
+	{
+		const char *Name;
+		const char *Description;
+		void (*Function)();
+	};
+
+	bool Benchmarks::Run(const std::string &name)
+	{
+		static const BenchmarkEntry benchmarks[] =
+		{
+			{ "async-compute", "GPU time of compute work on the compute queue and how much of it overlaps the graphics work", &Benchmarks::AsyncComputeOverlap },
+			{ "cluster-culling", "Meshlet building, the triangles a large mesh still draws when its meshlets are frustum and backface cone culled and the clusters the GPU pass draws", &Benchmarks::MeshletCulling },
+			{ "command-recording", "Draws per millisecond against the number of recording threads", &Benchmarks::CommandRecording },
+			{ "cpu-culling", "Objects frustum culled per microsecond by a naive loop against the SIMD structure of arrays culler", &Benchmarks::CpuFrustumCulling },
+			{ "depth-prepass", "GPU time and fragment shader invocations of overlapping objects with and without a depth prepass", &Benchmarks::DepthPrepass },
+			{ "draw-sorting", "Render queue sort time and the binds it saves for draws submitted in random order", &Benchmarks::DrawSorting },
+			{ "geometry-pool", "Range allocation cost and fragmentation of streamed meshes, and the binds a shared geometry pool saves", &Benchmarks::GeometryPooling },
+			{ "gpu-culling", "Frame time against the number of objects when they are frustum culled and drawn by the GPU", &Benchmarks::GpuFrustumCulling },
+			{ "indirect-drawing", "Recording time of direct draws against a single indirect draw for the same objects", &Benchmarks::IndirectDrawing },
+			{ "instancing", "Recording time and recorded draws for objects sharing a mesh, drawn one by one against merged into instanced draws", &Benchmarks::Instancing },
+			{ "job-overhead", "Cost of scheduling, running and waiting on an empty job", &Benchmarks::JobOverhead },
+			{ "job-scaling", "Embarrassingly parallel workload against the number of job system threads", &Benchmarks::JobScaling },
+			{ "mesh-lod", "LOD chain generation and the triangles LOD selection saves in a wide scene, with the level switches hysteresis prevents", &Benchmarks::MeshLodSelection },
+			{ "mesh-optimization", "Vertex cache efficiency and index memory of meshes before and after the mesh optimizer", &Benchmarks::MeshOptimization },
+			{ "occlusion-culling", "GPU time and drawn objects when the objects are occlusion culled against a depth pyramid", &Benchmarks::HiZOcclusionCulling },
+			{ "position-stream", "Vertex memory fetched by a depth-only pass from interleaved vertices against the split position stream", &Benchmarks::PositionStreamSplitting },
+			{ "software-occlusion", "Cost and accuracy of the CPU occlusion rasterizer against the same occluders at 8 times the resolution", &Benchmarks::SoftwareOcclusionCulling },
+			{ "vertex-quantization", "Conversion speed, memory saved and precision lost by the quantized mesh vertex layout, and the GPU time of drawing it", &Benchmarks::VertexQuantization },
+		};
+
+#ifndef ARC_FINAL
+		// Benchmarks don't go through Application::Run(), so they build their stale shaders themselves
+		ShaderCompileSettings shaderSettings;
+#ifdef ARC_RELEASE
+		shaderSettings.Optimize = true;
+#endif
+		if (!ShaderCompiler::CompileShaders(shaderSettings))
+		{
+			ARC_LOG_ERROR("Benchmark: Failed to build the shaders");
+			return false;
+		}
+#endif
+
+		for (const BenchmarkEntry &benchmark : benchmarks)
+		{
+			if (name == benchmark.Name)
+			{
+				ARC_LOG_INFO("Benchmark: Running {0} - {1}", benchmark.Name, benchmark.Description);
+				benchmark.Function();
+				return true;
+			}
+		}
+
+		ARC_LOG_ERROR("Benchmark: There is no benchmark called {0}", name);
+		for (const BenchmarkEntry &benchmark : benchmarks)
+		{
+			ARC_LOG_INFO("  {0} - {1}", benchmark.Name, benchmark.Description);
+		}
+		return false;
+	}
+
+	void Benchmarks::AsyncComputeOverlap()
+	{
+		const uint32_t valueCount = 1 << 20;
+		const uint32_t iterationCounts[] = { 0, 64, 256, 1024 };
+		const uint32_t frameCount = 200;
+
+		VulkanAPI *vulkan = Application::GetInstance().GetVulkanAPI();
+		vulkan->InitVulkan();
+		VkDevice device = *vulkan->GetDevice();
+
+		ComputeShader *shader = ShaderLoader::LoadComputeShader("res/Shaders/busywork_comp.spv");
+		ComputePipeline *pipeline = new ComputePipeline(vulkan, shader);
+
+		VkBuffer valueBuffer;
+		VkDeviceMemory valueBufferMemory;
+		vulkan->CreateBuffer(valueCount * sizeof(float), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_SHARING_MODE_EXCLUSIVE, &valueBuffer, &valueBufferMemory);
+
+		VkDescriptorPoolSize poolSize = {};
+		poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSize.descriptorCount = 1;
+
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.pNext = nullptr;
+		poolInfo.maxSets = 1;
+		poolInfo.poolSizeCount = 1;
+		poolInfo.pPoolSizes = &poolSize;
+
+		VkDescriptorPool descriptorPool;
+		VkResult result = vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool);
+		ARC_ASSERT(result == VK_SUCCESS, "Benchmark: Failed to create descriptor pool");
+
+		VkDescriptorSetLayout setLayout = pipeline->GetDescriptorSetLayout(0);
+		VkDescriptorSetAllocateInfo allocateInfo = {};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocateInfo.pNext = nullptr;
+		allocateInfo.descriptorPool = descriptorPool;
+		allocateInfo.descriptorSetCount = 1;
+		allocateInfo.pSetLayouts = &setLayout;
+
+		VkDescriptorSet descriptorSet;
+		result = vkAllocateDescriptorSets(device, &allocateInfo, &descriptorSet);
+		ARC_ASSERT(result == VK_SUCCESS, "Benchmark: Failed to allocate descriptor set");
+
+		VkDescriptorBufferInfo bufferInfo = {};
+		bufferInfo.buffer = valueBuffer;
+		bufferInfo.offset = 0;
+		bufferInfo.range = VK_WHOLE_SIZE;
+
+		VkWriteDescriptorSet descriptorWrite = {};
+		descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrite.pNext = nullptr;
+		descriptorWrite.dstSet = descriptorSet;
+		descriptorWrite.dstBinding = 0;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorWrite.pBufferInfo = &bufferInfo;
+		vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+
+		// Nothing on the graphics queue reads the values, so graphics never waits on the compute work and the two can overlap completely
+		uint32_t iterationCount = 0;
+		AsyncCompute *asyncCompute = vulkan->GetAsyncCompute();
+		uint32_t workHandle = asyncCompute->AddWork([pipeline, descriptorSet, valueCount, &iterationCount](VkCommandBuffer commandBuffer, uint32_t /*frameIndex*/)
+		{
+			// Every frame works on the same values, so it has to wait for the previous frame's writes
+			VkMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.pNext = nullptr;
+			barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+			uint32_t constants[] = { valueCount, iterationCount };
+			pipeline->Bind(commandBuffer);
+			pipeline->BindDescriptorSet(commandBuffer, descriptorSet);
+			pipeline->PushConstants(commandBuffer, constants, sizeof(constants));
+			pipeline->DispatchThreads(commandBuffer, valueCount);
+		}, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+		for (uint32_t iterations : iterationCounts)
+		{
+			iterationCount = iterations;
+
+			double graphicsTime = 0.0, computeTime = 0.0, overlapTime = 0.0, frameTime = 0.0;
+			uint32_t sampleCount = 0;
+			for (uint32_t frame = 0; frame < frameCount; frame++)
+			{
+				Profiler::GetInstance().BeginFrame();
+				glfwPollEvents();
+
+				double frameStartTime = Profiler::GetTimeMs();
+				vulkan->Render();
+				frameTime += Profiler::GetTimeMs() - frameStartTime;
+
+				// The first frames in flight haven't got any timings yet
+				const FrameStats &stats = Profiler::GetInstance().GetCurrentFrameStats();
+				if (stats.AsyncComputeGpuTime > 0.0)
+				{
+					graphicsTime += stats.GraphicsGpuTime;
+					computeTime += stats.AsyncComputeGpuTime;
+					overlapTime += stats.AsyncComputeOverlapTime;
+					sampleCount++;
+				}
+			}
+			vkDeviceWaitIdle(device);
+
+			sampleCount = std::max(sampleCount, 1u);
+			ARC_LOG_INFO("Benchmark: {0} iterations - {1:.3f}ms per frame - graphics {2:.3f}ms - async compute {3:.3f}ms - {4:.3f}ms overlapped ({5:.0f}%)", iterations, frameTime / frameCount,
+				graphicsTime / sampleCount, computeTime / sampleCount, overlapTime / sampleCount, computeTime > 0.0 ? overlapTime * 100.0 / computeTime : 0.0);
+		}
+
+		asyncCompute->RemoveWork(workHandle);
+		vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+		vkDestroyBuffer(device, valueBuffer, nullptr);
+		vkFreeMemory(device, valueBufferMemory, nullptr);
+		delete pipeline;
+		delete shader;
+	}
+
+	void Benchmarks::CommandRecording()
+	{
+		const uint32_t drawCount = 50000;
+		const uint32_t iterationCount = 20;
+
+		VulkanAPI *vulkan = Application::GetInstance().GetVulkanAPI();
+		vulkan->InitVulkan();
+
+		vulkan->RecordStressFrame(drawCount, JobSystem::GetThreadCount()); // Warm up, allocates every secondary command buffer
+		for (uint32_t threadCount = 1; threadCount <= JobSystem::GetThreadCount(); threadCount++)
+		{
+			// The fastest run is the one least disturbed by the rest of the system
+			double bestTime = std::numeric_limits<double>::max();
+			for (uint32_t i = 0; i < iterationCount; i++)
+			{
+				bestTime = std::min(bestTime, vulkan->RecordStressFrame(drawCount, threadCount));
+			}
+
+			ARC_LOG_INFO("Benchmark: {0} threads - {1} draws in {2:.3f}ms - {3:.0f} draws/ms", threadCount, drawCount, bestTime, drawCount / bestTime);
+		}
+	}
+
+	void Benchmarks::CpuFrustumCulling()
+	{
+		const uint32_t objectCounts[] = { 10000, 100000, 1000000 };
+		const uint32_t iterationCount = 20;
+
+		glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 1000.0f) * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::vec4 planes[6];
+		GpuCulling::ExtractFrustumPlanes(viewProjection, planes);
+
+		std::mt19937 random(1337);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+		for (uint32_t objectCount : objectCounts)
+		{
+			std::vector<glm::vec4> spheres(objectCount);
+			CpuCulling culling;
+			for (glm::vec4 &sphere : spheres)
+			{
+				sphere = glm::vec4(position(random), position(random), position(random), 0.75f);
+				culling.AddSphere(sphere);
+			}
+
+			// What culling usually looks like without the SoA layout, one object and one plane at a time
+			std::vector<uint32_t> visible;
+			visible.reserve(objectCount);
+			double naiveTime = std::numeric_limits<double>::max();
+			for (uint32_t iteration = 0; iteration < iterationCount; iteration++)
+			{
+				double startTime = Profiler::GetTimeMs();
+				visible.clear();
+				for (uint32_t i = 0; i < objectCount; i++)
+				{
+					bool inside = true;
+					for (int p = 0; p < 6 && inside; p++)
+					{
+						inside = glm::dot(glm::vec3(planes[p]), glm::vec3(spheres[i])) + planes[p].w > -spheres[i].w;
+					}
+					if (inside)
+						visible.push_back(i);
+				}
+				naiveTime = std::min(naiveTime, Profiler::GetTimeMs() - startTime);
+			}
+			const size_t naiveVisibleCount = visible.size();
+			ARC_LOG_INFO("Benchmark: {0} objects ({1} visible) - naive {2:.1f} objects/us", objectCount, naiveVisibleCount, objectCount / (naiveTime * 1000.0));
+
+			const CpuCullingPath paths[] = { CpuCullingPath::SCALAR, CpuCullingPath::SSE, CpuCullingPath::AVX };
+			const char *pathNames[] = { "scalar", "sse", "avx" };
+			for (int path = 0; path < 3; path++)
+			{
+				if (static_cast<int>(paths[path]) > static_cast<int>(CpuCulling::GetBestSupportedPath()))
+					continue;
+
+				culling.SetPath(paths[path]);
+				double times[2];
+				for (int useJobSystem = 0; useJobSystem < 2; useJobSystem++)
+				{
+					culling.SetUseJobSystem(useJobSystem != 0);
+					times[useJobSystem] = std::numeric_limits<double>::max();
+					for (uint32_t iteration = 0; iteration < iterationCount; iteration++)
+					{
+						double startTime = Profiler::GetTimeMs();
+						culling.Cull(viewProjection, visible);
+						times[useJobSystem] = std::min(times[useJobSystem], Profiler::GetTimeMs() - startTime);
+					}
+					if (visible.size() != naiveVisibleCount)
+						ARC_LOG_WARN("Benchmark: The {0} culler found {1} visible objects instead of {2}", pathNames[path], visible.size(), naiveVisibleCount);
+				}
+
+				ARC_LOG_INFO("Benchmark:   {0} - {1:.1f} objects/us - {2:.1f} objects/us with {3} threads - {4:.1f}x over naive", pathNames[path], objectCount / (times[0] * 1000.0),
+					objectCount / (times[1] * 1000.0), JobSystem::GetThreadCount(), naiveTime / times[1]);
+			}
+		}
+	}
+
+	void Benchmarks::DepthPrepass()
+	{
+		const uint32_t objectCounts[] = { 1000, 10000, 50000 }; // With the prepass every object takes two instances, which has to fit in the instance buffer
+		const uint32_t frameCount = 100;
+
+		VulkanAPI *vulkan = Application::GetInstance().GetVulkanAPI();
+		vulkan->InitVulkan();
+		if (!vulkan->IsPipelineStatisticsEnabled())
+		{
+			ARC_LOG_WARN("Benchmark: The device can't count fragment shader invocations, only the GPU times are compared");
+		}
+
+		// Objects are piled up along the view direction so they cover each other many times over. The render queue draws them front to back, so this measures
+		// what the prepass saves on top of the sort, the fragments of objects that overlap in depth or are only partly covered by the ones in front of them
+		std::mt19937 random(1337);
+		std::uniform_real_distribution<float> distance(0.0f, 40.0f);
+		std::uniform_real_distribution<float> offset(-1.5f, 1.5f);
+		const glm::vec3 viewDirection = glm::normalize(glm::vec3(-1.0f, -1.0f, -1.0f));
+		for (uint32_t objectCount : objectCounts)
+		{
+			std::vector<InstanceData> instances(objectCount);
+			for (InstanceData &instance : instances)
+			{
+				instance.transform = glm::translate(glm::mat4(1.0f), viewDirection * distance(random) + glm::vec3(offset(random), offset(random), offset(random)));
+			}
+			vulkan->SetSceneInstances(instances);
+
+			double graphicsTimes[2] = { 0.0, 0.0 };
+			uint64_t fragmentInvocations[2] = { 0, 0 };
+			for (int prepass = 0; prepass < 2; prepass++)
+			{
+				vulkan->SetDepthPrepass(prepass != 0);
+
+				uint32_t sampleCount = 0;
+				for (uint32_t frame = 0; frame < frameCount; frame++)
+				{
+					Profiler::GetInstance().BeginFrame();
+					glfwPollEvents();
+					vulkan->Render();
+
+					// The scene doesn't move, so the count of the last frame that had one is representative
+					const FrameStats &stats = Profiler::GetInstance().GetCurrentFrameStats();
+					if (stats.GraphicsGpuTime > 0.0)
+					{
+						graphicsTimes[prepass] += stats.GraphicsGpuTime;
+						sampleCount++;
+					}
+					if (stats.FragmentShaderInvocations > 0)
+					{
+						fragmentInvocations[prepass] = stats.FragmentShaderInvocations;
+					}
+				}
+				graphicsTimes[prepass] /= std::max(sampleCount, 1u);
+			}
+
+			ARC_LOG_INFO("Benchmark: {0} objects - without prepass {1:.3f}ms and {2} fragment shader invocations - with prepass {3:.3f}ms and {4} invocations ({5:.2f}x fewer)",
+				objectCount, graphicsTimes[0], fragmentInvocations[0], graphicsTimes[1], fragmentInvocations[1],
+				static_cast<double>(fragmentInvocations[0]) / static_cast<double>(std::max<uint64_t>(fragmentInvocations[1], 1)));
+			vulkan->SetDepthPrepass(false);
+		}
+		vulkan->SetSceneInstances({});
+	}
+
+	void Benchmarks::DrawSorting()
+	{
+		const uint32_t drawCounts[] = { 1000, 10000, 100000 };
+		const uint32_t pipelineCount = 16, materialCount = 256, meshCount = 512;
+		const uint32_t iterationCount = 20;
+
+		// Only the identity of the buffers and descriptor sets matters for sorting, so the draws point at placeholders that are never dereferenced
+		std::vector<PipelineDescription> pipelines(pipelineCount);
+		std::vector<uint8_t> placeholders(meshCount);
+
+		std::mt19937 random(1337);
+		std::uniform_int_distribution<uint32_t> pipeline(0, pipelineCount - 1), material(1, materialCount), mesh(0, meshCount - 1);
+		std::uniform_real_distribution<float> depth(0.1f, 1000.0f);
+		for (uint32_t drawCount : drawCounts)
+		{
+			std::vector<DrawCommand> draws(drawCount);
+			std::vector<float> depths(drawCount);
+			for (uint32_t i = 0; i < drawCount; i++)
+			{
+				uint32_t meshIndex = mesh(random);
+				draws[i].Pipeline = &pipelines[pipeline(random)];
+				draws[i].Vertices = reinterpret_cast<VertexBuffer*>(&placeholders[meshIndex]);
+				draws[i].Indices = reinterpret_cast<IndexBuffer*>(&placeholders[meshIndex]);
+				draws[i].DescriptorSet = (VkDescriptorSet)(uintptr_t)material(random);
+				depths[i] = depth(random);
+			}
+
+			Renderer renderer;
+			double sortTime = std::numeric_limits<double>::max();
+			for (uint32_t iteration = 0; iteration < iterationCount; iteration++)
+			{
+				renderer.BeginFrame();
+				for (uint32_t i = 0; i < drawCount; i++)
+				{
+					renderer.Submit(DrawPass::MAIN, draws[i], InstanceData(), depths[i], i % 8 == 0);
+				}
+
+				double startTime = Profiler::GetTimeMs();
+				renderer.Sort();
+				sortTime = std::min(sortTime, Profiler::GetTimeMs() - startTime);
+			}
+
+			// The radix sort alone against a stable comparison sort of the same amount of keys, only the low 60 bits are used like a single pass would
+			std::uniform_int_distribution<uint64_t> key(0, (1ull << 60) - 1);
+			std::vector<DrawPacket> packets(drawCount), sortedPackets, scratch;
+			for (uint32_t i = 0; i < drawCount; i++)
+			{
+				packets[i].Key = key(random);
+				packets[i].DrawIndex = i;
+			}
+			double radixSortTime = std::numeric_limits<double>::max(), comparisonSortTime = std::numeric_limits<double>::max();
+			for (uint32_t iteration = 0; iteration < iterationCount; iteration++)
+			{
+				sortedPackets = packets;
+				double startTime = Profiler::GetTimeMs();
+				Renderer::RadixSort(sortedPackets, scratch);
+				radixSortTime = std::min(radixSortTime, Profiler::GetTimeMs() - startTime);
+
+				sortedPackets = packets;
+				startTime = Profiler::GetTimeMs();
+				std::stable_sort(sortedPackets.begin(), sortedPackets.end(), [](const DrawPacket &a, const DrawPacket &b) { return a.Key < b.Key; });
+				comparisonSortTime = std::min(comparisonSortTime, Profiler::GetTimeMs() - startTime);
+			}
+
+			const std::vector<DrawCommand> &sortedDraws = renderer.GetSortedDraws(DrawPass::MAIN);
+			ARC_LOG_INFO("Benchmark: {0} draws - queue sorted in {1:.3f}ms - radix sort {2:.3f}ms against {3:.3f}ms for std::stable_sort - {4} binds in submission order, {5} sorted",
+				drawCount, sortTime, radixSortTime, comparisonSortTime, Renderer::CountBinds(draws.data(), draws.size()), Renderer::CountBinds(sortedDraws.data(), sortedDraws.size()));
+		}
+	}
+
+	void Benchmarks::GeometryPooling()
+	{
+		const uint32_t capacity = 1 << 22;
+		const uint32_t residentMeshCount = 2000, streamedMeshCount = 200000;
+
+		// Meshes between 64 and 16k vertices are streamed in and out in random order, which is what fragments the pool
+		std::mt19937 random(1337);
+		std::uniform_int_distribution<uint32_t> meshSize(64, 16384);
+		RangeAllocator allocator(capacity);
+		std::vector<std::pair<uint32_t, uint32_t>> meshes; // Offset and count
+		uint32_t failedCount = 0;
+		double allocateTime = 0.0, freeTime = 0.0;
+		for (uint32_t i = 0; i < streamedMeshCount; i++)
+		{
+			if (meshes.size() >= residentMeshCount)
+			{
+				size_t evicted = random() % meshes.size();
+				double startTime = Profiler::GetTimeMs();
+				allocator.Free(meshes[evicted].first, meshes[evicted].second);
+				freeTime += Profiler::GetTimeMs() - startTime;
+				meshes[evicted] = meshes.back();
+				meshes.pop_back();
+			}
+
+			uint32_t count = meshSize(random), offset;
+			double startTime = Profiler::GetTimeMs();
+			bool allocated = allocator.Allocate(count, &offset);
+			allocateTime += Profiler::GetTimeMs() - startTime;
+			if (allocated)
+			{
+				meshes.push_back(std::make_pair(offset, count));
+			}
+			else
+			{
+				// This is where the pool would compact, afterwards the meshes sit next to each other at the start
+				failedCount++;
+				uint32_t usedCount = 0;
+				for (std::pair<uint32_t, uint32_t> &mesh : meshes)
+				{
+					mesh.first = usedCount;
+					usedCount += mesh.second;
+				}
+				allocator.Reset(usedCount);
+			}
+		}
+		ARC_LOG_INFO("Benchmark: {0} streamed meshes - {1:.3f}us per allocation, {2:.3f}us per free - {3} compactions - {4:.1f}% free, largest free range is {5:.1f}% of it",
+			streamedMeshCount, allocateTime * 1000.0 / streamedMeshCount, freeTime * 1000.0 / (streamedMeshCount - residentMeshCount), failedCount,
+			100.0 * allocator.GetFreeCount() / capacity, 100.0 * allocator.GetLargestFreeRange() / std::max(allocator.GetFreeCount(), 1u));
+
+		// Same draws once with a vertex and index buffer per mesh and once as ranges of one pool, both sorted by the render queue. Only the identity of the buffers matters
+		const uint32_t drawCounts[] = { 1000, 10000, 100000 };
+		const uint32_t meshCount = 512;
+		std::vector<uint8_t> placeholders(meshCount + 1);
+		std::uniform_int_distribution<uint32_t> mesh(0, meshCount - 1);
+		PipelineDescription pipeline;
+		for (uint32_t drawCount : drawCounts)
+		{
+			Renderer separateRenderer, pooledRenderer;
+			separateRenderer.BeginFrame();
+			pooledRenderer.BeginFrame();
+			for (uint32_t i = 0; i < drawCount; i++)
+			{
+				uint32_t meshIndex = mesh(random);
+				DrawCommand draw;
+				draw.Pipeline = &pipeline;
+				draw.DescriptorSet = (VkDescriptorSet)(uintptr_t)(1 + i % 4);
+				draw.Vertices = reinterpret_cast<VertexBuffer*>(&placeholders[meshIndex]);
+				draw.Indices = reinterpret_cast<IndexBuffer*>(&placeholders[meshIndex]);
+				separateRenderer.Submit(DrawPass::MAIN, draw, InstanceData(), static_cast<float>(i));
+
+				draw.Vertices = nullptr;
+				draw.Indices = nullptr;
+				draw.Geometry = reinterpret_cast<const GeometryPool*>(&placeholders[meshCount]);
+				draw.FirstIndex = meshIndex * 36;
+				draw.IndexCount = 36;
+				draw.VertexOffset = static_cast<int32_t>(meshIndex * 24);
+				pooledRenderer.Submit(DrawPass::MAIN, draw, InstanceData(), static_cast<float>(i));
+			}
+			separateRenderer.Sort();
+			pooledRenderer.Sort();
+
+			const std::vector<DrawCommand> &separateDraws = separateRenderer.GetSortedDraws(DrawPass::MAIN), &pooledDraws = pooledRenderer.GetSortedDraws(DrawPass::MAIN);
+			ARC_LOG_INFO("Benchmark: {0} draws of {1} meshes - {2} binds with a buffer per mesh, {3} with a geometry pool", drawCount, meshCount,
+				Renderer::CountBinds(separateDraws.data(), separateDraws.size()), Renderer::CountBinds(pooledDraws.data(), pooledDraws.size()));
+		}
+	}
+
+	void Benchmarks::GpuFrustumCulling()
+	{
+		const uint32_t objectCounts[] = { 1000, 10000, 100000, 1000000 };
+		const uint32_t frameCount = 100;
+
+		VulkanAPI *vulkan = Application::GetInstance().GetVulkanAPI();
+		vulkan->InitVulkan();
+
+		// Objects are scattered around the camera so only part of them is inside the frustum
+		std::mt19937 random(1337);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+		for (uint32_t objectCount : objectCounts)
+		{
+			std::vector<glm::vec4> boundingSpheres(objectCount);
+			for (glm::vec4 &sphere : boundingSpheres)
+			{
+				sphere = glm::vec4(position(random), position(random), position(random), 0.75f);
+			}
+			vulkan->EnableGpuCulling(boundingSpheres);
+
+			double frameTime = 0.0, recordTime = 0.0, graphicsTime = 0.0, cullingTime = 0.0;
+			uint32_t sampleCount = 0;
+			for (uint32_t frame = 0; frame < frameCount; frame++)
+			{
+				Profiler::GetInstance().BeginFrame();
+				glfwPollEvents();
+
+				double frameStartTime = Profiler::GetTimeMs();
+				vulkan->Render();
+				frameTime += Profiler::GetTimeMs() - frameStartTime;
+
+				const FrameStats &stats = Profiler::GetInstance().GetCurrentFrameStats();
+				recordTime += stats.CommandRecordTime;
+				if (stats.AsyncComputeGpuTime > 0.0)
+				{
+					graphicsTime += stats.GraphicsGpuTime;
+					cullingTime += stats.AsyncComputeGpuTime;
+					sampleCount++;
+				}
+			}
+
+			sampleCount = std::max(sampleCount, 1u);
+			ARC_LOG_INFO("Benchmark: {0} objects - {1:.3f}ms per frame - {2:.3f}ms recording - culling {3:.3f}ms - graphics {4:.3f}ms", objectCount, frameTime / frameCount,
+				recordTime / frameCount, cullingTime / sampleCount, graphicsTime / sampleCount);
+		}
+
+		vulkan->DisableGpuCulling();
+	}
+
+	void Benchmarks::IndirectDrawing()
+	{
+		const uint32_t drawCounts[] = { 1000, 10000, 50000, 100000 };
+		const uint32_t iterationCount = 20;
+
+		VulkanAPI *vulkan = Application::GetInstance().GetVulkanAPI();
+		vulkan->InitVulkan();
+
+		// Single threaded so the comparison is draw call cost and not recording parallelism
+		vulkan->RecordStressFrame(drawCounts[0], 1); // Warm up
+		for (uint32_t drawCount : drawCounts)
+		{
+			double bestDirectTime = std::numeric_limits<double>::max(), bestIndirectTime = std::numeric_limits<double>::max();
+			for (uint32_t i = 0; i < iterationCount; i++)
+			{
+				bestDirectTime = std::min(bestDirectTime, vulkan->RecordStressFrame(drawCount, 1, StressRecordMode::DIRECT));
+				bestIndirectTime = std::min(bestIndirectTime, vulkan->RecordStressFrame(drawCount, 1, StressRecordMode::INDIRECT));
+			}
+
+			ARC_LOG_INFO("Benchmark: {0} objects - direct {1:.3f}ms - indirect {2:.3f}ms - {3:.1f}x", drawCount, bestDirectTime, bestIndirectTime, bestDirectTime / bestIndirectTime);
+		}
+	}
+
+	void Benchmarks::Instancing()
+	{
+		const uint32_t drawCounts[] = { 1000, 10000, 50000, 100000 };
+		const uint32_t iterationCount = 20;
+
+		VulkanAPI *vulkan = Application::GetInstance().GetVulkanAPI();
+		vulkan->InitVulkan();
+
+		vulkan->RecordStressFrame(drawCounts[0], 1); // Warm up
+		for (uint32_t drawCount : drawCounts)
+		{
+			double bestDirectTime = std::numeric_limits<double>::max(), bestInstancedTime = std::numeric_limits<double>::max();
+			uint32_t recordedDraws = 0;
+			for (uint32_t i = 0; i < iterationCount; i++)
+			{
+				bestDirectTime = std::min(bestDirectTime, vulkan->RecordStressFrame(drawCount, 1, StressRecordMode::DIRECT));
+
+				uint32_t previousDrawCount = Profiler::GetInstance().GetCurrentFrameStats().DrawCount;
+				bestInstancedTime = std::min(bestInstancedTime, vulkan->RecordStressFrame(drawCount, 1, StressRecordMode::INSTANCED));
+				recordedDraws = Profiler::GetInstance().GetCurrentFrameStats().DrawCount - previousDrawCount;
+			}
+
+			ARC_LOG_INFO("Benchmark: {0} objects - one draw each {1:.3f}ms - instanced {2:.3f}ms in {3} draws - {4:.1f}x", drawCount, bestDirectTime, bestInstancedTime, recordedDraws,
+				bestDirectTime / bestInstancedTime);
+		}
+	}
+
+	void Benchmarks::HiZOcclusionCulling()
+	{
+		const uint32_t objectCounts[] = { 1000, 10000, 100000, 1000000 };
+		const uint32_t frameCount = 100;
+
+		VulkanAPI *vulkan = Application::GetInstance().GetVulkanAPI();
+		vulkan->InitVulkan();
+
+		// Same scattered objects as the GPU culling benchmark, the ones behind the scene mesh are hidden by it
+		std::mt19937 random(1337);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+		for (uint32_t objectCount : objectCounts)
+		{
+			std::vector<glm::vec4> boundingSpheres(objectCount);
+			for (glm::vec4 &sphere : boundingSpheres)
+			{
+				sphere = glm::vec4(position(random), position(random), position(random), 0.75f);
+			}
+
+			double graphicsTimes[2] = { 0.0, 0.0 };
+			for (int occlusion = 0; occlusion < 2; occlusion++)
+			{
+				if (occlusion)
+				{
+					vulkan->DisableGpuCulling();
+					vulkan->EnableOcclusionCulling(boundingSpheres);
+				}
+				else
+				{
+					vulkan->EnableGpuCulling(boundingSpheres);
+				}
+
+				uint32_t sampleCount = 0;
+				for (uint32_t frame = 0; frame < frameCount; frame++)
+				{
+					Profiler::GetInstance().BeginFrame();
+					glfwPollEvents();
+					vulkan->Render();
+
+					const FrameStats &stats = Profiler::GetInstance().GetCurrentFrameStats();
+					if (stats.GraphicsGpuTime > 0.0)
+					{
+						graphicsTimes[occlusion] += stats.GraphicsGpuTime;
+						sampleCount++;
+					}
+				}
+				graphicsTimes[occlusion] /= std::max(sampleCount, 1u);
+			}
+
+			// The counts settle after the first frame, so the last frame is representative
+			const FrameStats &stats = Profiler::GetInstance().GetCurrentFrameStats();
+			ARC_LOG_INFO("Benchmark: {0} objects - frustum culling {1:.3f}ms - occlusion culling {2:.3f}ms - {3} early and {4} late draws - {5} frustum and {6} occlusion culled",
+				objectCount, graphicsTimes[0], graphicsTimes[1], stats.OcclusionEarlyDrawCount, stats.OcclusionLateDrawCount, stats.FrustumCulledCount, stats.OcclusionCulledCount);
+			vulkan->DisableOcclusionCulling();
+		}
+	}
+
+	void Benchmarks::JobOverhead()
+	{
+		const uint32_t jobCount = 200000;
+
+		// Every job scheduled on its own, this is the worst case for the job system
+		JobCounter counter;
+		double startTime = Profiler::GetTimeMs();
+		for (uint32_t i = 0; i < jobCount; i++)
+		{
+			JobSystem::Run([]() {}, &counter);
+		}
+		JobSystem::Wait(&counter);
+		double runTime = Profiler::GetTimeMs() - startTime;
+		ARC_LOG_INFO("Benchmark: {0} empty jobs in {1:.3f}ms - {2:.1f}ns per job", jobCount, runTime, runTime * 1000000.0 / jobCount);
+
+		// A single job that is waited on right away, what a dependency chain costs per link
+		startTime = Profiler::GetTimeMs();
+		for (uint32_t i = 0; i < jobCount; i++)
+		{
+			JobCounter chainCounter;
+			JobSystem::Run([]() {}, &chainCounter);
+			JobSystem::Wait(&chainCounter);
+		}
+		double chainTime = Profiler::GetTimeMs() - startTime;
+		ARC_LOG_INFO("Benchmark: {0} run and wait round trips in {1:.3f}ms - {2:.1f}ns per job", jobCount, chainTime, chainTime * 1000000.0 / jobCount);
+
+		// Batching amortizes the scheduling cost over many items
+		std::atomic<uint32_t> itemCount(0);
+		startTime = Profiler::GetTimeMs();
+		JobSystem::ParallelFor(jobCount, 256, [&itemCount](uint32_t begin, uint32_t end) { itemCount += end - begin; });
+		double batchTime = Profiler::GetTimeMs() - startTime;
+		ARC_LOG_INFO("Benchmark: ParallelFor over {0} items in batches of 256 in {1:.3f}ms - {2:.1f}ns per item", itemCount.load(), batchTime, batchTime * 1000000.0 / jobCount);
+	}
+
+	void Benchmarks::JobScaling()
+	{
+		const uint32_t itemCount = 1 << 24;
+		const uint32_t iterationCount = 5;
+		std::vector<float> input(itemCount), output(itemCount);
+		for (uint32_t i = 0; i < itemCount; i++)
+		{
+			input[i] = static_cast<float>(i);
+		}
+
+		// Restarts the job system with every worker count, so it has to be restored afterwards with the settings it was started with
+		uint32_t defaultThreadCount = JobSystem::GetThreadCount();
+		bool pinMainThread = JobSystem::IsMainThreadPinned();
+		double singleThreadTime = 0.0;
+		for (uint32_t threadCount = 1; threadCount <= defaultThreadCount; threadCount++)
+		{
+			JobSystem::Shutdown();
+			JobSystem::Initialize(threadCount, pinMainThread);
+
+			double bestTime = std::numeric_limits<double>::max();
+			for (uint32_t iteration = 0; iteration < iterationCount; iteration++)
+			{
+				double startTime = Profiler::GetTimeMs();
+				JobSystem::ParallelFor(itemCount, 16384, [&input, &output](uint32_t begin, uint32_t end)
+				{
+					for (uint32_t i = begin; i < end; i++)
+					{
+						output[i] = std::sqrt(input[i]) * std::sin(input[i]) + std::cos(input[i]);
+					}
+				});
+				bestTime = std::min(bestTime, Profiler::GetTimeMs() - startTime);
+			}
+
+			if (threadCount == 1)
+			{
+				singleThreadTime = bestTime;
+			}
+			ARC_LOG_INFO("Benchmark: {0} threads - {1:.3f}ms - {2:.2f}x speedup", JobSystem::GetThreadCount(), bestTime, singleThreadTime / bestTime);
+		}
+
+		JobSystem::Shutdown();
+		JobSystem::Initialize(defaultThreadCount, pinMainThread);
+	}
+
+	void Benchmarks::MeshLodSelection()
+	{
+		const uint32_t ringCount = 256, segmentCount = 256;
+		const uint32_t objectCount = 100000;
+		const uint32_t frameCount = 120;
+		const float viewportHeight = 1080.0f;
+
+		// A bumpy sphere with a radius of about one unit, the poles are closed off with a vertex each so the surface has no borders
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		for (uint32_t ring = 0; ring < ringCount; ring++)
+		{
+			for (uint32_t segment = 0; segment < segmentCount; segment++)
+			{
+				float theta = glm::pi<float>() * (ring + 0.5f) / ringCount, phi = glm::two_pi<float>() * segment / segmentCount;
+				float radius = 1.0f + 0.03f * std::sin(phi * 7.0f) * std::sin(theta * 5.0f);
+				Vertex vertex;
+				vertex.pos = glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)) * radius;
+				vertex.colour = glm::vec3(1.0f);
+				vertex.uv = glm::vec2(0.0f);
+				vertices.push_back(vertex);
+			}
+		}
+		for (uint32_t ring = 0; ring + 1 < ringCount; ring++)
+		{
+			for (uint32_t segment = 0; segment < segmentCount; segment++)
+			{
+				uint32_t a = ring * segmentCount + segment, b = ring * segmentCount + (segment + 1) % segmentCount;
+				uint32_t quad[] = { a, b, a + segmentCount, b, b + segmentCount, a + segmentCount };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+		}
+		uint32_t poles[] = { static_cast<uint32_t>(vertices.size()), static_cast<uint32_t>(vertices.size()) + 1 };
+		Vertex pole;
+		pole.pos = glm::vec3(0.0f, 1.0f, 0.0f);
+		pole.colour = glm::vec3(1.0f);
+		pole.uv = glm::vec2(0.0f);
+		vertices.push_back(pole);
+		pole.pos = glm::vec3(0.0f, -1.0f, 0.0f);
+		vertices.push_back(pole);
+		for (uint32_t segment = 0; segment < segmentCount; segment++)
+		{
+			uint32_t next = (segment + 1) % segmentCount, lastRing = (ringCount - 1) * segmentCount;
+			uint32_t caps[] = { poles[0], next, segment, poles[1], lastRing + segment, lastRing + next };
+			indices.insert(indices.end(), caps, caps + 6);
+		}
+		MeshOptimizer::Optimize(vertices, indices);
+
+		double startTime = Profiler::GetTimeMs();
+		std::vector<MeshLod> lods = MeshSimplifier::GenerateLods(vertices, indices);
+		double generateTime = Profiler::GetTimeMs() - startTime;
+
+		ARC_LOG_INFO("Benchmark: {0} triangles - {1} levels generated in {2:.1f}ms", lods[0].IndexCount / 3, lods.size(), generateTime);
+		for (size_t lod = 0; lod < lods.size(); lod++)
+		{
+			ARC_LOG_INFO("Benchmark: LOD {0} - {1} triangles, error {2:.5f}", lod, lods[lod].IndexCount / 3, lods[lod].Error);
+		}
+
+		// Scattered over a 2km square, the camera walks through them at 3 m/s while swaying back and forth, which is what the hysteresis is for
+		std::mt19937 random(1337);
+		std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+		std::vector<glm::vec4> spheres(objectCount);
+		CpuCulling culling;
+		for (glm::vec4 &sphere : spheres)
+		{
+			sphere = glm::vec4(position(random), 1.0f, position(random), 1.05f);
+			culling.AddSphere(sphere);
+		}
+
+		glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 2000.0f);
+		LodSettings settings;
+		const float hysteresisValues[] = { 0.0f, settings.Hysteresis };
+		for (float hysteresis : hysteresisValues)
+		{
+			settings.Hysteresis = hysteresis;
+			float errorScale = LodSelection::GetErrorScale(projection, viewportHeight, settings);
+
+			LodSelection selection;
+			std::vector<uint32_t> visible, previousLods;
+			uint64_t switchCount = 0, fullTriangleCount = 0, lodTriangleCount = 0;
+			double selectTime = 0.0;
+			for (uint32_t frame = 0; frame < frameCount; frame++)
+			{
+				glm::vec3 cameraPosition(0.0f, 1.7f, -0.05f * frame + 0.5f * std::sin(frame * 0.5f));
+				culling.Cull(projection * glm::lookAt(cameraPosition, cameraPosition + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)), visible);
+
+				previousLods = selection.GetLods();
+				startTime = Profiler::GetTimeMs();
+				selection.Select(spheres, visible, lods, cameraPosition, errorScale, settings);
+				selectTime += Profiler::GetTimeMs() - startTime;
+
+				// The first frame starts every object at full detail, so it isn't counted as switching
+				for (uint32_t object : visible)
+				{
+					switchCount += (frame > 0 && previousLods[object] != selection.GetLod(object)) ? 1 : 0;
+					fullTriangleCount += lods[0].IndexCount / 3;
+					lodTriangleCount += lods[selection.GetLod(object)].IndexCount / 3;
+				}
+			}
+
+			ARC_LOG_INFO("Benchmark: Hysteresis {0:.2f} - {1} visible objects draw {2}k triangles instead of {3}k ({4:.1f}% fewer) - selected in {5:.3f}ms - {6:.1f} level switches per frame",
+				hysteresis, visible.size(), lodTriangleCount / frameCount / 1000, fullTriangleCount / frameCount / 1000, 100.0 - 100.0 * lodTriangleCount / fullTriangleCount,
+				selectTime / frameCount, static_cast<double>(switchCount) / (frameCount - 1));
+		}
+	}
+
+	void Benchmarks::MeshOptimization()
+	{
+		const uint32_t gridSizes[] = { 32, 128, 512 };
+
+		std::mt19937 random(1337);
+		for (uint32_t gridSize : gridSizes)
+		{
+			// Every triangle comes with its own three vertices in random order, the worst case an exporter can hand over
+			std::vector<glm::uvec3> triangles;
+			triangles.reserve(gridSize * gridSize * 2);
+			for (uint32_t y = 0; y < gridSize; y++)
+			{
+				for (uint32_t x = 0; x < gridSize; x++)
+				{
+					uint32_t corner = y * (gridSize + 1) + x;
+					triangles.push_back(glm::uvec3(corner, corner + gridSize + 1, corner + 1));
+					triangles.push_back(glm::uvec3(corner + 1, corner + gridSize + 1, corner + gridSize + 2));
+				}
+			}
+			std::shuffle(triangles.begin(), triangles.end(), random);
+
+			std::vector<Vertex> vertices;
+			std::vector<uint32_t> indices;
+			vertices.reserve(triangles.size() * 3);
+			indices.reserve(triangles.size() * 3);
+			for (const glm::uvec3 &triangle : triangles)
+			{
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					uint32_t gridVertex = triangle[corner];
+					Vertex vertex;
+					vertex.pos = glm::vec3(static_cast<float>(gridVertex % (gridSize + 1)), static_cast<float>(gridVertex / (gridSize + 1)), 0.0f);
+					vertex.colour = glm::vec3(1.0f);
+					vertex.uv = glm::vec2(vertex.pos) / static_cast<float>(gridSize);
+					indices.push_back(static_cast<uint32_t>(vertices.size()));
+					vertices.push_back(vertex);
+				}
+			}
+			size_t inputVertexCount = vertices.size();
+
+			// The cache miss ratio before is measured on the welded mesh, otherwise no vertex could ever be reused
+			std::vector<Vertex> weldedVertices = vertices;
+			std::vector<uint32_t> weldedIndices = indices;
+			uint32_t weldedVertexCount = MeshOptimizer::DeduplicateVertices(weldedVertices, weldedIndices);
+			float acmrBefore = MeshOptimizer::CalculateACMR(weldedIndices, weldedVertexCount);
+
+			double startTime = Profiler::GetTimeMs();
+			MeshOptimizer::Optimize(vertices, indices);
+			double optimizeTime = Profiler::GetTimeMs() - startTime;
+
+			uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+			bool fitsUint16 = MeshOptimizer::FitsUint16(vertexCount);
+			size_t indexMemory32 = indices.size() * sizeof(uint32_t), indexMemory = indices.size() * (fitsUint16 ? sizeof(uint16_t) : sizeof(uint32_t));
+			ARC_LOG_INFO("Benchmark: {0} triangles - {1} vertices welded to {2} - ACMR {3:.3f} before, {4:.3f} after ({5:.3f} with a 32 entry cache) - optimized in {6:.2f}ms - {7} bit indices, {8}KB instead of {9}KB",
+				triangles.size(), inputVertexCount, vertexCount, acmrBefore, MeshOptimizer::CalculateACMR(indices, vertexCount), MeshOptimizer::CalculateACMR(indices, vertexCount, 32),
+				optimizeTime, fitsUint16 ? 16 : 32, indexMemory / 1024, indexMemory32 / 1024);
+		}
+	}
+
+	void Benchmarks::MeshletCulling()
+	{
+		const uint32_t gridSize = 1024;
+		const uint32_t gpuGridSize = 512;
+		const uint32_t frameCount = 100;
+		const uint32_t viewCount = 3;
+		const char *viewNames[viewCount] = { "ground level", "hillside", "from above" };
+		const glm::vec3 cameraPositions[viewCount] = { glm::vec3(0.0f, 12.0f, 500.0f), glm::vec3(-300.0f, 40.0f, 0.0f), glm::vec3(0.0f, 700.0f, 200.0f) };
+		const glm::vec3 cameraTargets[viewCount] = { glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(300.0f, 0.0f, 50.0f), glm::vec3(0.0f, 0.0f, 0.0f) };
+
+		// Large enough that any view only sees part of it and the hills turn plenty of slopes away from the camera
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		GenerateTerrain(gridSize, vertices, indices);
+		MeshOptimizer::Optimize(vertices, indices);
+
+		MeshletSettings meshletSizes[2];
+		meshletSizes[1].MaxVertices = 128;
+		meshletSizes[1].MaxTriangles = 256;
+		glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 5000.0f);
+		const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+		for (const MeshletSettings &settings : meshletSizes)
+		{
+			std::vector<uint32_t> meshletIndices(indices);
+			double startTime = Profiler::GetTimeMs();
+			std::vector<Meshlet> meshlets = MeshletBuilder::Build(vertices, meshletIndices, 0, static_cast<uint32_t>(meshletIndices.size()), settings);
+			double buildTime = Profiler::GetTimeMs() - startTime;
+
+			uint64_t vertexSum = 0;
+			uint32_t coneCount = 0;
+			for (const Meshlet &meshlet : meshlets)
+			{
+				vertexSum += meshlet.VertexCount;
+				coneCount += meshlet.Cone.w < 1.0f ? 1 : 0;
+			}
+			ARC_LOG_INFO("Benchmark: At most {0} vertices and {1} triangles - {2} meshlets of {3:.1f} vertices and {4:.1f} triangles on average, {5} with a cone - built in {6:.1f}ms",
+				settings.MaxVertices, settings.MaxTriangles, meshlets.size(), static_cast<double>(vertexSum) / meshlets.size(), static_cast<double>(triangleCount) / meshlets.size(),
+				coneCount, buildTime);
+
+			for (uint32_t view = 0; view < viewCount; view++)
+			{
+				glm::vec4 planes[6];
+				GpuCulling::ExtractFrustumPlanes(projection * glm::lookAt(cameraPositions[view], cameraTargets[view], glm::vec3(0.0f, 1.0f, 0.0f)), planes);
+
+				// The same tests the cluster culling shader does before it goes to the depth pyramid
+				uint64_t frustumTriangleCount = 0, coneTriangleCount = 0;
+				startTime = Profiler::GetTimeMs();
+				for (const Meshlet &meshlet : meshlets)
+				{
+					bool inFrustum = true;
+					for (int plane = 0; plane < 6 && inFrustum; plane++)
+					{
+						inFrustum = glm::dot(glm::vec3(planes[plane]), glm::vec3(meshlet.BoundingSphere)) + planes[plane].w >= -meshlet.BoundingSphere.w;
+					}
+					if (!inFrustum)
+						continue;
+
+					frustumTriangleCount += meshlet.IndexCount / 3;
+					coneTriangleCount += MeshletBuilder::IsBackfacing(meshlet, cameraPositions[view]) ? 0 : meshlet.IndexCount / 3;
+				}
+				double cullTime = Profiler::GetTimeMs() - startTime;
+
+				ARC_LOG_INFO("Benchmark: {0} - {1:.1f}% of the triangles drawn after frustum culling, {2:.1f}% after cone culling - {3} meshlets culled in {4:.3f}ms", viewNames[view],
+					100.0 * frustumTriangleCount / triangleCount, 100.0 * coneTriangleCount / triangleCount, meshlets.size(), cullTime);
+			}
+		}
+
+		// The cluster culling pass itself, drawing a smaller terrain as the scene mesh since the full one doesn't fit the geometry pool. The terrain replaces the
+		// occlusion culled objects, so there are none of them and the pyramid is built from the terrain's own depth
+		std::vector<Vertex> sceneVertices;
+		std::vector<uint32_t> sceneIndices;
+		GenerateTerrain(gpuGridSize, sceneVertices, sceneIndices);
+
+		VulkanAPI *vulkan = Application::GetInstance().GetVulkanAPI();
+		vulkan->InitVulkan();
+		vulkan->SetSceneMesh(sceneVertices, sceneIndices);
+		vulkan->EnableOcclusionCulling(std::vector<glm::vec4>());
+		vulkan->EnableClusterCulling();
+
+		double graphicsTime = 0.0;
+		uint32_t sampleCount = 0;
+		for (uint32_t frame = 0; frame < frameCount; frame++)
+		{
+			Profiler::GetInstance().BeginFrame();
+			glfwPollEvents();
+			vulkan->Render();
+
+			const FrameStats &stats = Profiler::GetInstance().GetCurrentFrameStats();
+			if (stats.GraphicsGpuTime > 0.0)
+			{
+				graphicsTime += stats.GraphicsGpuTime;
+				sampleCount++;
+			}
+		}
+		graphicsTime /= std::max(sampleCount, 1u);
+
+		// The counts settle after the first frame, so the last frame is representative
+		const FrameStats &stats = Profiler::GetInstance().GetCurrentFrameStats();
+		size_t clusterCount = vulkan->GetSceneMesh()->GetMeshlets().size();
+		ARC_LOG_INFO("Benchmark: GPU culling of {0} triangles - {1} of {2} clusters drawn ({3} early and {4} late) - {5} backface, {6} frustum and {7} occlusion culled - "
+			"{8:.3f}ms graphics", sceneIndices.size() / 3, stats.ClusterEarlyDrawCount + stats.ClusterLateDrawCount, clusterCount, stats.ClusterEarlyDrawCount,
+			stats.ClusterLateDrawCount, stats.ClusterBackfaceCulledCount, stats.ClusterFrustumCulledCount, stats.ClusterOcclusionCulledCount, graphicsTime);
+		vulkan->DisableOcclusionCulling();
+	}
+
+	void Benchmarks::GenerateTerrain(uint32_t gridSize, std::vector<Vertex> &outVertices, std::vector<uint32_t> &outIndices)
+	{
+		outVertices.clear();
+		outVertices.reserve((gridSize + 1) * (gridSize + 1));
+		for (uint32_t z = 0; z <= gridSize; z++)
+		{
+			for (uint32_t x = 0; x <= gridSize; x++)
+			{
+				float worldX = static_cast<float>(x) - gridSize * 0.5f, worldZ = static_cast<float>(z) - gridSize * 0.5f;
+				Vertex vertex;
+				vertex.pos = glm::vec3(worldX, 20.0f * std::sin(worldX * 0.03f) * std::cos(worldZ * 0.025f) + 4.0f * std::sin(worldZ * 0.11f), worldZ);
+				vertex.colour = glm::vec3(1.0f);
+				vertex.uv = glm::vec2(0.0f);
+				outVertices.push_back(vertex);
+			}
+		}
+		outIndices.clear();
+		outIndices.reserve(gridSize * gridSize * 6);
+		for (uint32_t z = 0; z < gridSize; z++)
+		{
+			for (uint32_t x = 0; x < gridSize; x++)
+			{
+				// Counter clockwise seen from above, so the normals point up
+				uint32_t a = z * (gridSize + 1) + x, b = a + 1, c = a + gridSize + 1, d = c + 1;
+				uint32_t quad[] = { a, c, b, b, c, d };
+				outIndices.insert(outIndices.end(), quad, quad + 6);
+			}
+		}
+	}
+
+	void Benchmarks::PositionStreamSplitting()
+	{
+		const uint32_t gridSize = 256;
+		const uint32_t iterationCount = 10;
+		// Models the GPU fetching vertices the post-transform cache misses through a small direct mapped cache of 64 byte lines
+		const uint32_t postTransformCacheSize = 16;
+		const uint32_t cacheLineSize = 64, cacheLineCount = 256;
+
+		std::vector<MeshVertex> meshVertices;
+		meshVertices.reserve((gridSize + 1) * (gridSize + 1));
+		for (uint32_t y = 0; y <= gridSize; y++)
+		{
+			for (uint32_t x = 0; x <= gridSize; x++)
+			{
+				MeshVertex vertex;
+				vertex.position = glm::vec3(static_cast<float>(x), std::sin(x * 0.1f) * std::cos(y * 0.1f), static_cast<float>(y));
+				vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+				vertex.tangent = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+				vertex.uv0 = glm::vec2(static_cast<float>(x), static_cast<float>(y)) / static_cast<float>(gridSize);
+				vertex.uv1 = vertex.uv0;
+				meshVertices.push_back(vertex);
+			}
+		}
+		std::vector<uint32_t> indices;
+		indices.reserve(gridSize * gridSize * 6);
+		for (uint32_t y = 0; y < gridSize; y++)
+		{
+			for (uint32_t x = 0; x < gridSize; x++)
+			{
+				uint32_t corner = y * (gridSize + 1) + x;
+				uint32_t quad[] = { corner, corner + gridSize + 1, corner + 1, corner + 1, corner + gridSize + 1, corner + gridSize + 2 };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+		}
+		uint32_t vertexCount = static_cast<uint32_t>(meshVertices.size());
+		MeshOptimizer::OptimizeVertexCache(indices, vertexCount);
+
+		std::vector<Vertex> vertices(vertexCount);
+		std::vector<QuantizedMeshVertex> quantizedVertices(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			vertices[i].pos = meshVertices[i].position;
+			vertices[i].colour = glm::vec3(1.0f);
+			vertices[i].uv = meshVertices[i].uv0;
+		}
+		VertexQuantizer::Quantize(meshVertices.data(), meshVertices.size(), quantizedVertices.data());
+
+		const char *layoutNames[] = { "standard", "mesh", "quantized mesh" };
+		const void *layoutVertices[] = { vertices.data(), meshVertices.data(), quantizedVertices.data() };
+		for (uint32_t layoutIndex = 0; layoutIndex < static_cast<uint32_t>(VertexLayout::COUNT); layoutIndex++)
+		{
+			VertexLayout layout = static_cast<VertexLayout>(layoutIndex);
+			uint32_t strides[] = { VertexLayouts::GetStride(layout), VertexLayouts::GetPositionStride(layout) };
+			size_t fetchedBytes[2];
+			for (uint32_t streamIndex = 0; streamIndex < 2; streamIndex++)
+			{
+				std::deque<uint32_t> transformedVertices;
+				std::vector<uint64_t> cachedLines(cacheLineCount, std::numeric_limits<uint64_t>::max());
+				size_t fetchedLineCount = 0;
+				for (uint32_t index : indices)
+				{
+					if (std::find(transformedVertices.begin(), transformedVertices.end(), index) != transformedVertices.end())
+						continue;
+					transformedVertices.push_back(index);
+					if (transformedVertices.size() > postTransformCacheSize)
+						transformedVertices.pop_front();
+
+					uint64_t firstByte = static_cast<uint64_t>(index) * strides[streamIndex];
+					for (uint64_t line = firstByte / cacheLineSize; line <= (firstByte + strides[streamIndex] - 1) / cacheLineSize; line++)
+					{
+						if (cachedLines[line % cacheLineCount] != line)
+						{
+							cachedLines[line % cacheLineCount] = line;
+							fetchedLineCount++;
+						}
+					}
+				}
+				fetchedBytes[streamIndex] = fetchedLineCount * cacheLineSize;
+			}
+
+			std::vector<uint8_t> positions(static_cast<size_t>(vertexCount) * strides[1]), attributes(static_cast<size_t>(vertexCount) * VertexLayouts::GetAttributeStride(layout));
+			double splitTime = std::numeric_limits<double>::max();
+			for (uint32_t iteration = 0; iteration < iterationCount; iteration++)
+			{
+				double startTime = Profiler::GetTimeMs();
+				VertexLayouts::SplitStreams(layout, layoutVertices[layoutIndex], vertexCount, positions.data(), attributes.data());
+				splitTime = std::min(splitTime, Profiler::GetTimeMs() - startTime);
+			}
+
+			ARC_LOG_INFO("Benchmark: {0} layout, {1} vertices - depth pass fetches {2}KB interleaved ({3} byte stride), {4}KB from the position stream ({5} byte stride), {6:.1f}% less - split in {7:.2f}ms",
+				layoutNames[layoutIndex], vertexCount, fetchedBytes[0] / 1024, strides[0], fetchedBytes[1] / 1024, strides[1], 100.0 - 100.0 * fetchedBytes[1] / fetchedBytes[0], splitTime);
+		}
+	}
+
+	void Benchmarks::SoftwareOcclusionCulling()
+	{
+		const uint32_t objectCount = 100000;
+		const uint32_t iterationCount = 20;
+
+		glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f) * glm::lookAt(glm::vec3(0.0f, 1.5f, 0.0f), glm::vec3(0.0f, 1.5f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+		// A street of buildings, boxes with gaps between them that the objects behind can be seen through
+		const std::vector<glm::vec3> boxPositions =
+		{
+			glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(0.5f, -0.5f, -0.5f), glm::vec3(0.5f, 0.5f, -0.5f), glm::vec3(-0.5f, 0.5f, -0.5f),
+			glm::vec3(-0.5f, -0.5f, 0.5f), glm::vec3(0.5f, -0.5f, 0.5f), glm::vec3(0.5f, 0.5f, 0.5f), glm::vec3(-0.5f, 0.5f, 0.5f)
+		};
+		const std::vector<uint32_t> boxIndices =
+		{
+			0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4,
+			3, 6, 2, 3, 7, 6, 0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5
+		};
+
+		SoftwareOcclusion occlusion;
+		SoftwareOcclusion reference(occlusion.GetWidth() * 8, occlusion.GetHeight() * 8);
+		for (int row = 1; row <= 6; row++)
+		{
+			for (int column = -4; column <= 4; column++)
+			{
+				glm::vec3 size(6.0f, 4.0f + 3.0f * ((row + column + 8) % 3), 2.0f);
+				glm::mat4 transform = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(column * 8.0f + (row % 2) * 4.0f, size.y * 0.5f, row * -15.0f)), size);
+				occlusion.AddOccluder(boxPositions, boxIndices, transform);
+				reference.AddOccluder(boxPositions, boxIndices, transform);
+			}
+		}
+
+		std::mt19937 random(1337);
+		std::uniform_real_distribution<float> positionX(-80.0f, 80.0f), positionY(0.0f, 10.0f), positionZ(-120.0f, -5.0f);
+		std::vector<glm::vec4> spheres(objectCount);
+		CpuCulling culling;
+		for (glm::vec4 &sphere : spheres)
+		{
+			sphere = glm::vec4(positionX(random), positionY(random), positionZ(random), 0.5f);
+			culling.AddSphere(sphere);
+		}
+		std::vector<uint32_t> candidates;
+		culling.Cull(viewProjection, candidates);
+
+		double rasterTime = std::numeric_limits<double>::max(), testTime = std::numeric_limits<double>::max();
+		std::vector<uint32_t> visible;
+		for (uint32_t iteration = 0; iteration < iterationCount; iteration++)
+		{
+			double startTime = Profiler::GetTimeMs();
+			occlusion.RasterizeOccluders(viewProjection);
+			rasterTime = std::min(rasterTime, Profiler::GetTimeMs() - startTime);
+
+			startTime = Profiler::GetTimeMs();
+			occlusion.CullSpheres(spheres, candidates, visible);
+			testTime = std::min(testTime, Profiler::GetTimeMs() - startTime);
+		}
+
+		// Objects the low resolution buffer can't hide cost a draw, objects it wrongly hides would pop
+		reference.RasterizeOccluders(viewProjection);
+		uint32_t referenceOccludedCount = 0, falseVisibleCount = 0, falseOccludedCount = 0;
+		for (uint32_t candidate : candidates)
+		{
+			bool referenceVisible = reference.IsVisible(spheres[candidate]);
+			bool lowResolutionVisible = occlusion.IsVisible(spheres[candidate]);
+			referenceOccludedCount += referenceVisible ? 0 : 1;
+			falseVisibleCount += (lowResolutionVisible && !referenceVisible) ? 1 : 0;
+			falseOccludedCount += (!lowResolutionVisible && referenceVisible) ? 1 : 0;
+		}
+
+		ARC_LOG_INFO("Benchmark: {0} occluder triangles at {1}x{2} - raster {3:.3f}ms - {4} frustum visible objects tested in {5:.3f}ms with {6} threads",
+			occlusion.GetOccluderTriangleCount(), occlusion.GetWidth(), occlusion.GetHeight(), rasterTime, candidates.size(), testTime, JobSystem::GetThreadCount());
+		ARC_LOG_INFO("Benchmark: {0} occluded ({1} at {2}x{3}) - {4:.1f}% of the occluded objects are drawn anyway - {5} objects wrongly occluded",
+			candidates.size() - visible.size(), referenceOccludedCount, reference.GetWidth(), reference.GetHeight(),
+			referenceOccludedCount > 0 ? 100.0 * falseVisibleCount / referenceOccludedCount : 0.0, falseOccludedCount);
+	}
+
+	void Benchmarks::VertexQuantization()
+	{
+		const uint32_t vertexCount = 1 << 20;
+		const uint32_t iterationCount = 10;
+		const uint32_t sphereSegments = 1024, sphereRings = 512;
+		const uint32_t frameCount = 100;
+
+		// A displaced sphere 20 units across with two UV sets, the second one tiled like a lightmap atlas would not be
+		std::mt19937 random(1337);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		std::vector<MeshVertex> vertices(vertexCount);
+		for (MeshVertex &vertex : vertices)
+		{
+			glm::vec3 direction = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(1e-6f));
+			glm::vec3 tangent = glm::normalize(glm::cross(direction, std::abs(direction.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f)));
+			vertex.position = direction * (10.0f + unit(random) * 0.5f) + glm::vec3(100.0f, 0.0f, -50.0f);
+			vertex.normal = direction;
+			vertex.tangent = glm::vec4(tangent, unit(random) >= 0.0f ? 1.0f : -1.0f);
+			vertex.uv0 = glm::vec2(unit(random), unit(random)) * 0.5f + 0.5f;
+			vertex.uv1 = vertex.uv0 * 16.0f;
+		}
+
+		std::vector<QuantizedMeshVertex> quantizedVertices(vertexCount);
+		glm::mat4 dequantizeTransform(1.0f);
+		double scalarTime = std::numeric_limits<double>::max(), simdTime = std::numeric_limits<double>::max();
+		for (uint32_t iteration = 0; iteration < iterationCount; iteration++)
+		{
+			double startTime = Profiler::GetTimeMs();
+			VertexQuantizer::Quantize(vertices.data(), vertices.size(), quantizedVertices.data(), false);
+			scalarTime = std::min(scalarTime, Profiler::GetTimeMs() - startTime);
+
+			startTime = Profiler::GetTimeMs();
+			dequantizeTransform = VertexQuantizer::Quantize(vertices.data(), vertices.size(), quantizedVertices.data(), true);
+			simdTime = std::min(simdTime, Profiler::GetTimeMs() - startTime);
+		}
+
+		std::vector<MeshVertex> dequantizedVertices(vertexCount);
+		VertexQuantizer::Dequantize(quantizedVertices.data(), quantizedVertices.size(), dequantizeTransform, dequantizedVertices.data());
+		float positionError = 0.0f, normalError = 0.0f, tangentError = 0.0f, uvError = 0.0f;
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			positionError = std::max(positionError, glm::length(dequantizedVertices[i].position - vertices[i].position));
+			normalError = std::max(normalError, glm::degrees(std::acos(std::min(glm::dot(dequantizedVertices[i].normal, vertices[i].normal), 1.0f))));
+			tangentError = std::max(tangentError, glm::degrees(std::acos(std::min(glm::dot(glm::vec3(dequantizedVertices[i].tangent), glm::vec3(vertices[i].tangent)), 1.0f))));
+			uvError = std::max(uvError, std::max(glm::length(dequantizedVertices[i].uv0 - vertices[i].uv0), glm::length(dequantizedVertices[i].uv1 - vertices[i].uv1)));
+		}
+
+		size_t fullSize = vertexCount * sizeof(MeshVertex), quantizedSize = vertexCount * sizeof(QuantizedMeshVertex);
+		ARC_LOG_INFO("Benchmark: {0} vertices - quantized in {1:.2f}ms scalar, {2:.2f}ms SSE2{3} - {4}MB instead of {5}MB ({6:.1f}% smaller)",
+			vertexCount, scalarTime, simdTime, VertexQuantizer::IsSimdSupported() ? "" : " (unsupported, ran scalar)", quantizedSize >> 20, fullSize >> 20, 100.0 - 100.0 * quantizedSize / fullSize);
+		ARC_LOG_INFO("Benchmark: Largest error - position {0:.5f} units, normal {1:.4f} degrees, tangent {2:.4f} degrees, UV {3:.5f}", positionError, normalError, tangentError, uvError);
+
+		// Draws a finely tessellated sphere filling the view through the quantized pipeline, where the render queue applies the mesh's dequantize transform
+		std::vector<MeshVertex> sphereVertices;
+		std::vector<uint32_t> sphereIndices;
+		sphereVertices.reserve((sphereSegments + 1) * (sphereRings + 1));
+		for (uint32_t ring = 0; ring <= sphereRings; ring++)
+		{
+			for (uint32_t segment = 0; segment <= sphereSegments; segment++)
+			{
+				float theta = glm::pi<float>() * ring / sphereRings, phi = glm::two_pi<float>() * segment / sphereSegments;
+				glm::vec3 direction(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+				MeshVertex vertex;
+				vertex.position = direction;
+				vertex.normal = direction;
+				vertex.tangent = glm::vec4(-std::sin(phi), std::cos(phi), 0.0f, 1.0f);
+				vertex.uv0 = glm::vec2(static_cast<float>(segment) / sphereSegments, static_cast<float>(ring) / sphereRings);
+				vertex.uv1 = vertex.uv0;
+				sphereVertices.push_back(vertex);
+			}
+		}
+		sphereIndices.reserve(sphereSegments * sphereRings * 6);
+		for (uint32_t ring = 0; ring < sphereRings; ring++)
+		{
+			for (uint32_t segment = 0; segment < sphereSegments; segment++)
+			{
+				uint32_t a = ring * (sphereSegments + 1) + segment, b = a + 1, c = a + sphereSegments + 1, d = c + 1;
+				uint32_t quad[] = { a, c, b, b, c, d };
+				sphereIndices.insert(sphereIndices.end(), quad, quad + 6);
+			}
+		}
+
+		VulkanAPI *vulkan = Application::GetInstance().GetVulkanAPI();
+		vulkan->InitVulkan();
+		vulkan->SetQuantizedSceneMesh(sphereVertices, sphereIndices);
+
+		double graphicsTime = 0.0;
+		uint32_t sampleCount = 0;
+		for (uint32_t frame = 0; frame < frameCount; frame++)
+		{
+			Profiler::GetInstance().BeginFrame();
+			glfwPollEvents();
+			vulkan->Render();
+
+			const FrameStats &stats = Profiler::GetInstance().GetCurrentFrameStats();
+			if (stats.GraphicsGpuTime > 0.0)
+			{
+				graphicsTime += stats.GraphicsGpuTime;
+				sampleCount++;
+			}
+		}
+		graphicsTime /= std::max(sampleCount, 1u);
+		ARC_LOG_INFO("Benchmark: {0} quantized vertices and {1} triangles drawn in {2:.3f}ms of graphics GPU time - {3}KB of vertices instead of {4}KB", sphereVertices.size(),
+			sphereIndices.size() / 3, graphicsTime, sphereVertices.size() * sizeof(QuantizedMeshVertex) >> 10, sphereVertices.size() * sizeof(MeshVertex) >> 10);
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Graphics/Vertex.h"
+
+namespace Arcane
+{
+	// Performance benchmarks that are run from the command line with: Arcane --benchmark <name>
+	class Benchmarks
+	{
+	public:
+		// Returns false if there is no benchmark with the name
+		static bool Run(const std::string &name);
+	private:
+		// Async compute and graphics GPU times and their overlap, for increasingly heavy compute work running next to the normal frame
+		static void AsyncComputeOverlap();
+		// Draws per millisecond recorded into secondary command buffers, for every thread count up to the number of cores
+		static void CommandRecording();
+		// Objects frustum culled per microsecond by a naive loop over glm spheres against the SoA culler with every instruction set, single threaded and on the job system
+		static void CpuFrustumCulling();
+		// Graphics GPU time and fragment shader invocations for 1k to 50k overlapping instances sorted front to back by the render queue, with and without a depth prepass
+		static void DepthPrepass();
+		// Render queue sort time, radix sort against std::stable_sort, and the binds sorting saves for 1k to 100k draws submitted in random order
+		static void DrawSorting();
+		// Allocation cost and fragmentation of the geometry pool's range allocator while meshes are streamed in and out, and the binds 1k to 100k draws need with a pool against a buffer per mesh
+		static void GeometryPooling();
+		// CPU frame time, culling pass and graphics GPU time for 1k to 1M objects that are frustum culled and drawn entirely by the GPU
+		static void GpuFrustumCulling();
+		// Recording time of one draw call per object against writing the arguments and submitting them with one indirect draw, for 1k to 100k objects
+		static void IndirectDrawing();
+		// Graphics GPU time and the objects drawn by each phase for 1k to 1M objects with two phase occlusion culling, against frustum culling alone
+		static void HiZOcclusionCulling();
+		// Recording time of one draw call per object against submitting them to the render queue, which merges them into instanced draws, for 1k to 100k objects
+		static void Instancing();
+		// LOD chain generation time and the levels it makes for a bumpy sphere, and the triangles 100k of them scattered around a moving camera draw with LOD selection,
+		// along with how often objects switch levels with and without hysteresis
+		static void MeshLodSelection();
+		// Vertex cache miss ratio of shuffled grid meshes before and after the mesh optimizer, the time it takes and the index memory 16 bit indices save
+		static void MeshOptimization();
+		// Meshlet build time and size for a 2M triangle terrain, and the triangles frustum and normal cone culling of its meshlets leave to draw from a few views,
+		// where culling the terrain as one object draws all of them. Then the clusters of a smaller terrain the GPU cluster culling pass draws and its GPU time
+		static void MeshletCulling();
+		// Vertex memory a depth-only pass fetches from interleaved vertices against the position stream alone for every vertex layout, and the time splitting the streams takes
+		static void PositionStreamSplitting();
+		// Rasterization and test time of the CPU occlusion buffer, and how many objects it hides compared to a buffer at 8 times the resolution
+		static void SoftwareOcclusionCulling();
+		// Import throughput of the scalar and SSE2 vertex quantizers, the memory the quantized layout saves and the largest error it introduces,
+		// then the graphics GPU time of drawing a 1M triangle sphere through the quantized pipeline
+		static void VertexQuantization();
+
+		// Time it takes to schedule and run an empty job, alone, as a dependency chain and batched with ParallelFor
+		static void JobOverhead();
+		// Speedup of a ParallelFor over 16M items for every thread count up to the number of cores
+		static void JobScaling();
+
+		// Rolling hills one unit apart around the origin, gridSize quads along each side
+		static void GenerateTerrain(uint32_t gridSize, std::vector<Vertex> &outVertices, std::vector<uint32_t> &outIndices);
+	};
+}
@@ -8,6 +8,8 @@
 #include "Core/FileUtils.h"
 #include "Core/Layer.h"
 #include "Core/Logger.h"
+#include "Core/Profiler.h"
+#include "Graphics/ShaderCompiler.h"
 #include "Graphics/Renderer/VulkanAPI.h"
 
 namespace Arcane
@@ -33,6 +35,19 @@ namespace Arcane
 
 	void Application::Run()
 	{
+#ifndef ARC_FINAL
+		// Dev builds rebuild any shader whose source changed since the last launch, final builds rely on the binaries from the post-build step
+		ShaderCompileSettings shaderSettings;
+#ifdef ARC_RELEASE
+		shaderSettings.Optimize = true;
+#endif
+		if (!ShaderCompiler::CompileShaders(shaderSettings))
+		{
+			ARC_LOG_ERROR("Application: Failed to build the shaders, the SPIR-V binaries aren't checked in so the engine can't start without them");
+			return;
+		}
+#endif
+
 		m_Vulkan->InitVulkan();
 
 		Loop();
@@ -77,6 +92,8 @@ namespace Arcane
 
 		while (!m_Window->ShouldClose())
 		{
+			Profiler::GetInstance().BeginFrame();
+
 			m_Window->Update();
 			for (auto layer : m_LayerStack)
 			{
@@ -87,7 +104,49 @@ namespace Arcane
 			++fps;
 			if (m_Timer.Elapsed() >= 1.0)
 			{
-				std::string profileString = std::string("- ") + std::to_string(fps) + std::string("fps - ") + std::to_string(1000.0f / fps) + std::string("ms");
+				std::string profileString = std::string("- ") + std::to_string(fps) + std::string("fps - ") + std::to_string(1000.0f / fps) + std::string("ms - ") +
+					std::to_string(Profiler::GetInstance().GetLastFrameStats().CommandRecordTime) + std::string("ms recording - ") +
+					std::to_string(Profiler::GetInstance().GetLastFrameStats().GraphicsGpuTime) + std::string("ms gpu - ") +
+					std::to_string(Profiler::GetInstance().GetLastFrameStats().DrawCount) + std::string(" draws (") +
+					std::to_string(Profiler::GetInstance().GetLastFrameStats().SubmittedDrawCount) + std::string(" submitted), ") +
+					std::to_string(Profiler::GetInstance().GetLastFrameStats().SortedBindCount) + std::string(" binds (") +
+					std::to_string(Profiler::GetInstance().GetLastFrameStats().UnsortedBindCount) + std::string(" unsorted)");
+				if (Profiler::GetInstance().GetLastFrameStats().AsyncComputeGpuTime > 0.0)
+				{
+					profileString += std::string(" - ") + std::to_string(Profiler::GetInstance().GetLastFrameStats().AsyncComputeGpuTime) + std::string("ms async compute (") +
+						std::to_string(Profiler::GetInstance().GetLastFrameStats().AsyncComputeOverlapTime) + std::string("ms overlapped)");
+				}
+				if (Profiler::GetInstance().GetLastFrameStats().FragmentShaderInvocations > 0)
+				{
+					profileString += std::string(" - ") + std::to_string(Profiler::GetInstance().GetLastFrameStats().FragmentShaderInvocations) + std::string(" fragment invocations") +
+						(m_Vulkan->IsDepthPrepass() ? std::string(" (depth prepass)") : std::string());
+				}
+				if (m_Vulkan->IsOcclusionCulling())
+				{
+					const FrameStats &stats = Profiler::GetInstance().GetLastFrameStats();
+					profileString += std::string(" - ") + std::to_string(stats.OcclusionEarlyDrawCount) + std::string(" early / ") + std::to_string(stats.OcclusionLateDrawCount) +
+						std::string(" late draws, ") + std::to_string(stats.FrustumCulledCount) + std::string(" frustum / ") + std::to_string(stats.OcclusionCulledCount) + std::string(" occlusion culled");
+				}
+				if (m_Vulkan->IsClusterCulling())
+				{
+					const FrameStats &stats = Profiler::GetInstance().GetLastFrameStats();
+					profileString += std::string(" - ") + std::to_string(stats.ClusterEarlyDrawCount) + std::string(" early / ") + std::to_string(stats.ClusterLateDrawCount) +
+						std::string(" late clusters, ") + std::to_string(stats.ClusterBackfaceCulledCount) + std::string(" backface / ") + std::to_string(stats.ClusterFrustumCulledCount) +
+						std::string(" frustum / ") + std::to_string(stats.ClusterOcclusionCulledCount) + std::string(" occlusion culled");
+				}
+				if (m_Vulkan->IsSoftwareOcclusion())
+				{
+					const FrameStats &stats = Profiler::GetInstance().GetLastFrameStats();
+					profileString += std::string(" - ") + std::to_string(stats.SoftwareOccluderTriangleCount) + std::string(" occluder triangles in ") +
+						std::to_string(stats.SoftwareOcclusionRasterTime) + std::string("ms, ") + std::to_string(stats.SoftwareOcclusionCulledCount) + std::string(" of ") +
+						std::to_string(stats.SoftwareOcclusionTestedCount) + std::string(" software occlusion culled in ") + std::to_string(stats.SoftwareOcclusionTestTime) + std::string("ms");
+					if (m_Vulkan->IsSoftwareOcclusionAccuracyMeasured())
+					{
+						profileString += std::string(" (") + std::to_string(stats.SoftwareOcclusionAccuracy) + std::string("% accurate, ") +
+							std::to_string(stats.SoftwareOcclusionFalseVisibleCount) + std::string(" false visible / ") + std::to_string(stats.SoftwareOcclusionFalseOccludedCount) +
+							std::string(" false occluded)");
+					}
+				}
 				m_Window->AppendTitle(profileString);
 				fps = 0.0;
 				m_Timer.Rewind(1.0);
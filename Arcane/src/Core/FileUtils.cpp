@@ -22,4 +22,27 @@ namespace Arcane
 
 		return result;
 	}
+
+	bool FileUtils::ReadSpirvFile(const std::string &filepath, std::vector<uint32_t> &outCode)
+	{
+		std::ifstream ifs(filepath, std::ios::in | std::ios::binary | std::ios::ate);
+		if (!ifs)
+		{
+			ARC_LOG_ERROR("Could not read file path {0}", filepath);
+			return false;
+		}
+
+		size_t fileSize = static_cast<size_t>(ifs.tellg());
+		if (fileSize == 0 || fileSize % sizeof(uint32_t) != 0)
+		{
+			ARC_LOG_ERROR("SPIR-V binary {0} has an invalid size of {1} bytes, it must be a multiple of 4", filepath, fileSize);
+			return false;
+		}
+
+		outCode.resize(fileSize / sizeof(uint32_t));
+		ifs.seekg(0);
+		ifs.read(reinterpret_cast<char*>(outCode.data()), fileSize);
+
+		return ifs.good();
+	}
 }
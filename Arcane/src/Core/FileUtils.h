@@ -6,5 +6,8 @@ namespace Arcane
 	{
 	public:
 		static std::string ReadFile(const std::string &filepath);
+
+		// Reads a SPIR-V binary straight into 32-bit words, so the code is correctly aligned for Vulkan without another copy
+		static bool ReadSpirvFile(const std::string &filepath, std::vector<uint32_t> &outCode);
 	};
 }
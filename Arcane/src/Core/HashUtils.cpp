@@ -0,0 +1,24 @@
+#include "arcpch.h"
+#include "HashUtils.h"
+
+namespace Arcane
+{
+	uint64_t HashUtils::HashBytes(const void *data, size_t size, uint64_t seed)
+	{
+		const uint8_t *bytes = static_cast<const uint8_t*>(data);
+
+		uint64_t hash = seed;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= static_cast<uint64_t>(bytes[i]);
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
+	}
+
+	uint64_t HashUtils::HashString(const std::string &string, uint64_t seed)
+	{
+		return HashBytes(string.data(), string.size(), seed);
+	}
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+namespace Arcane
+{
+	class HashUtils
+	{
+	public:
+		// 64-bit FNV-1a, stable across runs and platforms so it can be used for on-disk cache keys (unlike std::hash)
+		static uint64_t HashBytes(const void *data, size_t size, uint64_t seed = 14695981039346656037ull);
+		static uint64_t HashString(const std::string &string, uint64_t seed = 14695981039346656037ull);
+
+		inline static void Combine(uint64_t &seed, uint64_t value) { seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2); }
+	};
+}
@@ -0,0 +1,243 @@
+#include "arcpch.h"
+#include "JobSystem.h"
+
+#ifdef ARC_PLATFORM_WINDOWS
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#endif
+
+namespace Arcane
+{
+	std::vector<std::unique_ptr<JobQueue>> JobSystem::s_Queues;
+	std::vector<std::thread> JobSystem::s_Workers;
+	bool JobSystem::s_MainThreadPinned = false;
+	std::atomic<bool> JobSystem::s_Running(false);
+	std::atomic<uint32_t> JobSystem::s_QueuedJobCount(0);
+	std::mutex JobSystem::s_SleepMutex;
+	std::condition_variable JobSystem::s_WakeCondition;
+
+	static thread_local uint32_t s_ThreadIndex = 0;
+
+	void JobSystem::Initialize(uint32_t threadCount, bool pinMainThread)
+	{
+		ARC_ASSERT(!IsInitialized(), "JobSystem: Already initialized");
+
+		if (threadCount == 0)
+		{
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		s_MainThreadPinned = pinMainThread;
+		if (pinMainThread)
+		{
+#ifdef ARC_PLATFORM_WINDOWS
+			SetThreadAffinityMask(GetCurrentThread(), 1);
+#endif
+		}
+
+		s_ThreadIndex = 0;
+		s_Running = true;
+		for (uint32_t i = 0; i < threadCount; i++)
+		{
+			s_Queues.push_back(std::make_unique<JobQueue>());
+		}
+		for (uint32_t i = 1; i < threadCount; i++)
+		{
+			s_Workers.emplace_back(&JobSystem::WorkerLoop, i);
+		}
+
+		ARC_LOG_INFO("JobSystem: Initialized with {0} threads", threadCount);
+	}
+
+	void JobSystem::Shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(s_SleepMutex);
+			s_Running = false;
+		}
+		s_WakeCondition.notify_all();
+
+		for (std::thread &worker : s_Workers)
+		{
+			worker.join();
+		}
+		s_Workers.clear();
+		s_Queues.clear();
+		s_QueuedJobCount = 0;
+	}
+
+	void JobSystem::Run(std::function<void()> function, JobCounter *counter)
+	{
+		if (counter)
+		{
+			counter->m_Count.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		Job job;
+		job.Function = std::move(function);
+		job.Counter = counter;
+		Push(std::move(job));
+	}
+
+	void JobSystem::RunAfter(JobCounter *dependency, std::function<void()> function, JobCounter *counter)
+	{
+		if (counter)
+		{
+			counter->m_Count.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		{
+			// The last job of the dependency takes this lock after its decrement, so a continuation can't be added after the continuations were flushed
+			std::lock_guard<std::mutex> lock(dependency->m_ContinuationMutex);
+			if (!dependency->IsDone())
+			{
+				dependency->m_Continuations.emplace_back(std::move(function), counter);
+				return;
+			}
+		}
+
+		Job job;
+		job.Function = std::move(function);
+		job.Counter = counter;
+		Push(std::move(job));
+	}
+
+	void JobSystem::ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t, uint32_t)> &function)
+	{
+		JobCounter counter;
+		ParallelFor(count, batchSize, function, &counter);
+		Wait(&counter);
+	}
+
+	void JobSystem::ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t, uint32_t)> &function, JobCounter *counter)
+	{
+		batchSize = std::max(1u, batchSize);
+		for (uint32_t begin = 0; begin < count; begin += batchSize)
+		{
+			uint32_t end = std::min(count, begin + batchSize);
+			Run([&function, begin, end]() { function(begin, end); }, counter);
+		}
+	}
+
+	void JobSystem::Wait(JobCounter *counter)
+	{
+		uint32_t threadIndex = GetThreadIndex();
+		while (!counter->IsDone())
+		{
+			if (!TryRunJob(threadIndex))
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		// The job that finished the counter might still hold its lock, wait for it to let go so the counter can safely be destroyed after this returns
+		std::lock_guard<std::mutex> lock(counter->m_ContinuationMutex);
+	}
+
+	uint32_t JobSystem::GetThreadIndex()
+	{
+		return s_ThreadIndex;
+	}
+
+	void JobSystem::WorkerLoop(uint32_t threadIndex)
+	{
+		s_ThreadIndex = threadIndex;
+
+		while (s_Running)
+		{
+			if (TryRunJob(threadIndex))
+				continue;
+
+			std::unique_lock<std::mutex> lock(s_SleepMutex);
+			s_WakeCondition.wait(lock, []() { return s_QueuedJobCount.load() > 0 || !s_Running; });
+		}
+	}
+
+	void JobSystem::Push(Job &&job)
+	{
+		ARC_ASSERT(IsInitialized(), "JobSystem: Can't run jobs before the job system is initialized");
+
+		JobQueue &queue = *s_Queues[GetThreadIndex()];
+		{
+			std::lock_guard<std::mutex> lock(queue.Mutex);
+			queue.Jobs.push_back(std::move(job));
+		}
+
+		{
+			// Taking the sleep lock makes sure a worker can't miss the wake up between checking the count and going to sleep
+			std::lock_guard<std::mutex> lock(s_SleepMutex);
+			s_QueuedJobCount.fetch_add(1);
+		}
+		s_WakeCondition.notify_one();
+	}
+
+	bool JobSystem::TryRunJob(uint32_t threadIndex)
+	{
+		Job job;
+		if (!PopOrSteal(threadIndex, job))
+			return false;
+
+		job.Function();
+		FinishJob(job.Counter);
+		return true;
+	}
+
+	bool JobSystem::PopOrSteal(uint32_t threadIndex, Job &outJob)
+	{
+		// Newest job from our own queue first, its data is most likely still in the cache
+		{
+			JobQueue &queue = *s_Queues[threadIndex];
+			std::lock_guard<std::mutex> lock(queue.Mutex);
+			if (!queue.Jobs.empty())
+			{
+				outJob = std::move(queue.Jobs.back());
+				queue.Jobs.pop_back();
+				s_QueuedJobCount.fetch_sub(1);
+				return true;
+			}
+		}
+
+		// Otherwise steal the oldest job from another thread, starting at our neighbour so thieves spread out over the queues
+		size_t queueCount = s_Queues.size();
+		for (size_t i = 1; i < queueCount; i++)
+		{
+			JobQueue &queue = *s_Queues[(threadIndex + i) % queueCount];
+			std::lock_guard<std::mutex> lock(queue.Mutex);
+			if (!queue.Jobs.empty())
+			{
+				outJob = std::move(queue.Jobs.front());
+				queue.Jobs.pop_front();
+				s_QueuedJobCount.fetch_sub(1);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void JobSystem::FinishJob(JobCounter *counter)
+	{
+		if (!counter)
+			return;
+
+		// The decrement happens under the lock so RunAfter either sees the counter as done or adds its job before the continuations are taken.
+		// After unlocking the counter is never touched again, a waiter could destroy it right away
+		std::vector<std::pair<std::function<void()>, JobCounter*>> continuations;
+		{
+			std::lock_guard<std::mutex> lock(counter->m_ContinuationMutex);
+			if (counter->m_Count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				continuations.swap(counter->m_Continuations);
+			}
+		}
+
+		for (auto &continuation : continuations)
+		{
+			Job job;
+			job.Function = std::move(continuation.first);
+			job.Counter = continuation.second;
+			Push(std::move(job));
+		}
+	}
+}
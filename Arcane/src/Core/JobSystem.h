@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Arcane
+{
+	// Number of unfinished jobs in a group. Jobs can be scheduled to run once a counter reaches zero, and waiting on a counter runs other jobs in the meantime
+	class JobCounter
+	{
+		friend class JobSystem;
+	public:
+		JobCounter() = default;
+		JobCounter(const JobCounter &counter) = delete;
+		JobCounter& operator=(const JobCounter &counter) = delete;
+
+		inline bool IsDone() const { return m_Count.load(std::memory_order_acquire) == 0; }
+	private:
+		std::atomic<uint32_t> m_Count{ 0 };
+		std::mutex m_ContinuationMutex;
+		std::vector<std::pair<std::function<void()>, JobCounter*>> m_Continuations; // Jobs waiting for this counter to reach zero
+	};
+
+	struct Job
+	{
+		std::function<void()> Function;
+		JobCounter *Counter = nullptr;
+	};
+
+	// Owned by a single thread, which pushes and pops at the back. Idle threads steal from the front so they take the oldest (usually largest) work
+	struct JobQueue
+	{
+		std::mutex Mutex;
+		std::deque<Job> Jobs;
+	};
+
+	// Work-stealing job system. Every worker and the main thread have their own queue, the main thread takes part in the work whenever it waits on a counter
+	class JobSystem
+	{
+	public:
+		// threadCount includes the main thread, 0 gives one thread per hardware thread. Pinning keeps the main thread on the first core so the OS doesn't move it around
+		static void Initialize(uint32_t threadCount = 0, bool pinMainThread = false);
+		static void Shutdown();
+
+		static void Run(std::function<void()> function, JobCounter *counter = nullptr);
+		// Schedules the job once dependency reaches zero (right away if it already has)
+		static void RunAfter(JobCounter *dependency, std::function<void()> function, JobCounter *counter = nullptr);
+
+		// Runs function(begin, end) over [0, count) in batches of batchSize. The blocking version waits for every batch, the other adds them to counter
+		// and the function has to stay alive until the counter has been waited on
+		static void ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t, uint32_t)> &function);
+		static void ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t, uint32_t)> &function, JobCounter *counter);
+
+		// Runs other jobs on the calling thread until the counter reaches zero. A counter must not be destroyed before it has been waited on
+		static void Wait(JobCounter *counter);
+
+		// Index of the calling thread, 0 for the main thread and 1 to GetThreadCount() - 1 for the workers. Used to index per thread resources
+		static uint32_t GetThreadIndex();
+		inline static uint32_t GetThreadCount() { return static_cast<uint32_t>(s_Queues.size()); }
+		inline static bool IsInitialized() { return !s_Queues.empty(); }
+		inline static bool IsMainThreadPinned() { return s_MainThreadPinned; }
+	private:
+		static void WorkerLoop(uint32_t threadIndex);
+		static void Push(Job &&job);
+		static bool TryRunJob(uint32_t threadIndex);
+		static bool PopOrSteal(uint32_t threadIndex, Job &outJob);
+		static void FinishJob(JobCounter *counter);
+	private:
+		static std::vector<std::unique_ptr<JobQueue>> s_Queues;
+		static std::vector<std::thread> s_Workers;
+		static bool s_MainThreadPinned; // Kept so restarting the job system can keep the setting
+
+		static std::atomic<bool> s_Running;
+		static std::atomic<uint32_t> s_QueuedJobCount;
+		static std::mutex s_SleepMutex;
+		static std::condition_variable s_WakeCondition; // Idle workers sleep until a job is pushed
+	};
+}
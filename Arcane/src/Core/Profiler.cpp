@@ -0,0 +1,24 @@
+#include "arcpch.h"
+#include "Profiler.h"
+
+#include <chrono>
+
+namespace Arcane
+{
+	Profiler& Profiler::GetInstance()
+	{
+		static Profiler profiler;
+		return profiler;
+	}
+
+	void Profiler::BeginFrame()
+	{
+		m_LastFrameStats = m_CurrentFrameStats;
+		m_CurrentFrameStats = FrameStats();
+	}
+
+	double Profiler::GetTimeMs()
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Core/Singleton.h"
+
+namespace Arcane
+{
+	// CPU timings and counters gathered over a single frame. GPU timings are read back once the GPU is done with a frame, so they trail the CPU by a few frames
+	struct FrameStats
+	{
+		double CommandRecordTime = 0.0; // Milliseconds spent recording the frame's command buffers
+		uint32_t DrawCount = 0; // Draw calls recorded by the CPU
+		uint32_t IndirectDrawCount = 0; // Draws submitted through indirect draw calls, these don't cost the CPU anything per draw
+		uint32_t SubmittedDrawCount = 0; // Draws submitted to the render queue, before they were merged into instanced draws
+		double DrawSortTime = 0.0; // Milliseconds spent sorting the render queue
+		uint32_t UnsortedBindCount = 0; // Pipeline, buffer and descriptor set binds the draws would have needed in submission order
+		uint32_t SortedBindCount = 0; // Binds the draws need after sorting
+
+		double GraphicsGpuTime = 0.0; // Milliseconds the graphics queue spent on the frame's command buffer
+		double AsyncComputeGpuTime = 0.0; // Milliseconds the compute queue spent on the frame's async compute work
+		double AsyncComputeOverlapTime = 0.0; // Milliseconds of the async compute work that ran at the same time as the graphics work
+		uint64_t FragmentShaderInvocations = 0; // Of the frame's graphics work, stays 0 if the device can't count them
+
+		// Occlusion culling object counts, read back with the GPU times
+		uint32_t OcclusionEarlyDrawCount = 0; // Visible last frame and still in the frustum
+		uint32_t OcclusionLateDrawCount = 0; // Became visible this frame
+		uint32_t FrustumCulledCount = 0;
+		uint32_t OcclusionCulledCount = 0;
+
+		// Cluster culling cluster counts, read back with the GPU times
+		uint32_t ClusterEarlyDrawCount = 0; // Visible last frame, still facing the camera and in the frustum
+		uint32_t ClusterLateDrawCount = 0; // Became visible this frame
+		uint32_t ClusterBackfaceCulledCount = 0; // Facing away from the camera by their normal cones
+		uint32_t ClusterFrustumCulledCount = 0;
+		uint32_t ClusterOcclusionCulledCount = 0;
+
+		// CPU software occlusion
+		double SoftwareOcclusionRasterTime = 0.0; // Milliseconds spent rasterizing the occluders
+		double SoftwareOcclusionTestTime = 0.0; // Milliseconds spent testing objects against the occluders
+		uint32_t SoftwareOccluderTriangleCount = 0;
+		uint32_t SoftwareOcclusionTestedCount = 0;
+		uint32_t SoftwareOcclusionCulledCount = 0;
+		// Compared against the same occluders at a higher resolution, only filled while the renderer measures the accuracy
+		double SoftwareOcclusionAccuracy = 0.0; // Percentage of the objects the higher resolution hides that were culled
+		uint32_t SoftwareOcclusionFalseVisibleCount = 0; // Drawn although the higher resolution hides them
+		uint32_t SoftwareOcclusionFalseOccludedCount = 0; // Culled although they are visible at the higher resolution, these pop
+	};
+
+	// Systems write into the stats of the frame in progress, the stats of the last completed frame are kept around so they can be displayed
+	class Profiler : public Singleton
+	{
+	private:
+		Profiler() = default;
+		virtual ~Profiler() = default;
+	public:
+		static Profiler& GetInstance();
+
+		// Called once at the start of every frame by the application
+		void BeginFrame();
+
+		inline FrameStats& GetCurrentFrameStats() { return m_CurrentFrameStats; }
+		inline const FrameStats& GetLastFrameStats() const { return m_LastFrameStats; }
+
+		// Milliseconds since an arbitrary point in time, used to time CPU work
+		static double GetTimeMs();
+	private:
+		FrameStats m_CurrentFrameStats;
+		FrameStats m_LastFrameStats;
+	};
+}
@@ -0,0 +1,296 @@
+#include "arcpch.h"
+#include "GeometryPool.h"
+
+#include "Graphics/VertexLayouts.h"
+#include "Graphics/Renderer/VulkanAPI.h"
+
+namespace Arcane
+{
+	RangeAllocator::RangeAllocator(uint32_t capacity) : m_Capacity(capacity), m_FreeCount(0)
+	{
+		Reset(0);
+	}
+
+	bool RangeAllocator::Allocate(uint32_t count, uint32_t *outOffset)
+	{
+		if (count == 0)
+		{
+			*outOffset = 0;
+			return true;
+		}
+
+		// Best fit, the leftover of the smallest range that fits is the least likely to be too small for anything
+		size_t best = m_FreeRanges.size();
+		for (size_t i = 0; i < m_FreeRanges.size(); i++)
+		{
+			if (m_FreeRanges[i].Count >= count && (best == m_FreeRanges.size() || m_FreeRanges[i].Count < m_FreeRanges[best].Count))
+			{
+				best = i;
+				if (m_FreeRanges[i].Count == count)
+					break;
+			}
+		}
+		if (best == m_FreeRanges.size())
+			return false;
+
+		*outOffset = m_FreeRanges[best].Offset;
+		m_FreeRanges[best].Offset += count;
+		m_FreeRanges[best].Count -= count;
+		if (m_FreeRanges[best].Count == 0)
+			m_FreeRanges.erase(m_FreeRanges.begin() + best);
+
+		m_FreeCount -= count;
+		return true;
+	}
+
+	void RangeAllocator::Free(uint32_t offset, uint32_t count)
+	{
+		if (count == 0)
+			return;
+
+		ARC_ASSERT(offset + count <= m_Capacity, "RangeAllocator: Range {0} + {1} is out of range", offset, count);
+		auto next = std::lower_bound(m_FreeRanges.begin(), m_FreeRanges.end(), offset, [](const FreeRange &range, uint32_t value) { return range.Offset < value; });
+
+		// Merge with the free ranges right before and after it
+		bool mergesPrevious = next != m_FreeRanges.begin() && (next - 1)->Offset + (next - 1)->Count == offset;
+		bool mergesNext = next != m_FreeRanges.end() && offset + count == next->Offset;
+		if (mergesPrevious && mergesNext)
+		{
+			(next - 1)->Count += count + next->Count;
+			m_FreeRanges.erase(next);
+		}
+		else if (mergesPrevious)
+		{
+			(next - 1)->Count += count;
+		}
+		else if (mergesNext)
+		{
+			next->Offset = offset;
+			next->Count += count;
+		}
+		else
+		{
+			FreeRange range;
+			range.Offset = offset;
+			range.Count = count;
+			m_FreeRanges.insert(next, range);
+		}
+
+		m_FreeCount += count;
+	}
+
+	void RangeAllocator::Reset(uint32_t usedCount)
+	{
+		m_FreeRanges.clear();
+		m_FreeCount = m_Capacity - usedCount;
+		if (m_FreeCount > 0)
+		{
+			FreeRange range;
+			range.Offset = usedCount;
+			range.Count = m_FreeCount;
+			m_FreeRanges.push_back(range);
+		}
+	}
+
+	uint32_t RangeAllocator::GetLargestFreeRange() const
+	{
+		uint32_t largest = 0;
+		for (const FreeRange &range : m_FreeRanges)
+		{
+			largest = std::max(largest, range.Count);
+		}
+		return largest;
+	}
+
+	GeometryPool::GeometryPool(const VulkanAPI *const vulkan, VertexLayout vertexLayout, VertexStreams vertexStreams, VkIndexType indexType, uint32_t maxVertexCount, uint32_t maxIndexCount)
+		: m_Vulkan(vulkan), m_VertexLayout(vertexLayout), m_VertexStreams(vertexStreams), m_IndexType(indexType), m_VertexStride(VertexLayouts::GetStride(vertexLayout)), m_VertexBufferSize(0), m_VertexBuffer(VK_NULL_HANDLE),
+		m_IndexBuffer(VK_NULL_HANDLE), m_VertexBufferMemory(VK_NULL_HANDLE), m_IndexBufferMemory(VK_NULL_HANDLE), m_VertexAllocator(maxVertexCount), m_IndexAllocator(maxIndexCount)
+	{
+		ARC_ASSERT(vertexStreams != VertexStreams::POSITION_ONLY, "GeometryPool: Position only is a way to read split vertices, the pool has to store all of them");
+		ARC_ASSERT(indexType == VK_INDEX_TYPE_UINT16 || indexType == VK_INDEX_TYPE_UINT32, "GeometryPool: Indices have to be 16 or 32-bit");
+
+		StreamRegion region;
+		region.Offset = 0;
+		if (m_VertexStreams == VertexStreams::SPLIT)
+		{
+			// The attribute stream starts 16 byte aligned so every attribute in it stays aligned to its components
+			region.Stride = VertexLayouts::GetPositionStride(m_VertexLayout);
+			m_StreamRegions.push_back(region);
+			region.Offset = (static_cast<VkDeviceSize>(maxVertexCount) * region.Stride + 15) & ~static_cast<VkDeviceSize>(15);
+			region.Stride = VertexLayouts::GetAttributeStride(m_VertexLayout);
+			m_StreamRegions.push_back(region);
+		}
+		else
+		{
+			region.Stride = m_VertexStride;
+			m_StreamRegions.push_back(region);
+		}
+		m_VertexBufferSize = m_StreamRegions.back().Offset + static_cast<VkDeviceSize>(maxVertexCount) * m_StreamRegions.back().Stride;
+
+		CreateBuffers(&m_VertexBuffer, &m_VertexBufferMemory, &m_IndexBuffer, &m_IndexBufferMemory);
+	}
+
+	GeometryPool::~GeometryPool()
+	{
+		vkDestroyBuffer(*m_Vulkan->GetDevice(), m_VertexBuffer, nullptr);
+		vkFreeMemory(*m_Vulkan->GetDevice(), m_VertexBufferMemory, nullptr);
+		vkDestroyBuffer(*m_Vulkan->GetDevice(), m_IndexBuffer, nullptr);
+		vkFreeMemory(*m_Vulkan->GetDevice(), m_IndexBufferMemory, nullptr);
+	}
+
+	GeometryHandle GeometryPool::Allocate(const void *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount)
+	{
+		ARC_ASSERT(vertexCount <= m_VertexAllocator.GetFreeCount() && indexCount <= m_IndexAllocator.GetFreeCount(), "GeometryPool: Out of space for a mesh with {0} vertices and {1} indices",
+			vertexCount, indexCount);
+		// 0xFFFF is kept free since it restarts primitives when that is enabled
+		ARC_ASSERT(m_IndexType == VK_INDEX_TYPE_UINT32 || vertexCount <= 0xFFFF, "GeometryPool: A mesh with {0} vertices doesn't fit 16-bit indices", vertexCount);
+
+		GeometryRange range;
+		range.VertexCount = vertexCount;
+		range.IndexCount = indexCount;
+		if (vertexCount > m_VertexAllocator.GetLargestFreeRange() || indexCount > m_IndexAllocator.GetLargestFreeRange())
+		{
+			ARC_LOG_WARN("GeometryPool: Compacting, the pool is too fragmented for a mesh with {0} vertices and {1} indices", vertexCount, indexCount);
+			Compact();
+		}
+
+		bool allocated = m_VertexAllocator.Allocate(vertexCount, &range.FirstVertex);
+		allocated = allocated && m_IndexAllocator.Allocate(indexCount, &range.FirstIndex);
+		ARC_ASSERT(allocated, "GeometryPool: Failed to allocate a mesh with {0} vertices and {1} indices", vertexCount, indexCount);
+
+		if (m_VertexStreams == VertexStreams::SPLIT)
+		{
+			std::vector<uint8_t> positions(static_cast<size_t>(vertexCount) * m_StreamRegions[0].Stride), attributes(static_cast<size_t>(vertexCount) * m_StreamRegions[1].Stride);
+			VertexLayouts::SplitStreams(m_VertexLayout, vertices, vertexCount, positions.data(), attributes.data());
+			m_Vulkan->UploadToBuffer(m_VertexBuffer, positions.data(), positions.size(), m_StreamRegions[0].Offset + static_cast<VkDeviceSize>(range.FirstVertex) * m_StreamRegions[0].Stride);
+			m_Vulkan->UploadToBuffer(m_VertexBuffer, attributes.data(), attributes.size(), m_StreamRegions[1].Offset + static_cast<VkDeviceSize>(range.FirstVertex) * m_StreamRegions[1].Stride);
+		}
+		else
+		{
+			m_Vulkan->UploadToBuffer(m_VertexBuffer, vertices, static_cast<VkDeviceSize>(vertexCount) * m_VertexStride, static_cast<VkDeviceSize>(range.FirstVertex) * m_VertexStride);
+		}
+		if (m_IndexType == VK_INDEX_TYPE_UINT16)
+		{
+			std::vector<uint16_t> narrowedIndices(indices, indices + indexCount);
+			m_Vulkan->UploadToBuffer(m_IndexBuffer, narrowedIndices.data(), static_cast<VkDeviceSize>(indexCount) * GetIndexSize(), static_cast<VkDeviceSize>(range.FirstIndex) * GetIndexSize());
+		}
+		else
+		{
+			m_Vulkan->UploadToBuffer(m_IndexBuffer, indices, static_cast<VkDeviceSize>(indexCount) * GetIndexSize(), static_cast<VkDeviceSize>(range.FirstIndex) * GetIndexSize());
+		}
+
+		GeometryHandle handle;
+		if (!m_FreeHandles.empty())
+		{
+			handle = m_FreeHandles.back();
+			m_FreeHandles.pop_back();
+			m_Ranges[handle] = range;
+			m_RangeUsed[handle] = true;
+		}
+		else
+		{
+			handle = static_cast<GeometryHandle>(m_Ranges.size());
+			m_Ranges.push_back(range);
+			m_RangeUsed.push_back(true);
+		}
+		return handle;
+	}
+
+	void GeometryPool::Free(GeometryHandle handle)
+	{
+		ARC_ASSERT(handle < m_Ranges.size() && m_RangeUsed[handle], "GeometryPool: Freeing mesh {0} that isn't allocated", handle);
+
+		const GeometryRange &range = m_Ranges[handle];
+		m_VertexAllocator.Free(range.FirstVertex, range.VertexCount);
+		m_IndexAllocator.Free(range.FirstIndex, range.IndexCount);
+		m_RangeUsed[handle] = false;
+		m_FreeHandles.push_back(handle);
+	}
+
+	void GeometryPool::Compact()
+	{
+		// Source and destination ranges of a copy within one buffer can't overlap, so the meshes are packed into new buffers instead of moved in place
+		vkDeviceWaitIdle(*m_Vulkan->GetDevice());
+
+		VkBuffer vertexBuffer, indexBuffer;
+		VkDeviceMemory vertexBufferMemory, indexBufferMemory;
+		CreateBuffers(&vertexBuffer, &vertexBufferMemory, &indexBuffer, &indexBufferMemory);
+
+		std::vector<VkBufferCopy> vertexCopies, indexCopies;
+		uint32_t vertexCount = 0, indexCount = 0;
+		for (GeometryHandle handle = 0; handle < m_Ranges.size(); handle++)
+		{
+			if (!m_RangeUsed[handle])
+				continue;
+
+			GeometryRange &range = m_Ranges[handle];
+			for (const StreamRegion &region : m_StreamRegions)
+			{
+				if (range.VertexCount == 0)
+					continue;
+
+				VkBufferCopy copy = {};
+				copy.srcOffset = region.Offset + static_cast<VkDeviceSize>(range.FirstVertex) * region.Stride;
+				copy.dstOffset = region.Offset + static_cast<VkDeviceSize>(vertexCount) * region.Stride;
+				copy.size = static_cast<VkDeviceSize>(range.VertexCount) * region.Stride;
+				vertexCopies.push_back(copy);
+			}
+			if (range.IndexCount > 0)
+			{
+				VkBufferCopy copy = {};
+				copy.srcOffset = static_cast<VkDeviceSize>(range.FirstIndex) * GetIndexSize();
+				copy.dstOffset = static_cast<VkDeviceSize>(indexCount) * GetIndexSize();
+				copy.size = static_cast<VkDeviceSize>(range.IndexCount) * GetIndexSize();
+				indexCopies.push_back(copy);
+			}
+
+			range.FirstVertex = vertexCount;
+			range.FirstIndex = indexCount;
+			vertexCount += range.VertexCount;
+			indexCount += range.IndexCount;
+		}
+
+		if (!vertexCopies.empty() || !indexCopies.empty())
+		{
+			VkCommandBuffer commandBuffer = m_Vulkan->BeginUploadCommands();
+			if (!vertexCopies.empty())
+				vkCmdCopyBuffer(commandBuffer, m_VertexBuffer, vertexBuffer, static_cast<uint32_t>(vertexCopies.size()), vertexCopies.data());
+			if (!indexCopies.empty())
+				vkCmdCopyBuffer(commandBuffer, m_IndexBuffer, indexBuffer, static_cast<uint32_t>(indexCopies.size()), indexCopies.data());
+			m_Vulkan->SubmitUploadCommands(commandBuffer);
+		}
+
+		vkDestroyBuffer(*m_Vulkan->GetDevice(), m_VertexBuffer, nullptr);
+		vkFreeMemory(*m_Vulkan->GetDevice(), m_VertexBufferMemory, nullptr);
+		vkDestroyBuffer(*m_Vulkan->GetDevice(), m_IndexBuffer, nullptr);
+		vkFreeMemory(*m_Vulkan->GetDevice(), m_IndexBufferMemory, nullptr);
+		m_VertexBuffer = vertexBuffer;
+		m_VertexBufferMemory = vertexBufferMemory;
+		m_IndexBuffer = indexBuffer;
+		m_IndexBufferMemory = indexBufferMemory;
+
+		m_VertexAllocator.Reset(vertexCount);
+		m_IndexAllocator.Reset(indexCount);
+	}
+
+	void GeometryPool::Bind(VkCommandBuffer commandBuffer) const
+	{
+		VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_VertexBuffer, offsets);
+		if (m_VertexStreams == VertexStreams::SPLIT)
+		{
+			vkCmdBindVertexBuffers(commandBuffer, VertexLayouts::ATTRIBUTE_STREAM_BINDING, 1, &m_VertexBuffer, &m_StreamRegions[1].Offset);
+		}
+		vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer, 0, m_IndexType);
+	}
+
+	void GeometryPool::CreateBuffers(VkBuffer *outVertexBuffer, VkDeviceMemory *outVertexMemory, VkBuffer *outIndexBuffer, VkDeviceMemory *outIndexMemory) const
+	{
+		// Concurrent like the other vertex buffers, uploads go through the copy queue. Transfer source so the meshes can be copied out when compacting
+		VkBufferUsageFlags transferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		m_Vulkan->CreateBuffer(m_VertexBufferSize, transferUsage | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_SHARING_MODE_CONCURRENT, outVertexBuffer, outVertexMemory);
+		m_Vulkan->CreateBuffer(static_cast<VkDeviceSize>(m_IndexAllocator.GetCapacity()) * GetIndexSize(), transferUsage | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_SHARING_MODE_CONCURRENT, outIndexBuffer, outIndexMemory);
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Graphics/Vertex.h"
+
+namespace Arcane
+{
+	class VulkanAPI;
+
+	using GeometryHandle = uint32_t;
+	const GeometryHandle INVALID_GEOMETRY_HANDLE = ~0u;
+
+	// Where a mesh lives in the pool. Its indices are relative to its own vertices, so draws use FirstVertex as their vertexOffset
+	struct GeometryRange
+	{
+		uint32_t FirstVertex = 0;
+		uint32_t VertexCount = 0;
+		uint32_t FirstIndex = 0;
+		uint32_t IndexCount = 0;
+	};
+
+	// Hands out ranges of [0, capacity). Free ranges are kept sorted by offset and merged with their neighbours when freed, allocations take the smallest free range they fit in
+	class RangeAllocator
+	{
+	public:
+		RangeAllocator(uint32_t capacity);
+
+		// Returns false when no single free range is big enough, even if there is enough free space in total
+		bool Allocate(uint32_t count, uint32_t *outOffset);
+		void Free(uint32_t offset, uint32_t count);
+		void Reset(uint32_t usedCount); // Everything below usedCount is allocated, everything above is free
+
+		// Getters
+		inline uint32_t GetCapacity() const { return m_Capacity; }
+		inline uint32_t GetFreeCount() const { return m_FreeCount; }
+		uint32_t GetLargestFreeRange() const;
+	private:
+		struct FreeRange
+		{
+			uint32_t Offset;
+			uint32_t Count;
+		};
+
+		uint32_t m_Capacity;
+		uint32_t m_FreeCount;
+		std::vector<FreeRange> m_FreeRanges;
+	};
+
+	// A few large device local buffers that every mesh of one vertex layout is sub-allocated from, so all of them draw with a single vertex and index buffer bind
+	// and a whole scene can be drawn from one indirect multi-draw. Meshes are referred to by handle since compacting the pool moves their ranges.
+	// With split streams the vertex buffer holds the position stream followed by the attribute stream, a range covers the same vertices in both.
+	// Indices are relative to their mesh's vertices, so a pool of 16-bit indices can hold any number of meshes as long as each has fewer than 0xFFFF vertices
+	class GeometryPool
+	{
+	public:
+		GeometryPool(const VulkanAPI *const vulkan, VertexLayout vertexLayout, VertexStreams vertexStreams, VkIndexType indexType, uint32_t maxVertexCount, uint32_t maxIndexCount);
+		~GeometryPool();
+
+		// Uploads the mesh into free ranges of the pool. Compacts the pool first if it is too fragmented to fit the mesh, which waits for the device to be idle
+		// The vertices have to be in the pool's layout and interleaved, they are split on upload if the pool stores split streams. The indices are narrowed on upload
+		// if the pool stores 16-bit indices
+		GeometryHandle Allocate(const void *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount);
+		// The ranges can be handed out again right away, so the GPU has to be done with every draw of the mesh
+		void Free(GeometryHandle handle);
+
+		// Moves every mesh to the start of the buffers so the free space is in one piece. Waits for the device to be idle, ranges of every handle can change
+		void Compact();
+
+		// Binds the vertex buffer to binding 0 (and the attribute stream to binding 2) and the index buffer
+		void Bind(VkCommandBuffer commandBuffer) const;
+
+		// Getters
+		inline VertexLayout GetVertexLayout() const { return m_VertexLayout; }
+		inline VertexStreams GetVertexStreams() const { return m_VertexStreams; }
+		inline VkIndexType GetIndexType() const { return m_IndexType; }
+		inline VkDeviceSize GetIndexSize() const { return m_IndexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t); }
+		inline const GeometryRange& GetRange(GeometryHandle handle) const { return m_Ranges[handle]; }
+		inline uint32_t GetUsedVertexCount() const { return m_VertexAllocator.GetCapacity() - m_VertexAllocator.GetFreeCount(); }
+		inline uint32_t GetUsedIndexCount() const { return m_IndexAllocator.GetCapacity() - m_IndexAllocator.GetFreeCount(); }
+		inline uint32_t GetMeshCount() const { return static_cast<uint32_t>(m_Ranges.size() - m_FreeHandles.size()); }
+	private:
+		void CreateBuffers(VkBuffer *outVertexBuffer, VkDeviceMemory *outVertexMemory, VkBuffer *outIndexBuffer, VkDeviceMemory *outIndexMemory) const;
+	private:
+		const VulkanAPI *const m_Vulkan;
+		VertexLayout m_VertexLayout;
+		VertexStreams m_VertexStreams;
+		VkIndexType m_IndexType;
+		uint32_t m_VertexStride;
+
+		// Regions of the vertex buffer, the whole vertex when interleaved, otherwise the positions and then the other attributes
+		struct StreamRegion
+		{
+			VkDeviceSize Offset;
+			uint32_t Stride;
+		};
+		std::vector<StreamRegion> m_StreamRegions;
+		VkDeviceSize m_VertexBufferSize;
+
+		VkBuffer m_VertexBuffer, m_IndexBuffer;
+		VkDeviceMemory m_VertexBufferMemory, m_IndexBufferMemory;
+		RangeAllocator m_VertexAllocator, m_IndexAllocator;
+
+		std::vector<GeometryRange> m_Ranges; // Indexed by handle
+		std::vector<bool> m_RangeUsed;
+		std::vector<GeometryHandle> m_FreeHandles;
+	};
+}
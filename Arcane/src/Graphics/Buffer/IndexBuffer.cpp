@@ -5,9 +5,33 @@
 
 namespace Arcane
 {
-	IndexBuffer::IndexBuffer(const VulkanAPI *const vulkan, const uint32_t *data, size_t amount) : m_Vulkan(vulkan), m_Count(static_cast<uint32_t>(amount))
+	IndexBuffer::IndexBuffer(const VulkanAPI *const vulkan, const uint32_t *data, size_t amount) : m_Vulkan(vulkan), m_Count(static_cast<uint32_t>(amount)), m_IndexType(VK_INDEX_TYPE_UINT32)
 	{
-		LoadData(data, amount);
+		ARC_ASSERT(data, "IndexBuffer: Failed to initialize because no data was provided");
+
+		// 0xFFFF is kept free since it restarts primitives when that is enabled
+		uint32_t maxIndex = 0;
+		for (size_t i = 0; i < amount; i++)
+		{
+			maxIndex = std::max(maxIndex, data[i]);
+		}
+
+		if (maxIndex < 0xFFFF)
+		{
+			std::vector<uint16_t> narrowedData(data, data + amount);
+			m_IndexType = VK_INDEX_TYPE_UINT16;
+			LoadData(narrowedData.data(), GetSize());
+		}
+		else
+		{
+			LoadData(data, GetSize());
+		}
+	}
+
+	IndexBuffer::IndexBuffer(const VulkanAPI *const vulkan, const uint16_t *data, size_t amount) : m_Vulkan(vulkan), m_Count(static_cast<uint32_t>(amount)), m_IndexType(VK_INDEX_TYPE_UINT16)
+	{
+		ARC_ASSERT(data, "IndexBuffer: Failed to initialize because no data was provided");
+		LoadData(data, GetSize());
 	}
 
 	IndexBuffer::~IndexBuffer()
@@ -18,14 +42,11 @@ namespace Arcane
 
 	void IndexBuffer::Bind(VkCommandBuffer &commandBuffer)
 	{
-		vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+		vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer, 0, m_IndexType);
 	}
 
-	void IndexBuffer::LoadData(const uint32_t *data, size_t amount)
+	void IndexBuffer::LoadData(const void *data, VkDeviceSize bufferSize)
 	{
-		ARC_ASSERT(data, "IndexBuffer: Failed to initialize because no data was provided");
-
-		VkDeviceSize bufferSize = sizeof(data[0]) * amount;
 		VkBuffer stagingBuffer;
 		VkDeviceMemory stagingBufferMemory;
 
@@ -4,22 +4,26 @@ namespace Arcane
 {
 	class VulkanAPI;
 
-	// TODO: Index buffer shouldn't use 32 bit indices when it is not needed
+	// Stores the indices as 16 bit whenever every index fits, which halves the memory and the bandwidth of reading them
 	class IndexBuffer
 	{
 	public:
 		IndexBuffer(const VulkanAPI *const vulkan, const uint32_t *data, size_t amount);
+		IndexBuffer(const VulkanAPI *const vulkan, const uint16_t *data, size_t amount);
 		~IndexBuffer();
 
 		void Bind(VkCommandBuffer &commandBuffer);
 
 		inline uint32_t GetCount() { return m_Count; }
+		inline VkIndexType GetIndexType() const { return m_IndexType; }
+		inline VkDeviceSize GetSize() const { return static_cast<VkDeviceSize>(m_Count) * (m_IndexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t)); }
 	private:
-		void LoadData(const uint32_t *data, size_t amount);
+		void LoadData(const void *data, VkDeviceSize bufferSize);
 	private:
 		const VulkanAPI *const m_Vulkan;
 
 		uint32_t m_Count;
+		VkIndexType m_IndexType;
 		VkDeviceMemory m_IndexBufferMemory;
 		VkBuffer m_IndexBuffer;
 	};
@@ -0,0 +1,99 @@
+#include "arcpch.h"
+#include "IndirectDrawBuffer.h"
+
+#include "Graphics/Renderer/VulkanAPI.h"
+
+namespace Arcane
+{
+	IndirectDrawBuffer::IndirectDrawBuffer(const VulkanAPI *const vulkan, uint32_t maxDrawCount, uint32_t framesInFlight, IndirectDrawSource source)
+		: m_Vulkan(vulkan), m_Source(source), m_MaxDrawCount(maxDrawCount), m_FramesInFlight(framesInFlight), m_CurrentFrame(0), m_FrameSize(0), m_Buffer(VK_NULL_HANDLE),
+		m_BufferMemory(VK_NULL_HANDLE), m_MappedMemory(nullptr), m_DrawCount(0)
+	{
+		VkDeviceSize commandsSize = COMMANDS_OFFSET + static_cast<VkDeviceSize>(m_MaxDrawCount) * sizeof(VkDrawIndexedIndirectCommand);
+		m_FrameSize = (commandsSize + FRAME_ALIGNMENT - 1) / FRAME_ALIGNMENT * FRAME_ALIGNMENT;
+
+		if (m_Source == IndirectDrawSource::CPU)
+		{
+			// Host visible so the CPU writes the commands straight into the buffer the GPU reads, each frame in flight writes its own region so nothing the GPU is still reading gets overwritten
+			m_Vulkan->CreateBuffer(m_FrameSize * m_FramesInFlight, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				VK_SHARING_MODE_EXCLUSIVE, &m_Buffer, &m_BufferMemory);
+
+			void *mappedMemory;
+			VkResult result = vkMapMemory(*m_Vulkan->GetDevice(), m_BufferMemory, 0, VK_WHOLE_SIZE, 0, &mappedMemory);
+			ARC_ASSERT(result == VK_SUCCESS, "IndirectDrawBuffer: Failed to map the draw argument buffer");
+			m_MappedMemory = static_cast<uint8_t*>(mappedMemory);
+		}
+		else
+		{
+			// Concurrent since the commands are usually written on the async compute queue and read on the graphics queue
+			m_Vulkan->CreateBuffer(m_FrameSize * m_FramesInFlight, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_SHARING_MODE_CONCURRENT, &m_Buffer, &m_BufferMemory);
+		}
+	}
+
+	IndirectDrawBuffer::~IndirectDrawBuffer()
+	{
+		if (m_MappedMemory)
+			vkUnmapMemory(*m_Vulkan->GetDevice(), m_BufferMemory);
+
+		vkDestroyBuffer(*m_Vulkan->GetDevice(), m_Buffer, nullptr);
+		vkFreeMemory(*m_Vulkan->GetDevice(), m_BufferMemory, nullptr);
+	}
+
+	void IndirectDrawBuffer::BeginFrame(uint32_t frameIndex)
+	{
+		ARC_ASSERT(frameIndex < m_FramesInFlight, "IndirectDrawBuffer: Frame {0} is out of range", frameIndex);
+
+		m_CurrentFrame = frameIndex;
+		m_DrawCount = 0;
+	}
+
+	VkDrawIndexedIndirectCommand* IndirectDrawBuffer::AllocateDraws(uint32_t count, uint32_t *outFirstDraw)
+	{
+		ARC_ASSERT(m_Source == IndirectDrawSource::CPU, "IndirectDrawBuffer: Only buffers written by the CPU can allocate draws");
+
+		uint32_t firstDraw = m_DrawCount.fetch_add(count);
+		ARC_ASSERT(firstDraw + count <= m_MaxDrawCount, "IndirectDrawBuffer: Ran out of draws ({0} max)", m_MaxDrawCount);
+
+		*outFirstDraw = firstDraw;
+		return reinterpret_cast<VkDrawIndexedIndirectCommand*>(m_MappedMemory + GetCommandOffset(firstDraw));
+	}
+
+	uint32_t IndirectDrawBuffer::AddDraw(const VkDrawIndexedIndirectCommand &command)
+	{
+		uint32_t draw;
+		*AllocateDraws(1, &draw) = command;
+		return draw;
+	}
+
+	void IndirectDrawBuffer::ResetDrawCount(VkCommandBuffer commandBuffer) const
+	{
+		ARC_ASSERT(m_Source == IndirectDrawSource::GPU, "IndirectDrawBuffer: The draw count of buffers written by the CPU is reset in BeginFrame()");
+
+		vkCmdFillBuffer(commandBuffer, m_Buffer, GetCountOffset(), sizeof(uint32_t), 0);
+	}
+
+	void IndirectDrawBuffer::Draw(VkCommandBuffer commandBuffer, uint32_t firstDraw, uint32_t drawCount) const
+	{
+		if (drawCount == 0)
+			return;
+
+		const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+		const VulkanExtensionFunctions &extensions = m_Vulkan->GetExtensionFunctions();
+		if (m_Source == IndirectDrawSource::GPU && extensions.CmdDrawIndexedIndirectCount)
+		{
+			// The count covers the whole region, so the GPU written draws always start at the first command
+			ARC_ASSERT(firstDraw == 0, "IndirectDrawBuffer: Draws written by the GPU have to be drawn from the start of the buffer");
+			extensions.CmdDrawIndexedIndirectCount(commandBuffer, m_Buffer, GetCommandOffset(0), m_Buffer, GetCountOffset(), drawCount, stride);
+			return;
+		}
+
+		// Without multi draw indirect every command needs its own call, which still saves the CPU from binding anything per draw
+		uint32_t maxDrawsPerCall = m_Vulkan->IsMultiDrawIndirectEnabled() ? m_Vulkan->GetPhysicalDeviceLimits().maxDrawIndirectCount : 1;
+		for (uint32_t draw = firstDraw; draw < firstDraw + drawCount; draw += maxDrawsPerCall)
+		{
+			uint32_t callDrawCount = std::min(maxDrawsPerCall, firstDraw + drawCount - draw);
+			vkCmdDrawIndexedIndirect(commandBuffer, m_Buffer, GetCommandOffset(draw), callDrawCount, stride);
+		}
+	}
+}
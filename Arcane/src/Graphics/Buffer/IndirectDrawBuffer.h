@@ -0,0 +1,61 @@
+#pragma once
+
+namespace Arcane
+{
+	class VulkanAPI;
+
+	enum class IndirectDrawSource
+	{
+		CPU, // Written through a persistent mapping, the draw count is known when recording
+		GPU  // Written by compute shaders, the draw count is read from the buffer with vkCmdDrawIndexedIndirectCount
+	};
+
+	// Persistent buffer of VkDrawIndexedIndirectCommand entries so a whole bucket of draws is submitted with a single call. Every frame in flight has its own region laid out as
+	//   uint32_t DrawCount; uint32_t Padding[3]; VkDrawIndexedIndirectCommand Commands[MaxDrawCount];
+	// which is also how compute shaders see it when the region is bound as a storage buffer (GetFrameOffset() and GetFrameSize())
+	class IndirectDrawBuffer
+	{
+	public:
+		IndirectDrawBuffer(const VulkanAPI *const vulkan, uint32_t maxDrawCount, uint32_t framesInFlight, IndirectDrawSource source);
+		~IndirectDrawBuffer();
+
+		// Switches to the frame's region and resets the CPU draw count, the frame's fence needs to have signaled
+		void BeginFrame(uint32_t frameIndex);
+
+		// CPU source only. Reserves consecutive commands and returns a pointer to the first, thread safe so draws can be written from jobs
+		VkDrawIndexedIndirectCommand* AllocateDraws(uint32_t count, uint32_t *outFirstDraw);
+		uint32_t AddDraw(const VkDrawIndexedIndirectCommand &command);
+
+		// GPU source only. Clears the draw count before the compute shaders append to it, the caller has to synchronize the transfer write with them
+		void ResetDrawCount(VkCommandBuffer commandBuffer) const;
+
+		// Records vkCmdDrawIndexedIndirect for a range of commands of the current frame. For the GPU source the draw count is read from the buffer when
+		// vkCmdDrawIndexedIndirectCount is supported, otherwise all maxDrawCount commands are drawn and unused ones need an instance count of 0
+		void Draw(VkCommandBuffer commandBuffer, uint32_t firstDraw, uint32_t drawCount) const;
+
+		// Getters
+		inline VkBuffer GetBuffer() const { return m_Buffer; }
+		inline IndirectDrawSource GetSource() const { return m_Source; }
+		inline uint32_t GetMaxDrawCount() const { return m_MaxDrawCount; }
+		inline uint32_t GetDrawCount() const { return m_DrawCount.load(); } // CPU source only
+		inline VkDeviceSize GetFrameOffset() const { return m_FrameSize * m_CurrentFrame; }
+		inline VkDeviceSize GetFrameSize() const { return m_FrameSize; }
+		inline VkDeviceSize GetCountOffset() const { return GetFrameOffset(); }
+		inline VkDeviceSize GetCommandOffset(uint32_t draw) const { return GetFrameOffset() + COMMANDS_OFFSET + static_cast<VkDeviceSize>(draw) * sizeof(VkDrawIndexedIndirectCommand); }
+	private:
+		const VulkanAPI *const m_Vulkan;
+		IndirectDrawSource m_Source;
+		uint32_t m_MaxDrawCount;
+		uint32_t m_FramesInFlight;
+		uint32_t m_CurrentFrame;
+		VkDeviceSize m_FrameSize;
+
+		VkBuffer m_Buffer;
+		VkDeviceMemory m_BufferMemory;
+		uint8_t *m_MappedMemory; // CPU source only, stays mapped for the lifetime of the buffer
+		std::atomic<uint32_t> m_DrawCount;
+
+		static const VkDeviceSize COMMANDS_OFFSET = 16;
+		static const VkDeviceSize FRAME_ALIGNMENT = 256; // Largest minStorageBufferOffsetAlignment allowed by the spec, so any frame can be bound as a storage buffer
+	};
+}
@@ -0,0 +1,52 @@
+#include "arcpch.h"
+#include "InstanceBuffer.h"
+
+#include "Graphics/Renderer/VulkanAPI.h"
+
+namespace Arcane
+{
+	InstanceBuffer::InstanceBuffer(const VulkanAPI *const vulkan, uint32_t maxInstanceCount, uint32_t framesInFlight)
+		: m_Vulkan(vulkan), m_MaxInstanceCount(maxInstanceCount), m_FramesInFlight(framesInFlight), m_CurrentFrame(0), m_FrameSize(0), m_Buffer(VK_NULL_HANDLE),
+		m_BufferMemory(VK_NULL_HANDLE), m_MappedMemory(nullptr), m_InstanceCount(0)
+	{
+		m_FrameSize = static_cast<VkDeviceSize>(m_MaxInstanceCount) * sizeof(InstanceData);
+
+		m_Vulkan->CreateBuffer(m_FrameSize * m_FramesInFlight, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			VK_SHARING_MODE_EXCLUSIVE, &m_Buffer, &m_BufferMemory);
+
+		void *mappedMemory;
+		VkResult result = vkMapMemory(*m_Vulkan->GetDevice(), m_BufferMemory, 0, VK_WHOLE_SIZE, 0, &mappedMemory);
+		ARC_ASSERT(result == VK_SUCCESS, "InstanceBuffer: Failed to map the instance buffer");
+		m_MappedMemory = static_cast<uint8_t*>(mappedMemory);
+	}
+
+	InstanceBuffer::~InstanceBuffer()
+	{
+		vkUnmapMemory(*m_Vulkan->GetDevice(), m_BufferMemory);
+		vkDestroyBuffer(*m_Vulkan->GetDevice(), m_Buffer, nullptr);
+		vkFreeMemory(*m_Vulkan->GetDevice(), m_BufferMemory, nullptr);
+	}
+
+	void InstanceBuffer::BeginFrame(uint32_t frameIndex)
+	{
+		ARC_ASSERT(frameIndex < m_FramesInFlight, "InstanceBuffer: Frame {0} is out of range", frameIndex);
+
+		m_CurrentFrame = frameIndex;
+		m_InstanceCount = 0;
+	}
+
+	InstanceData* InstanceBuffer::AllocateInstances(uint32_t count, uint32_t *outFirstInstance)
+	{
+		uint32_t firstInstance = m_InstanceCount.fetch_add(count);
+		ARC_ASSERT(firstInstance + count <= m_MaxInstanceCount, "InstanceBuffer: Ran out of instances ({0} max)", m_MaxInstanceCount);
+
+		*outFirstInstance = firstInstance;
+		return reinterpret_cast<InstanceData*>(m_MappedMemory + GetInstanceOffset(firstInstance));
+	}
+
+	void InstanceBuffer::Bind(VkCommandBuffer commandBuffer, uint32_t firstInstance) const
+	{
+		VkDeviceSize offset = GetInstanceOffset(firstInstance);
+		vkCmdBindVertexBuffers(commandBuffer, 1, 1, &m_Buffer, &offset);
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Graphics/Vertex.h"
+
+namespace Arcane
+{
+	class VulkanAPI;
+
+	// Transient per frame buffer of InstanceData that is bound to vertex binding 1. Written through a persistent mapping, every frame in flight has its own region
+	// so nothing the GPU is still reading gets overwritten. Instances are allocated fresh every frame and gone after BeginFrame() comes around to the region again
+	class InstanceBuffer
+	{
+	public:
+		InstanceBuffer(const VulkanAPI *const vulkan, uint32_t maxInstanceCount, uint32_t framesInFlight);
+		~InstanceBuffer();
+
+		// Switches to the frame's region and frees every instance in it, the frame's fence needs to have signaled
+		void BeginFrame(uint32_t frameIndex);
+
+		// Reserves consecutive instances and returns a pointer to the first, thread safe so instances can be written from jobs
+		InstanceData* AllocateInstances(uint32_t count, uint32_t *outFirstInstance);
+
+		// Binds the current frame's region starting at the instance, instanced draws then index it with their firstInstance
+		void Bind(VkCommandBuffer commandBuffer, uint32_t firstInstance = 0) const;
+
+		// Getters
+		inline uint32_t GetMaxInstanceCount() const { return m_MaxInstanceCount; }
+		inline uint32_t GetInstanceCount() const { return m_InstanceCount.load(); }
+		inline VkDeviceSize GetInstanceOffset(uint32_t instance) const { return m_FrameSize * m_CurrentFrame + static_cast<VkDeviceSize>(instance) * sizeof(InstanceData); }
+	private:
+		const VulkanAPI *const m_Vulkan;
+		uint32_t m_MaxInstanceCount;
+		uint32_t m_FramesInFlight;
+		uint32_t m_CurrentFrame;
+		VkDeviceSize m_FrameSize;
+
+		VkBuffer m_Buffer;
+		VkDeviceMemory m_BufferMemory;
+		uint8_t *m_MappedMemory; // Stays mapped for the lifetime of the buffer
+		std::atomic<uint32_t> m_InstanceCount;
+	};
+}
@@ -0,0 +1,55 @@
+#include "arcpch.h"
+#include "ComputeShader.h"
+
+#include "Core/HashUtils.h"
+#include "Graphics/ShaderModule.h"
+#include "Graphics/ShaderLoader.h"
+
+namespace Arcane
+{
+	ComputeShader::ComputeShader(ShaderModule *computeModule, const ShaderSpecialization &specialization)
+		: m_ComputeModule(computeModule), m_ShaderStage(), m_Specialization(specialization), m_PermutationKey(ComputePermutationKey(computeModule, specialization)), m_SpecializationInfo()
+	{
+		Init();
+	}
+
+	ComputeShader::~ComputeShader()
+	{
+		ShaderLoader::EvictComputeShader(m_PermutationKey);
+		ShaderLoader::ReleaseShaderModule(m_ComputeModule);
+	}
+
+	void ComputeShader::Init()
+	{
+		ARC_ASSERT(m_ComputeModule->GetStage() == VK_SHADER_STAGE_COMPUTE_BIT, "Shader: {0} is not a compute shader", m_ComputeModule->GetBinaryPath());
+
+		m_Reflection = m_ComputeModule->GetReflection();
+
+		const VkSpecializationInfo *specializationInfo = nullptr;
+		if (!m_Specialization.IsEmpty())
+		{
+			m_Specialization.GetSpecializationData(m_Reflection, m_SpecializationMapEntries, m_SpecializationData);
+
+			m_SpecializationInfo.mapEntryCount = static_cast<uint32_t>(m_SpecializationMapEntries.size());
+			m_SpecializationInfo.pMapEntries = m_SpecializationMapEntries.data();
+			m_SpecializationInfo.dataSize = m_SpecializationData.size() * sizeof(uint32_t);
+			m_SpecializationInfo.pData = m_SpecializationData.data();
+			specializationInfo = &m_SpecializationInfo;
+		}
+
+		m_ShaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		m_ShaderStage.pNext = nullptr;
+		m_ShaderStage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		m_ShaderStage.module = m_ComputeModule->GetModule();
+		m_ShaderStage.pName = "main";
+		m_ShaderStage.pSpecializationInfo = specializationInfo;
+	}
+
+	uint64_t ComputeShader::ComputePermutationKey(const ShaderModule *computeModule, const ShaderSpecialization &specialization)
+	{
+		uint64_t key = computeModule->GetContentHash();
+		HashUtils::Combine(key, specialization.GetHash());
+
+		return key;
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Graphics/ShaderSpecialization.h"
+#include "Graphics/ShaderReflection.h"
+
+namespace Arcane
+{
+	class ShaderModule;
+
+	// A shared compute stage module plus the specialization constants it is pipelined with
+	class ComputeShader
+	{
+	public:
+		ComputeShader(ShaderModule *computeModule, const ShaderSpecialization &specialization = ShaderSpecialization());
+		~ComputeShader();
+
+		inline const VkPipelineShaderStageCreateInfo& GetShaderStage() const { return m_ShaderStage; }
+		inline const ShaderSpecialization& GetSpecialization() const { return m_Specialization; }
+		inline const ShaderReflection& GetReflection() const { return m_Reflection; }
+		inline uint64_t GetPermutationKey() const { return m_PermutationKey; }
+
+		static uint64_t ComputePermutationKey(const ShaderModule *computeModule, const ShaderSpecialization &specialization);
+	private:
+		void Init();
+	private:
+		ShaderModule *m_ComputeModule; // Owned by the ShaderLoader, this shader holds a reference to it
+		VkPipelineShaderStageCreateInfo m_ShaderStage;
+		ShaderReflection m_Reflection;
+
+		const ShaderSpecialization m_Specialization;
+		const uint64_t m_PermutationKey;
+		std::vector<VkSpecializationMapEntry> m_SpecializationMapEntries;
+		std::vector<uint32_t> m_SpecializationData;
+		VkSpecializationInfo m_SpecializationInfo; // Referenced by m_ShaderStage so it needs to live as long as the shader
+	};
+}
@@ -1,6 +1,50 @@
 #include "arcpch.h"
+#include "Mesh.h"
+
+#include "Graphics/Renderer/ParallelCommandRecorder.h"
 
 namespace Arcane
 {
+	Mesh::Mesh(GeometryPool *geometryPool, const void *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount, const std::vector<MeshLod> &lods,
+		const std::vector<Meshlet> &meshlets, const glm::mat4 &dequantizeTransform)
+		: m_GeometryPool(geometryPool), m_Handle(INVALID_GEOMETRY_HANDLE), m_DequantizeTransform(dequantizeTransform), m_Lods(lods), m_Meshlets(meshlets)
+	{
+		if (m_Lods.empty())
+		{
+			MeshLod fullDetail;
+			fullDetail.FirstIndex = 0;
+			fullDetail.IndexCount = indexCount;
+			fullDetail.Error = 0.0f;
+			m_Lods.push_back(fullDetail);
+		}
+		for (const MeshLod &lod : m_Lods)
+		{
+			ARC_ASSERT(lod.FirstIndex + lod.IndexCount <= indexCount, "Mesh: LOD indices [{0}, {1}) are outside of the {2} indices", lod.FirstIndex, lod.FirstIndex + lod.IndexCount, indexCount);
+		}
+		for (const Meshlet &meshlet : m_Meshlets)
+		{
+			ARC_ASSERT(meshlet.FirstIndex + meshlet.IndexCount <= indexCount, "Mesh: Meshlet indices [{0}, {1}) are outside of the {2} indices", meshlet.FirstIndex, meshlet.FirstIndex + meshlet.IndexCount, indexCount);
+		}
+
+		m_Handle = m_GeometryPool->Allocate(vertices, vertexCount, indices, indexCount);
+	}
+
+	Mesh::~Mesh()
+	{
+		m_GeometryPool->Free(m_Handle);
+	}
+
+	void Mesh::SetupDraw(DrawCommand &draw, uint32_t lod) const
+	{
+		ARC_ASSERT(lod < m_Lods.size(), "Mesh: LOD {0} doesn't exist, the mesh has {1}", lod, m_Lods.size());
 
+		const GeometryRange &range = m_GeometryPool->GetRange(m_Handle);
+		draw.Geometry = m_GeometryPool;
+		draw.Vertices = nullptr;
+		draw.Indices = nullptr;
+		draw.FirstIndex = range.FirstIndex + m_Lods[lod].FirstIndex;
+		draw.IndexCount = m_Lods[lod].IndexCount;
+		draw.VertexOffset = static_cast<int32_t>(range.FirstVertex);
+		draw.DequantizeTransform = m_GeometryPool->GetVertexLayout() == VertexLayout::MESH_QUANTIZED ? &m_DequantizeTransform : nullptr;
+	}
 }
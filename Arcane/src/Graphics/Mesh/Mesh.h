@@ -1,11 +1,44 @@
 #pragma once
 
+#include "Graphics/Buffer/GeometryPool.h"
+#include "Graphics/Mesh/MeshletBuilder.h"
+#include "Graphics/Mesh/MeshSimplifier.h"
+
 namespace Arcane
 {
+	struct DrawCommand;
+
+	// Indexed mesh that lives in a range of a geometry pool instead of buffers of its own. Gives its range back to the pool when deleted,
+	// so like the pool's Free() the GPU has to be done drawing it. The range is looked up on every draw since compacting the pool moves it.
+	// Quantized meshes carry the transform back from their quantized positions, it goes before the instance transform of every draw. The levels of detail are
+	// all in the mesh's range, a mesh without any is its own only level. Meshlets split the full detail level into clusters that can be culled on their own
 	class Mesh
 	{
 	public:
-		Mesh();
+		// The vertices have to be in the pool's layout, the indices are every level's indices (see MeshSimplifier::GenerateLods()) with the full detail level
+		// ordered by meshlet (see MeshletBuilder::Build())
+		Mesh(GeometryPool *geometryPool, const void *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount, const std::vector<MeshLod> &lods = std::vector<MeshLod>(),
+			const std::vector<Meshlet> &meshlets = std::vector<Meshlet>(), const glm::mat4 &dequantizeTransform = glm::mat4(1.0f));
 		~Mesh();
+
+		// Points the draw at the level's indices in the pool
+		void SetupDraw(DrawCommand &draw, uint32_t lod = 0) const;
+
+		// Getters
+		inline GeometryPool* GetGeometryPool() const { return m_GeometryPool; }
+		inline const glm::mat4& GetDequantizeTransform() const { return m_DequantizeTransform; }
+		inline const std::vector<MeshLod>& GetLods() const { return m_Lods; }
+		inline uint32_t GetLodCount() const { return static_cast<uint32_t>(m_Lods.size()); }
+		inline uint32_t GetIndexCount(uint32_t lod = 0) const { return m_Lods[lod].IndexCount; }
+		inline uint32_t GetFirstIndex(uint32_t lod = 0) const { return m_GeometryPool->GetRange(m_Handle).FirstIndex + m_Lods[lod].FirstIndex; }
+		inline int32_t GetVertexOffset() const { return static_cast<int32_t>(m_GeometryPool->GetRange(m_Handle).FirstVertex); }
+		inline const std::vector<Meshlet>& GetMeshlets() const { return m_Meshlets; }
+		inline uint32_t GetMeshletFirstIndex(uint32_t meshlet) const { return m_GeometryPool->GetRange(m_Handle).FirstIndex + m_Meshlets[meshlet].FirstIndex; }
+	private:
+		GeometryPool *m_GeometryPool;
+		GeometryHandle m_Handle;
+		glm::mat4 m_DequantizeTransform;
+		std::vector<MeshLod> m_Lods;
+		std::vector<Meshlet> m_Meshlets;
 	};
 }
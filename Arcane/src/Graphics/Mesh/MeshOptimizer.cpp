@@ -0,0 +1,316 @@
+#include "arcpch.h"
+#include "MeshOptimizer.h"
+
+#include "Core/HashUtils.h"
+
+namespace Arcane
+{
+	void MeshOptimizer::Optimize(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+	{
+		ARC_ASSERT(indices.size() % 3 == 0, "MeshOptimizer: {0} indices isn't a triangle list", indices.size());
+
+		uint32_t vertexCount = DeduplicateVertices(vertices, indices);
+		OptimizeVertexCache(indices, vertexCount);
+		OptimizeOverdraw(indices, vertices);
+		OptimizeVertexFetch(vertices, indices);
+	}
+
+	uint32_t MeshOptimizer::DeduplicateVertices(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+	{
+		// Keyed by hash, on the off chance two different vertices collide the second one simply stays a vertex of its own
+		std::unordered_map<uint64_t, uint32_t> uniqueVertices;
+		uniqueVertices.reserve(vertices.size());
+		std::vector<uint32_t> remap(vertices.size(), ~0u);
+		std::vector<Vertex> weldedVertices;
+		weldedVertices.reserve(vertices.size());
+		for (uint32_t &index : indices)
+		{
+			ARC_ASSERT(index < vertices.size(), "MeshOptimizer: Index {0} is out of range", index);
+			if (remap[index] == ~0u)
+			{
+				const Vertex &vertex = vertices[index];
+				auto iter = uniqueVertices.emplace(HashUtils::HashBytes(&vertex, sizeof(Vertex)), static_cast<uint32_t>(weldedVertices.size())).first;
+				if (iter->second < weldedVertices.size() && memcmp(&weldedVertices[iter->second], &vertex, sizeof(Vertex)) == 0)
+				{
+					remap[index] = iter->second;
+				}
+				else
+				{
+					remap[index] = static_cast<uint32_t>(weldedVertices.size());
+					weldedVertices.push_back(vertex);
+				}
+			}
+			index = remap[index];
+		}
+
+		vertices.swap(weldedVertices);
+		return static_cast<uint32_t>(vertices.size());
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t> &indices, uint32_t vertexCount)
+	{
+		const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+		if (triangleCount == 0)
+			return;
+
+		// Triangles of every vertex, the first liveTriangleCounts of each list are the ones not emitted yet
+		std::vector<uint32_t> triangleOffsets(vertexCount + 1, 0), liveTriangleCounts(vertexCount, 0);
+		for (uint32_t index : indices)
+		{
+			liveTriangleCounts[index]++;
+		}
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			triangleOffsets[vertex + 1] = triangleOffsets[vertex] + liveTriangleCounts[vertex];
+		}
+		std::vector<uint32_t> vertexTriangles(indices.size()), fillCounts(vertexCount, 0);
+		for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+		{
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				uint32_t vertex = indices[triangle * 3 + corner];
+				vertexTriangles[triangleOffsets[vertex] + fillCounts[vertex]++] = triangle;
+			}
+		}
+
+		std::vector<int32_t> cachePositions(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount), triangleScores(triangleCount, 0.0f);
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			vertexScores[vertex] = ScoreVertex(-1, liveTriangleCounts[vertex]);
+		}
+		uint32_t bestTriangle = 0;
+		for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+		{
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				triangleScores[triangle] += vertexScores[indices[triangle * 3 + corner]];
+			}
+			if (triangleScores[triangle] > triangleScores[bestTriangle])
+				bestTriangle = triangle;
+		}
+
+		// The cache holds three extra entries so the vertices that get pushed out still have their scores updated
+		std::vector<uint32_t> cache, newCache;
+		cache.reserve(CACHE_OPTIMIZE_SIZE + 3);
+		newCache.reserve(CACHE_OPTIMIZE_SIZE + 3);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<uint32_t> optimizedIndices;
+		optimizedIndices.reserve(indices.size());
+		uint32_t nextUnemitted = 0;
+		for (uint32_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+		{
+			// Dead end, none of the cached vertices has triangles left. Starting over at the next triangle in the original order is linear and nearly as good as a full search
+			if (bestTriangle == ~0u)
+			{
+				while (emitted[nextUnemitted])
+				{
+					nextUnemitted++;
+				}
+				bestTriangle = nextUnemitted;
+			}
+
+			const uint32_t *triangleIndices = &indices[bestTriangle * 3];
+			emitted[bestTriangle] = true;
+			newCache.clear();
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				uint32_t vertex = triangleIndices[corner];
+				optimizedIndices.push_back(vertex);
+				newCache.push_back(vertex);
+
+				uint32_t *triangles = &vertexTriangles[triangleOffsets[vertex]];
+				uint32_t &liveCount = liveTriangleCounts[vertex];
+				for (uint32_t i = 0; i < liveCount; i++)
+				{
+					if (triangles[i] == bestTriangle)
+					{
+						std::swap(triangles[i], triangles[liveCount - 1]);
+						liveCount--;
+						break;
+					}
+				}
+			}
+			for (uint32_t vertex : cache)
+			{
+				if (vertex != triangleIndices[0] && vertex != triangleIndices[1] && vertex != triangleIndices[2])
+					newCache.push_back(vertex);
+			}
+
+			// Rescore everything that moved in the cache, the triangles around it change by the difference
+			for (size_t i = 0; i < newCache.size(); i++)
+			{
+				uint32_t vertex = newCache[i];
+				cachePositions[vertex] = i < CACHE_OPTIMIZE_SIZE ? static_cast<int32_t>(i) : -1;
+				float score = ScoreVertex(cachePositions[vertex], liveTriangleCounts[vertex]);
+				float scoreDelta = score - vertexScores[vertex];
+				vertexScores[vertex] = score;
+
+				const uint32_t *triangles = &vertexTriangles[triangleOffsets[vertex]];
+				for (uint32_t j = 0; j < liveTriangleCounts[vertex]; j++)
+				{
+					triangleScores[triangles[j]] += scoreDelta;
+				}
+			}
+			if (newCache.size() > CACHE_OPTIMIZE_SIZE)
+				newCache.resize(CACHE_OPTIMIZE_SIZE);
+			cache.swap(newCache);
+
+			// Only triangles of cached vertices gained from this triangle, so the next one is looked for among them
+			bestTriangle = ~0u;
+			float bestScore = -1.0f;
+			for (uint32_t vertex : cache)
+			{
+				const uint32_t *triangles = &vertexTriangles[triangleOffsets[vertex]];
+				for (uint32_t j = 0; j < liveTriangleCounts[vertex]; j++)
+				{
+					if (triangleScores[triangles[j]] > bestScore)
+					{
+						bestScore = triangleScores[triangles[j]];
+						bestTriangle = triangles[j];
+					}
+				}
+			}
+		}
+
+		indices.swap(optimizedIndices);
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<Vertex> &vertices, float threshold)
+	{
+		const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+		const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+		if (triangleCount == 0)
+			return;
+
+		// Cluster boundaries are where a triangle misses the cache with all three vertices, the order starts over there anyway so moving clusters around costs little cache
+		const uint32_t cacheSize = 16;
+		std::vector<uint32_t> clusterStarts;
+		std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+		uint32_t timestamp = cacheSize + 1;
+		for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+		{
+			uint32_t missCount = 0;
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				uint32_t vertex = indices[triangle * 3 + corner];
+				if (timestamp - cacheTimestamps[vertex] > cacheSize)
+				{
+					cacheTimestamps[vertex] = timestamp++;
+					missCount++;
+				}
+			}
+			if (missCount == 3 || triangle == 0)
+				clusterStarts.push_back(triangle);
+		}
+		if (clusterStarts.size() < 2)
+			return;
+
+		// Area weighted centroid and normal of the mesh and every cluster, clusters facing away from the middle of the mesh are the ones on the outside
+		glm::vec3 meshCentroid(0.0f);
+		float meshArea = 0.0f;
+		std::vector<glm::vec3> clusterCentroids(clusterStarts.size(), glm::vec3(0.0f)), clusterNormals(clusterStarts.size(), glm::vec3(0.0f));
+		for (size_t cluster = 0; cluster < clusterStarts.size(); cluster++)
+		{
+			uint32_t end = cluster + 1 < clusterStarts.size() ? clusterStarts[cluster + 1] : triangleCount;
+			float clusterArea = 0.0f;
+			for (uint32_t triangle = clusterStarts[cluster]; triangle < end; triangle++)
+			{
+				const glm::vec3 &a = vertices[indices[triangle * 3 + 0]].pos, &b = vertices[indices[triangle * 3 + 1]].pos, &c = vertices[indices[triangle * 3 + 2]].pos;
+				glm::vec3 normal = glm::cross(b - a, c - a);
+				float area = glm::length(normal);
+				clusterCentroids[cluster] += (a + b + c) * (area / 3.0f);
+				clusterNormals[cluster] += normal;
+				clusterArea += area;
+			}
+			meshCentroid += clusterCentroids[cluster];
+			meshArea += clusterArea;
+			clusterCentroids[cluster] = clusterArea > 0.0f ? clusterCentroids[cluster] / clusterArea : clusterCentroids[cluster];
+		}
+		meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : meshCentroid;
+
+		std::vector<float> clusterSortKeys(clusterStarts.size());
+		std::vector<uint32_t> clusterOrder(clusterStarts.size());
+		for (size_t cluster = 0; cluster < clusterStarts.size(); cluster++)
+		{
+			float normalLength = glm::length(clusterNormals[cluster]);
+			glm::vec3 normal = normalLength > 0.0f ? clusterNormals[cluster] / normalLength : glm::vec3(0.0f);
+			clusterSortKeys[cluster] = glm::dot(clusterCentroids[cluster] - meshCentroid, normal);
+			clusterOrder[cluster] = static_cast<uint32_t>(cluster);
+		}
+		std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&clusterSortKeys](uint32_t a, uint32_t b) { return clusterSortKeys[a] > clusterSortKeys[b]; });
+
+		std::vector<uint32_t> sortedIndices;
+		sortedIndices.reserve(indices.size());
+		for (uint32_t cluster : clusterOrder)
+		{
+			uint32_t end = cluster + 1 < clusterStarts.size() ? clusterStarts[cluster + 1] : triangleCount;
+			sortedIndices.insert(sortedIndices.end(), indices.begin() + clusterStarts[cluster] * 3, indices.begin() + end * 3);
+		}
+
+		if (CalculateACMR(sortedIndices, vertexCount) <= CalculateACMR(indices, vertexCount) * threshold)
+			indices.swap(sortedIndices);
+	}
+
+	void MeshOptimizer::OptimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+	{
+		std::vector<uint32_t> remap(vertices.size(), ~0u);
+		std::vector<Vertex> orderedVertices;
+		orderedVertices.reserve(vertices.size());
+		for (uint32_t &index : indices)
+		{
+			if (remap[index] == ~0u)
+			{
+				remap[index] = static_cast<uint32_t>(orderedVertices.size());
+				orderedVertices.push_back(vertices[index]);
+			}
+			index = remap[index];
+		}
+
+		vertices.swap(orderedVertices);
+	}
+
+	float MeshOptimizer::CalculateACMR(const std::vector<uint32_t> &indices, uint32_t vertexCount, uint32_t cacheSize)
+	{
+		if (indices.size() < 3)
+			return 0.0f;
+
+		// A vertex is still in the FIFO if fewer than cacheSize misses happened since it went in
+		std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+		uint32_t timestamp = cacheSize + 1;
+		uint32_t missCount = 0;
+		for (uint32_t index : indices)
+		{
+			if (timestamp - cacheTimestamps[index] > cacheSize)
+			{
+				cacheTimestamps[index] = timestamp++;
+				missCount++;
+			}
+		}
+		return static_cast<float>(missCount) / static_cast<float>(indices.size() / 3);
+	}
+
+	float MeshOptimizer::ScoreVertex(int32_t cachePosition, uint32_t liveTriangleCount)
+	{
+		// Nothing left to draw with it
+		if (liveTriangleCount == 0)
+			return -1.0f;
+
+		// The vertices of the last triangle get a fixed score so the next triangle doesn't just pick up the same edge, older ones decay with their position.
+		// Vertices with few triangles left get a boost so they get finished off instead of stranding a triangle that has to miss the cache later on
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			if (cachePosition < 3)
+			{
+				score = 0.75f;
+			}
+			else
+			{
+				float scale = 1.0f / static_cast<float>(CACHE_OPTIMIZE_SIZE - 3);
+				score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, 1.5f);
+			}
+		}
+		return score + 2.0f / std::sqrt(static_cast<float>(liveTriangleCount));
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Graphics/Vertex.h"
+
+namespace Arcane
+{
+	// Offline style processing for indexed triangle lists before they are uploaded. Every step keeps the same triangles, only the order of the data changes (or duplicates go away),
+	// so they can be run in any combination. Optimize() runs all of them in the order they are meant to go in
+	class MeshOptimizer
+	{
+	public:
+		// Welds vertices, reorders triangles for the vertex cache and then overdraw, and finally reorders vertices in the order they are first used
+		static void Optimize(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+
+		// Merges bitwise identical vertices and drops unused ones. Returns the new vertex count
+		static uint32_t DeduplicateVertices(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+		// Reorders triangles so vertices are reused while they are still in the post-transform cache (Forsyth's linear-speed algorithm)
+		static void OptimizeVertexCache(std::vector<uint32_t> &indices, uint32_t vertexCount);
+		// Splits the cache-optimized order into clusters where it already starts over with cold vertices and draws the outward facing clusters first, so they occlude
+		// the rest. Keeps the old order if the vertex cache ends up more than threshold times worse
+		static void OptimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<Vertex> &vertices, float threshold = 1.05f);
+		// Reorders vertices in the order the indices first use them, so fetching them walks the vertex buffer mostly in order
+		static void OptimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+
+		// Average cache miss ratio, the vertices transformed per triangle with a FIFO cache of the size. 0.5 is the best a regular grid can do, 3 means no reuse at all
+		static float CalculateACMR(const std::vector<uint32_t> &indices, uint32_t vertexCount, uint32_t cacheSize = 16);
+
+		// 16 bit indices can address the mesh, 0xFFFF is left out since it restarts primitives when that is enabled
+		inline static bool FitsUint16(uint32_t vertexCount) { return vertexCount <= 0xFFFF; }
+	private:
+		static float ScoreVertex(int32_t cachePosition, uint32_t liveTriangleCount);
+	private:
+		// Size of the cache the vertex cache optimization models, larger than real hardware caches since the scoring degrades gracefully
+		static const uint32_t CACHE_OPTIMIZE_SIZE = 32;
+	};
+}
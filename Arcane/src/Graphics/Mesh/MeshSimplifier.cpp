@@ -0,0 +1,266 @@
+#include "arcpch.h"
+#include "MeshSimplifier.h"
+
+#include "Graphics/Mesh/MeshOptimizer.h"
+
+namespace Arcane
+{
+	// Sum of squared distances to a set of planes as a symmetric 4x4 matrix, each plane weighted by the area of the triangle it came from
+	struct Quadric
+	{
+		double A00 = 0.0, A01 = 0.0, A02 = 0.0, A11 = 0.0, A12 = 0.0, A22 = 0.0;
+		double B0 = 0.0, B1 = 0.0, B2 = 0.0;
+		double C = 0.0;
+		double Weight = 0.0;
+
+		void AddPlane(const glm::dvec3 &normal, double distance, double weight)
+		{
+			A00 += normal.x * normal.x * weight; A01 += normal.x * normal.y * weight; A02 += normal.x * normal.z * weight;
+			A11 += normal.y * normal.y * weight; A12 += normal.y * normal.z * weight; A22 += normal.z * normal.z * weight;
+			B0 += normal.x * distance * weight; B1 += normal.y * distance * weight; B2 += normal.z * distance * weight;
+			C += distance * distance * weight;
+			Weight += weight;
+		}
+
+		void Add(const Quadric &other)
+		{
+			A00 += other.A00; A01 += other.A01; A02 += other.A02; A11 += other.A11; A12 += other.A12; A22 += other.A22;
+			B0 += other.B0; B1 += other.B1; B2 += other.B2;
+			C += other.C;
+			Weight += other.Weight;
+		}
+
+		// Mean squared distance of the point to the planes, weighted by area
+		double Evaluate(const glm::dvec3 &p) const
+		{
+			double error = A00 * p.x * p.x + A11 * p.y * p.y + A22 * p.z * p.z + 2.0 * (A01 * p.x * p.y + A02 * p.x * p.z + A12 * p.y * p.z) +
+				2.0 * (B0 * p.x + B1 * p.y + B2 * p.z) + C;
+			return Weight > 0.0 ? std::max(error, 0.0) / Weight : 0.0;
+		}
+	};
+
+	struct EdgeCollapse
+	{
+		uint32_t Source;
+		uint32_t Target;
+		double Cost; // Squared error of the target's position after the collapse
+	};
+
+	float MeshSimplifier::Simplify(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, uint32_t targetIndexCount, float maxError, std::vector<uint32_t> &outIndices)
+	{
+		ARC_ASSERT(indices.size() % 3 == 0, "MeshSimplifier: {0} indices isn't a triangle list", indices.size());
+
+		const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+		outIndices = indices;
+
+		// Interior edges of a closed surface are used by exactly two triangles, everything else is a border, a seam or non manifold and has to stay where it is
+		std::unordered_map<uint64_t, uint32_t> edgeUseCounts;
+		edgeUseCounts.reserve(indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (size_t corner = 0; corner < 3; corner++)
+			{
+				uint32_t a = indices[i + corner], b = indices[i + (corner + 1) % 3];
+				edgeUseCounts[(static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b)]++;
+			}
+		}
+		std::vector<bool> locked(vertexCount, false);
+		for (const std::pair<const uint64_t, uint32_t> &edge : edgeUseCounts)
+		{
+			if (edge.second != 2)
+			{
+				locked[static_cast<uint32_t>(edge.first >> 32)] = true;
+				locked[static_cast<uint32_t>(edge.first & 0xFFFFFFFF)] = true;
+			}
+		}
+
+		std::vector<Quadric> quadrics(vertexCount);
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			glm::dvec3 p0(vertices[indices[i]].pos), p1(vertices[indices[i + 1]].pos), p2(vertices[indices[i + 2]].pos);
+			glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+			double doubleArea = glm::length(normal);
+			if (doubleArea == 0.0)
+				continue;
+
+			normal /= doubleArea;
+			for (size_t corner = 0; corner < 3; corner++)
+			{
+				quadrics[indices[i + corner]].AddPlane(normal, -glm::dot(normal, p0), doubleArea * 0.5);
+			}
+		}
+
+		const double maxErrorSquared = static_cast<double>(maxError) * maxError;
+		double reachedErrorSquared = 0.0;
+		std::vector<uint32_t> adjacencyOffsets, adjacency, remap(vertexCount);
+		std::vector<bool> touched(vertexCount);
+		std::vector<EdgeCollapse> collapses;
+		while (outIndices.size() > targetIndexCount)
+		{
+			BuildAdjacency(outIndices, vertexCount, adjacencyOffsets, adjacency);
+
+			// Every interior edge shows up once in each direction, so only the direction going up is taken. The collapse goes whichever way costs less
+			collapses.clear();
+			for (size_t i = 0; i < outIndices.size(); i += 3)
+			{
+				for (size_t corner = 0; corner < 3; corner++)
+				{
+					uint32_t a = outIndices[i + corner], b = outIndices[i + (corner + 1) % 3];
+					if (a > b || (locked[a] && locked[b]))
+						continue;
+
+					Quadric merged = quadrics[a];
+					merged.Add(quadrics[b]);
+					double costAToB = locked[a] ? std::numeric_limits<double>::max() : merged.Evaluate(glm::dvec3(vertices[b].pos));
+					double costBToA = locked[b] ? std::numeric_limits<double>::max() : merged.Evaluate(glm::dvec3(vertices[a].pos));
+
+					EdgeCollapse collapse;
+					collapse.Source = costAToB <= costBToA ? a : b;
+					collapse.Target = costAToB <= costBToA ? b : a;
+					collapse.Cost = std::min(costAToB, costBToA);
+					collapses.push_back(collapse);
+				}
+			}
+			std::sort(collapses.begin(), collapses.end(), [](const EdgeCollapse &a, const EdgeCollapse &b) { return a.Cost < b.Cost; });
+
+			// A collapse removes about two triangles. The triangles around a collapsed vertex have changed, so none of their vertices can collapse again
+			// until the next pass rebuilds the adjacency
+			const size_t collapseLimit = std::max<size_t>((outIndices.size() - targetIndexCount) / 6, 1);
+			size_t collapseCount = 0;
+			std::fill(touched.begin(), touched.end(), false);
+			for (uint32_t i = 0; i < vertexCount; i++)
+			{
+				remap[i] = i;
+			}
+
+			for (const EdgeCollapse &collapse : collapses)
+			{
+				if (collapseCount >= collapseLimit || collapse.Cost > maxErrorSquared)
+					break;
+				if (touched[collapse.Source] || touched[collapse.Target] || CollapseFlipsTriangle(vertices, outIndices, adjacencyOffsets, adjacency, collapse.Source, collapse.Target))
+					continue;
+
+				remap[collapse.Source] = collapse.Target;
+				quadrics[collapse.Target].Add(quadrics[collapse.Source]);
+				for (uint32_t j = adjacencyOffsets[collapse.Source]; j < adjacencyOffsets[collapse.Source + 1]; j++)
+				{
+					for (uint32_t corner = 0; corner < 3; corner++)
+					{
+						touched[outIndices[adjacency[j] * 3 + corner]] = true;
+					}
+				}
+				reachedErrorSquared = std::max(reachedErrorSquared, collapse.Cost);
+				collapseCount++;
+			}
+
+			if (collapseCount == 0)
+				break;
+
+			// Triangles that had the collapsed edge are left with two corners on the same vertex
+			size_t writeIndex = 0;
+			for (size_t i = 0; i < outIndices.size(); i += 3)
+			{
+				uint32_t a = remap[outIndices[i]], b = remap[outIndices[i + 1]], c = remap[outIndices[i + 2]];
+				if (a == b || b == c || a == c)
+					continue;
+
+				outIndices[writeIndex++] = a;
+				outIndices[writeIndex++] = b;
+				outIndices[writeIndex++] = c;
+			}
+			outIndices.resize(writeIndex);
+		}
+
+		return static_cast<float>(std::sqrt(reachedErrorSquared));
+	}
+
+	std::vector<MeshLod> MeshSimplifier::GenerateLods(const std::vector<Vertex> &vertices, std::vector<uint32_t> &indices, const MeshLodSettings &settings)
+	{
+		std::vector<MeshLod> lods;
+		MeshLod fullDetail;
+		fullDetail.FirstIndex = 0;
+		fullDetail.IndexCount = static_cast<uint32_t>(indices.size());
+		fullDetail.Error = 0.0f;
+		lods.push_back(fullDetail);
+		if (indices.empty())
+			return lods;
+
+		glm::vec3 boundsMin(std::numeric_limits<float>::max()), boundsMax(std::numeric_limits<float>::lowest());
+		for (uint32_t index : indices)
+		{
+			boundsMin = glm::min(boundsMin, vertices[index].pos);
+			boundsMax = glm::max(boundsMax, vertices[index].pos);
+		}
+		const float maxError = settings.MaxError * glm::length(boundsMax - boundsMin) * 0.5f;
+
+		// Simplifying the previous level instead of the full mesh keeps every level cheap. Its error adds onto the previous one, which keeps
+		// the errors conservative and growing with every level
+		std::vector<uint32_t> previousIndices(indices), lodIndices;
+		float error = 0.0f;
+		while (lods.size() < settings.MaxLodCount && error < maxError)
+		{
+			uint32_t targetIndexCount = static_cast<uint32_t>(previousIndices.size() / 3 * settings.TargetRatio) * 3;
+			float levelError = Simplify(vertices, previousIndices, targetIndexCount, maxError - error, lodIndices);
+			if (lodIndices.empty() || lodIndices.size() > previousIndices.size() * settings.MinReduction)
+				break;
+
+			MeshOptimizer::OptimizeVertexCache(lodIndices, static_cast<uint32_t>(vertices.size()));
+			error += levelError;
+
+			MeshLod lod;
+			lod.FirstIndex = static_cast<uint32_t>(indices.size());
+			lod.IndexCount = static_cast<uint32_t>(lodIndices.size());
+			lod.Error = error;
+			lods.push_back(lod);
+			indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+			previousIndices.swap(lodIndices);
+		}
+
+		return lods;
+	}
+
+	void MeshSimplifier::BuildAdjacency(const std::vector<uint32_t> &indices, uint32_t vertexCount, std::vector<uint32_t> &outOffsets, std::vector<uint32_t> &outTriangles)
+	{
+		outOffsets.assign(vertexCount + 1, 0);
+		for (uint32_t index : indices)
+		{
+			outOffsets[index + 1]++;
+		}
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			outOffsets[i + 1] += outOffsets[i];
+		}
+
+		outTriangles.resize(indices.size());
+		std::vector<uint32_t> writeOffsets(outOffsets.begin(), outOffsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			outTriangles[writeOffsets[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	bool MeshSimplifier::CollapseFlipsTriangle(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, const std::vector<uint32_t> &adjacencyOffsets,
+		const std::vector<uint32_t> &adjacency, uint32_t source, uint32_t target)
+	{
+		for (uint32_t i = adjacencyOffsets[source]; i < adjacencyOffsets[source + 1]; i++)
+		{
+			const uint32_t *triangle = &indices[adjacency[i] * 3];
+			if (triangle[0] == target || triangle[1] == target || triangle[2] == target)
+				continue; // Collapses into a line and goes away
+
+			glm::vec3 before[3], after[3];
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				before[corner] = vertices[triangle[corner]].pos;
+				after[corner] = triangle[corner] == source ? vertices[target].pos : before[corner];
+			}
+
+			glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+			glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+			if (glm::dot(normalBefore, normalAfter) <= 0.0f)
+				return true;
+		}
+
+		return false;
+	}
+}
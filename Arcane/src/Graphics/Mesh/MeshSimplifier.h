@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Graphics/Vertex.h"
+
+namespace Arcane
+{
+	// A level of detail of a mesh. Every level indexes the mesh's vertices, only the indices are its own
+	struct MeshLod
+	{
+		uint32_t FirstIndex; // Relative to the mesh's first index
+		uint32_t IndexCount;
+		float Error; // How far in mesh units the surface is allowed to have moved from the full detail mesh, 0 for the full detail level
+	};
+
+	struct MeshLodSettings
+	{
+		float TargetRatio = 0.5f;   // Each level aims for this fraction of the previous level's triangles
+		float MaxError = 0.05f;     // Error the last level can reach, relative to the mesh's bounding radius
+		float MinReduction = 0.85f; // A level keeping more than this fraction of the previous level's triangles isn't worth its indices and ends the chain
+		uint32_t MaxLodCount = 8;
+	};
+
+	// Quadric error edge collapse simplification (Garland and Heckbert). Vertices are only collapsed onto their neighbours and never moved, so a level keeps
+	// indexing the original vertices and a whole LOD chain only costs indices. Vertices on edges with only one triangle (borders and the seams where the
+	// attributes are split) are never collapsed, so seams don't open up
+	class MeshSimplifier
+	{
+	public:
+		// Collapses edges until the target index count is reached or the next collapse would move the surface more than maxError (mesh units).
+		// Returns the error it ended up with
+		static float Simplify(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, uint32_t targetIndexCount, float maxError, std::vector<uint32_t> &outIndices);
+
+		// Each level is simplified from the previous one and has its triangles reordered for the vertex cache, their indices are appended to the full detail
+		// indices. The first level is the full detail mesh and the errors never decrease from one level to the next
+		static std::vector<MeshLod> GenerateLods(const std::vector<Vertex> &vertices, std::vector<uint32_t> &indices, const MeshLodSettings &settings = MeshLodSettings());
+	private:
+		// Outputs the triangles using every vertex, those of vertex i are at [outOffsets[i], outOffsets[i + 1])
+		static void BuildAdjacency(const std::vector<uint32_t> &indices, uint32_t vertexCount, std::vector<uint32_t> &outOffsets, std::vector<uint32_t> &outTriangles);
+		// Whether moving the source vertex onto the target turns any of its triangles that survive the collapse upside down
+		static bool CollapseFlipsTriangle(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, const std::vector<uint32_t> &adjacencyOffsets,
+			const std::vector<uint32_t> &adjacency, uint32_t source, uint32_t target);
+	};
+}
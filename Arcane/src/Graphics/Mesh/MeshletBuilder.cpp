@@ -0,0 +1,206 @@
+#include "arcpch.h"
+#include "MeshletBuilder.h"
+
+namespace Arcane
+{
+	std::vector<Meshlet> MeshletBuilder::Build(const std::vector<Vertex> &vertices, std::vector<uint32_t> &indices, uint32_t firstIndex, uint32_t indexCount,
+		const MeshletSettings &settings)
+	{
+		ARC_ASSERT(indexCount % 3 == 0, "MeshletBuilder: {0} indices isn't a triangle list", indexCount);
+		ARC_ASSERT(static_cast<size_t>(firstIndex) + indexCount <= indices.size(), "MeshletBuilder: Index range is out of bounds");
+		ARC_ASSERT(settings.MaxVertices >= 3 && settings.MaxTriangles >= 1, "MeshletBuilder: A meshlet has to fit at least one triangle");
+
+		const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+		const uint32_t triangleCount = indexCount / 3;
+		const uint32_t *triangles = &indices[firstIndex];
+
+		// The triangles using every vertex, those of vertex i are at [adjacencyOffsets[i], adjacencyOffsets[i + 1])
+		std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0), adjacency(indexCount);
+		for (uint32_t i = 0; i < indexCount; i++)
+		{
+			adjacencyOffsets[triangles[i] + 1]++;
+		}
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+		}
+		std::vector<uint32_t> writeOffsets(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (uint32_t i = 0; i < indexCount; i++)
+		{
+			adjacency[writeOffsets[triangles[i]]++] = i / 3;
+		}
+		std::vector<uint32_t> liveTriangleCounts(vertexCount); // Triangles using the vertex that aren't in a meshlet yet
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			liveTriangleCounts[i] = adjacencyOffsets[i + 1] - adjacencyOffsets[i];
+		}
+
+		std::vector<glm::vec3> centroids(triangleCount);
+		for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+		{
+			centroids[triangle] = (vertices[triangles[triangle * 3]].pos + vertices[triangles[triangle * 3 + 1]].pos + vertices[triangles[triangle * 3 + 2]].pos) / 3.0f;
+		}
+
+		const uint32_t noTriangle = std::numeric_limits<uint32_t>::max();
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<uint32_t> vertexMeshlets(vertexCount, std::numeric_limits<uint32_t>::max()); // The last meshlet that used the vertex
+		std::vector<uint32_t> meshletVertices, orderedIndices;
+		orderedIndices.reserve(indexCount);
+
+		std::vector<Meshlet> meshlets;
+		uint32_t nextSeed = 0;
+		while (orderedIndices.size() < indexCount)
+		{
+			// New meshlets start at the first triangle left in the original order, which was already ordered for the vertex cache and so keeps neighbours together
+			while (emitted[nextSeed])
+			{
+				nextSeed++;
+			}
+
+			const uint32_t meshletIndex = static_cast<uint32_t>(meshlets.size());
+			const uint32_t meshletStart = static_cast<uint32_t>(orderedIndices.size());
+			uint32_t meshletTriangleCount = 0;
+			glm::vec3 positionSum(0.0f);
+			meshletVertices.clear();
+
+			uint32_t triangle = nextSeed;
+			while (triangle != noTriangle)
+			{
+				emitted[triangle] = true;
+				meshletTriangleCount++;
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					uint32_t index = triangles[triangle * 3 + corner];
+					orderedIndices.push_back(index);
+					liveTriangleCounts[index]--;
+					if (vertexMeshlets[index] != meshletIndex)
+					{
+						vertexMeshlets[index] = meshletIndex;
+						meshletVertices.push_back(index);
+						positionSum += vertices[index].pos;
+					}
+				}
+				if (meshletTriangleCount == settings.MaxTriangles)
+					break;
+
+				// Only triangles sharing a vertex with the meshlet are candidates, a meshlet with nothing left next to it is done. Triangles that are the last one
+				// left on one of their vertices go first among those adding as many vertices, otherwise they end up stranded as meshlets of their own.
+				// Only the neighbours of the triangle just added are looked at unless none of them fits, searching the whole meshlet every time makes building about
+				// three times slower for meshlets that are barely fuller
+				const glm::vec3 centre = positionSum / static_cast<float>(meshletVertices.size());
+				const uint32_t addedTriangle = triangle;
+				uint32_t bestPriority = std::numeric_limits<uint32_t>::max();
+				float bestDistance = std::numeric_limits<float>::max();
+				triangle = noTriangle;
+				for (uint32_t pass = 0; pass < 2 && triangle == noTriangle; pass++)
+				{
+					const uint32_t *searchVertices = pass == 0 ? &triangles[addedTriangle * 3] : meshletVertices.data();
+					const size_t searchVertexCount = pass == 0 ? 3 : meshletVertices.size();
+					for (size_t searchVertex = 0; searchVertex < searchVertexCount; searchVertex++)
+					{
+						const uint32_t vertex = searchVertices[searchVertex];
+						if (liveTriangleCounts[vertex] == 0)
+							continue; // Surrounded by the meshlet, which is most of its vertices once it has grown
+
+						for (uint32_t i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; i++)
+						{
+							uint32_t candidate = adjacency[i];
+							if (emitted[candidate])
+								continue;
+
+							uint32_t newVertexCount = 0;
+							bool lastOnVertex = false;
+							for (uint32_t corner = 0; corner < 3; corner++)
+							{
+								uint32_t index = triangles[candidate * 3 + corner];
+								newVertexCount += vertexMeshlets[index] != meshletIndex ? 1 : 0;
+								lastOnVertex |= liveTriangleCounts[index] == 1;
+							}
+							if (meshletVertices.size() + newVertexCount > settings.MaxVertices)
+								continue;
+
+							uint32_t priority = newVertexCount * 2 + (lastOnVertex ? 0 : 1);
+							float distance = glm::dot(centroids[candidate] - centre, centroids[candidate] - centre);
+							if (priority < bestPriority || (priority == bestPriority && distance < bestDistance))
+							{
+								triangle = candidate;
+								bestPriority = priority;
+								bestDistance = distance;
+							}
+						}
+					}
+				}
+			}
+
+			Meshlet meshlet;
+			meshlet.FirstIndex = firstIndex + meshletStart;
+			meshlet.IndexCount = static_cast<uint32_t>(orderedIndices.size()) - meshletStart;
+			meshlet.VertexCount = static_cast<uint32_t>(meshletVertices.size());
+			ComputeBounds(vertices, &orderedIndices[meshletStart], meshlet.IndexCount, settings.MaxConeAngle, meshlet);
+			meshlets.push_back(meshlet);
+		}
+
+		std::copy(orderedIndices.begin(), orderedIndices.end(), indices.begin() + firstIndex);
+		return meshlets;
+	}
+
+	bool MeshletBuilder::IsBackfacing(const Meshlet &meshlet, const glm::vec3 &cameraPosition)
+	{
+		// The view direction to every point of the sphere has to be within 90 degrees minus the cone's spread of its axis, for the sphere's centre that means
+		// the projection onto the axis beats the cutoff by at least the radius
+		glm::vec3 toCentre = glm::vec3(meshlet.BoundingSphere) - cameraPosition;
+		return glm::dot(toCentre, glm::vec3(meshlet.Cone)) >= meshlet.Cone.w * glm::length(toCentre) + meshlet.BoundingSphere.w;
+	}
+
+	void MeshletBuilder::ComputeBounds(const std::vector<Vertex> &vertices, const uint32_t *indices, uint32_t indexCount, float maxConeAngle, Meshlet &outMeshlet)
+	{
+		glm::vec3 boundsMin(std::numeric_limits<float>::max()), boundsMax(std::numeric_limits<float>::lowest());
+		for (uint32_t i = 0; i < indexCount; i++)
+		{
+			boundsMin = glm::min(boundsMin, vertices[indices[i]].pos);
+			boundsMax = glm::max(boundsMax, vertices[indices[i]].pos);
+		}
+
+		glm::vec3 centre = (boundsMin + boundsMax) * 0.5f;
+		float radiusSquared = 0.0f;
+		for (uint32_t i = 0; i < indexCount; i++)
+		{
+			glm::vec3 offset = vertices[indices[i]].pos - centre;
+			radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+		}
+		outMeshlet.BoundingSphere = glm::vec4(centre, std::sqrt(radiusSquared));
+
+		// Every triangle counts the same no matter its area, a small triangle facing the camera makes the meshlet just as visible as a large one
+		std::vector<glm::vec3> normals;
+		normals.reserve(indexCount / 3);
+		glm::vec3 normalSum(0.0f);
+		for (uint32_t i = 0; i < indexCount; i += 3)
+		{
+			const glm::vec3 &p0 = vertices[indices[i]].pos, &p1 = vertices[indices[i + 1]].pos, &p2 = vertices[indices[i + 2]].pos;
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float length = glm::length(normal);
+			if (length == 0.0f)
+				continue;
+
+			normals.push_back(normal / length);
+			normalSum += normals.back();
+		}
+
+		// The cone stays disabled (a zero axis never passes the test) when the normals cancel out or spread further than the limit
+		outMeshlet.Cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		float sumLength = glm::length(normalSum);
+		if (sumLength == 0.0f)
+			return;
+
+		glm::vec3 axis = normalSum / sumLength;
+		float minDot = 1.0f;
+		for (const glm::vec3 &normal : normals)
+		{
+			minDot = std::min(minDot, glm::dot(axis, normal));
+		}
+		if (minDot <= std::cos(glm::radians(maxConeAngle)))
+			return;
+
+		outMeshlet.Cone = glm::vec4(axis, std::sqrt(1.0f - minDot * minDot));
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Graphics/Vertex.h"
+
+namespace Arcane
+{
+	// A cluster of a mesh's triangles that is culled on its own. Its triangles are contiguous in the mesh's indices, so a cluster that survives culling is drawn
+	// with a single indexed draw of its range
+	struct Meshlet
+	{
+		glm::vec4 BoundingSphere; // Mesh space centre and radius
+		glm::vec4 Cone; // Average normal of the triangles and the sine of the largest angle between it and any of their normals, a zero axis can't be backface culled
+		uint32_t FirstIndex; // Relative to the mesh's first index
+		uint32_t IndexCount;
+		uint32_t VertexCount; // Distinct vertices the triangles use
+	};
+
+	struct MeshletSettings
+	{
+		uint32_t MaxVertices = 64;
+		uint32_t MaxTriangles = 124;
+		float MaxConeAngle = 80.0f; // Degrees, triangles spreading their normals further than this are not worth a cone that would almost never cull
+	};
+
+	// Greedily grows meshlets over neighbouring triangles, taking the triangle next to the last one that adds the fewest new vertices and then the one closest
+	// to the meshlet, so meshlets stay compact and their bounds tight. A meshlet is closed once it is full or nothing next to it is left
+	class MeshletBuilder
+	{
+	public:
+		// Reorders the triangles of the index range so every meshlet's triangles are contiguous, the rest of the indices are left as they are.
+		// FirstIndex of the meshlets is relative to the start of the index buffer
+		static std::vector<Meshlet> Build(const std::vector<Vertex> &vertices, std::vector<uint32_t> &indices, uint32_t firstIndex, uint32_t indexCount,
+			const MeshletSettings &settings = MeshletSettings());
+
+		// Whether every triangle of the meshlet faces away from the camera, conservatively for all of its bounding sphere. The same test the cluster culling shader does
+		static bool IsBackfacing(const Meshlet &meshlet, const glm::vec3 &cameraPosition);
+	private:
+		static void ComputeBounds(const std::vector<Vertex> &vertices, const uint32_t *indices, uint32_t indexCount, float maxConeAngle, Meshlet &outMeshlet);
+	};
+}
@@ -0,0 +1,249 @@
+#include "arcpch.h"
+#include "VertexQuantizer.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define ARC_QUANTIZE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Arcane
+{
+	glm::mat4 VertexQuantizer::Quantize(const MeshVertex *vertices, size_t vertexCount, QuantizedMeshVertex *outVertices, bool useSimd)
+	{
+		if (vertexCount == 0)
+			return glm::mat4(1.0f);
+
+		glm::vec3 boundsMin = vertices[0].position, boundsMax = vertices[0].position;
+		for (size_t i = 1; i < vertexCount; i++)
+		{
+			boundsMin = glm::min(boundsMin, vertices[i].position);
+			boundsMax = glm::max(boundsMax, vertices[i].position);
+		}
+		glm::vec3 centre = (boundsMin + boundsMax) * 0.5f;
+		glm::vec3 halfExtents = (boundsMax - boundsMin) * 0.5f;
+		float extent = std::max(std::max(halfExtents.x, halfExtents.y), halfExtents.z);
+		extent = extent > 0.0f ? extent : 1.0f;
+
+		if (useSimd && IsSimdSupported())
+		{
+			QuantizeSse(vertices, vertexCount, centre, 1.0f / extent, outVertices);
+		}
+		else
+		{
+			QuantizeScalar(vertices, vertexCount, centre, 1.0f / extent, outVertices);
+		}
+
+		return glm::scale(glm::translate(glm::mat4(1.0f), centre), glm::vec3(extent));
+	}
+
+	void VertexQuantizer::Dequantize(const QuantizedMeshVertex *vertices, size_t vertexCount, const glm::mat4 &dequantizeTransform, MeshVertex *outVertices)
+	{
+		// Same conversions as the vertex fetch, snorm16 maps -32768 and -32767 both to -1
+		auto snormToFloat = [](int16_t value) { return std::max(static_cast<float>(value) / 32767.0f, -1.0f); };
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			const QuantizedMeshVertex &vertex = vertices[i];
+			MeshVertex &outVertex = outVertices[i];
+			glm::vec3 position(snormToFloat(vertex.position[0]), snormToFloat(vertex.position[1]), snormToFloat(vertex.position[2]));
+			outVertex.position = glm::vec3(dequantizeTransform * glm::vec4(position, 1.0f));
+			outVertex.normal = DecodeOctahedral(glm::vec2(snormToFloat(vertex.normal[0]), snormToFloat(vertex.normal[1])));
+			outVertex.tangent = glm::vec4(DecodeOctahedral(glm::vec2(snormToFloat(vertex.tangent[0]), snormToFloat(vertex.tangent[1]))), snormToFloat(vertex.position[3]));
+			outVertex.uv0 = glm::vec2(HalfToFloat(vertex.uv0[0]), HalfToFloat(vertex.uv0[1]));
+			outVertex.uv1 = glm::vec2(HalfToFloat(vertex.uv1[0]), HalfToFloat(vertex.uv1[1]));
+		}
+	}
+
+	glm::vec2 VertexQuantizer::EncodeOctahedral(const glm::vec3 &direction)
+	{
+		// The lower half of the octahedron is folded over the diagonals onto the corners
+		float length = std::max((std::abs(direction.x) + std::abs(direction.y)) + std::abs(direction.z), 1e-20f);
+		glm::vec2 encoded(direction.x / length, direction.y / length);
+		if (direction.z < 0.0f)
+		{
+			glm::vec2 folded((1.0f - std::abs(encoded.y)) * (encoded.x >= 0.0f ? 1.0f : -1.0f), (1.0f - std::abs(encoded.x)) * (encoded.y >= 0.0f ? 1.0f : -1.0f));
+			encoded = folded;
+		}
+		return encoded;
+	}
+
+	glm::vec3 VertexQuantizer::DecodeOctahedral(const glm::vec2 &encoded)
+	{
+		glm::vec3 direction(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+		float fold = std::max(-direction.z, 0.0f);
+		direction.x += direction.x >= 0.0f ? -fold : fold;
+		direction.y += direction.y >= 0.0f ? -fold : fold;
+		return glm::normalize(direction);
+	}
+
+	uint16_t VertexQuantizer::FloatToHalf(float value)
+	{
+		// The exponent is rebiased with integer math, values too small for a normal half are rounded by adding a float that pushes their bits into place
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(float));
+		uint32_t sign = bits & 0x80000000u;
+		bits ^= sign;
+
+		uint32_t half;
+		if (bits >= (127u + 16u) << 23)
+		{
+			half = bits > 0x7F800000u ? 0x7E00u : 0x7C00u;
+		}
+		else if (bits < 113u << 23)
+		{
+			const uint32_t denormMagicBits = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+			float denormMagic, magnitude;
+			memcpy(&denormMagic, &denormMagicBits, sizeof(float));
+			memcpy(&magnitude, &bits, sizeof(float));
+			magnitude += denormMagic;
+			memcpy(&bits, &magnitude, sizeof(float));
+			half = bits - denormMagicBits;
+		}
+		else
+		{
+			uint32_t mantissaOdd = (bits >> 13) & 1;
+			bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xFFFu + mantissaOdd;
+			half = bits >> 13;
+		}
+		return static_cast<uint16_t>(half | (sign >> 16));
+	}
+
+	float VertexQuantizer::HalfToFloat(uint16_t value)
+	{
+		uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+		uint32_t exponent = (value >> 10) & 0x1Fu;
+		uint32_t mantissa = value & 0x3FFu;
+
+		uint32_t bits;
+		if (exponent == 0)
+		{
+			float magnitude = static_cast<float>(mantissa) * (1.0f / 16777216.0f); // Subnormal, mantissa * 2^-24
+			memcpy(&bits, &magnitude, sizeof(float));
+			bits |= sign;
+		}
+		else if (exponent == 31)
+		{
+			bits = sign | 0x7F800000u | (mantissa << 13);
+		}
+		else
+		{
+			bits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+		}
+
+		float result;
+		memcpy(&result, &bits, sizeof(float));
+		return result;
+	}
+
+	bool VertexQuantizer::IsSimdSupported()
+	{
+#ifdef ARC_QUANTIZE_SSE
+		return true; // SSE2 is part of x64, 32 bit builds only get here when compiled for it
+#else
+		return false;
+#endif
+	}
+
+	void VertexQuantizer::QuantizeScalar(const MeshVertex *vertices, size_t vertexCount, const glm::vec3 &centre, float inverseExtent, QuantizedMeshVertex *outVertices)
+	{
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			const MeshVertex &vertex = vertices[i];
+			QuantizedMeshVertex &outVertex = outVertices[i];
+
+			glm::vec3 position = (vertex.position - centre) * inverseExtent;
+			outVertex.position[0] = FloatToSnorm16(position.x);
+			outVertex.position[1] = FloatToSnorm16(position.y);
+			outVertex.position[2] = FloatToSnorm16(position.z);
+			outVertex.position[3] = FloatToSnorm16(vertex.tangent.w >= 0.0f ? 1.0f : -1.0f);
+
+			glm::vec2 normal = EncodeOctahedral(vertex.normal), tangent = EncodeOctahedral(glm::vec3(vertex.tangent));
+			outVertex.normal[0] = FloatToSnorm16(normal.x);
+			outVertex.normal[1] = FloatToSnorm16(normal.y);
+			outVertex.tangent[0] = FloatToSnorm16(tangent.x);
+			outVertex.tangent[1] = FloatToSnorm16(tangent.y);
+
+			outVertex.uv0[0] = FloatToHalf(vertex.uv0.x);
+			outVertex.uv0[1] = FloatToHalf(vertex.uv0.y);
+			outVertex.uv1[0] = FloatToHalf(vertex.uv1.x);
+			outVertex.uv1[1] = FloatToHalf(vertex.uv1.y);
+		}
+	}
+
+	void VertexQuantizer::QuantizeSse(const MeshVertex *vertices, size_t vertexCount, const glm::vec3 &centre, float inverseExtent, QuantizedMeshVertex *outVertices)
+	{
+#ifdef ARC_QUANTIZE_SSE
+		static_assert(offsetof(QuantizedMeshVertex, normal) == 8 && offsetof(QuantizedMeshVertex, tangent) == 12 && offsetof(QuantizedMeshVertex, uv1) == 20,
+			"VertexQuantizer: The SSE path writes position, normal and tangent with one store and both UVs with another");
+		static_assert(offsetof(MeshVertex, uv1) == offsetof(MeshVertex, uv0) + 8, "VertexQuantizer: The SSE path loads both UVs at once");
+
+		// Position and both octahedral encodings go through the same lanes the scalar path uses one at a time, so both paths round identically
+		const __m128 centreOffset = _mm_setr_ps(centre.x, centre.y, centre.z, 0.0f);
+		const __m128 positionScale = _mm_setr_ps(inverseExtent, inverseExtent, inverseExtent, 1.0f);
+		const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), minusOne = _mm_set1_ps(-1.0f);
+		const __m128 snormScale = _mm_set1_ps(32767.0f), minLength = _mm_set1_ps(1e-20f);
+
+		// Half conversion constants, see FloatToHalf()
+		const __m128i signMask = _mm_set1_epi32(static_cast<int>(0x80000000u));
+		const __m128i halfOverflow = _mm_set1_epi32(((127 + 16) << 23) - 1), floatInfinity = _mm_set1_epi32(0x7F800000), denormLimit = _mm_set1_epi32(113 << 23);
+		const __m128i denormMagicBits = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+		const __m128i rebias = _mm_set1_epi32(static_cast<int>((static_cast<uint32_t>(15 - 127) << 23) + 0xFFFu)), lowBit = _mm_set1_epi32(1);
+		const __m128i infinity = _mm_set1_epi32(0x7C00), quietNaNBit = _mm_set1_epi32(0x0200), packBias = _mm_set1_epi32(0x8000);
+
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			const MeshVertex &vertex = vertices[i];
+
+			__m128 position = _mm_setr_ps(vertex.position.x, vertex.position.y, vertex.position.z, vertex.tangent.w >= 0.0f ? 1.0f : -1.0f);
+			position = _mm_mul_ps(_mm_sub_ps(position, centreOffset), positionScale);
+
+			// Normal in the low two lanes and tangent in the high two
+			__m128 directionXY = _mm_setr_ps(vertex.normal.x, vertex.normal.y, vertex.tangent.x, vertex.tangent.y);
+			__m128 directionZ = _mm_setr_ps(vertex.normal.z, vertex.normal.z, vertex.tangent.z, vertex.tangent.z);
+			__m128 absXY = _mm_and_ps(directionXY, absMask);
+			__m128 length = _mm_add_ps(_mm_add_ps(absXY, _mm_shuffle_ps(absXY, absXY, _MM_SHUFFLE(2, 3, 0, 1))), _mm_and_ps(directionZ, absMask));
+			__m128 encoded = _mm_div_ps(directionXY, _mm_max_ps(length, minLength));
+
+			__m128 absEncoded = _mm_and_ps(encoded, absMask);
+			__m128 positive = _mm_cmpge_ps(encoded, zero);
+			__m128 signs = _mm_or_ps(_mm_and_ps(positive, one), _mm_andnot_ps(positive, minusOne));
+			__m128 folded = _mm_mul_ps(_mm_sub_ps(one, _mm_shuffle_ps(absEncoded, absEncoded, _MM_SHUFFLE(2, 3, 0, 1))), signs);
+			__m128 lowerHalf = _mm_cmplt_ps(directionZ, zero);
+			encoded = _mm_or_ps(_mm_and_ps(lowerHalf, folded), _mm_andnot_ps(lowerHalf, encoded));
+
+			__m128i positionSnorm = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(position, minusOne), one), snormScale));
+			__m128i encodedSnorm = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(encoded, minusOne), one), snormScale));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(outVertices[i].position), _mm_packs_epi32(positionSnorm, encodedSnorm));
+
+			// Every lane takes all three half conversion paths and keeps the one that applies to it
+			__m128i bits = _mm_castps_si128(_mm_loadu_ps(&vertex.uv0.x));
+			__m128i sign = _mm_and_si128(bits, signMask);
+			bits = _mm_xor_si128(bits, sign);
+
+			__m128i overflowed = _mm_cmpgt_epi32(bits, halfOverflow);
+			__m128i overflowHalf = _mm_or_si128(infinity, _mm_and_si128(_mm_cmpgt_epi32(bits, floatInfinity), quietNaNBit));
+
+			__m128i denormal = _mm_cmplt_epi32(bits, denormLimit);
+			__m128i denormalHalf = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(bits), _mm_castsi128_ps(denormMagicBits))), denormMagicBits);
+
+			__m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(bits, 13), lowBit);
+			__m128i normalHalf = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(bits, rebias), mantissaOdd), 13);
+
+			__m128i half = _mm_or_si128(_mm_and_si128(denormal, denormalHalf), _mm_andnot_si128(denormal, normalHalf));
+			half = _mm_or_si128(_mm_and_si128(overflowed, overflowHalf), _mm_andnot_si128(overflowed, half));
+			half = _mm_or_si128(half, _mm_srli_epi32(sign, 16));
+
+			// The signed pack would saturate halves with the sign bit set, so they are shifted into the signed range and back
+			__m128i packed = _mm_packs_epi32(_mm_sub_epi32(half, packBias), _mm_sub_epi32(half, packBias));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(outVertices[i].uv0), _mm_add_epi16(packed, _mm_set1_epi16(static_cast<short>(0x8000))));
+		}
+#else
+		QuantizeScalar(vertices, vertexCount, centre, inverseExtent, outVertices);
+#endif
+	}
+
+	int16_t VertexQuantizer::FloatToSnorm16(float value)
+	{
+		return static_cast<int16_t>(std::nearbyint(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f));
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Graphics/Vertex.h"
+
+namespace Arcane
+{
+	// Converts imported MeshVertex data to QuantizedMeshVertex. Positions are stored relative to the mesh's bounds, which are made a cube so the dequantize transform
+	// is a translation and uniform scale that normals survive unchanged. That transform goes before the instance transform (Mesh keeps it for its draws)
+	class VertexQuantizer
+	{
+	public:
+		// Returns the transform from the quantized positions back to mesh space. The SSE2 path gives the same bits as the scalar one, it is used whenever it is available
+		static glm::mat4 Quantize(const MeshVertex *vertices, size_t vertexCount, QuantizedMeshVertex *outVertices, bool useSimd = true);
+		// The dequantize transform is applied, so the result can be compared against the vertices that went in
+		static void Dequantize(const QuantizedMeshVertex *vertices, size_t vertexCount, const glm::mat4 &dequantizeTransform, MeshVertex *outVertices);
+
+		// Maps a unit vector onto an octahedron that is unfolded into the [-1, 1] square, which spreads the precision far more evenly than storing xyz
+		static glm::vec2 EncodeOctahedral(const glm::vec3 &direction);
+		static glm::vec3 DecodeOctahedral(const glm::vec2 &encoded);
+
+		// Rounds to nearest even, overflows to infinity and keeps NaNs
+		static uint16_t FloatToHalf(float value);
+		static float HalfToFloat(uint16_t value);
+
+		static bool IsSimdSupported();
+	private:
+		static void QuantizeScalar(const MeshVertex *vertices, size_t vertexCount, const glm::vec3 &centre, float inverseExtent, QuantizedMeshVertex *outVertices);
+		static void QuantizeSse(const MeshVertex *vertices, size_t vertexCount, const glm::vec3 &centre, float inverseExtent, QuantizedMeshVertex *outVertices);
+		static int16_t FloatToSnorm16(float value);
+	};
+}
@@ -0,0 +1,145 @@
+#include "arcpch.h"
+#include "AsyncCompute.h"
+
+#include "Graphics/Renderer/VulkanAPI.h"
+
+namespace Arcane
+{
+	AsyncCompute::AsyncCompute(const VulkanAPI *const vulkan, VkQueue computeQueue, uint32_t framesInFlight)
+		: m_Vulkan(vulkan), m_ComputeQueue(computeQueue), m_Timer(vulkan, vulkan->GetDeviceQueueIndices().computeQueue.value(), framesInFlight), m_ConsumerStages(0), m_NextWorkHandle(0)
+	{
+		VkDevice device = *m_Vulkan->GetDevice();
+
+		VkCommandPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.pNext = nullptr;
+		poolInfo.queueFamilyIndex = m_Vulkan->GetDeviceQueueIndices().computeQueue.value();
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		VkSemaphoreCreateInfo semaphoreInfo = {};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = nullptr;
+		semaphoreInfo.flags = 0;
+
+		VkFenceCreateInfo fenceInfo = {};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		fenceInfo.pNext = nullptr;
+		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+		m_CommandPools.resize(framesInFlight);
+		m_CommandBuffers.resize(framesInFlight);
+		m_Fences.resize(framesInFlight);
+		m_FinishedSemaphores.resize(framesInFlight);
+		for (uint32_t i = 0; i < framesInFlight; i++)
+		{
+			VkResult result = vkCreateCommandPool(device, &poolInfo, nullptr, &m_CommandPools[i]);
+			ARC_ASSERT(result == VK_SUCCESS, "AsyncCompute: Failed to create compute command pool");
+
+			VkCommandBufferAllocateInfo allocateInfo = {};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocateInfo.pNext = nullptr;
+			allocateInfo.commandPool = m_CommandPools[i];
+			allocateInfo.commandBufferCount = 1;
+			allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
+			result = vkAllocateCommandBuffers(device, &allocateInfo, &m_CommandBuffers[i]);
+			ARC_ASSERT(result == VK_SUCCESS, "AsyncCompute: Failed to allocate compute command buffer");
+			result = vkCreateFence(device, &fenceInfo, nullptr, &m_Fences[i]);
+			ARC_ASSERT(result == VK_SUCCESS, "AsyncCompute: Failed to create fence");
+			result = vkCreateSemaphore(device, &semaphoreInfo, nullptr, &m_FinishedSemaphores[i]);
+			ARC_ASSERT(result == VK_SUCCESS, "AsyncCompute: Failed to create semaphore");
+		}
+	}
+
+	AsyncCompute::~AsyncCompute()
+	{
+		VkDevice device = *m_Vulkan->GetDevice();
+
+		vkWaitForFences(device, static_cast<uint32_t>(m_Fences.size()), m_Fences.data(), VK_TRUE, UINT64_MAX);
+		for (size_t i = 0; i < m_CommandPools.size(); i++)
+		{
+			vkDestroyCommandPool(device, m_CommandPools[i], nullptr);
+			vkDestroyFence(device, m_Fences[i], nullptr);
+			vkDestroySemaphore(device, m_FinishedSemaphores[i], nullptr);
+		}
+	}
+
+	uint32_t AsyncCompute::AddWork(const AsyncComputeWork &work, VkPipelineStageFlags consumerStages)
+	{
+		ARC_ASSERT(consumerStages != 0, "AsyncCompute: Work needs the stages that consume it, use bottom of pipe if nothing does");
+
+		RegisteredWork registeredWork;
+		registeredWork.Handle = m_NextWorkHandle++;
+		registeredWork.Work = work;
+		registeredWork.ConsumerStages = consumerStages;
+		m_Work.push_back(registeredWork);
+		m_ConsumerStages |= consumerStages;
+
+		return registeredWork.Handle;
+	}
+
+	void AsyncCompute::RemoveWork(uint32_t workHandle)
+	{
+		m_Work.erase(std::remove_if(m_Work.begin(), m_Work.end(), [workHandle](const RegisteredWork &work) { return work.Handle == workHandle; }), m_Work.end());
+
+		m_ConsumerStages = 0;
+		for (const RegisteredWork &work : m_Work)
+		{
+			m_ConsumerStages |= work.ConsumerStages;
+		}
+	}
+
+	void AsyncCompute::ClearWork()
+	{
+		m_Work.clear();
+		m_ConsumerStages = 0;
+	}
+
+	VkSemaphore AsyncCompute::Execute(uint32_t frameIndex, VkSemaphore waitSemaphore, VkPipelineStageFlags waitStages)
+	{
+		if (m_Work.empty())
+			return VK_NULL_HANDLE;
+
+		// Graphics waiting on the semaphore usually means the compute work is long done by the time the frame comes around again, so this rarely stalls
+		VkDevice device = *m_Vulkan->GetDevice();
+		vkWaitForFences(device, 1, &m_Fences[frameIndex], VK_TRUE, UINT64_MAX);
+		vkResetCommandPool(device, m_CommandPools[frameIndex], 0);
+
+		VkCommandBuffer commandBuffer = m_CommandBuffers[frameIndex];
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.pNext = nullptr;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		beginInfo.pInheritanceInfo = nullptr;
+
+		VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		ARC_ASSERT(result == VK_SUCCESS, "AsyncCompute: Failed to begin compute command buffer recording");
+
+		m_Timer.Begin(commandBuffer, frameIndex);
+		for (const RegisteredWork &work : m_Work)
+		{
+			work.Work(commandBuffer, frameIndex);
+		}
+		m_Timer.End(commandBuffer, frameIndex);
+
+		result = vkEndCommandBuffer(commandBuffer);
+		ARC_ASSERT(result == VK_SUCCESS, "AsyncCompute: Error occurred during compute command buffer recording");
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = nullptr;
+		submitInfo.waitSemaphoreCount = waitSemaphore != VK_NULL_HANDLE ? 1 : 0;
+		submitInfo.pWaitSemaphores = &waitSemaphore;
+		submitInfo.pWaitDstStageMask = &waitStages;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &m_FinishedSemaphores[frameIndex];
+
+		vkResetFences(device, 1, &m_Fences[frameIndex]);
+		result = vkQueueSubmit(m_ComputeQueue, 1, &submitInfo, m_Fences[frameIndex]);
+		ARC_ASSERT(result == VK_SUCCESS, "AsyncCompute: Failed to submit compute command buffer");
+
+		return m_FinishedSemaphores[frameIndex];
+	}
+}
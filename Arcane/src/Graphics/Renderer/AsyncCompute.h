@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Graphics/Renderer/GpuTimer.h"
+
+namespace Arcane
+{
+	class VulkanAPI;
+
+	// Records the work of the compute passes as a frame in flight (e.g. culling, particles) and gets told the frame's index
+	using AsyncComputeWork = std::function<void(VkCommandBuffer commandBuffer, uint32_t frameIndex)>;
+
+	// Submits compute work to the dedicated compute queue so it runs alongside the raster work of the graphics queue. Every frame in flight has its own transient
+	// command pool, fence and semaphore. The semaphore returned by Execute() has to be waited on by the graphics submission of the same frame, at the stages that
+	// consume the results. Since the compute family is never the graphics family, buffers and images shared between both queues need VK_SHARING_MODE_CONCURRENT
+	class AsyncCompute
+	{
+	public:
+		AsyncCompute(const VulkanAPI *const vulkan, VkQueue computeQueue, uint32_t framesInFlight);
+		~AsyncCompute();
+
+		// Work is recorded in the order it was added, consumer stages are the graphics stages that read its results (bottom of pipe if nothing does).
+		// Returns a handle to remove the work with
+		uint32_t AddWork(const AsyncComputeWork &work, VkPipelineStageFlags consumerStages);
+		void RemoveWork(uint32_t workHandle);
+		void ClearWork();
+
+		// Records and submits the registered work for the frame, waiting on the semaphore first if there is one (e.g. compute that reads last frame's depth).
+		// Returns the semaphore graphics has to wait on, or VK_NULL_HANDLE if there is no work
+		VkSemaphore Execute(uint32_t frameIndex, VkSemaphore waitSemaphore = VK_NULL_HANDLE, VkPipelineStageFlags waitStages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		inline bool HasWork() const { return !m_Work.empty(); }
+		inline VkPipelineStageFlags GetConsumerStages() const { return m_ConsumerStages; }
+		inline GpuTimer* GetTimer() { return &m_Timer; }
+	private:
+		struct RegisteredWork
+		{
+			uint32_t Handle;
+			AsyncComputeWork Work;
+			VkPipelineStageFlags ConsumerStages;
+		};
+	private:
+		const VulkanAPI *const m_Vulkan;
+		VkQueue m_ComputeQueue;
+
+		std::vector<VkCommandPool> m_CommandPools;
+		std::vector<VkCommandBuffer> m_CommandBuffers;
+		std::vector<VkFence> m_Fences;
+		std::vector<VkSemaphore> m_FinishedSemaphores;
+		GpuTimer m_Timer;
+
+		std::vector<RegisteredWork> m_Work;
+		VkPipelineStageFlags m_ConsumerStages;
+		uint32_t m_NextWorkHandle;
+	};
+}
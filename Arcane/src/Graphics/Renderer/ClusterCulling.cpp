@@ -0,0 +1,299 @@
+#include "arcpch.h"
+#include "ClusterCulling.h"
+
+#include "Graphics/ComputeShader.h"
+#include "Graphics/ShaderLoader.h"
+#include "Graphics/ShaderSpecialization.h"
+#include "Graphics/Buffer/IndirectDrawBuffer.h"
+#include "Graphics/Renderer/ComputePipeline.h"
+#include "Graphics/Renderer/OcclusionCulling.h"
+#include "Graphics/Renderer/VulkanAPI.h"
+
+namespace Arcane
+{
+	struct ClusterCullConstants
+	{
+		glm::mat4 ViewProjection;
+		glm::vec4 CameraPosition;
+		uint32_t ClusterCount;
+		uint32_t DepthPyramidLevelCount;
+	};
+
+	ClusterCulling::ClusterCulling(const VulkanAPI *const vulkan, const OcclusionCulling *occlusionCulling, uint32_t maxClusterCount, uint32_t framesInFlight)
+		: m_Vulkan(vulkan), m_OcclusionCulling(occlusionCulling), m_MaxClusterCount(maxClusterCount), m_FramesInFlight(framesInFlight), m_ClusterCount(0), m_CurrentFrame(0), m_View(),
+		m_CullShaders{ nullptr, nullptr }, m_CullPipelines{ nullptr, nullptr }, m_ClusterBuffer(VK_NULL_HANDLE), m_ClusterBufferMemory(VK_NULL_HANDLE), m_VisibilityBuffer(VK_NULL_HANDLE),
+		m_VisibilityBufferMemory(VK_NULL_HANDLE), m_DrawBuffers{ nullptr, nullptr }, m_StatsBuffer(VK_NULL_HANDLE), m_StatsBufferMemory(VK_NULL_HANDLE), m_StatsReadbackBuffer(VK_NULL_HANDLE),
+		m_StatsReadbackBufferMemory(VK_NULL_HANDLE), m_MappedStats(nullptr), m_StatsPending(framesInFlight, false), m_DescriptorPool(VK_NULL_HANDLE)
+	{
+		VkDevice device = *m_Vulkan->GetDevice();
+
+		// Without indirect count the draws cover every cluster, so each cluster has to write its own command
+		for (int phase = 0; phase < 2; phase++)
+		{
+			ShaderSpecialization specialization;
+			specialization.SetBool("COMPACT_DRAWS", m_Vulkan->IsDrawIndirectCountEnabled());
+			specialization.SetBool("LATE_PHASE", phase == static_cast<int>(OcclusionCullPhase::LATE));
+			m_CullShaders[phase] = ShaderLoader::LoadComputeShader("res/Shaders/clustercull_comp.spv", &specialization);
+			m_CullPipelines[phase] = new ComputePipeline(m_Vulkan, m_CullShaders[phase]);
+		}
+
+		// Concurrent since the clusters are uploaded on the copy queue
+		m_Vulkan->CreateBuffer(sizeof(GpuCluster) * m_MaxClusterCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			VK_SHARING_MODE_CONCURRENT, &m_ClusterBuffer, &m_ClusterBufferMemory);
+		m_Vulkan->CreateBuffer(sizeof(uint32_t) * m_MaxClusterCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			VK_SHARING_MODE_EXCLUSIVE, &m_VisibilityBuffer, &m_VisibilityBufferMemory);
+		for (int phase = 0; phase < 2; phase++)
+		{
+			m_DrawBuffers[phase] = new IndirectDrawBuffer(m_Vulkan, m_MaxClusterCount, m_FramesInFlight, IndirectDrawSource::GPU);
+		}
+
+		m_Vulkan->CreateBuffer(sizeof(ClusterCullingStats), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_SHARING_MODE_EXCLUSIVE, &m_StatsBuffer, &m_StatsBufferMemory);
+		m_Vulkan->GetResourceStateTracker()->RegisterBuffer(m_StatsBuffer);
+		m_Vulkan->CreateBuffer(sizeof(ClusterCullingStats) * m_FramesInFlight, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			VK_SHARING_MODE_EXCLUSIVE, &m_StatsReadbackBuffer, &m_StatsReadbackBufferMemory);
+
+		void *mappedMemory;
+		VkResult result = vkMapMemory(device, m_StatsReadbackBufferMemory, 0, VK_WHOLE_SIZE, 0, &mappedMemory);
+		ARC_ASSERT(result == VK_SUCCESS, "ClusterCulling: Failed to map the stats readback buffer");
+		m_MappedStats = static_cast<ClusterCullingStats*>(mappedMemory);
+
+		std::array<VkDescriptorPoolSize, 2> poolSizes = {};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSizes[0].descriptorCount = 4 * 2 * m_FramesInFlight;
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		poolSizes[1].descriptorCount = 2 * m_FramesInFlight;
+
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.pNext = nullptr;
+		poolInfo.maxSets = 2 * m_FramesInFlight;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+
+		result = vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_DescriptorPool);
+		ARC_ASSERT(result == VK_SUCCESS, "ClusterCulling: Failed to create descriptor pool");
+
+		for (int phase = 0; phase < 2; phase++)
+		{
+			std::vector<VkDescriptorSetLayout> setLayouts(m_FramesInFlight, m_CullPipelines[phase]->GetDescriptorSetLayout(0));
+			VkDescriptorSetAllocateInfo allocateInfo = {};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			allocateInfo.pNext = nullptr;
+			allocateInfo.descriptorPool = m_DescriptorPool;
+			allocateInfo.descriptorSetCount = m_FramesInFlight;
+			allocateInfo.pSetLayouts = setLayouts.data();
+
+			m_DescriptorSets[phase].resize(m_FramesInFlight);
+			result = vkAllocateDescriptorSets(device, &allocateInfo, m_DescriptorSets[phase].data());
+			ARC_ASSERT(result == VK_SUCCESS, "ClusterCulling: Failed to allocate descriptor sets");
+		}
+	}
+
+	ClusterCulling::~ClusterCulling()
+	{
+		VkDevice device = *m_Vulkan->GetDevice();
+
+		vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+		vkUnmapMemory(device, m_StatsReadbackBufferMemory);
+		vkDestroyBuffer(device, m_StatsReadbackBuffer, nullptr);
+		vkFreeMemory(device, m_StatsReadbackBufferMemory, nullptr);
+		m_Vulkan->GetResourceStateTracker()->UnregisterBuffer(m_StatsBuffer);
+		vkDestroyBuffer(device, m_StatsBuffer, nullptr);
+		vkFreeMemory(device, m_StatsBufferMemory, nullptr);
+		for (int phase = 0; phase < 2; phase++)
+		{
+			delete m_DrawBuffers[phase];
+		}
+		vkDestroyBuffer(device, m_VisibilityBuffer, nullptr);
+		vkFreeMemory(device, m_VisibilityBufferMemory, nullptr);
+		vkDestroyBuffer(device, m_ClusterBuffer, nullptr);
+		vkFreeMemory(device, m_ClusterBufferMemory, nullptr);
+
+		for (int phase = 0; phase < 2; phase++)
+		{
+			delete m_CullPipelines[phase];
+			delete m_CullShaders[phase];
+		}
+	}
+
+	void ClusterCulling::SetClusters(const std::vector<GpuCluster> &clusters)
+	{
+		ARC_ASSERT(clusters.size() <= m_MaxClusterCount, "ClusterCulling: Can't cull more than {0} clusters", m_MaxClusterCount);
+
+		vkDeviceWaitIdle(*m_Vulkan->GetDevice()); // The buffers might still be read by a culling pass in flight
+		m_ClusterCount = static_cast<uint32_t>(clusters.size());
+		if (clusters.empty())
+			return;
+
+		m_Vulkan->UploadToBuffer(m_ClusterBuffer, clusters.data(), sizeof(GpuCluster) * clusters.size());
+
+		// Nothing was visible last frame, so the first frame draws every cluster that survives in the late phase
+		VkCommandBuffer commandBuffer = m_Vulkan->BeginUploadCommands();
+		vkCmdFillBuffer(commandBuffer, m_VisibilityBuffer, 0, sizeof(uint32_t) * m_ClusterCount, 0);
+
+		VkBufferMemoryBarrier visibilityBarrier = {};
+		visibilityBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		visibilityBarrier.pNext = nullptr;
+		visibilityBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		visibilityBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		visibilityBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		visibilityBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		visibilityBarrier.buffer = m_VisibilityBuffer;
+		visibilityBarrier.offset = 0;
+		visibilityBarrier.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &visibilityBarrier, 0, nullptr);
+		m_Vulkan->SubmitUploadCommands(commandBuffer);
+	}
+
+	void ClusterCulling::SetupGraph(RenderGraph &graph)
+	{
+		m_VisibilityResource = graph.ImportBuffer("ClusterVisibility", m_VisibilityBuffer, sizeof(uint32_t) * m_MaxClusterCount);
+		m_DrawBufferResources[static_cast<int>(OcclusionCullPhase::EARLY)] = graph.ImportBuffer("ClusterEarlyDraws", m_DrawBuffers[0]->GetBuffer(), m_DrawBuffers[0]->GetFrameSize() * m_FramesInFlight);
+		m_DrawBufferResources[static_cast<int>(OcclusionCullPhase::LATE)] = graph.ImportBuffer("ClusterLateDraws", m_DrawBuffers[1]->GetBuffer(), m_DrawBuffers[1]->GetFrameSize() * m_FramesInFlight);
+
+		for (int phase = 0; phase < 2; phase++)
+		{
+			for (uint32_t i = 0; i < m_FramesInFlight; i++)
+			{
+				m_DrawBuffers[phase]->BeginFrame(i);
+
+				VkDescriptorBufferInfo bufferInfos[] = { { m_ClusterBuffer, 0, VK_WHOLE_SIZE }, { m_VisibilityBuffer, 0, VK_WHOLE_SIZE },
+					{ m_DrawBuffers[phase]->GetBuffer(), m_DrawBuffers[phase]->GetFrameOffset(), m_DrawBuffers[phase]->GetFrameSize() }, { m_StatsBuffer, 0, VK_WHOLE_SIZE } };
+
+				VkDescriptorImageInfo depthPyramidInfo = {};
+				depthPyramidInfo.sampler = m_OcclusionCulling->GetDepthSampler();
+				depthPyramidInfo.imageView = m_OcclusionCulling->GetDepthPyramidView();
+				depthPyramidInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+				std::array<VkWriteDescriptorSet, 5> descriptorWrites = {};
+				for (uint32_t binding = 0; binding < descriptorWrites.size(); binding++)
+				{
+					descriptorWrites[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+					descriptorWrites[binding].pNext = nullptr;
+					descriptorWrites[binding].dstSet = m_DescriptorSets[phase][i];
+					descriptorWrites[binding].dstBinding = binding;
+					descriptorWrites[binding].descriptorCount = 1;
+					if (binding < 4)
+					{
+						descriptorWrites[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+						descriptorWrites[binding].pBufferInfo = &bufferInfos[binding];
+					}
+					else
+					{
+						descriptorWrites[binding].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+						descriptorWrites[binding].pImageInfo = &depthPyramidInfo;
+					}
+				}
+
+				vkUpdateDescriptorSets(*m_Vulkan->GetDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+			}
+		}
+	}
+
+	void ClusterCulling::AddCullPass(RenderGraph &graph, OcclusionCullPhase phase)
+	{
+		const int phaseIndex = static_cast<int>(phase);
+
+		// Like the occlusion culling passes, the depth pyramid and the stats are synchronized by the resource state tracker
+		RenderGraphPass &pass = graph.AddPass(phase == OcclusionCullPhase::EARLY ? "ClusterCullEarly" : "ClusterCullLate", RenderGraphPassType::COMPUTE);
+		if (phase == OcclusionCullPhase::EARLY)
+			pass.AddBufferInput(m_VisibilityResource, ResourceAccess::STORAGE_READ);
+		else
+			pass.AddBufferOutput(m_VisibilityResource, ResourceAccess::STORAGE_WRITE);
+		pass.AddBufferOutput(m_DrawBufferResources[phaseIndex], ResourceAccess::STORAGE_WRITE);
+		pass.SetSideEffects();
+		pass.SetExecute([this, phase](const RenderGraphPassContext &context)
+		{
+			RecordCullPass(context.CommandBuffer, phase);
+		});
+	}
+
+	void ClusterCulling::BeginFrame(uint32_t frameIndex, const GpuCullView &view)
+	{
+		m_CurrentFrame = frameIndex;
+		m_View = view;
+		for (int phase = 0; phase < 2; phase++)
+		{
+			m_DrawBuffers[phase]->BeginFrame(frameIndex);
+		}
+	}
+
+	bool ClusterCulling::ReadStats(uint32_t frameIndex, ClusterCullingStats &outStats)
+	{
+		if (!m_StatsPending[frameIndex])
+			return false;
+
+		m_StatsPending[frameIndex] = false;
+		outStats = m_MappedStats[frameIndex];
+		return true;
+	}
+
+	void ClusterCulling::RecordCullPass(VkCommandBuffer commandBuffer, OcclusionCullPhase phase)
+	{
+		const int phaseIndex = static_cast<int>(phase);
+		IndirectDrawBuffer *drawBuffer = m_DrawBuffers[phaseIndex];
+		ResourceStateTracker *tracker = m_Vulkan->GetResourceStateTracker();
+
+		// Compaction appends to the draw count, so it starts every frame at zero. The stats are counted from zero by the early phase
+		drawBuffer->ResetDrawCount(commandBuffer);
+		if (phase == OcclusionCullPhase::EARLY)
+		{
+			tracker->TransitionBuffer(m_StatsBuffer, ResourceAccess::TRANSFER_WRITE);
+			tracker->FlushBarriers(commandBuffer);
+			vkCmdFillBuffer(commandBuffer, m_StatsBuffer, 0, VK_WHOLE_SIZE, 0);
+		}
+
+		VkBufferMemoryBarrier countBarrier = {};
+		countBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		countBarrier.pNext = nullptr;
+		countBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		countBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		countBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		countBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		countBarrier.buffer = drawBuffer->GetBuffer();
+		countBarrier.offset = drawBuffer->GetCountOffset();
+		countBarrier.size = sizeof(uint32_t);
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &countBarrier, 0, nullptr);
+
+		// Both phases bind the pyramid, the early one never samples it but the descriptor still has to be in the right layout
+		tracker->TransitionBuffer(m_StatsBuffer, ResourceAccess::STORAGE_WRITE, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		tracker->TransitionImage(m_OcclusionCulling->GetDepthPyramid(), ResourceAccess::SAMPLED, nullptr, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		tracker->FlushBarriers(commandBuffer);
+
+		if (m_ClusterCount > 0)
+		{
+			ClusterCullConstants constants;
+			constants.ViewProjection = m_View.ViewProjection;
+			constants.CameraPosition = glm::vec4(m_View.CameraPosition, 1.0f);
+			constants.ClusterCount = m_ClusterCount;
+			constants.DepthPyramidLevelCount = m_OcclusionCulling->GetDepthPyramidLevelCount();
+
+			m_CullPipelines[phaseIndex]->Bind(commandBuffer);
+			m_CullPipelines[phaseIndex]->BindDescriptorSet(commandBuffer, m_DescriptorSets[phaseIndex][m_CurrentFrame]);
+			m_CullPipelines[phaseIndex]->PushConstants(commandBuffer, &constants, sizeof(constants));
+			m_CullPipelines[phaseIndex]->DispatchThreads(commandBuffer, m_ClusterCount);
+		}
+
+		if (phase == OcclusionCullPhase::LATE)
+		{
+			// Both phases have counted, the copy is read on the CPU once the frame's fence has signaled
+			tracker->TransitionBuffer(m_StatsBuffer, ResourceAccess::TRANSFER_READ);
+			tracker->FlushBarriers(commandBuffer);
+
+			VkBufferCopy copyRegion = {};
+			copyRegion.srcOffset = 0;
+			copyRegion.dstOffset = sizeof(ClusterCullingStats) * m_CurrentFrame;
+			copyRegion.size = sizeof(ClusterCullingStats);
+			vkCmdCopyBuffer(commandBuffer, m_StatsBuffer, m_StatsReadbackBuffer, 1, &copyRegion);
+
+			VkMemoryBarrier hostBarrier = {};
+			hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			hostBarrier.pNext = nullptr;
+			hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+			m_StatsPending[m_CurrentFrame] = true;
+		}
+	}
+}
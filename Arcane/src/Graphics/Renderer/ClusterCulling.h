@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Graphics/Renderer/GpuCulling.h"
+#include "Graphics/Renderer/OcclusionCulling.h"
+#include "Graphics/Renderer/RenderGraph.h"
+
+namespace Arcane
+{
+	class VulkanAPI;
+	class ComputeShader;
+	class ComputePipeline;
+	class IndirectDrawBuffer;
+
+	// A meshlet as the culling pass reads it, matches Cluster in clustercull.comp
+	struct GpuCluster
+	{
+		glm::vec4 BoundingSphere; // Centre and radius in the space of the view the clusters are culled with
+		glm::vec4 Cone; // Meshlet::Cone
+		uint32_t FirstIndex; // Absolute, into the geometry pool
+		uint32_t IndexCount;
+		int32_t VertexOffset;
+		uint32_t Padding = 0;
+	};
+
+	// Cluster counts of a frame, read back from the GPU
+	struct ClusterCullingStats
+	{
+		uint32_t EarlyDrawCount = 0;
+		uint32_t LateDrawCount = 0;
+		uint32_t BackfaceCulledCount = 0;
+		uint32_t FrustumCulledCount = 0;
+		uint32_t OcclusionCulledCount = 0;
+	};
+
+	// Culls large meshes cluster by cluster, so the parts of a mesh that are off screen, facing away or hidden aren't drawn with the rest of it. Works in the same
+	// two phases as OcclusionCulling and shares its depth pyramid: the early phase draws the clusters that were visible last frame, the late phase tests every
+	// cluster against its normal cone, the frustum and the pyramid built from the early draws, and draws the ones that became visible. The survivors of each phase
+	// are compacted into an IndirectDrawBuffer. The passes go next to OcclusionCulling's, CullPass(EARLY) before the early draws and CullPass(LATE) after its DepthPyramidPass.
+	// Clusters are culled in the space of the view's matrix and camera position, so a mesh with a transform needs it in the matrix and the camera moved into
+	// mesh space. The transform can't scale non-uniformly, the spheres and cones wouldn't hold anymore
+	class ClusterCulling
+	{
+	public:
+		ClusterCulling(const VulkanAPI *const vulkan, const OcclusionCulling *occlusionCulling, uint32_t maxClusterCount, uint32_t framesInFlight);
+		~ClusterCulling();
+
+		// Waits for the device to be idle before replacing the clusters, every cluster starts out as not visible
+		void SetClusters(const std::vector<GpuCluster> &clusters);
+
+		// Imports the buffers into a new graph and points the descriptor sets at the occlusion culling's depth pyramid, has to be called after
+		// OcclusionCulling::SetupGraph() since that can recreate the pyramid. The device has to be idle
+		void SetupGraph(RenderGraph &graph);
+		void AddCullPass(RenderGraph &graph, OcclusionCullPhase phase);
+
+		// Selects the frame's draw buffer regions and the camera the passes cull against, the frame's fence needs to have signaled
+		void BeginFrame(uint32_t frameIndex, const GpuCullView &view);
+		// Reads the stats of the last frame that used this frame's slot without waiting, false if there is no new result
+		bool ReadStats(uint32_t frameIndex, ClusterCullingStats &outStats);
+
+		// Getters
+		inline IndirectDrawBuffer* GetDrawBuffer(OcclusionCullPhase phase) const { return m_DrawBuffers[static_cast<int>(phase)]; }
+		inline RenderGraphResource GetDrawBufferResource(OcclusionCullPhase phase) const { return m_DrawBufferResources[static_cast<int>(phase)]; }
+		inline uint32_t GetClusterCount() const { return m_ClusterCount; }
+	private:
+		void RecordCullPass(VkCommandBuffer commandBuffer, OcclusionCullPhase phase);
+	private:
+		const VulkanAPI *const m_Vulkan;
+		const OcclusionCulling *const m_OcclusionCulling;
+		const uint32_t m_MaxClusterCount;
+		const uint32_t m_FramesInFlight;
+		uint32_t m_ClusterCount;
+		uint32_t m_CurrentFrame;
+		GpuCullView m_View;
+
+		ComputeShader *m_CullShaders[2]; // Indexed by phase
+		ComputePipeline *m_CullPipelines[2];
+
+		VkBuffer m_ClusterBuffer;
+		VkDeviceMemory m_ClusterBufferMemory;
+		VkBuffer m_VisibilityBuffer; // Kept across frames, the late phase of a frame decides what the early phase of the next one draws
+		VkDeviceMemory m_VisibilityBufferMemory;
+		IndirectDrawBuffer *m_DrawBuffers[2];
+		VkBuffer m_StatsBuffer; // Counted by both phases, then copied into the frame's slot of the readback buffer
+		VkDeviceMemory m_StatsBufferMemory;
+		VkBuffer m_StatsReadbackBuffer;
+		VkDeviceMemory m_StatsReadbackBufferMemory;
+		ClusterCullingStats *m_MappedStats;
+		std::vector<bool> m_StatsPending;
+
+		RenderGraphResource m_VisibilityResource;
+		RenderGraphResource m_DrawBufferResources[2];
+
+		VkDescriptorPool m_DescriptorPool;
+		std::vector<VkDescriptorSet> m_DescriptorSets[2]; // Per phase, one per frame in flight, each points at its frame's region of the phase's draw buffer
+	};
+}
@@ -0,0 +1,112 @@
+#include "arcpch.h"
+#include "CommandBufferState.h"
+
+#include "Graphics/Renderer/VulkanExtensions.h"
+
+namespace Arcane
+{
+	CommandBufferState::CommandBufferState(PipelineCache *pipelineCache, const VulkanExtensionFunctions *extensionFunctions)
+		: m_PipelineCache(pipelineCache), m_ExtensionFunctions(extensionFunctions), m_CommandBuffer(VK_NULL_HANDLE), m_BoundPipeline(VK_NULL_HANDLE), m_RenderStateValid(false),
+		m_ViewportValid(false), m_ScissorValid(false), m_Viewport(), m_Scissor(), m_RecordedStateCount(0), m_SkippedStateCount(0)
+	{
+
+	}
+
+	void CommandBufferState::Begin(VkCommandBuffer commandBuffer)
+	{
+		m_CommandBuffer = commandBuffer;
+		m_BoundPipeline = VK_NULL_HANDLE;
+		m_RenderStateValid = false;
+		m_ViewportValid = false;
+		m_ScissorValid = false;
+		m_RecordedStateCount = 0;
+		m_SkippedStateCount = 0;
+	}
+
+	void CommandBufferState::SetPipeline(const PipelineDescription &description)
+	{
+		VkPipeline pipeline = m_PipelineCache->GetPipeline(description);
+		if (pipeline != m_BoundPipeline)
+		{
+			vkCmdBindPipeline(m_CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+			m_BoundPipeline = pipeline;
+			m_RecordedStateCount++;
+		}
+		else
+		{
+			m_SkippedStateCount++;
+		}
+
+		// Every pipeline has the same set of dynamic states, so the state set for a previous pipeline is still valid after a bind
+		if (m_PipelineCache->UsesDynamicRenderState())
+		{
+			SetRenderState(description.State);
+		}
+	}
+
+	void CommandBufferState::SetViewport(const VkViewport &viewport)
+	{
+		if (m_ViewportValid && memcmp(&m_Viewport, &viewport, sizeof(VkViewport)) == 0)
+		{
+			m_SkippedStateCount++;
+			return;
+		}
+
+		vkCmdSetViewport(m_CommandBuffer, 0, 1, &viewport);
+		m_Viewport = viewport;
+		m_ViewportValid = true;
+		m_RecordedStateCount++;
+	}
+
+	void CommandBufferState::SetScissor(const VkRect2D &scissor)
+	{
+		if (m_ScissorValid && memcmp(&m_Scissor, &scissor, sizeof(VkRect2D)) == 0)
+		{
+			m_SkippedStateCount++;
+			return;
+		}
+
+		vkCmdSetScissor(m_CommandBuffer, 0, 1, &scissor);
+		m_Scissor = scissor;
+		m_ScissorValid = true;
+		m_RecordedStateCount++;
+	}
+
+	void CommandBufferState::SetRenderState(const RenderState &state)
+	{
+		if (!m_RenderStateValid)
+		{
+			// Nothing has been set on this command buffer yet, so make sure every dynamic state gets recorded once
+			m_RenderState.Topology = VK_PRIMITIVE_TOPOLOGY_MAX_ENUM;
+			m_RenderState.CullMode = VK_CULL_MODE_FLAG_BITS_MAX_ENUM;
+			m_RenderState.FrontFace = VK_FRONT_FACE_MAX_ENUM;
+			m_RenderState.DepthTestEnable = !state.DepthTestEnable;
+			m_RenderState.DepthWriteEnable = !state.DepthWriteEnable;
+			m_RenderState.DepthCompareOp = VK_COMPARE_OP_MAX_ENUM;
+			m_RenderStateValid = true;
+		}
+
+		const VulkanExtensionFunctions &ext = *m_ExtensionFunctions;
+		VkCommandBuffer commandBuffer = m_CommandBuffer;
+		SetIfChanged(m_RenderState.Topology, state.Topology, [&](VkPrimitiveTopology value) { ext.CmdSetPrimitiveTopology(commandBuffer, value); });
+		SetIfChanged(m_RenderState.CullMode, state.CullMode, [&](VkCullModeFlags value) { ext.CmdSetCullMode(commandBuffer, value); });
+		SetIfChanged(m_RenderState.FrontFace, state.FrontFace, [&](VkFrontFace value) { ext.CmdSetFrontFace(commandBuffer, value); });
+		SetIfChanged(m_RenderState.DepthTestEnable, state.DepthTestEnable, [&](bool value) { ext.CmdSetDepthTestEnable(commandBuffer, value ? VK_TRUE : VK_FALSE); });
+		SetIfChanged(m_RenderState.DepthWriteEnable, state.DepthWriteEnable, [&](bool value) { ext.CmdSetDepthWriteEnable(commandBuffer, value ? VK_TRUE : VK_FALSE); });
+		SetIfChanged(m_RenderState.DepthCompareOp, state.DepthCompareOp, [&](VkCompareOp value) { ext.CmdSetDepthCompareOp(commandBuffer, value); });
+	}
+
+	template<typename T, typename SetFunction>
+	void CommandBufferState::SetIfChanged(T &current, const T &value, SetFunction setFunction)
+	{
+		if (current == value)
+		{
+			m_SkippedStateCount++;
+			return;
+		}
+
+		setFunction(value);
+		current = value;
+		m_RecordedStateCount++;
+	}
+}
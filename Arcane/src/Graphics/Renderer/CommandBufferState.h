@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Graphics/Renderer/PipelineCache.h"
+
+namespace Arcane
+{
+	struct VulkanExtensionFunctions;
+
+	// Remembers what has been recorded into a command buffer so pipeline binds and dynamic state that wouldn't change anything are skipped
+	class CommandBufferState
+	{
+	public:
+		CommandBufferState(PipelineCache *pipelineCache, const VulkanExtensionFunctions *extensionFunctions);
+
+		// Forgets all tracked state, nothing carries over between command buffers
+		void Begin(VkCommandBuffer commandBuffer);
+
+		// Binds the pipeline for the description and, with extended dynamic state, sets whatever part of its RenderState changed since the last draw
+		void SetPipeline(const PipelineDescription &description);
+		void SetViewport(const VkViewport &viewport);
+		void SetScissor(const VkRect2D &scissor);
+
+		inline VkCommandBuffer GetCommandBuffer() const { return m_CommandBuffer; }
+		inline uint32_t GetRecordedStateCount() const { return m_RecordedStateCount; }
+		inline uint32_t GetSkippedStateCount() const { return m_SkippedStateCount; }
+	private:
+		void SetRenderState(const RenderState &state);
+		template<typename T, typename SetFunction>
+		void SetIfChanged(T &current, const T &value, SetFunction setFunction);
+	private:
+		PipelineCache *m_PipelineCache;
+		const VulkanExtensionFunctions *m_ExtensionFunctions;
+
+		VkCommandBuffer m_CommandBuffer;
+		VkPipeline m_BoundPipeline;
+		RenderState m_RenderState;
+		bool m_RenderStateValid, m_ViewportValid, m_ScissorValid;
+		VkViewport m_Viewport;
+		VkRect2D m_Scissor;
+
+		uint32_t m_RecordedStateCount, m_SkippedStateCount;
+	};
+}
@@ -0,0 +1,96 @@
+#include "arcpch.h"
+#include "ComputePipeline.h"
+
+#include "Graphics/ComputeShader.h"
+#include "Graphics/Renderer/PipelineCache.h"
+#include "Graphics/Renderer/VulkanAPI.h"
+
+namespace Arcane
+{
+	ComputePipeline::ComputePipeline(const VulkanAPI *const vulkan, const ComputeShader *shader)
+		: m_Vulkan(vulkan), m_Shader(shader), m_Layout(VK_NULL_HANDLE), m_Pipeline(VK_NULL_HANDLE), m_WorkgroupSize(shader->GetReflection().GetWorkgroupSize())
+	{
+		VkDevice device = *m_Vulkan->GetDevice();
+		const ShaderReflection &reflection = m_Shader->GetReflection();
+
+		// Every set up to the highest one the shader uses gets a layout, sets the shader skips get an empty one so the set numbers still line up
+		m_DescriptorSetLayouts.resize(reflection.GetDescriptorSetCount());
+		for (uint32_t set = 0; set < m_DescriptorSetLayouts.size(); set++)
+		{
+			std::vector<VkDescriptorSetLayoutBinding> bindings = reflection.GetDescriptorSetLayoutBindings(set);
+			VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+			layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			layoutInfo.pNext = nullptr;
+			layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+			layoutInfo.pBindings = bindings.data();
+
+			VkResult result = vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_DescriptorSetLayouts[set]);
+			ARC_ASSERT(result == VK_SUCCESS, "ComputePipeline: Failed to create a descriptor set layout");
+		}
+
+		VkPipelineLayoutCreateInfo layoutCreateInfo = {};
+		layoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		layoutCreateInfo.pNext = nullptr;
+		layoutCreateInfo.setLayoutCount = static_cast<uint32_t>(m_DescriptorSetLayouts.size());
+		layoutCreateInfo.pSetLayouts = m_DescriptorSetLayouts.data();
+		layoutCreateInfo.pushConstantRangeCount = static_cast<uint32_t>(reflection.GetPushConstantRanges().size());
+		layoutCreateInfo.pPushConstantRanges = reflection.GetPushConstantRanges().data();
+
+		VkResult result = vkCreatePipelineLayout(device, &layoutCreateInfo, nullptr, &m_Layout);
+		ARC_ASSERT(result == VK_SUCCESS, "ComputePipeline: Failed to create the pipeline layout");
+
+		VkComputePipelineCreateInfo pipelineInfo = {};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.pNext = nullptr;
+		pipelineInfo.stage = m_Shader->GetShaderStage();
+		pipelineInfo.layout = m_Layout;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+		pipelineInfo.basePipelineIndex = -1;
+
+		result = vkCreateComputePipelines(device, m_Vulkan->GetPipelineCache()->GetVulkanPipelineCache(), 1, &pipelineInfo, nullptr, &m_Pipeline);
+		ARC_ASSERT(result == VK_SUCCESS, "ComputePipeline: Failed to create the compute pipeline");
+	}
+
+	ComputePipeline::~ComputePipeline()
+	{
+		VkDevice device = *m_Vulkan->GetDevice();
+
+		vkDestroyPipeline(device, m_Pipeline, nullptr);
+		vkDestroyPipelineLayout(device, m_Layout, nullptr);
+		for (VkDescriptorSetLayout setLayout : m_DescriptorSetLayouts)
+		{
+			vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+		}
+	}
+
+	void ComputePipeline::Bind(VkCommandBuffer commandBuffer) const
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+	}
+
+	void ComputePipeline::BindDescriptorSet(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, uint32_t set) const
+	{
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Layout, set, 1, &descriptorSet, 0, nullptr);
+	}
+
+	void ComputePipeline::PushConstants(VkCommandBuffer commandBuffer, const void *data, uint32_t size, uint32_t offset) const
+	{
+		vkCmdPushConstants(commandBuffer, m_Layout, VK_SHADER_STAGE_COMPUTE_BIT, offset, size, data);
+	}
+
+	void ComputePipeline::Dispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) const
+	{
+		vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+	}
+
+	void ComputePipeline::DispatchThreads(VkCommandBuffer commandBuffer, uint32_t threadCountX, uint32_t threadCountY, uint32_t threadCountZ) const
+	{
+		vkCmdDispatch(commandBuffer, (threadCountX + m_WorkgroupSize[0] - 1) / m_WorkgroupSize[0], (threadCountY + m_WorkgroupSize[1] - 1) / m_WorkgroupSize[1],
+			(threadCountZ + m_WorkgroupSize[2] - 1) / m_WorkgroupSize[2]);
+	}
+
+	void ComputePipeline::DispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset) const
+	{
+		vkCmdDispatchIndirect(commandBuffer, buffer, offset);
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+namespace Arcane
+{
+	class VulkanAPI;
+	class ComputeShader;
+
+	// A compute shader's pipeline along with the descriptor set layouts and pipeline layout reflected from it. Unlike graphics pipelines it doesn't depend on
+	// any render pass, so it lives as long as its owner and is recorded into command buffers of either the graphics or the compute queue
+	class ComputePipeline
+	{
+	public:
+		ComputePipeline(const VulkanAPI *const vulkan, const ComputeShader *shader);
+		~ComputePipeline();
+
+		void Bind(VkCommandBuffer commandBuffer) const;
+		void BindDescriptorSet(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, uint32_t set = 0) const;
+		void PushConstants(VkCommandBuffer commandBuffer, const void *data, uint32_t size, uint32_t offset = 0) const;
+
+		void Dispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1) const;
+		// Dispatches enough workgroups to cover the threads, the shader has to ignore the threads past the end of the last group
+		void DispatchThreads(VkCommandBuffer commandBuffer, uint32_t threadCountX, uint32_t threadCountY = 1, uint32_t threadCountZ = 1) const;
+		void DispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset) const;
+
+		// Getters
+		inline VkPipeline GetPipeline() const { return m_Pipeline; }
+		inline VkPipelineLayout GetLayout() const { return m_Layout; }
+		inline VkDescriptorSetLayout GetDescriptorSetLayout(uint32_t set) const { return m_DescriptorSetLayouts[set]; }
+		inline const ComputeShader* GetShader() const { return m_Shader; }
+	private:
+		const VulkanAPI *const m_Vulkan;
+		const ComputeShader *m_Shader;
+
+		std::vector<VkDescriptorSetLayout> m_DescriptorSetLayouts;
+		VkPipelineLayout m_Layout;
+		VkPipeline m_Pipeline;
+		std::array<uint32_t, 3> m_WorkgroupSize;
+	};
+}
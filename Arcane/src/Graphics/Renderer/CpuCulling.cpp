@@ -0,0 +1,243 @@
+#include "arcpch.h"
+#include "CpuCulling.h"
+
+#include "Core/JobSystem.h"
+#include "Graphics/Renderer/GpuCulling.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define ARC_CULLING_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ARC_TARGET_AVX
+#else
+#define ARC_TARGET_AVX __attribute__((target("avx"))) // MSVC emits AVX intrinsics without /arch:AVX, GCC and Clang need them enabled per function
+#endif
+#endif
+
+namespace Arcane
+{
+	static const uint32_t SIMD_WIDTH = 8;
+
+	CpuCulling::CpuCulling()
+		: m_ObjectCount(0), m_Path(GetBestSupportedPath()), m_UseJobSystem(true)
+	{
+	}
+
+	uint32_t CpuCulling::AddSphere(const glm::vec4 &sphere)
+	{
+		return AddObject(glm::vec3(sphere), glm::vec3(0.0f), sphere.w);
+	}
+
+	uint32_t CpuCulling::AddBox(const glm::vec3 &min, const glm::vec3 &max)
+	{
+		return AddObject((min + max) * 0.5f, (max - min) * 0.5f, 0.0f);
+	}
+
+	void CpuCulling::Clear()
+	{
+		m_ObjectCount = 0;
+		for (std::vector<float> *array : { &m_CentreX, &m_CentreY, &m_CentreZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ, &m_Radius })
+		{
+			array->clear();
+		}
+	}
+
+	uint32_t CpuCulling::AddObject(const glm::vec3 &centre, const glm::vec3 &extents, float radius)
+	{
+		// Padding objects are never read past the object count, so they can stay zero
+		if (m_ObjectCount == m_Radius.size())
+		{
+			for (std::vector<float> *array : { &m_CentreX, &m_CentreY, &m_CentreZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ, &m_Radius })
+			{
+				array->resize(array->size() + SIMD_WIDTH, 0.0f);
+			}
+		}
+
+		uint32_t index = m_ObjectCount++;
+		m_CentreX[index] = centre.x;
+		m_CentreY[index] = centre.y;
+		m_CentreZ[index] = centre.z;
+		m_ExtentX[index] = extents.x;
+		m_ExtentY[index] = extents.y;
+		m_ExtentZ[index] = extents.z;
+		m_Radius[index] = radius;
+		return index;
+	}
+
+	void CpuCulling::Cull(const glm::mat4 &viewProjection, std::vector<uint32_t> &outVisible)
+	{
+		glm::vec4 planes[6];
+		GpuCulling::ExtractFrustumPlanes(viewProjection, planes);
+
+		outVisible.clear();
+		if (m_ObjectCount == 0)
+			return;
+
+		if (!m_UseJobSystem || !JobSystem::IsInitialized() || m_ObjectCount <= BATCH_SIZE)
+		{
+			outVisible.resize(m_ObjectCount);
+			outVisible.resize(CullRange(planes, 0, m_ObjectCount, outVisible.data()));
+			return;
+		}
+
+		uint32_t batchCount = (m_ObjectCount + BATCH_SIZE - 1) / BATCH_SIZE;
+		m_BatchVisible.resize(m_ObjectCount);
+		m_BatchVisibleCounts.resize(batchCount);
+		JobSystem::ParallelFor(m_ObjectCount, BATCH_SIZE, [this, &planes](uint32_t begin, uint32_t end)
+		{
+			m_BatchVisibleCounts[begin / BATCH_SIZE] = CullRange(planes, begin, end, m_BatchVisible.data() + begin);
+		});
+
+		uint32_t visibleCount = 0;
+		for (uint32_t count : m_BatchVisibleCounts)
+		{
+			visibleCount += count;
+		}
+
+		outVisible.resize(visibleCount);
+		uint32_t *output = outVisible.data();
+		for (uint32_t batch = 0; batch < batchCount; batch++)
+		{
+			memcpy(output, m_BatchVisible.data() + batch * BATCH_SIZE, m_BatchVisibleCounts[batch] * sizeof(uint32_t));
+			output += m_BatchVisibleCounts[batch];
+		}
+	}
+
+	CpuCullingPath CpuCulling::GetBestSupportedPath()
+	{
+#if defined(ARC_CULLING_X86) && defined(_MSC_VER)
+		// AVX also needs the OS to save the upper halves of the registers, which XGETBV reports
+		int cpuInfo[4];
+		__cpuid(cpuInfo, 1);
+		bool osSavesAvx = (cpuInfo[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+		if (osSavesAvx && (cpuInfo[2] & (1 << 28)) != 0)
+			return CpuCullingPath::AVX;
+		if ((cpuInfo[3] & (1 << 25)) != 0)
+			return CpuCullingPath::SSE;
+#elif defined(ARC_CULLING_X86)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx"))
+			return CpuCullingPath::AVX;
+		if (__builtin_cpu_supports("sse"))
+			return CpuCullingPath::SSE;
+#endif
+		return CpuCullingPath::SCALAR;
+	}
+
+#ifdef ARC_CULLING_X86
+	// An object is outside when its box grown by its radius is entirely behind one of the planes. The projection of the box's extents onto the
+	// plane normal is the distance its furthest corner reaches in front of its centre
+	static uint32_t CullRangeSSE(const glm::vec4 planes[6], const float *const arrays[7], uint32_t begin, uint32_t end, uint32_t *outVisible)
+	{
+		__m128 normalX[6], normalY[6], normalZ[6], distance[6], absNormalX[6], absNormalY[6], absNormalZ[6];
+		for (int p = 0; p < 6; p++)
+		{
+			normalX[p] = _mm_set1_ps(planes[p].x);
+			normalY[p] = _mm_set1_ps(planes[p].y);
+			normalZ[p] = _mm_set1_ps(planes[p].z);
+			distance[p] = _mm_set1_ps(planes[p].w);
+			absNormalX[p] = _mm_set1_ps(std::abs(planes[p].x));
+			absNormalY[p] = _mm_set1_ps(std::abs(planes[p].y));
+			absNormalZ[p] = _mm_set1_ps(std::abs(planes[p].z));
+		}
+
+		const __m128 zero = _mm_setzero_ps();
+		uint32_t visibleCount = 0;
+		for (uint32_t i = begin; i < end; i += 4)
+		{
+			__m128 centreX = _mm_loadu_ps(arrays[0] + i), centreY = _mm_loadu_ps(arrays[1] + i), centreZ = _mm_loadu_ps(arrays[2] + i);
+			__m128 extentX = _mm_loadu_ps(arrays[3] + i), extentY = _mm_loadu_ps(arrays[4] + i), extentZ = _mm_loadu_ps(arrays[5] + i);
+			__m128 radius = _mm_loadu_ps(arrays[6] + i);
+
+			__m128 inside = _mm_cmpeq_ps(zero, zero);
+			for (int p = 0; p < 6; p++)
+			{
+				__m128 centreDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX[p], centreX), _mm_mul_ps(normalY[p], centreY)), _mm_add_ps(_mm_mul_ps(normalZ[p], centreZ), distance[p]));
+				__m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absNormalX[p], extentX), _mm_mul_ps(absNormalY[p], extentY)), _mm_add_ps(_mm_mul_ps(absNormalZ[p], extentZ), radius));
+				inside = _mm_and_ps(inside, _mm_cmpgt_ps(_mm_add_ps(centreDistance, reach), zero));
+			}
+
+			// Writes every lane and only advances past the visible ones, which avoids a branch per object
+			uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(inside));
+			uint32_t laneCount = std::min(4u, end - i);
+			for (uint32_t lane = 0; lane < laneCount; lane++)
+			{
+				outVisible[visibleCount] = i + lane;
+				visibleCount += (mask >> lane) & 1;
+			}
+		}
+		return visibleCount;
+	}
+
+	ARC_TARGET_AVX static uint32_t CullRangeAVX(const glm::vec4 planes[6], const float *const arrays[7], uint32_t begin, uint32_t end, uint32_t *outVisible)
+	{
+		__m256 normalX[6], normalY[6], normalZ[6], distance[6], absNormalX[6], absNormalY[6], absNormalZ[6];
+		for (int p = 0; p < 6; p++)
+		{
+			normalX[p] = _mm256_set1_ps(planes[p].x);
+			normalY[p] = _mm256_set1_ps(planes[p].y);
+			normalZ[p] = _mm256_set1_ps(planes[p].z);
+			distance[p] = _mm256_set1_ps(planes[p].w);
+			absNormalX[p] = _mm256_set1_ps(std::abs(planes[p].x));
+			absNormalY[p] = _mm256_set1_ps(std::abs(planes[p].y));
+			absNormalZ[p] = _mm256_set1_ps(std::abs(planes[p].z));
+		}
+
+		const __m256 zero = _mm256_setzero_ps();
+		uint32_t visibleCount = 0;
+		for (uint32_t i = begin; i < end; i += 8)
+		{
+			__m256 centreX = _mm256_loadu_ps(arrays[0] + i), centreY = _mm256_loadu_ps(arrays[1] + i), centreZ = _mm256_loadu_ps(arrays[2] + i);
+			__m256 extentX = _mm256_loadu_ps(arrays[3] + i), extentY = _mm256_loadu_ps(arrays[4] + i), extentZ = _mm256_loadu_ps(arrays[5] + i);
+			__m256 radius = _mm256_loadu_ps(arrays[6] + i);
+
+			__m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+			for (int p = 0; p < 6; p++)
+			{
+				__m256 centreDistance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(normalX[p], centreX), _mm256_mul_ps(normalY[p], centreY)), _mm256_add_ps(_mm256_mul_ps(normalZ[p], centreZ), distance[p]));
+				__m256 reach = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(absNormalX[p], extentX), _mm256_mul_ps(absNormalY[p], extentY)), _mm256_add_ps(_mm256_mul_ps(absNormalZ[p], extentZ), radius));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(centreDistance, reach), zero, _CMP_GT_OQ));
+			}
+
+			uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+			uint32_t laneCount = std::min(8u, end - i);
+			for (uint32_t lane = 0; lane < laneCount; lane++)
+			{
+				outVisible[visibleCount] = i + lane;
+				visibleCount += (mask >> lane) & 1;
+			}
+		}
+		return visibleCount;
+	}
+#endif
+
+	uint32_t CpuCulling::CullRange(const glm::vec4 planes[6], uint32_t begin, uint32_t end, uint32_t *outVisible) const
+	{
+		ARC_ASSERT(begin % SIMD_WIDTH == 0, "CpuCulling: Ranges have to start on a multiple of {0} objects", SIMD_WIDTH);
+
+#ifdef ARC_CULLING_X86
+		const float *const arrays[7] = { m_CentreX.data(), m_CentreY.data(), m_CentreZ.data(), m_ExtentX.data(), m_ExtentY.data(), m_ExtentZ.data(), m_Radius.data() };
+		if (m_Path == CpuCullingPath::AVX)
+			return CullRangeAVX(planes, arrays, begin, end, outVisible);
+		if (m_Path == CpuCullingPath::SSE)
+			return CullRangeSSE(planes, arrays, begin, end, outVisible);
+#endif
+
+		uint32_t visibleCount = 0;
+		for (uint32_t i = begin; i < end; i++)
+		{
+			bool inside = true;
+			for (int p = 0; p < 6; p++)
+			{
+				float centreDistance = planes[p].x * m_CentreX[i] + planes[p].y * m_CentreY[i] + planes[p].z * m_CentreZ[i] + planes[p].w;
+				float reach = std::abs(planes[p].x) * m_ExtentX[i] + std::abs(planes[p].y) * m_ExtentY[i] + std::abs(planes[p].z) * m_ExtentZ[i] + m_Radius[i];
+				inside = inside && centreDistance + reach > 0.0f;
+			}
+
+			outVisible[visibleCount] = i;
+			visibleCount += inside ? 1 : 0;
+		}
+		return visibleCount;
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+namespace Arcane
+{
+	// Instruction sets the plane tests can run with, every path gives the same visible list
+	enum class CpuCullingPath
+	{
+		SCALAR,
+		SSE, // 4 objects per instruction
+		AVX  // 8 objects per instruction
+	};
+
+	// Frustum culls objects on the CPU for when GPU culling is off or the results are needed on the CPU (shadow cascades for example). The bounds are stored as
+	// structure of arrays so the plane tests load 4 or 8 objects at once, and the objects are split into batches that run on the job system. Every object is a box
+	// (centre and half extents) grown by a radius, so spheres are boxes with no extents and boxes have no radius
+	class CpuCulling
+	{
+	public:
+		CpuCulling();
+
+		uint32_t AddSphere(const glm::vec4 &sphere); // World space centre and radius
+		uint32_t AddBox(const glm::vec3 &min, const glm::vec3 &max);
+		void Clear();
+
+		// Outputs the indices of the objects that are at least partially inside the frustum of a view projection matrix with a zero to one depth range, in ascending order
+		void Cull(const glm::mat4 &viewProjection, std::vector<uint32_t> &outVisible);
+
+		static CpuCullingPath GetBestSupportedPath();
+
+		// Getters
+		inline uint32_t GetObjectCount() const { return m_ObjectCount; }
+		inline CpuCullingPath GetPath() const { return m_Path; }
+
+		// Setters
+		inline void SetPath(CpuCullingPath path) { m_Path = path; } // The path has to be supported by the CPU, defaults to the best one
+		inline void SetUseJobSystem(bool useJobSystem) { m_UseJobSystem = useJobSystem; }
+	private:
+		uint32_t AddObject(const glm::vec3 &centre, const glm::vec3 &extents, float radius);
+		// Tests [begin, end) and writes the visible indices to outVisible, returns how many were written. Begin has to be a multiple of 8
+		uint32_t CullRange(const glm::vec4 planes[6], uint32_t begin, uint32_t end, uint32_t *outVisible) const;
+	private:
+		uint32_t m_ObjectCount;
+		CpuCullingPath m_Path;
+		bool m_UseJobSystem;
+
+		// Padded to a multiple of 8 objects so the last group can always be loaded in full
+		std::vector<float> m_CentreX, m_CentreY, m_CentreZ;
+		std::vector<float> m_ExtentX, m_ExtentY, m_ExtentZ;
+		std::vector<float> m_Radius;
+
+		// Every batch writes its visible indices to its own range, they are packed together afterwards
+		std::vector<uint32_t> m_BatchVisible;
+		std::vector<uint32_t> m_BatchVisibleCounts;
+
+		static const uint32_t BATCH_SIZE = 4096;
+	};
+}
@@ -0,0 +1,244 @@
+#include "arcpch.h"
+#include "GpuCulling.h"
+
+#include "Graphics/ComputeShader.h"
+#include "Graphics/ShaderLoader.h"
+#include "Graphics/ShaderSpecialization.h"
+#include "Graphics/Buffer/IndirectDrawBuffer.h"
+#include "Graphics/Renderer/ComputePipeline.h"
+#include "Graphics/Renderer/VulkanAPI.h"
+
+namespace Arcane
+{
+	struct FrustumCullConstants
+	{
+		glm::vec4 FrustumPlanes[6];
+		glm::vec4 LodCamera; // Position and error scale
+		uint32_t ObjectCount;
+		float LodHysteresis;
+	};
+
+	GpuCulling::GpuCulling(const VulkanAPI *const vulkan, uint32_t maxObjectCount, uint32_t framesInFlight)
+		: m_Vulkan(vulkan), m_MaxObjectCount(maxObjectCount), m_ObjectCount(0), m_Shader(nullptr), m_Pipeline(nullptr), m_ObjectBuffer(VK_NULL_HANDLE), m_ObjectBufferMemory(VK_NULL_HANDLE),
+		m_LodBuffer(VK_NULL_HANDLE), m_LodBufferMemory(VK_NULL_HANDLE), m_LodStateBuffer(VK_NULL_HANDLE), m_LodStateBufferMemory(VK_NULL_HANDLE), m_DrawBuffer(nullptr), m_DescriptorPool(VK_NULL_HANDLE)
+	{
+		VkDevice device = *m_Vulkan->GetDevice();
+
+		// Without indirect count the draw covers every object, so each object has to write its own command
+		ShaderSpecialization specialization;
+		specialization.SetBool("COMPACT_DRAWS", m_Vulkan->IsDrawIndirectCountEnabled());
+		m_Shader = ShaderLoader::LoadComputeShader("res/Shaders/frustumcull_comp.spv", &specialization);
+		m_Pipeline = new ComputePipeline(m_Vulkan, m_Shader);
+
+		// Concurrent since the objects are uploaded on the copy queue and read on the compute queue
+		m_Vulkan->CreateBuffer(sizeof(GpuCullObject) * m_MaxObjectCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			VK_SHARING_MODE_CONCURRENT, &m_ObjectBuffer, &m_ObjectBufferMemory);
+		m_Vulkan->CreateBuffer(sizeof(GpuMeshLod) * MAX_LOD_COUNT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			VK_SHARING_MODE_CONCURRENT, &m_LodBuffer, &m_LodBufferMemory);
+		m_Vulkan->CreateBuffer(sizeof(uint32_t) * m_MaxObjectCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			VK_SHARING_MODE_CONCURRENT, &m_LodStateBuffer, &m_LodStateBufferMemory);
+		m_DrawBuffer = new IndirectDrawBuffer(m_Vulkan, m_MaxObjectCount, framesInFlight, IndirectDrawSource::GPU);
+
+		VkDescriptorPoolSize poolSize = {};
+		poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSize.descriptorCount = 4 * framesInFlight;
+
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.pNext = nullptr;
+		poolInfo.maxSets = framesInFlight;
+		poolInfo.poolSizeCount = 1;
+		poolInfo.pPoolSizes = &poolSize;
+
+		VkResult result = vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_DescriptorPool);
+		ARC_ASSERT(result == VK_SUCCESS, "GpuCulling: Failed to create descriptor pool");
+
+		std::vector<VkDescriptorSetLayout> setLayouts(framesInFlight, m_Pipeline->GetDescriptorSetLayout(0));
+		VkDescriptorSetAllocateInfo allocateInfo = {};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocateInfo.pNext = nullptr;
+		allocateInfo.descriptorPool = m_DescriptorPool;
+		allocateInfo.descriptorSetCount = framesInFlight;
+		allocateInfo.pSetLayouts = setLayouts.data();
+
+		m_DescriptorSets.resize(framesInFlight);
+		result = vkAllocateDescriptorSets(device, &allocateInfo, m_DescriptorSets.data());
+		ARC_ASSERT(result == VK_SUCCESS, "GpuCulling: Failed to allocate descriptor sets");
+
+		for (uint32_t i = 0; i < framesInFlight; i++)
+		{
+			m_DrawBuffer->BeginFrame(i);
+
+			VkDescriptorBufferInfo objectBufferInfo = {};
+			objectBufferInfo.buffer = m_ObjectBuffer;
+			objectBufferInfo.offset = 0;
+			objectBufferInfo.range = VK_WHOLE_SIZE;
+
+			VkDescriptorBufferInfo drawBufferInfo = {};
+			drawBufferInfo.buffer = m_DrawBuffer->GetBuffer();
+			drawBufferInfo.offset = m_DrawBuffer->GetFrameOffset();
+			drawBufferInfo.range = m_DrawBuffer->GetFrameSize();
+
+			VkDescriptorBufferInfo lodBufferInfo = {};
+			lodBufferInfo.buffer = m_LodBuffer;
+			lodBufferInfo.offset = 0;
+			lodBufferInfo.range = VK_WHOLE_SIZE;
+
+			VkDescriptorBufferInfo lodStateBufferInfo = {};
+			lodStateBufferInfo.buffer = m_LodStateBuffer;
+			lodStateBufferInfo.offset = 0;
+			lodStateBufferInfo.range = VK_WHOLE_SIZE;
+
+			std::array<VkWriteDescriptorSet, 4> descriptorWrites = {};
+			descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[0].pNext = nullptr;
+			descriptorWrites[0].dstSet = m_DescriptorSets[i];
+			descriptorWrites[0].dstBinding = 0;
+			descriptorWrites[0].descriptorCount = 1;
+			descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrites[0].pBufferInfo = &objectBufferInfo;
+
+			descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[1].pNext = nullptr;
+			descriptorWrites[1].dstSet = m_DescriptorSets[i];
+			descriptorWrites[1].dstBinding = 1;
+			descriptorWrites[1].descriptorCount = 1;
+			descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrites[1].pBufferInfo = &drawBufferInfo;
+
+			descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[2].pNext = nullptr;
+			descriptorWrites[2].dstSet = m_DescriptorSets[i];
+			descriptorWrites[2].dstBinding = 2;
+			descriptorWrites[2].descriptorCount = 1;
+			descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrites[2].pBufferInfo = &lodBufferInfo;
+
+			descriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[3].pNext = nullptr;
+			descriptorWrites[3].dstSet = m_DescriptorSets[i];
+			descriptorWrites[3].dstBinding = 3;
+			descriptorWrites[3].descriptorCount = 1;
+			descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrites[3].pBufferInfo = &lodStateBufferInfo;
+
+			vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+		}
+	}
+
+	GpuCulling::~GpuCulling()
+	{
+		VkDevice device = *m_Vulkan->GetDevice();
+
+		vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+		delete m_DrawBuffer;
+		vkDestroyBuffer(device, m_LodStateBuffer, nullptr);
+		vkFreeMemory(device, m_LodStateBufferMemory, nullptr);
+		vkDestroyBuffer(device, m_LodBuffer, nullptr);
+		vkFreeMemory(device, m_LodBufferMemory, nullptr);
+		vkDestroyBuffer(device, m_ObjectBuffer, nullptr);
+		vkFreeMemory(device, m_ObjectBufferMemory, nullptr);
+		delete m_Pipeline;
+		delete m_Shader;
+	}
+
+	void GpuCulling::SetObjects(const std::vector<GpuCullObject> &objects, const std::vector<GpuMeshLod> &lods)
+	{
+		ARC_ASSERT(objects.size() <= m_MaxObjectCount, "GpuCulling: Can't cull more than {0} objects", m_MaxObjectCount);
+		ARC_ASSERT(lods.size() <= MAX_LOD_COUNT, "GpuCulling: Too many levels of detail ({0})", lods.size());
+
+		vkDeviceWaitIdle(*m_Vulkan->GetDevice()); // The buffers might still be read by a culling pass in flight
+		m_ObjectCount = static_cast<uint32_t>(objects.size());
+		if (objects.empty())
+			return;
+
+		m_Vulkan->UploadToBuffer(m_ObjectBuffer, objects.data(), sizeof(GpuCullObject) * objects.size());
+		m_Vulkan->UploadToBuffer(m_LodBuffer, lods.data(), sizeof(GpuMeshLod) * lods.size());
+
+		// Nothing has been drawn yet, the first frame selects every level from full detail
+		VkCommandBuffer commandBuffer = m_Vulkan->BeginUploadCommands();
+		vkCmdFillBuffer(commandBuffer, m_LodStateBuffer, 0, sizeof(uint32_t) * m_ObjectCount, 0);
+
+		VkBufferMemoryBarrier lodStateBarrier = {};
+		lodStateBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		lodStateBarrier.pNext = nullptr;
+		lodStateBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		lodStateBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		lodStateBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		lodStateBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		lodStateBarrier.buffer = m_LodStateBuffer;
+		lodStateBarrier.offset = 0;
+		lodStateBarrier.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &lodStateBarrier, 0, nullptr);
+		m_Vulkan->SubmitUploadCommands(commandBuffer);
+	}
+
+	void GpuCulling::Record(VkCommandBuffer commandBuffer, uint32_t frameIndex, const GpuCullView &view)
+	{
+		m_DrawBuffer->BeginFrame(frameIndex);
+
+		// Compaction appends to the draw count, so it starts every frame at zero
+		m_DrawBuffer->ResetDrawCount(commandBuffer);
+
+		VkBufferMemoryBarrier countBarrier = {};
+		countBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		countBarrier.pNext = nullptr;
+		countBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		countBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		countBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		countBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		countBarrier.buffer = m_DrawBuffer->GetBuffer();
+		countBarrier.offset = m_DrawBuffer->GetCountOffset();
+		countBarrier.size = sizeof(uint32_t);
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &countBarrier, 0, nullptr);
+
+		// The levels last frame's pass stored are this frame's starting point
+		VkBufferMemoryBarrier lodStateBarrier = {};
+		lodStateBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		lodStateBarrier.pNext = nullptr;
+		lodStateBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		lodStateBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		lodStateBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		lodStateBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		lodStateBarrier.buffer = m_LodStateBuffer;
+		lodStateBarrier.offset = 0;
+		lodStateBarrier.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &lodStateBarrier, 0, nullptr);
+
+		if (m_ObjectCount == 0)
+			return;
+
+		FrustumCullConstants constants;
+		ExtractFrustumPlanes(view.ViewProjection, constants.FrustumPlanes);
+		constants.LodCamera = glm::vec4(view.CameraPosition, view.LodErrorScale);
+		constants.ObjectCount = m_ObjectCount;
+		constants.LodHysteresis = view.LodHysteresis;
+
+		m_Pipeline->Bind(commandBuffer);
+		m_Pipeline->BindDescriptorSet(commandBuffer, m_DescriptorSets[frameIndex]);
+		m_Pipeline->PushConstants(commandBuffer, &constants, sizeof(constants));
+		m_Pipeline->DispatchThreads(commandBuffer, m_ObjectCount);
+	}
+
+	void GpuCulling::ExtractFrustumPlanes(const glm::mat4 &viewProjection, glm::vec4 outPlanes[6])
+	{
+		// Gribb-Hartmann, glm is column major so the rows are gathered across the columns
+		glm::vec4 rows[4];
+		for (int i = 0; i < 4; i++)
+		{
+			rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+		}
+
+		outPlanes[0] = rows[3] + rows[0]; // Left
+		outPlanes[1] = rows[3] - rows[0]; // Right
+		outPlanes[2] = rows[3] + rows[1]; // Bottom
+		outPlanes[3] = rows[3] - rows[1]; // Top
+		outPlanes[4] = rows[2];           // Near, depth goes from zero to one
+		outPlanes[5] = rows[3] - rows[2]; // Far
+
+		for (int i = 0; i < 6; i++)
+		{
+			outPlanes[i] /= glm::length(glm::vec3(outPlanes[i]));
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+namespace Arcane
+{
+	class VulkanAPI;
+	class ComputeShader;
+	class ComputePipeline;
+	class IndirectDrawBuffer;
+
+	// Per object data the culling pass reads, matches CullObject in frustumcull.comp and occlusioncull.comp
+	struct GpuCullObject
+	{
+		glm::vec4 BoundingSphere; // World space centre and radius
+		int32_t VertexOffset;
+		uint32_t FirstLod; // Into the levels given with the objects, objects using the same mesh share its levels
+		uint32_t LodCount;
+		float Scale = 1.0f; // Uniform scale from mesh to world space, the levels' errors are in mesh units
+	};
+
+	// A level of detail of a mesh, matches MeshLod in lodselect.glsl
+	struct GpuMeshLod
+	{
+		uint32_t FirstIndex; // Absolute, into the geometry pool
+		uint32_t IndexCount;
+		float Error;
+		uint32_t Padding = 0;
+	};
+
+	// The camera the culling passes test against and select the levels of detail for
+	struct GpuCullView
+	{
+		glm::mat4 ViewProjection;
+		glm::vec3 CameraPosition;
+		float LodErrorScale; // LodSelection::GetErrorScale()
+		float LodHysteresis;
+	};
+
+	// Frustum culls every object on the GPU and compacts the survivors into an IndirectDrawBuffer that the graphics pass draws with a single indirect count draw,
+	// so the CPU does nothing per object. Each surviving object is drawn with the level of detail selected for its distance, which it remembers for the next frame's
+	// hysteresis. The objects live in a device local buffer that is only uploaded when they change
+	class GpuCulling
+	{
+	public:
+		GpuCulling(const VulkanAPI *const vulkan, uint32_t maxObjectCount, uint32_t framesInFlight);
+		~GpuCulling();
+
+		// Waits for the device to be idle before replacing the objects and their levels of detail, every object starts out at full detail
+		void SetObjects(const std::vector<GpuCullObject> &objects, const std::vector<GpuMeshLod> &lods);
+
+		// Records the culling pass for the frame, it is normally recorded on the async compute queue with the graphics pass waiting on it at the draw indirect stage
+		void Record(VkCommandBuffer commandBuffer, uint32_t frameIndex, const GpuCullView &view);
+
+		// Outputs the planes (xyz normal pointing inwards, w distance) of a view projection matrix with a zero to one depth range, normalized so spheres can be tested against them
+		static void ExtractFrustumPlanes(const glm::mat4 &viewProjection, glm::vec4 outPlanes[6]);
+
+		// Getters
+		inline IndirectDrawBuffer* GetDrawBuffer() const { return m_DrawBuffer; }
+		inline uint32_t GetObjectCount() const { return m_ObjectCount; }
+		inline uint32_t GetMaxObjectCount() const { return m_MaxObjectCount; }
+	private:
+		const VulkanAPI *const m_Vulkan;
+		const uint32_t m_MaxObjectCount;
+		uint32_t m_ObjectCount;
+
+		ComputeShader *m_Shader;
+		ComputePipeline *m_Pipeline;
+
+		VkBuffer m_ObjectBuffer;
+		VkDeviceMemory m_ObjectBufferMemory;
+		VkBuffer m_LodBuffer;
+		VkDeviceMemory m_LodBufferMemory;
+		VkBuffer m_LodStateBuffer; // Level each object was drawn with, kept across frames
+		VkDeviceMemory m_LodStateBufferMemory;
+		IndirectDrawBuffer *m_DrawBuffer;
+
+		VkDescriptorPool m_DescriptorPool;
+		std::vector<VkDescriptorSet> m_DescriptorSets; // One per frame in flight, each points at its frame's region of the draw buffer
+
+		static const uint32_t MAX_LOD_COUNT = 4096; // Levels of detail of all the meshes the objects use together
+	};
+}
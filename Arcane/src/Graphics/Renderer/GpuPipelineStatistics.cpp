@@ -0,0 +1,64 @@
+#include "arcpch.h"
+#include "GpuPipelineStatistics.h"
+
+#include "Graphics/Renderer/VulkanAPI.h"
+
+namespace Arcane
+{
+	GpuPipelineStatistics::GpuPipelineStatistics(const VulkanAPI *const vulkan, uint32_t framesInFlight)
+		: m_Vulkan(vulkan), m_Supported(m_Vulkan->IsPipelineStatisticsEnabled()), m_QueryPool(VK_NULL_HANDLE), m_Pending(framesInFlight, false)
+	{
+		if (!m_Supported)
+		{
+			ARC_LOG_WARN("GpuPipelineStatistics: The device can't inherit pipeline statistics queries, fragment shader invocations won't be counted");
+			return;
+		}
+
+		VkQueryPoolCreateInfo queryPoolInfo = {};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.pNext = nullptr;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+		queryPoolInfo.queryCount = framesInFlight;
+		queryPoolInfo.pipelineStatistics = GetInheritedStatistics();
+
+		VkResult result = vkCreateQueryPool(*m_Vulkan->GetDevice(), &queryPoolInfo, nullptr, &m_QueryPool);
+		ARC_ASSERT(result == VK_SUCCESS, "GpuPipelineStatistics: Failed to create the pipeline statistics query pool");
+	}
+
+	GpuPipelineStatistics::~GpuPipelineStatistics()
+	{
+		vkDestroyQueryPool(*m_Vulkan->GetDevice(), m_QueryPool, nullptr);
+	}
+
+	void GpuPipelineStatistics::Begin(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+	{
+		if (!m_Supported)
+			return;
+
+		vkCmdResetQueryPool(commandBuffer, m_QueryPool, frameIndex, 1);
+		vkCmdBeginQuery(commandBuffer, m_QueryPool, frameIndex, 0);
+	}
+
+	void GpuPipelineStatistics::End(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+	{
+		if (!m_Supported)
+			return;
+
+		vkCmdEndQuery(commandBuffer, m_QueryPool, frameIndex);
+		m_Pending[frameIndex] = true;
+	}
+
+	bool GpuPipelineStatistics::ReadResult(uint32_t frameIndex, uint64_t &outFragmentInvocations)
+	{
+		if (!m_Supported || !m_Pending[frameIndex])
+			return false;
+
+		// Only one statistic is enabled, so the result is that single counter
+		VkResult result = vkGetQueryPoolResults(*m_Vulkan->GetDevice(), m_QueryPool, frameIndex, 1, sizeof(uint64_t), &outFragmentInvocations, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		if (result != VK_SUCCESS)
+			return false; // VK_NOT_READY, the command buffer was recorded but never submitted or hasn't finished
+
+		m_Pending[frameIndex] = false;
+		return true;
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+namespace Arcane
+{
+	class VulkanAPI;
+
+	// Counts the fragment shader invocations of a command buffer for every frame in flight with a pipeline statistics query. Like GpuTimer the results are
+	// read back without stalling, so a frame's count is only available once its fence has signaled. Secondary command buffers executed while the query is
+	// active have to inherit its statistics
+	class GpuPipelineStatistics
+	{
+	public:
+		GpuPipelineStatistics(const VulkanAPI *const vulkan, uint32_t framesInFlight);
+		~GpuPipelineStatistics();
+
+		// Both have to be recorded in the primary command buffer outside of a render pass, Begin resets the frame's query
+		void Begin(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+		void End(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+		// Returns false if the query isn't available, or was already read
+		bool ReadResult(uint32_t frameIndex, uint64_t &outFragmentInvocations);
+
+		// Getters
+		inline bool IsSupported() const { return m_Supported; }
+		// Statistics that VkCommandBufferInheritanceInfo::pipelineStatistics of the secondary command buffers has to include
+		inline VkQueryPipelineStatisticFlags GetInheritedStatistics() const { return m_Supported ? VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT : 0; }
+	private:
+		const VulkanAPI *const m_Vulkan;
+		const bool m_Supported;
+
+		VkQueryPool m_QueryPool; // A query per frame in flight
+		std::vector<bool> m_Pending; // Frames that began a query that hasn't been read back yet
+	};
+}
@@ -0,0 +1,74 @@
+#include "arcpch.h"
+#include "GpuTimer.h"
+
+#include "Graphics/Renderer/VulkanAPI.h"
+
+namespace Arcane
+{
+	GpuTimer::GpuTimer(const VulkanAPI *const vulkan, uint32_t queueFamilyIndex, uint32_t framesInFlight)
+		: m_Vulkan(vulkan), m_Supported(false), m_TimestampPeriod(m_Vulkan->GetPhysicalDeviceLimits().timestampPeriod), m_TimestampMask(0), m_QueryPool(VK_NULL_HANDLE), m_Pending(framesInFlight, false)
+	{
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(m_Vulkan->GetPhysicalDevice(), &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(m_Vulkan->GetPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+
+		// Queue families without any valid timestamp bits can't write timestamps at all, the timer then never has any results
+		uint32_t validBits = queueFamilies[queueFamilyIndex].timestampValidBits;
+		m_Supported = validBits > 0;
+		if (!m_Supported)
+		{
+			ARC_LOG_WARN("GpuTimer: Queue family {0} does not support timestamps", queueFamilyIndex);
+			return;
+		}
+		m_TimestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+		VkQueryPoolCreateInfo queryPoolInfo = {};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.pNext = nullptr;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = framesInFlight * 2;
+
+		VkResult result = vkCreateQueryPool(*m_Vulkan->GetDevice(), &queryPoolInfo, nullptr, &m_QueryPool);
+		ARC_ASSERT(result == VK_SUCCESS, "GpuTimer: Failed to create the timestamp query pool");
+	}
+
+	GpuTimer::~GpuTimer()
+	{
+		vkDestroyQueryPool(*m_Vulkan->GetDevice(), m_QueryPool, nullptr);
+	}
+
+	void GpuTimer::Begin(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+	{
+		if (!m_Supported)
+			return;
+
+		vkCmdResetQueryPool(commandBuffer, m_QueryPool, frameIndex * 2, 2);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_QueryPool, frameIndex * 2);
+	}
+
+	void GpuTimer::End(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+	{
+		if (!m_Supported)
+			return;
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_QueryPool, frameIndex * 2 + 1);
+		m_Pending[frameIndex] = true;
+	}
+
+	bool GpuTimer::ReadResult(uint32_t frameIndex, double &outBeginMs, double &outEndMs)
+	{
+		if (!m_Supported || !m_Pending[frameIndex])
+			return false;
+
+		uint64_t timestamps[2];
+		VkResult result = vkGetQueryPoolResults(*m_Vulkan->GetDevice(), m_QueryPool, frameIndex * 2, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		if (result != VK_SUCCESS)
+			return false; // VK_NOT_READY, the command buffer was recorded but never submitted or hasn't finished
+
+		m_Pending[frameIndex] = false;
+		outBeginMs = static_cast<double>(timestamps[0] & m_TimestampMask) * m_TimestampPeriod / 1000000.0;
+		outEndMs = static_cast<double>(timestamps[1] & m_TimestampMask) * m_TimestampPeriod / 1000000.0;
+		return true;
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+namespace Arcane
+{
+	class VulkanAPI;
+
+	// Timestamps at the start and end of a command buffer for every frame in flight. Results are read back without stalling, so a frame's time is only
+	// available once its fence has signaled. Timestamps of every queue on the device share a clock, so timers of different queues can be compared for overlap
+	class GpuTimer
+	{
+	public:
+		GpuTimer(const VulkanAPI *const vulkan, uint32_t queueFamilyIndex, uint32_t framesInFlight);
+		~GpuTimer();
+
+		// Begin has to be recorded outside of a render pass since it resets the frame's queries
+		void Begin(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+		void End(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+		// Start and end of the frame's last submitted timing in milliseconds on the device clock. Returns false if the queries aren't available, or were already read
+		bool ReadResult(uint32_t frameIndex, double &outBeginMs, double &outEndMs);
+
+		inline bool IsSupported() const { return m_Supported; }
+	private:
+		const VulkanAPI *const m_Vulkan;
+		bool m_Supported;
+		double m_TimestampPeriod; // Nanoseconds per tick
+		uint64_t m_TimestampMask;
+
+		VkQueryPool m_QueryPool; // [frameIndex * 2] is the begin timestamp, [frameIndex * 2 + 1] the end timestamp
+		std::vector<bool> m_Pending; // Frames that wrote timestamps that haven't been read back yet
+	};
+}
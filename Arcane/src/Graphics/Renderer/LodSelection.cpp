@@ -0,0 +1,46 @@
+#include "arcpch.h"
+#include "LodSelection.h"
+
+namespace Arcane
+{
+	float LodSelection::GetErrorScale(const glm::mat4 &projection, float viewportHeight, const LodSettings &settings)
+	{
+		// The projection's y scale is cot(fov / 2), flipped for Vulkan's clip space
+		return std::abs(projection[1][1]) * viewportHeight * 0.5f / settings.PixelError;
+	}
+
+	uint32_t LodSelection::SelectLod(const std::vector<MeshLod> &lods, float distance, float errorScale, float hysteresis, uint32_t currentLod)
+	{
+		if (lods.empty() || distance <= 0.0f)
+			return 0;
+
+		// Finer until the level is within the limit, then coarser while the next level is clearly within it. Running it again on its own result changes nothing
+		uint32_t lod = std::min(currentLod, static_cast<uint32_t>(lods.size()) - 1);
+		while (lod > 0 && lods[lod].Error * errorScale > distance)
+		{
+			lod--;
+		}
+		while (lod + 1 < lods.size() && lods[lod + 1].Error * errorScale <= distance * (1.0f - hysteresis))
+		{
+			lod++;
+		}
+		return lod;
+	}
+
+	void LodSelection::Select(const std::vector<glm::vec4> &boundingSpheres, const std::vector<uint32_t> &visible, const std::vector<MeshLod> &lods, const glm::vec3 &cameraPosition,
+		float errorScale, const LodSettings &settings)
+	{
+		m_Lods.resize(boundingSpheres.size(), 0);
+		for (uint32_t object : visible)
+		{
+			const glm::vec4 &sphere = boundingSpheres[object];
+			float distance = glm::length(glm::vec3(sphere) - cameraPosition) - sphere.w;
+			m_Lods[object] = SelectLod(lods, distance, errorScale, settings.Hysteresis, m_Lods[object]);
+		}
+	}
+
+	void LodSelection::Clear()
+	{
+		m_Lods.clear();
+	}
+}
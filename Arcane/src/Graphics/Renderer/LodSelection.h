@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Graphics/Mesh/MeshSimplifier.h"
+
+namespace Arcane
+{
+	struct LodSettings
+	{
+		float PixelError = 1.0f; // A level is used while the error it adds covers at most this many pixels on screen
+		float Hysteresis = 0.25f; // Switching to a coarser level waits until its error is this fraction below the limit, so objects near a boundary don't flicker
+	};
+
+	// Picks a level of detail per object from how many pixels each level's error covers at the object's distance. The GPU culling shaders run the same
+	// selection (lodselect.glsl), this is the CPU side for objects culled by CpuCulling. Levels only ever move while they stay within the pixel error, and
+	// the hysteresis needs the level the object had last time, so every object remembers its level
+	class LodSelection
+	{
+	public:
+		// Pixels covered by one unit of error one unit in front of the camera, divided by the pixel error so an error scaled by it is at the limit at 1
+		static float GetErrorScale(const glm::mat4 &projection, float viewportHeight, const LodSettings &settings);
+		// Distance is from the camera to the nearest point of the object's bounds and the error scale includes the object's scale. Inside the bounds is always
+		// the full detail level
+		static uint32_t SelectLod(const std::vector<MeshLod> &lods, float distance, float errorScale, float hysteresis, uint32_t currentLod);
+
+		// Selects the level of every visible object, which all use the same mesh. Objects that aren't visible keep the level they had
+		void Select(const std::vector<glm::vec4> &boundingSpheres, const std::vector<uint32_t> &visible, const std::vector<MeshLod> &lods, const glm::vec3 &cameraPosition,
+			float errorScale, const LodSettings &settings);
+		void Clear();
+
+		// Getters
+		inline uint32_t GetLod(uint32_t object) const { return m_Lods[object]; }
+		inline const std::vector<uint32_t>& GetLods() const { return m_Lods; }
+	private:
+		std::vector<uint32_t> m_Lods; // Indexed by object
+	};
+}
@@ -0,0 +1,516 @@
+#include "arcpch.h"
+#include "OcclusionCulling.h"
+
+#include "Graphics/ComputeShader.h"
+#include "Graphics/ShaderLoader.h"
+#include "Graphics/ShaderSpecialization.h"
+#include "Graphics/Buffer/IndirectDrawBuffer.h"
+#include "Graphics/Renderer/ComputePipeline.h"
+#include "Graphics/Renderer/VulkanAPI.h"
+
+namespace Arcane
+{
+	struct OcclusionCullConstants
+	{
+		glm::mat4 ViewProjection;
+		glm::vec4 LodCamera; // Position and error scale
+		uint32_t ObjectCount;
+		uint32_t DepthPyramidLevelCount;
+		float LodHysteresis;
+	};
+
+	OcclusionCulling::OcclusionCulling(const VulkanAPI *const vulkan, uint32_t maxObjectCount, uint32_t framesInFlight)
+		: m_Vulkan(vulkan), m_MaxObjectCount(maxObjectCount), m_FramesInFlight(framesInFlight), m_ObjectCount(0), m_CurrentFrame(0), m_View(),
+		m_CullShaders{ nullptr, nullptr }, m_CullPipelines{ nullptr, nullptr }, m_DepthPyramidShader(nullptr), m_DepthPyramidPipeline(nullptr),
+		m_ObjectBuffer(VK_NULL_HANDLE), m_ObjectBufferMemory(VK_NULL_HANDLE), m_LodBuffer(VK_NULL_HANDLE), m_LodBufferMemory(VK_NULL_HANDLE), m_VisibilityBuffer(VK_NULL_HANDLE), m_VisibilityBufferMemory(VK_NULL_HANDLE), m_DrawBuffers{ nullptr, nullptr },
+		m_StatsBuffer(VK_NULL_HANDLE), m_StatsBufferMemory(VK_NULL_HANDLE), m_StatsReadbackBuffer(VK_NULL_HANDLE), m_StatsReadbackBufferMemory(VK_NULL_HANDLE), m_MappedStats(nullptr),
+		m_StatsPending(framesInFlight, false), m_DepthPyramidExtent({ 0, 0 }), m_DepthPyramidLevelCount(0), m_DepthPyramid(VK_NULL_HANDLE), m_DepthPyramidMemory(VK_NULL_HANDLE),
+		m_DepthPyramidView(VK_NULL_HANDLE), m_DepthSampler(VK_NULL_HANDLE), m_DepthPyramidSourceView(VK_NULL_HANDLE), m_CullDescriptorPool(VK_NULL_HANDLE),
+		m_DepthPyramidDescriptorPool(VK_NULL_HANDLE)
+	{
+		VkDevice device = *m_Vulkan->GetDevice();
+
+		// Without indirect count the draws cover every object, so each object has to write its own command
+		for (int phase = 0; phase < 2; phase++)
+		{
+			ShaderSpecialization specialization;
+			specialization.SetBool("COMPACT_DRAWS", m_Vulkan->IsDrawIndirectCountEnabled());
+			specialization.SetBool("LATE_PHASE", phase == static_cast<int>(OcclusionCullPhase::LATE));
+			m_CullShaders[phase] = ShaderLoader::LoadComputeShader("res/Shaders/occlusioncull_comp.spv", &specialization);
+			m_CullPipelines[phase] = new ComputePipeline(m_Vulkan, m_CullShaders[phase]);
+		}
+		m_DepthPyramidShader = ShaderLoader::LoadComputeShader("res/Shaders/hizbuild_comp.spv");
+		m_DepthPyramidPipeline = new ComputePipeline(m_Vulkan, m_DepthPyramidShader);
+
+		// Concurrent since the objects are uploaded on the copy queue
+		m_Vulkan->CreateBuffer(sizeof(GpuCullObject) * m_MaxObjectCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			VK_SHARING_MODE_CONCURRENT, &m_ObjectBuffer, &m_ObjectBufferMemory);
+		m_Vulkan->CreateBuffer(sizeof(GpuMeshLod) * MAX_LOD_COUNT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			VK_SHARING_MODE_CONCURRENT, &m_LodBuffer, &m_LodBufferMemory);
+		m_Vulkan->CreateBuffer(sizeof(uint32_t) * m_MaxObjectCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			VK_SHARING_MODE_EXCLUSIVE, &m_VisibilityBuffer, &m_VisibilityBufferMemory);
+		for (int phase = 0; phase < 2; phase++)
+		{
+			m_DrawBuffers[phase] = new IndirectDrawBuffer(m_Vulkan, m_MaxObjectCount, m_FramesInFlight, IndirectDrawSource::GPU);
+		}
+
+		m_Vulkan->CreateBuffer(sizeof(OcclusionCullingStats), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_SHARING_MODE_EXCLUSIVE, &m_StatsBuffer, &m_StatsBufferMemory);
+		m_Vulkan->GetResourceStateTracker()->RegisterBuffer(m_StatsBuffer);
+		m_Vulkan->CreateBuffer(sizeof(OcclusionCullingStats) * m_FramesInFlight, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			VK_SHARING_MODE_EXCLUSIVE, &m_StatsReadbackBuffer, &m_StatsReadbackBufferMemory);
+
+		void *mappedMemory;
+		VkResult result = vkMapMemory(device, m_StatsReadbackBufferMemory, 0, VK_WHOLE_SIZE, 0, &mappedMemory);
+		ARC_ASSERT(result == VK_SUCCESS, "OcclusionCulling: Failed to map the stats readback buffer");
+		m_MappedStats = static_cast<OcclusionCullingStats*>(mappedMemory);
+
+		// Texels are fetched directly, the sampler is only there because the pyramid and the depth buffer are bound as combined image samplers
+		VkSamplerCreateInfo samplerInfo = {};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.pNext = nullptr;
+		samplerInfo.magFilter = VK_FILTER_NEAREST;
+		samplerInfo.minFilter = VK_FILTER_NEAREST;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.anisotropyEnable = VK_FALSE;
+		samplerInfo.maxAnisotropy = 1.0f;
+		samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+		samplerInfo.unnormalizedCoordinates = VK_FALSE;
+		samplerInfo.compareEnable = VK_FALSE;
+		samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerInfo.mipLodBias = 0.0f;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+		result = vkCreateSampler(device, &samplerInfo, nullptr, &m_DepthSampler);
+		ARC_ASSERT(result == VK_SUCCESS, "OcclusionCulling: Failed to create the depth sampler");
+
+		std::array<VkDescriptorPoolSize, 2> poolSizes = {};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSizes[0].descriptorCount = 5 * 2 * m_FramesInFlight;
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		poolSizes[1].descriptorCount = 2 * m_FramesInFlight;
+
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.pNext = nullptr;
+		poolInfo.maxSets = 2 * m_FramesInFlight;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+
+		result = vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_CullDescriptorPool);
+		ARC_ASSERT(result == VK_SUCCESS, "OcclusionCulling: Failed to create descriptor pool");
+
+		for (int phase = 0; phase < 2; phase++)
+		{
+			std::vector<VkDescriptorSetLayout> setLayouts(m_FramesInFlight, m_CullPipelines[phase]->GetDescriptorSetLayout(0));
+			VkDescriptorSetAllocateInfo allocateInfo = {};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			allocateInfo.pNext = nullptr;
+			allocateInfo.descriptorPool = m_CullDescriptorPool;
+			allocateInfo.descriptorSetCount = m_FramesInFlight;
+			allocateInfo.pSetLayouts = setLayouts.data();
+
+			m_CullDescriptorSets[phase].resize(m_FramesInFlight);
+			result = vkAllocateDescriptorSets(device, &allocateInfo, m_CullDescriptorSets[phase].data());
+			ARC_ASSERT(result == VK_SUCCESS, "OcclusionCulling: Failed to allocate descriptor sets");
+		}
+	}
+
+	OcclusionCulling::~OcclusionCulling()
+	{
+		VkDevice device = *m_Vulkan->GetDevice();
+
+		DestroyDepthPyramid();
+		vkDestroyDescriptorPool(device, m_CullDescriptorPool, nullptr);
+		vkDestroySampler(device, m_DepthSampler, nullptr);
+
+		vkUnmapMemory(device, m_StatsReadbackBufferMemory);
+		vkDestroyBuffer(device, m_StatsReadbackBuffer, nullptr);
+		vkFreeMemory(device, m_StatsReadbackBufferMemory, nullptr);
+		m_Vulkan->GetResourceStateTracker()->UnregisterBuffer(m_StatsBuffer);
+		vkDestroyBuffer(device, m_StatsBuffer, nullptr);
+		vkFreeMemory(device, m_StatsBufferMemory, nullptr);
+		for (int phase = 0; phase < 2; phase++)
+		{
+			delete m_DrawBuffers[phase];
+		}
+		vkDestroyBuffer(device, m_VisibilityBuffer, nullptr);
+		vkFreeMemory(device, m_VisibilityBufferMemory, nullptr);
+		vkDestroyBuffer(device, m_LodBuffer, nullptr);
+		vkFreeMemory(device, m_LodBufferMemory, nullptr);
+		vkDestroyBuffer(device, m_ObjectBuffer, nullptr);
+		vkFreeMemory(device, m_ObjectBufferMemory, nullptr);
+
+		delete m_DepthPyramidPipeline;
+		delete m_DepthPyramidShader;
+		for (int phase = 0; phase < 2; phase++)
+		{
+			delete m_CullPipelines[phase];
+			delete m_CullShaders[phase];
+		}
+	}
+
+	void OcclusionCulling::SetObjects(const std::vector<GpuCullObject> &objects, const std::vector<GpuMeshLod> &lods)
+	{
+		ARC_ASSERT(objects.size() <= m_MaxObjectCount, "OcclusionCulling: Can't cull more than {0} objects", m_MaxObjectCount);
+		ARC_ASSERT(lods.size() <= MAX_LOD_COUNT, "OcclusionCulling: Too many levels of detail ({0})", lods.size());
+
+		vkDeviceWaitIdle(*m_Vulkan->GetDevice()); // The buffers might still be read by a culling pass in flight
+		m_ObjectCount = static_cast<uint32_t>(objects.size());
+		if (objects.empty())
+			return;
+
+		m_Vulkan->UploadToBuffer(m_ObjectBuffer, objects.data(), sizeof(GpuCullObject) * objects.size());
+		m_Vulkan->UploadToBuffer(m_LodBuffer, lods.data(), sizeof(GpuMeshLod) * lods.size());
+
+		// Nothing was visible last frame, so the first frame draws everything in the late phase at full detail
+		VkCommandBuffer commandBuffer = m_Vulkan->BeginUploadCommands();
+		vkCmdFillBuffer(commandBuffer, m_VisibilityBuffer, 0, sizeof(uint32_t) * m_ObjectCount, 0);
+
+		VkBufferMemoryBarrier visibilityBarrier = {};
+		visibilityBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		visibilityBarrier.pNext = nullptr;
+		visibilityBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		visibilityBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		visibilityBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		visibilityBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		visibilityBarrier.buffer = m_VisibilityBuffer;
+		visibilityBarrier.offset = 0;
+		visibilityBarrier.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &visibilityBarrier, 0, nullptr);
+		m_Vulkan->SubmitUploadCommands(commandBuffer);
+	}
+
+	void OcclusionCulling::SetupGraph(RenderGraph &graph, VkExtent2D extent)
+	{
+		// The buffers are written and read in the graph's passes, importing them lets the graph place the barriers between the culling and the draws
+		m_VisibilityResource = graph.ImportBuffer("OcclusionVisibility", m_VisibilityBuffer, sizeof(uint32_t) * m_MaxObjectCount);
+		m_DrawBufferResources[static_cast<int>(OcclusionCullPhase::EARLY)] = graph.ImportBuffer("OcclusionEarlyDraws", m_DrawBuffers[0]->GetBuffer(), m_DrawBuffers[0]->GetFrameSize() * m_FramesInFlight);
+		m_DrawBufferResources[static_cast<int>(OcclusionCullPhase::LATE)] = graph.ImportBuffer("OcclusionLateDraws", m_DrawBuffers[1]->GetBuffer(), m_DrawBuffers[1]->GetFrameSize() * m_FramesInFlight);
+
+		// The first level reads the depth buffer, which only exists once the new graph is compiled
+		m_DepthPyramidSourceView = VK_NULL_HANDLE;
+
+		VkExtent2D pyramidExtent = { std::max((extent.width + 1) / 2, 1u), std::max((extent.height + 1) / 2, 1u) };
+		if (pyramidExtent.width == m_DepthPyramidExtent.width && pyramidExtent.height == m_DepthPyramidExtent.height)
+			return;
+
+		DestroyDepthPyramid();
+		CreateDepthPyramid(pyramidExtent);
+
+		for (int phase = 0; phase < 2; phase++)
+		{
+			for (uint32_t i = 0; i < m_FramesInFlight; i++)
+			{
+				m_DrawBuffers[phase]->BeginFrame(i);
+
+				VkDescriptorBufferInfo objectBufferInfo = { m_ObjectBuffer, 0, VK_WHOLE_SIZE };
+				VkDescriptorBufferInfo visibilityBufferInfo = { m_VisibilityBuffer, 0, VK_WHOLE_SIZE };
+				VkDescriptorBufferInfo drawBufferInfo = { m_DrawBuffers[phase]->GetBuffer(), m_DrawBuffers[phase]->GetFrameOffset(), m_DrawBuffers[phase]->GetFrameSize() };
+				VkDescriptorBufferInfo statsBufferInfo = { m_StatsBuffer, 0, VK_WHOLE_SIZE };
+				VkDescriptorBufferInfo lodBufferInfo = { m_LodBuffer, 0, VK_WHOLE_SIZE };
+				VkDescriptorBufferInfo bufferInfos[] = { objectBufferInfo, visibilityBufferInfo, drawBufferInfo, statsBufferInfo, lodBufferInfo };
+
+				VkDescriptorImageInfo depthPyramidInfo = {};
+				depthPyramidInfo.sampler = m_DepthSampler;
+				depthPyramidInfo.imageView = m_DepthPyramidView;
+				depthPyramidInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+				// Binding 4 is the pyramid, the levels of detail come after it
+				std::array<VkWriteDescriptorSet, 6> descriptorWrites = {};
+				for (uint32_t binding = 0; binding < descriptorWrites.size(); binding++)
+				{
+					descriptorWrites[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+					descriptorWrites[binding].pNext = nullptr;
+					descriptorWrites[binding].dstSet = m_CullDescriptorSets[phase][i];
+					descriptorWrites[binding].dstBinding = binding;
+					descriptorWrites[binding].descriptorCount = 1;
+					if (binding != 4)
+					{
+						descriptorWrites[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+						descriptorWrites[binding].pBufferInfo = &bufferInfos[binding < 4 ? binding : binding - 1];
+					}
+					else
+					{
+						descriptorWrites[binding].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+						descriptorWrites[binding].pImageInfo = &depthPyramidInfo;
+					}
+				}
+
+				vkUpdateDescriptorSets(*m_Vulkan->GetDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+			}
+		}
+	}
+
+	void OcclusionCulling::AddCullPass(RenderGraph &graph, OcclusionCullPhase phase)
+	{
+		const int phaseIndex = static_cast<int>(phase);
+
+		// The depth pyramid and the stats are synchronized by the resource state tracker, which the graph doesn't know about
+		RenderGraphPass &pass = graph.AddPass(phase == OcclusionCullPhase::EARLY ? "OcclusionCullEarly" : "OcclusionCullLate", RenderGraphPassType::COMPUTE);
+		if (phase == OcclusionCullPhase::EARLY)
+			pass.AddBufferInput(m_VisibilityResource, ResourceAccess::STORAGE_READ);
+		else
+			pass.AddBufferOutput(m_VisibilityResource, ResourceAccess::STORAGE_WRITE);
+		pass.AddBufferOutput(m_DrawBufferResources[phaseIndex], ResourceAccess::STORAGE_WRITE);
+		pass.SetSideEffects();
+		pass.SetExecute([this, phase](const RenderGraphPassContext &context)
+		{
+			RecordCullPass(context.CommandBuffer, phase);
+		});
+	}
+
+	void OcclusionCulling::AddDepthPyramidPass(RenderGraph &graph, RenderGraphResource depth)
+	{
+		RenderGraphPass &pass = graph.AddPass("DepthPyramid", RenderGraphPassType::COMPUTE);
+		pass.AddTextureInput(depth);
+		pass.SetSideEffects(); // Only the late culling pass reads the pyramid
+		pass.SetExecute([this, depth](const RenderGraphPassContext &context)
+		{
+			RecordDepthPyramidPass(context.CommandBuffer, context.Graph->GetImageView(depth));
+		});
+	}
+
+	void OcclusionCulling::BeginFrame(uint32_t frameIndex, const GpuCullView &view)
+	{
+		m_CurrentFrame = frameIndex;
+		m_View = view;
+		for (int phase = 0; phase < 2; phase++)
+		{
+			m_DrawBuffers[phase]->BeginFrame(frameIndex);
+		}
+	}
+
+	bool OcclusionCulling::ReadStats(uint32_t frameIndex, OcclusionCullingStats &outStats)
+	{
+		if (!m_StatsPending[frameIndex])
+			return false;
+
+		m_StatsPending[frameIndex] = false;
+		outStats = m_MappedStats[frameIndex];
+		return true;
+	}
+
+	void OcclusionCulling::CreateDepthPyramid(VkExtent2D extent)
+	{
+		VkDevice device = *m_Vulkan->GetDevice();
+
+		m_DepthPyramidExtent = extent;
+		m_DepthPyramidLevelCount = 1;
+		for (uint32_t width = extent.width, height = extent.height; width > 1 || height > 1; width = (width + 1) / 2, height = (height + 1) / 2)
+		{
+			m_DepthPyramidLevelCount++;
+		}
+
+		m_Vulkan->CreateImage2D(extent.width, extent.height, VK_FORMAT_R32_SFLOAT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_SHARING_MODE_EXCLUSIVE, &m_DepthPyramid, &m_DepthPyramidMemory, m_DepthPyramidLevelCount);
+		m_Vulkan->GetResourceStateTracker()->RegisterImage(m_DepthPyramid, VK_IMAGE_ASPECT_COLOR_BIT, m_DepthPyramidLevelCount);
+
+		m_DepthPyramidView = m_Vulkan->CreateImageView(m_DepthPyramid, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 0, m_DepthPyramidLevelCount);
+		m_DepthPyramidLevelViews.resize(m_DepthPyramidLevelCount);
+		for (uint32_t level = 0; level < m_DepthPyramidLevelCount; level++)
+		{
+			m_DepthPyramidLevelViews[level] = m_Vulkan->CreateImageView(m_DepthPyramid, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, level, 1);
+		}
+
+		std::array<VkDescriptorPoolSize, 2> poolSizes = {};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		poolSizes[0].descriptorCount = m_DepthPyramidLevelCount;
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		poolSizes[1].descriptorCount = m_DepthPyramidLevelCount;
+
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.pNext = nullptr;
+		poolInfo.maxSets = m_DepthPyramidLevelCount;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+
+		VkResult result = vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_DepthPyramidDescriptorPool);
+		ARC_ASSERT(result == VK_SUCCESS, "OcclusionCulling: Failed to create descriptor pool");
+
+		std::vector<VkDescriptorSetLayout> setLayouts(m_DepthPyramidLevelCount, m_DepthPyramidPipeline->GetDescriptorSetLayout(0));
+		VkDescriptorSetAllocateInfo allocateInfo = {};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocateInfo.pNext = nullptr;
+		allocateInfo.descriptorPool = m_DepthPyramidDescriptorPool;
+		allocateInfo.descriptorSetCount = m_DepthPyramidLevelCount;
+		allocateInfo.pSetLayouts = setLayouts.data();
+
+		m_DepthPyramidDescriptorSets.resize(m_DepthPyramidLevelCount);
+		result = vkAllocateDescriptorSets(device, &allocateInfo, m_DepthPyramidDescriptorSets.data());
+		ARC_ASSERT(result == VK_SUCCESS, "OcclusionCulling: Failed to allocate descriptor sets");
+	}
+
+	void OcclusionCulling::DestroyDepthPyramid()
+	{
+		if (m_DepthPyramid == VK_NULL_HANDLE)
+			return;
+
+		VkDevice device = *m_Vulkan->GetDevice();
+		vkDestroyDescriptorPool(device, m_DepthPyramidDescriptorPool, nullptr);
+		m_DepthPyramidDescriptorSets.clear();
+		for (VkImageView levelView : m_DepthPyramidLevelViews)
+		{
+			vkDestroyImageView(device, levelView, nullptr);
+		}
+		m_DepthPyramidLevelViews.clear();
+		vkDestroyImageView(device, m_DepthPyramidView, nullptr);
+
+		m_Vulkan->GetResourceStateTracker()->UnregisterImage(m_DepthPyramid);
+		vkDestroyImage(device, m_DepthPyramid, nullptr);
+		vkFreeMemory(device, m_DepthPyramidMemory, nullptr);
+		m_DepthPyramid = VK_NULL_HANDLE;
+		m_DepthPyramidExtent = { 0, 0 };
+	}
+
+	void OcclusionCulling::UpdateDepthPyramidDescriptorSets(VkImageView depthView)
+	{
+		// Every level reads the one before it, the first one reads the depth buffer
+		for (uint32_t level = 0; level < m_DepthPyramidLevelCount; level++)
+		{
+			VkDescriptorImageInfo sourceInfo = {};
+			sourceInfo.sampler = m_DepthSampler;
+			sourceInfo.imageView = level == 0 ? depthView : m_DepthPyramidLevelViews[level - 1];
+			sourceInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			VkDescriptorImageInfo destinationInfo = {};
+			destinationInfo.sampler = VK_NULL_HANDLE;
+			destinationInfo.imageView = m_DepthPyramidLevelViews[level];
+			destinationInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			std::array<VkWriteDescriptorSet, 2> descriptorWrites = {};
+			descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[0].pNext = nullptr;
+			descriptorWrites[0].dstSet = m_DepthPyramidDescriptorSets[level];
+			descriptorWrites[0].dstBinding = 0;
+			descriptorWrites[0].descriptorCount = 1;
+			descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			descriptorWrites[0].pImageInfo = &sourceInfo;
+
+			descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[1].pNext = nullptr;
+			descriptorWrites[1].dstSet = m_DepthPyramidDescriptorSets[level];
+			descriptorWrites[1].dstBinding = 1;
+			descriptorWrites[1].descriptorCount = 1;
+			descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			descriptorWrites[1].pImageInfo = &destinationInfo;
+
+			vkUpdateDescriptorSets(*m_Vulkan->GetDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+		}
+
+		m_DepthPyramidSourceView = depthView;
+	}
+
+	void OcclusionCulling::RecordCullPass(VkCommandBuffer commandBuffer, OcclusionCullPhase phase)
+	{
+		const int phaseIndex = static_cast<int>(phase);
+		IndirectDrawBuffer *drawBuffer = m_DrawBuffers[phaseIndex];
+		ResourceStateTracker *tracker = m_Vulkan->GetResourceStateTracker();
+
+		// Compaction appends to the draw count, so it starts every frame at zero. The stats are counted from zero by the early phase
+		drawBuffer->ResetDrawCount(commandBuffer);
+		if (phase == OcclusionCullPhase::EARLY)
+		{
+			tracker->TransitionBuffer(m_StatsBuffer, ResourceAccess::TRANSFER_WRITE);
+			tracker->FlushBarriers(commandBuffer);
+			vkCmdFillBuffer(commandBuffer, m_StatsBuffer, 0, VK_WHOLE_SIZE, 0);
+		}
+
+		VkBufferMemoryBarrier countBarrier = {};
+		countBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		countBarrier.pNext = nullptr;
+		countBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		countBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		countBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		countBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		countBarrier.buffer = drawBuffer->GetBuffer();
+		countBarrier.offset = drawBuffer->GetCountOffset();
+		countBarrier.size = sizeof(uint32_t);
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &countBarrier, 0, nullptr);
+
+		// Both phases bind the pyramid, the early one never samples it but the descriptor still has to be in the right layout
+		tracker->TransitionBuffer(m_StatsBuffer, ResourceAccess::STORAGE_WRITE, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		tracker->TransitionImage(m_DepthPyramid, ResourceAccess::SAMPLED, nullptr, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		tracker->FlushBarriers(commandBuffer);
+
+		if (m_ObjectCount > 0)
+		{
+			OcclusionCullConstants constants;
+			constants.ViewProjection = m_View.ViewProjection;
+			constants.LodCamera = glm::vec4(m_View.CameraPosition, m_View.LodErrorScale);
+			constants.ObjectCount = m_ObjectCount;
+			constants.DepthPyramidLevelCount = m_DepthPyramidLevelCount;
+			constants.LodHysteresis = m_View.LodHysteresis;
+
+			m_CullPipelines[phaseIndex]->Bind(commandBuffer);
+			m_CullPipelines[phaseIndex]->BindDescriptorSet(commandBuffer, m_CullDescriptorSets[phaseIndex][m_CurrentFrame]);
+			m_CullPipelines[phaseIndex]->PushConstants(commandBuffer, &constants, sizeof(constants));
+			m_CullPipelines[phaseIndex]->DispatchThreads(commandBuffer, m_ObjectCount);
+		}
+
+		if (phase == OcclusionCullPhase::LATE)
+		{
+			// Both phases have counted, the copy is read on the CPU once the frame's fence has signaled
+			tracker->TransitionBuffer(m_StatsBuffer, ResourceAccess::TRANSFER_READ);
+			tracker->FlushBarriers(commandBuffer);
+
+			VkBufferCopy copyRegion = {};
+			copyRegion.srcOffset = 0;
+			copyRegion.dstOffset = sizeof(OcclusionCullingStats) * m_CurrentFrame;
+			copyRegion.size = sizeof(OcclusionCullingStats);
+			vkCmdCopyBuffer(commandBuffer, m_StatsBuffer, m_StatsReadbackBuffer, 1, &copyRegion);
+
+			VkMemoryBarrier hostBarrier = {};
+			hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			hostBarrier.pNext = nullptr;
+			hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+			m_StatsPending[m_CurrentFrame] = true;
+		}
+	}
+
+	void OcclusionCulling::RecordDepthPyramidPass(VkCommandBuffer commandBuffer, VkImageView depthView)
+	{
+		// Transient textures keep their view until the graph is rebuilt, which happens with the device idle
+		if (depthView != m_DepthPyramidSourceView)
+			UpdateDepthPyramidDescriptorSets(depthView);
+
+		ResourceStateTracker *tracker = m_Vulkan->GetResourceStateTracker();
+		m_DepthPyramidPipeline->Bind(commandBuffer);
+
+		uint32_t width = m_DepthPyramidExtent.width, height = m_DepthPyramidExtent.height;
+		for (uint32_t level = 0; level < m_DepthPyramidLevelCount; level++)
+		{
+			VkImageSubresourceRange levelRange = {};
+			levelRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			levelRange.baseMipLevel = level;
+			levelRange.levelCount = 1;
+			levelRange.baseArrayLayer = 0;
+			levelRange.layerCount = 1;
+			tracker->TransitionImage(m_DepthPyramid, ResourceAccess::STORAGE_WRITE, &levelRange, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+			if (level > 0)
+			{
+				levelRange.baseMipLevel = level - 1;
+				tracker->TransitionImage(m_DepthPyramid, ResourceAccess::SAMPLED, &levelRange, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+			}
+			tracker->FlushBarriers(commandBuffer);
+
+			m_DepthPyramidPipeline->BindDescriptorSet(commandBuffer, m_DepthPyramidDescriptorSets[level]);
+			m_DepthPyramidPipeline->DispatchThreads(commandBuffer, width, height);
+
+			width = (width + 1) / 2;
+			height = (height + 1) / 2;
+		}
+
+		// The late culling pass samples every level
+		tracker->TransitionImage(m_DepthPyramid, ResourceAccess::SAMPLED, nullptr, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		tracker->FlushBarriers(commandBuffer);
+	}
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Graphics/Renderer/GpuCulling.h"
+#include "Graphics/Renderer/RenderGraph.h"
+
+namespace Arcane
+{
+	class VulkanAPI;
+	class ComputeShader;
+	class ComputePipeline;
+	class IndirectDrawBuffer;
+
+	enum class OcclusionCullPhase
+	{
+		EARLY, // Draws what was visible last frame, only frustum tested
+		LATE   // Tests everything against the depth pyramid built from the early draws and draws what became visible
+	};
+
+	// Object counts of a frame, read back from the GPU
+	struct OcclusionCullingStats
+	{
+		uint32_t EarlyDrawCount = 0;
+		uint32_t LateDrawCount = 0;
+		uint32_t FrustumCulledCount = 0;
+		uint32_t OcclusionCulledCount = 0;
+	};
+
+	// Two phase hierarchical Z occlusion culling on the graphics queue. The early phase draws last frame's visible objects, their depth is reduced into a pyramid
+	// of farthest depths and the late phase tests every object's projected bounds against it. Objects that became visible are drawn by a second graphics pass
+	// and the visible set is kept for the next frame, so nothing is culled against a stale depth buffer. Objects are drawn with the level of detail selected for
+	// their distance, which is kept next to their visibility for the next frame's hysteresis. The passes are added to the render graph by the caller in the order
+	// CullPass(EARLY), the early draws, DepthPyramidPass, CullPass(LATE), the late draws
+	class OcclusionCulling
+	{
+	public:
+		OcclusionCulling(const VulkanAPI *const vulkan, uint32_t maxObjectCount, uint32_t framesInFlight);
+		~OcclusionCulling();
+
+		// Waits for the device to be idle before replacing the objects and their levels of detail, every object starts out as not visible and at full detail
+		void SetObjects(const std::vector<GpuCullObject> &objects, const std::vector<GpuMeshLod> &lods);
+
+		// Imports the buffers into a new graph and (re)creates the depth pyramid when the extent changed, has to be called before adding the passes.
+		// The device has to be idle
+		void SetupGraph(RenderGraph &graph, VkExtent2D extent);
+		void AddCullPass(RenderGraph &graph, OcclusionCullPhase phase);
+		void AddDepthPyramidPass(RenderGraph &graph, RenderGraphResource depth);
+
+		// Selects the frame's draw buffer regions and the camera the passes cull against, the frame's fence needs to have signaled
+		void BeginFrame(uint32_t frameIndex, const GpuCullView &view);
+		// Reads the stats of the last frame that used this frame's slot without waiting, false if there is no new result
+		bool ReadStats(uint32_t frameIndex, OcclusionCullingStats &outStats);
+
+		// Getters
+		inline IndirectDrawBuffer* GetDrawBuffer(OcclusionCullPhase phase) const { return m_DrawBuffers[static_cast<int>(phase)]; }
+		inline RenderGraphResource GetDrawBufferResource(OcclusionCullPhase phase) const { return m_DrawBufferResources[static_cast<int>(phase)]; }
+		inline uint32_t GetObjectCount() const { return m_ObjectCount; }
+		inline uint32_t GetDepthPyramidLevelCount() const { return m_DepthPyramidLevelCount; }
+		inline VkImage GetDepthPyramid() const { return m_DepthPyramid; }
+		inline VkImageView GetDepthPyramidView() const { return m_DepthPyramidView; }
+		inline VkSampler GetDepthSampler() const { return m_DepthSampler; }
+	private:
+		void CreateDepthPyramid(VkExtent2D extent);
+		void DestroyDepthPyramid();
+		void UpdateDepthPyramidDescriptorSets(VkImageView depthView);
+		void RecordCullPass(VkCommandBuffer commandBuffer, OcclusionCullPhase phase);
+		void RecordDepthPyramidPass(VkCommandBuffer commandBuffer, VkImageView depthView);
+	private:
+		const VulkanAPI *const m_Vulkan;
+		const uint32_t m_MaxObjectCount;
+		const uint32_t m_FramesInFlight;
+		uint32_t m_ObjectCount;
+		uint32_t m_CurrentFrame;
+		GpuCullView m_View;
+
+		ComputeShader *m_CullShaders[2]; // Indexed by phase
+		ComputePipeline *m_CullPipelines[2];
+		ComputeShader *m_DepthPyramidShader;
+		ComputePipeline *m_DepthPyramidPipeline;
+
+		VkBuffer m_ObjectBuffer;
+		VkDeviceMemory m_ObjectBufferMemory;
+		VkBuffer m_LodBuffer;
+		VkDeviceMemory m_LodBufferMemory;
+		VkBuffer m_VisibilityBuffer; // Kept across frames, the late phase of a frame decides what the early phase of the next one draws and at which level
+		VkDeviceMemory m_VisibilityBufferMemory;
+		IndirectDrawBuffer *m_DrawBuffers[2];
+		VkBuffer m_StatsBuffer; // Counted by both phases, then copied into the frame's slot of the readback buffer
+		VkDeviceMemory m_StatsBufferMemory;
+		VkBuffer m_StatsReadbackBuffer;
+		VkDeviceMemory m_StatsReadbackBufferMemory;
+		OcclusionCullingStats *m_MappedStats;
+		std::vector<bool> m_StatsPending;
+
+		RenderGraphResource m_VisibilityResource;
+		RenderGraphResource m_DrawBufferResources[2];
+
+		// Farthest depth pyramid, the first level is half the resolution of the depth buffer and every level is half of the previous one rounded up
+		VkExtent2D m_DepthPyramidExtent;
+		uint32_t m_DepthPyramidLevelCount;
+		VkImage m_DepthPyramid;
+		VkDeviceMemory m_DepthPyramidMemory;
+		VkImageView m_DepthPyramidView;
+		std::vector<VkImageView> m_DepthPyramidLevelViews;
+		VkSampler m_DepthSampler;
+		VkImageView m_DepthPyramidSourceView; // Depth buffer view the first level's descriptor set was written with
+
+		VkDescriptorPool m_CullDescriptorPool;
+		std::vector<VkDescriptorSet> m_CullDescriptorSets[2]; // One per frame in flight and phase, each points at its frame's region of the phase's draw buffer
+		VkDescriptorPool m_DepthPyramidDescriptorPool; // Recreated with the depth pyramid
+		std::vector<VkDescriptorSet> m_DepthPyramidDescriptorSets; // One per level
+
+		static const uint32_t MAX_LOD_COUNT = 4096; // Levels of detail of all the meshes the objects use together
+	};
+}
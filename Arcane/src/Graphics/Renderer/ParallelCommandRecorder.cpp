@@ -0,0 +1,209 @@
+#include "arcpch.h"
+#include "ParallelCommandRecorder.h"
+
+#include "Core/JobSystem.h"
+#include "Core/Profiler.h"
+#include "Graphics/Buffer/VertexBuffer.h"
+#include "Graphics/Buffer/IndexBuffer.h"
+#include "Graphics/Buffer/IndirectDrawBuffer.h"
+#include "Graphics/Buffer/InstanceBuffer.h"
+#include "Graphics/Buffer/GeometryPool.h"
+#include "Graphics/VertexLayouts.h"
+#include "Graphics/Renderer/CommandBufferState.h"
+#include "Graphics/Renderer/VulkanAPI.h"
+
+namespace Arcane
+{
+	ParallelCommandRecorder::ParallelCommandRecorder(const VulkanAPI *const vulkan, PipelineCache *pipelineCache, uint32_t framesInFlight)
+		: m_Vulkan(vulkan), m_PipelineCache(pipelineCache), m_CurrentFrame(0)
+	{
+		VkCommandPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.pNext = nullptr;
+		poolInfo.queueFamilyIndex = m_Vulkan->GetDeviceQueueIndices().graphicsQueue.value();
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		m_Contexts.resize(framesInFlight);
+		for (std::vector<CommandRecordContext> &frameContexts : m_Contexts)
+		{
+			frameContexts.resize(JobSystem::GetThreadCount());
+			for (CommandRecordContext &context : frameContexts)
+			{
+				VkResult result = vkCreateCommandPool(*m_Vulkan->GetDevice(), &poolInfo, nullptr, &context.Pool);
+				ARC_ASSERT(result == VK_SUCCESS, "Vulkan: Failed to create command recording pool");
+			}
+		}
+	}
+
+	ParallelCommandRecorder::~ParallelCommandRecorder()
+	{
+		for (std::vector<CommandRecordContext> &frameContexts : m_Contexts)
+		{
+			for (CommandRecordContext &context : frameContexts)
+			{
+				vkDestroyCommandPool(*m_Vulkan->GetDevice(), context.Pool, nullptr); // Frees its command buffers too
+			}
+		}
+	}
+
+	void ParallelCommandRecorder::BeginFrame(uint32_t frameIndex)
+	{
+		m_CurrentFrame = frameIndex;
+		for (CommandRecordContext &context : m_Contexts[m_CurrentFrame])
+		{
+			vkResetCommandPool(*m_Vulkan->GetDevice(), context.Pool, 0);
+			context.UsedCommandBufferCount = 0;
+		}
+	}
+
+	void ParallelCommandRecorder::Record(VkCommandBuffer primaryCommandBuffer, const VkCommandBufferInheritanceInfo &inheritanceInfo, const VkViewport &viewport, const VkRect2D &scissor,
+		const std::vector<DrawCommand> &draws, uint32_t threadCount)
+	{
+		if (draws.empty())
+			return;
+
+		size_t chunkCount = std::min<size_t>(std::clamp(threadCount, 1u, JobSystem::GetThreadCount()), (draws.size() + MIN_DRAWS_PER_CHUNK - 1) / MIN_DRAWS_PER_CHUNK);
+		size_t drawsPerChunk = (draws.size() + chunkCount - 1) / chunkCount;
+
+		// A command buffer is taken from the pool of whichever thread ends up running the chunk, so no two threads ever touch the same pool.
+		// The secondaries are executed in chunk order no matter which thread recorded them
+		std::vector<VkCommandBuffer> secondaryCommandBuffers(chunkCount);
+		JobSystem::ParallelFor(static_cast<uint32_t>(chunkCount), 1, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; i++)
+			{
+				size_t first = i * drawsPerChunk;
+				size_t count = std::min(drawsPerChunk, draws.size() - first);
+
+				secondaryCommandBuffers[i] = AcquireCommandBuffer(m_Contexts[m_CurrentFrame][JobSystem::GetThreadIndex()]);
+				RecordChunk(secondaryCommandBuffers[i], inheritanceInfo, viewport, scissor, &draws[first], count);
+			}
+		});
+
+		vkCmdExecuteCommands(primaryCommandBuffer, static_cast<uint32_t>(secondaryCommandBuffers.size()), secondaryCommandBuffers.data());
+
+		FrameStats &stats = Profiler::GetInstance().GetCurrentFrameStats();
+		stats.DrawCount += static_cast<uint32_t>(draws.size());
+		for (const DrawCommand &draw : draws)
+		{
+			if (draw.IndirectArguments)
+				stats.IndirectDrawCount += draw.IndirectDrawCount;
+		}
+	}
+
+	VkCommandBuffer ParallelCommandRecorder::AcquireCommandBuffer(CommandRecordContext &context)
+	{
+		// Command buffers are kept allocated between frames, resetting the pool puts them back in the initial state
+		if (context.UsedCommandBufferCount == context.CommandBuffers.size())
+		{
+			VkCommandBufferAllocateInfo allocateInfo = {};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocateInfo.pNext = nullptr;
+			allocateInfo.commandPool = context.Pool;
+			allocateInfo.commandBufferCount = 1;
+			allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+
+			VkCommandBuffer commandBuffer;
+			VkResult result = vkAllocateCommandBuffers(*m_Vulkan->GetDevice(), &allocateInfo, &commandBuffer);
+			ARC_ASSERT(result == VK_SUCCESS, "Vulkan: Failed to allocate secondary command buffer");
+			context.CommandBuffers.push_back(commandBuffer);
+		}
+
+		return context.CommandBuffers[context.UsedCommandBufferCount++];
+	}
+
+	void ParallelCommandRecorder::RecordChunk(VkCommandBuffer commandBuffer, const VkCommandBufferInheritanceInfo &inheritanceInfo, const VkViewport &viewport, const VkRect2D &scissor,
+		const DrawCommand *draws, size_t drawCount)
+	{
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.pNext = nullptr;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT; // Entirely inside the render pass of the primary
+		beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+		VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		ARC_ASSERT(result == VK_SUCCESS, "Vulkan: Failed to begin secondary command buffer recording");
+
+		// Dynamic state is not inherited from the primary, every secondary command buffer starts out with nothing set
+		CommandBufferState state(m_PipelineCache, &m_Vulkan->GetExtensionFunctions());
+		state.Begin(commandBuffer);
+		state.SetViewport(viewport);
+		state.SetScissor(scissor);
+
+		VertexBuffer *boundVertexBuffer = nullptr;
+		IndexBuffer *boundIndexBuffer = nullptr;
+		const GeometryPool *boundGeometryPool = nullptr;
+		const InstanceBuffer *boundInstanceBuffer = nullptr;
+		uint32_t boundInstanceOffset = 0;
+		VkDescriptorSet boundDescriptorSet = VK_NULL_HANDLE;
+		for (size_t i = 0; i < drawCount; i++)
+		{
+			const DrawCommand &draw = draws[i];
+			state.SetPipeline(*draw.Pipeline);
+
+			if (draw.Geometry)
+			{
+				ARC_ASSERT(draw.Pipeline->VertexInput == draw.Geometry->GetVertexLayout() && VertexLayouts::CanRead(draw.Pipeline->Streams, draw.Geometry->GetVertexStreams()),
+					"Vulkan: The pipeline reads a different vertex layout than the geometry pool holds");
+				if (draw.Geometry != boundGeometryPool)
+				{
+					draw.Geometry->Bind(commandBuffer);
+					boundGeometryPool = draw.Geometry;
+					boundVertexBuffer = nullptr;
+					boundIndexBuffer = nullptr;
+				}
+			}
+			else
+			{
+				if (draw.Vertices != boundVertexBuffer)
+				{
+					draw.Vertices->Bind(commandBuffer);
+					boundVertexBuffer = draw.Vertices;
+					boundGeometryPool = nullptr;
+				}
+				if (draw.Indices && draw.Indices != boundIndexBuffer)
+				{
+					draw.Indices->Bind(commandBuffer);
+					boundIndexBuffer = draw.Indices;
+					boundGeometryPool = nullptr;
+				}
+			}
+			if (draw.Instances)
+			{
+				uint32_t instanceOffset = draw.IndirectArguments ? draw.FirstInstance : 0;
+				if (draw.Instances != boundInstanceBuffer || instanceOffset != boundInstanceOffset)
+				{
+					draw.Instances->Bind(commandBuffer, instanceOffset);
+					boundInstanceBuffer = draw.Instances;
+					boundInstanceOffset = instanceOffset;
+				}
+			}
+			if (draw.DescriptorSet != boundDescriptorSet)
+			{
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, draw.Pipeline->Layout, 0, 1, &draw.DescriptorSet, 0, nullptr);
+				boundDescriptorSet = draw.DescriptorSet;
+			}
+
+			if (draw.IndirectArguments)
+			{
+				ARC_ASSERT(draw.Indices || draw.Geometry, "Vulkan: Indirect draws need an index buffer");
+				draw.IndirectArguments->Draw(commandBuffer, draw.FirstIndirectDraw, draw.IndirectDrawCount);
+			}
+			else if (draw.Geometry)
+			{
+				vkCmdDrawIndexed(commandBuffer, draw.IndexCount, draw.InstanceCount, draw.FirstIndex, draw.VertexOffset, draw.FirstInstance);
+			}
+			else if (draw.Indices)
+			{
+				vkCmdDrawIndexed(commandBuffer, draw.Indices->GetCount(), draw.InstanceCount, 0, 0, draw.FirstInstance);
+			}
+			else
+			{
+				vkCmdDraw(commandBuffer, draw.Vertices->GetCount(), draw.InstanceCount, 0, draw.FirstInstance);
+			}
+		}
+
+		result = vkEndCommandBuffer(commandBuffer);
+		ARC_ASSERT(result == VK_SUCCESS, "Vulkan: Error occurred during secondary command buffer recording");
+	}
+}
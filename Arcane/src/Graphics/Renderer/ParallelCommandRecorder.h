@@ -0,0 +1,77 @@
+#pragma once
+
+namespace Arcane
+{
+	class VulkanAPI;
+	class PipelineCache;
+	class VertexBuffer;
+	class IndexBuffer;
+	class IndirectDrawBuffer;
+	class InstanceBuffer;
+	class GeometryPool;
+	struct PipelineDescription;
+
+	struct DrawCommand
+	{
+		const PipelineDescription *Pipeline = nullptr;
+		VertexBuffer *Vertices = nullptr;
+		IndexBuffer *Indices = nullptr; // Optional, draws non-indexed without it
+		VkDescriptorSet DescriptorSet = VK_NULL_HANDLE;
+		uint32_t InstanceCount = 1;
+
+		// Draws a mesh range out of the shared geometry pool instead of Vertices and Indices, every draw from the same pool shares one buffer bind
+		const GeometryPool *Geometry = nullptr;
+		uint32_t FirstIndex = 0;
+		uint32_t IndexCount = 0;
+		int32_t VertexOffset = 0;
+		const glm::mat4 *DequantizeTransform = nullptr; // Of quantized meshes, the render queue puts it before the transform of every instance it is submitted with
+
+		// Optional per instance data for vertex binding 1, direct draws read InstanceCount instances from FirstInstance on. Indirect commands start at instance 0,
+		// so the buffer is bound at FirstInstance for them instead
+		const InstanceBuffer *Instances = nullptr;
+		uint32_t FirstInstance = 0;
+
+		// Submits a whole bucket of draws sharing the pipeline, buffers and descriptor set with one indirect call instead of drawing the index buffer directly.
+		// The commands index into the bound buffers with their own firstIndex and vertexOffset (firstInstance has to be 0 unless drawIndirectFirstInstance is supported)
+		const IndirectDrawBuffer *IndirectArguments = nullptr;
+		uint32_t FirstIndirectDraw = 0;
+		uint32_t IndirectDrawCount = 0; // Upper bound when the GPU writes the draw count
+	};
+
+	// Command pool owned by a single recording thread for a single frame in flight, along with the secondary command buffers allocated from it
+	struct CommandRecordContext
+	{
+		VkCommandPool Pool = VK_NULL_HANDLE;
+		std::vector<VkCommandBuffer> CommandBuffers;
+		uint32_t UsedCommandBufferCount = 0;
+	};
+
+	// Splits a draw list into chunks that are recorded as jobs into secondary command buffers, which are then executed by the primary.
+	// Every job system thread has its own transient command pool per frame in flight so recording never needs a lock
+	class ParallelCommandRecorder
+	{
+	public:
+		ParallelCommandRecorder(const VulkanAPI *const vulkan, PipelineCache *pipelineCache, uint32_t framesInFlight);
+		~ParallelCommandRecorder();
+
+		// Resets every pool of the frame, the frame's fence needs to have signaled
+		void BeginFrame(uint32_t frameIndex);
+
+		// The primary command buffer needs to be inside a render pass begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS that matches the inheritance info
+		void Record(VkCommandBuffer primaryCommandBuffer, const VkCommandBufferInheritanceInfo &inheritanceInfo, const VkViewport &viewport, const VkRect2D &scissor,
+			const std::vector<DrawCommand> &draws, uint32_t threadCount);
+	private:
+		VkCommandBuffer AcquireCommandBuffer(CommandRecordContext &context);
+		void RecordChunk(VkCommandBuffer commandBuffer, const VkCommandBufferInheritanceInfo &inheritanceInfo, const VkViewport &viewport, const VkRect2D &scissor,
+			const DrawCommand *draws, size_t drawCount);
+	private:
+		const VulkanAPI *const m_Vulkan;
+		PipelineCache *m_PipelineCache;
+
+		uint32_t m_CurrentFrame;
+		std::vector<std::vector<CommandRecordContext>> m_Contexts; // [frame in flight][job system thread index]
+
+		// Splitting only pays off when every job gets enough draws to cover the cost of scheduling it
+		static const size_t MIN_DRAWS_PER_CHUNK = 64;
+	};
+}
@@ -0,0 +1,245 @@
+#include "arcpch.h"
+#include "PipelineCache.h"
+
+#include "Core/HashUtils.h"
+#include "Graphics/Shader.h"
+#include "Graphics/VertexLayouts.h"
+#include "Graphics/Renderer/VulkanAPI.h"
+#include "Graphics/Renderer/VulkanExtensions.h"
+
+namespace Arcane
+{
+	// With extended dynamic state the topology can only change within the same class (point, line, triangle, patch), so the class stays part of the pipeline key
+	static uint32_t GetTopologyClass(VkPrimitiveTopology topology)
+	{
+		switch (topology)
+		{
+		case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+			return 0;
+		case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+			return 1;
+		case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+			return 3;
+		default:
+			return 2;
+		}
+	}
+
+	PipelineCache::PipelineCache(const VulkanAPI *const vulkan, bool dynamicRenderState) : m_Vulkan(vulkan), m_DynamicRenderState(dynamicRenderState), m_VulkanPipelineCache(VK_NULL_HANDLE)
+	{
+		VkPipelineCacheCreateInfo createInfo = {};
+		createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		createInfo.pNext = nullptr;
+		createInfo.initialDataSize = 0;
+		createInfo.pInitialData = nullptr;
+
+		VkResult result = vkCreatePipelineCache(*m_Vulkan->GetDevice(), &createInfo, nullptr, &m_VulkanPipelineCache);
+		ARC_ASSERT(result == VK_SUCCESS, "Vulkan: Failed to create pipeline cache");
+	}
+
+	PipelineCache::~PipelineCache()
+	{
+		Clear();
+		vkDestroyPipelineCache(*m_Vulkan->GetDevice(), m_VulkanPipelineCache, nullptr);
+	}
+
+	VkPipeline PipelineCache::GetPipeline(const PipelineDescription &description)
+	{
+		uint64_t key = ComputeKey(description);
+		{
+			std::shared_lock<std::shared_mutex> lock(m_PipelinesMutex);
+			auto iter = m_Pipelines.find(key);
+			if (iter != m_Pipelines.end())
+			{
+				return iter->second;
+			}
+		}
+
+		// Another thread could have created the pipeline between releasing the shared lock and taking the exclusive one
+		std::unique_lock<std::shared_mutex> lock(m_PipelinesMutex);
+		auto iter = m_Pipelines.find(key);
+		if (iter != m_Pipelines.end())
+		{
+			return iter->second;
+		}
+
+		VkPipeline pipeline = CreatePipeline(description);
+		m_Pipelines.insert(std::pair<uint64_t, VkPipeline>(key, pipeline));
+		ARC_LOG_INFO("Vulkan: Created graphics pipeline {0} ({1} cached)", key, m_Pipelines.size());
+
+		return pipeline;
+	}
+
+	uint64_t PipelineCache::ComputeKey(const PipelineDescription &description) const
+	{
+		uint64_t key = description.PipelineShader->GetPermutationKey();
+		HashUtils::Combine(key, reinterpret_cast<uint64_t>(description.Layout));
+		HashUtils::Combine(key, reinterpret_cast<uint64_t>(description.RenderPass));
+		HashUtils::Combine(key, description.Subpass);
+		HashUtils::Combine(key, description.ColourAttachmentCount);
+		HashUtils::Combine(key, static_cast<uint64_t>(description.VertexInput));
+		HashUtils::Combine(key, static_cast<uint64_t>(description.Streams));
+
+		const RenderState &state = description.State;
+		if (m_DynamicRenderState)
+		{
+			HashUtils::Combine(key, GetTopologyClass(state.Topology));
+		}
+		else
+		{
+			HashUtils::Combine(key, state.Topology);
+			HashUtils::Combine(key, state.CullMode);
+			HashUtils::Combine(key, state.FrontFace);
+			HashUtils::Combine(key, state.DepthTestEnable);
+			HashUtils::Combine(key, state.DepthWriteEnable);
+			HashUtils::Combine(key, state.DepthCompareOp);
+		}
+
+		return key;
+	}
+
+	void PipelineCache::Clear()
+	{
+		std::unique_lock<std::shared_mutex> lock(m_PipelinesMutex);
+		for (auto &pipeline : m_Pipelines)
+		{
+			vkDestroyPipeline(*m_Vulkan->GetDevice(), pipeline.second, nullptr);
+		}
+		m_Pipelines.clear();
+	}
+
+	VkPipeline PipelineCache::CreatePipeline(const PipelineDescription &description) const
+	{
+		const Shader *shader = description.PipelineShader;
+		const RenderState &state = description.State;
+
+		std::vector<VkVertexInputBindingDescription> bindingDescriptions = VertexLayouts::GetBindingDescriptions(description.VertexInput, description.Streams);
+		bindingDescriptions.push_back(InstanceData::GetBindingDescription());
+		auto attributeDescription = VertexLayouts::GetAttributeDescription(description.VertexInput, description.Streams);
+		auto instanceAttributeDescription = InstanceData::GetAttributeDescription();
+		attributeDescription.insert(attributeDescription.end(), instanceAttributeDescription.begin(), instanceAttributeDescription.end());
+		bool vertexLayoutValid = shader->GetReflection().ValidateVertexInput(attributeDescription);
+		ARC_ASSERT(vertexLayoutValid, "Vulkan: Vertex layout does not match the vertex shader inputs");
+
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+		vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
+		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescription.size());
+		vertexInputInfo.pVertexAttributeDescriptions = attributeDescription.data();
+
+		VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo = {};
+		inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		inputAssemblyInfo.topology = state.Topology;
+		inputAssemblyInfo.primitiveRestartEnable = VK_FALSE;
+
+		// Viewport and scissor are dynamic so only their count is given here, they are set when recording the command buffer
+		VkPipelineViewportStateCreateInfo viewportCreateInfo = {};
+		viewportCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		viewportCreateInfo.viewportCount = 1;
+		viewportCreateInfo.pViewports = nullptr;
+		viewportCreateInfo.scissorCount = 1;
+		viewportCreateInfo.pScissors = nullptr;
+
+		VkPipelineRasterizationStateCreateInfo rasterizationCreateInfo = {};
+		rasterizationCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		rasterizationCreateInfo.depthClampEnable = VK_FALSE; // TODO: Might be useful for shadowmaps?
+		rasterizationCreateInfo.rasterizerDiscardEnable = VK_FALSE;
+		rasterizationCreateInfo.polygonMode = VK_POLYGON_MODE_FILL; // TODO: This is where we can do wireframe
+		rasterizationCreateInfo.lineWidth = 1.0f;
+		rasterizationCreateInfo.cullMode = state.CullMode;
+		rasterizationCreateInfo.frontFace = state.FrontFace;
+		rasterizationCreateInfo.depthBiasEnable = VK_FALSE;
+		rasterizationCreateInfo.depthBiasConstantFactor = 0.0f;
+		rasterizationCreateInfo.depthBiasClamp = 0.0f;
+		rasterizationCreateInfo.depthBiasSlopeFactor = 0.0f;
+
+		VkPipelineMultisampleStateCreateInfo multisampleCreateInfo = {}; // Enabling MSAA requires enabling a GPU feature
+		multisampleCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		multisampleCreateInfo.sampleShadingEnable = VK_FALSE;
+		multisampleCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+		multisampleCreateInfo.minSampleShading = 1.0f;
+		multisampleCreateInfo.pSampleMask = nullptr;
+		multisampleCreateInfo.alphaToCoverageEnable = VK_FALSE;
+		multisampleCreateInfo.alphaToOneEnable = VK_FALSE;
+
+		VkPipelineDepthStencilStateCreateInfo depthStencilCreateInfo = {};
+		depthStencilCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		depthStencilCreateInfo.pNext = nullptr;
+		depthStencilCreateInfo.depthTestEnable = state.DepthTestEnable ? VK_TRUE : VK_FALSE;
+		depthStencilCreateInfo.depthWriteEnable = state.DepthWriteEnable ? VK_TRUE : VK_FALSE;
+		depthStencilCreateInfo.depthCompareOp = state.DepthCompareOp;
+		depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;
+		depthStencilCreateInfo.minDepthBounds = 0.0f;
+		depthStencilCreateInfo.maxDepthBounds = 1.0f;
+		depthStencilCreateInfo.stencilTestEnable = VK_FALSE;
+
+		VkPipelineColorBlendAttachmentState colourBlendState = {};
+		colourBlendState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		colourBlendState.blendEnable = VK_FALSE;
+		colourBlendState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		colourBlendState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		colourBlendState.colorBlendOp = VK_BLEND_OP_ADD;
+		colourBlendState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		colourBlendState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		colourBlendState.alphaBlendOp = VK_BLEND_OP_ADD;
+		std::vector<VkPipelineColorBlendAttachmentState> colourBlendStates(description.ColourAttachmentCount, colourBlendState); // Every attachment blends the same way
+
+		VkPipelineColorBlendStateCreateInfo colorBlendCreateInfo = {};
+		colorBlendCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		colorBlendCreateInfo.logicOpEnable = VK_FALSE;
+		colorBlendCreateInfo.logicOp = VK_LOGIC_OP_COPY;
+		colorBlendCreateInfo.attachmentCount = static_cast<uint32_t>(colourBlendStates.size());
+		colorBlendCreateInfo.pAttachments = colourBlendStates.data();
+		colorBlendCreateInfo.blendConstants[0] = 0.0f;
+		colorBlendCreateInfo.blendConstants[1] = 0.0f;
+		colorBlendCreateInfo.blendConstants[2] = 0.0f;
+		colorBlendCreateInfo.blendConstants[3] = 0.0f;
+
+		// The values baked in above for the dynamic states are ignored, but they still need to be valid
+		std::vector<VkDynamicState> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+		if (m_DynamicRenderState)
+		{
+			dynamicStates.push_back(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT);
+			dynamicStates.push_back(VK_DYNAMIC_STATE_CULL_MODE_EXT);
+			dynamicStates.push_back(VK_DYNAMIC_STATE_FRONT_FACE_EXT);
+			dynamicStates.push_back(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT);
+			dynamicStates.push_back(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT);
+			dynamicStates.push_back(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT);
+		}
+
+		VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = {};
+		dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		dynamicStateCreateInfo.pNext = nullptr;
+		dynamicStateCreateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+		dynamicStateCreateInfo.pDynamicStates = dynamicStates.data();
+
+		VkGraphicsPipelineCreateInfo pipelineCreateInfo = {};
+		pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineCreateInfo.pNext = nullptr;
+		pipelineCreateInfo.stageCount = static_cast<uint32_t>(shader->GetShaderStages().size());
+		pipelineCreateInfo.pStages = shader->GetShaderStages().data();
+		pipelineCreateInfo.pVertexInputState = &vertexInputInfo;
+		pipelineCreateInfo.pInputAssemblyState = &inputAssemblyInfo;
+		pipelineCreateInfo.pViewportState = &viewportCreateInfo;
+		pipelineCreateInfo.pRasterizationState = &rasterizationCreateInfo;
+		pipelineCreateInfo.pMultisampleState = &multisampleCreateInfo;
+		pipelineCreateInfo.pDepthStencilState = &depthStencilCreateInfo;
+		pipelineCreateInfo.pColorBlendState = &colorBlendCreateInfo;
+		pipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
+		pipelineCreateInfo.layout = description.Layout;
+		pipelineCreateInfo.renderPass = description.RenderPass;
+		pipelineCreateInfo.subpass = description.Subpass; // index of the subpass
+		pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE; // Used to create a pipeline from an existing pipeline
+		pipelineCreateInfo.basePipelineIndex = -1; // Used to create a pipeline from an existing pipeline
+
+		VkPipeline pipeline;
+		VkResult result = vkCreateGraphicsPipelines(*m_Vulkan->GetDevice(), m_VulkanPipelineCache, 1, &pipelineCreateInfo, nullptr, &pipeline);
+		ARC_ASSERT(result == VK_SUCCESS, "Failed to create Vulkan Graphics Pipeline");
+
+		return pipeline;
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <shared_mutex>
+
+#include "Graphics/Vertex.h"
+
+namespace Arcane
+{
+	class VulkanAPI;
+	class Shader;
+
+	// Fixed function state that is set per draw when VK_EXT_extended_dynamic_state is supported, otherwise each combination is baked into its own pipeline
+	struct RenderState
+	{
+		VkPrimitiveTopology Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		VkCullModeFlags CullMode = VK_CULL_MODE_BACK_BIT;
+		VkFrontFace FrontFace = VK_FRONT_FACE_CLOCKWISE;
+		bool DepthTestEnable = true;
+		bool DepthWriteEnable = true;
+		VkCompareOp DepthCompareOp = VK_COMPARE_OP_LESS;
+	};
+
+	struct PipelineDescription
+	{
+		const Shader *PipelineShader = nullptr;
+		VkPipelineLayout Layout = VK_NULL_HANDLE;
+		VkRenderPass RenderPass = VK_NULL_HANDLE;
+		uint32_t Subpass = 0;
+		uint32_t ColourAttachmentCount = 1; // Of the subpass, 0 for depth-only passes
+		VertexLayout VertexInput = VertexLayout::STANDARD; // Binding 0 (and 2 for split streams), binding 1 is always InstanceData
+		VertexStreams Streams = VertexStreams::INTERLEAVED;
+		RenderState State;
+	};
+
+	// Creates graphics pipelines on first use and keeps them around. Viewport and scissor are always dynamic so pipelines don't depend on the swapchain size,
+	// and with extended dynamic state the RenderState is left out of the key so all of its combinations share one pipeline
+	class PipelineCache
+	{
+	public:
+		PipelineCache(const VulkanAPI *const vulkan, bool dynamicRenderState);
+		~PipelineCache();
+
+		// Safe to call from multiple recording threads at once
+		VkPipeline GetPipeline(const PipelineDescription &description);
+		uint64_t ComputeKey(const PipelineDescription &description) const;
+
+		// Destroys every pipeline, needs to be called when a render pass they were created with is destroyed
+		void Clear();
+
+		inline bool UsesDynamicRenderState() const { return m_DynamicRenderState; }
+		inline VkPipelineCache GetVulkanPipelineCache() const { return m_VulkanPipelineCache; } // Shared with pipelines that are not created through this cache
+		inline size_t GetPipelineCount() { std::shared_lock<std::shared_mutex> lock(m_PipelinesMutex); return m_Pipelines.size(); }
+	private:
+		VkPipeline CreatePipeline(const PipelineDescription &description) const;
+	private:
+		const VulkanAPI *const m_Vulkan;
+		const bool m_DynamicRenderState;
+
+		VkPipelineCache m_VulkanPipelineCache; // Lets the driver reuse compiled state between similar pipelines
+		std::unordered_map<uint64_t, VkPipeline> m_Pipelines;
+		std::shared_mutex m_PipelinesMutex; // Lookups share the lock, only creating a pipeline takes it exclusively
+	};
+}
@@ -0,0 +1,741 @@
+#include "arcpch.h"
+#include "RenderGraph.h"
+
+#include "Graphics/Renderer/VulkanAPI.h"
+
+namespace Arcane
+{
+	static VkPipelineStageFlags GetShaderStages(RenderGraphPassType passType)
+	{
+		return passType == RenderGraphPassType::COMPUTE ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : (VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	}
+
+	static VkImageUsageFlags GetImageUsage(ResourceAccess access)
+	{
+		switch (access)
+		{
+		case ResourceAccess::COLOUR_ATTACHMENT: return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		case ResourceAccess::DEPTH_ATTACHMENT:
+		case ResourceAccess::DEPTH_READ_ONLY: return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		case ResourceAccess::SAMPLED: return VK_IMAGE_USAGE_SAMPLED_BIT;
+		case ResourceAccess::STORAGE_READ:
+		case ResourceAccess::STORAGE_WRITE: return VK_IMAGE_USAGE_STORAGE_BIT;
+		case ResourceAccess::TRANSFER_READ: return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		case ResourceAccess::TRANSFER_WRITE: return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		default: return 0;
+		}
+	}
+
+	static VkImageAspectFlags GetImageAspect(VkFormat format)
+	{
+		switch (format)
+		{
+		case VK_FORMAT_D16_UNORM:
+		case VK_FORMAT_X8_D24_UNORM_PACK32:
+		case VK_FORMAT_D32_SFLOAT:
+			return VK_IMAGE_ASPECT_DEPTH_BIT;
+		case VK_FORMAT_D16_UNORM_S8_UINT:
+		case VK_FORMAT_D24_UNORM_S8_UINT:
+		case VK_FORMAT_D32_SFLOAT_S8_UINT:
+			return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+		default:
+			return VK_IMAGE_ASPECT_COLOR_BIT;
+		}
+	}
+
+	RenderGraphPass::RenderGraphPass(const std::string &name, RenderGraphPassType type, uint32_t index)
+		: m_Name(name), m_Type(type), m_Index(index), m_DepthClearValue()
+	{
+
+	}
+
+	void RenderGraphPass::AddColourOutput(RenderGraphResource texture, const VkClearColorValue *clearValue)
+	{
+		ARC_ASSERT(m_Type == RenderGraphPassType::GRAPHICS, "RenderGraph: Only graphics passes can have attachments ({0})", m_Name);
+
+		VkClearValue value = {};
+		if (clearValue)
+			value.color = *clearValue;
+
+		m_ColourOutputs.push_back(texture);
+		m_ColourClearValues.push_back(value);
+		m_ColourCleared.push_back(clearValue != nullptr);
+		AddUse(texture, ResourceAccess::COLOUR_ATTACHMENT, clearValue != nullptr);
+	}
+
+	void RenderGraphPass::SetDepthOutput(RenderGraphResource texture, const VkClearDepthStencilValue *clearValue)
+	{
+		ARC_ASSERT(m_Type == RenderGraphPassType::GRAPHICS, "RenderGraph: Only graphics passes can have attachments ({0})", m_Name);
+		ARC_ASSERT(!m_DepthAttachment.IsValid(), "RenderGraph: Pass {0} already has a depth attachment", m_Name);
+
+		m_DepthAttachment = texture;
+		m_DepthCleared = clearValue != nullptr;
+		if (clearValue)
+			m_DepthClearValue.depthStencil = *clearValue;
+		AddUse(texture, ResourceAccess::DEPTH_ATTACHMENT, m_DepthCleared);
+	}
+
+	void RenderGraphPass::SetDepthInput(RenderGraphResource texture)
+	{
+		ARC_ASSERT(m_Type == RenderGraphPassType::GRAPHICS, "RenderGraph: Only graphics passes can have attachments ({0})", m_Name);
+		ARC_ASSERT(!m_DepthAttachment.IsValid(), "RenderGraph: Pass {0} already has a depth attachment", m_Name);
+
+		m_DepthAttachment = texture;
+		m_DepthReadOnly = true;
+		AddUse(texture, ResourceAccess::DEPTH_READ_ONLY);
+	}
+
+	void RenderGraphPass::AddTextureInput(RenderGraphResource texture)
+	{
+		AddUse(texture, ResourceAccess::SAMPLED);
+	}
+
+	void RenderGraphPass::AddStorageTexture(RenderGraphResource texture, bool write)
+	{
+		AddUse(texture, write ? ResourceAccess::STORAGE_WRITE : ResourceAccess::STORAGE_READ);
+	}
+
+	void RenderGraphPass::AddBufferInput(RenderGraphResource buffer, ResourceAccess access)
+	{
+		ARC_ASSERT(!ResourceStateTracker::GetAccessInfo(access, GetShaderStages(m_Type)).Write, "RenderGraph: Pass {0} declares a buffer input with a write access", m_Name);
+		AddUse(buffer, access);
+	}
+
+	void RenderGraphPass::AddBufferOutput(RenderGraphResource buffer, ResourceAccess access)
+	{
+		ARC_ASSERT(ResourceStateTracker::GetAccessInfo(access, GetShaderStages(m_Type)).Write, "RenderGraph: Pass {0} declares a buffer output with a read only access", m_Name);
+		AddUse(buffer, access);
+	}
+
+	void RenderGraphPass::AddUse(RenderGraphResource resource, ResourceAccess access, bool discardsContents)
+	{
+		ARC_ASSERT(resource.IsValid(), "RenderGraph: Pass {0} uses an invalid resource", m_Name);
+
+		RenderGraphResourceUse use;
+		use.Resource = resource;
+		use.Access = access;
+		use.DiscardsContents = discardsContents;
+		m_Uses.push_back(use);
+	}
+
+	RenderGraph::RenderGraph(const VulkanAPI *const vulkan) : m_Vulkan(vulkan), m_Device(*vulkan->GetDevice())
+	{
+
+	}
+
+	RenderGraph::~RenderGraph()
+	{
+		Cleanup();
+	}
+
+	RenderGraphResource RenderGraph::CreateTexture(const std::string &name, const RenderGraphTextureDesc &desc)
+	{
+		Resource resource;
+		resource.Name = name;
+		resource.Type = ResourceType::TRANSIENT_TEXTURE;
+		resource.TextureDesc = desc;
+		resource.Aspect = GetImageAspect(desc.Format);
+		m_Resources.push_back(resource);
+
+		RenderGraphResource handle;
+		handle.Index = static_cast<uint32_t>(m_Resources.size() - 1);
+		return handle;
+	}
+
+	RenderGraphResource RenderGraph::ImportSwapchain(const std::string &name, const std::vector<VkImage> &images, const std::vector<VkImageView> &imageViews, VkFormat format, VkExtent2D extent)
+	{
+		ARC_ASSERT(images.size() == imageViews.size(), "RenderGraph: Swapchain {0} needs a view for every image", name);
+
+		Resource resource;
+		resource.Name = name;
+		resource.Type = ResourceType::SWAPCHAIN_TEXTURE;
+		resource.TextureDesc.Width = extent.width;
+		resource.TextureDesc.Height = extent.height;
+		resource.TextureDesc.Format = format;
+		resource.Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		resource.Images = images;
+		resource.ImageViews = imageViews;
+		m_Resources.push_back(resource);
+
+		RenderGraphResource handle;
+		handle.Index = static_cast<uint32_t>(m_Resources.size() - 1);
+		return handle;
+	}
+
+	RenderGraphResource RenderGraph::ImportBuffer(const std::string &name, VkBuffer buffer, VkDeviceSize size)
+	{
+		Resource resource;
+		resource.Name = name;
+		resource.Type = ResourceType::IMPORTED_BUFFER;
+		resource.Buffer = buffer;
+		resource.BufferSize = size;
+		m_Resources.push_back(resource);
+
+		RenderGraphResource handle;
+		handle.Index = static_cast<uint32_t>(m_Resources.size() - 1);
+		return handle;
+	}
+
+	RenderGraphPass& RenderGraph::AddPass(const std::string &name, RenderGraphPassType type)
+	{
+		ARC_ASSERT(!m_Compiled, "RenderGraph: Can't add pass {0} to a compiled graph", name);
+
+		m_Passes.emplace_back(name, type, static_cast<uint32_t>(m_Passes.size()));
+		return m_Passes.back();
+	}
+
+	void RenderGraph::SetOutput(RenderGraphResource resource)
+	{
+		m_Resources[resource.Index].IsOutput = true;
+	}
+
+	void RenderGraph::Compile()
+	{
+		ARC_ASSERT(!m_Compiled, "RenderGraph: The graph is already compiled");
+
+		CullPasses();
+		ComputeLifetimes();
+		CreateTransientTextures();
+		ComputeBarriers();
+		for (RenderGraphPass &pass : m_Passes)
+		{
+			if (pass.m_Culled || pass.m_Type != RenderGraphPassType::GRAPHICS)
+				continue;
+
+			CreateRenderPass(pass);
+			CreateFramebuffers(pass);
+		}
+		m_Compiled = true;
+
+		ARC_LOG_INFO("RenderGraph: Compiled {0} passes ({1} culled) with {2} barriers, transient textures use {3} KB ({4} KB without aliasing)", m_Passes.size(), m_CulledPassCount, m_BarrierCount,
+			m_TransientMemorySize / 1024, m_UnaliasedTransientMemorySize / 1024);
+	}
+
+	void RenderGraph::CullPasses()
+	{
+		// Walk the passes backwards so every reader is visited before the passes that write what it reads. A pass is kept if it writes something that is still needed,
+		// which makes everything it reads needed as well (including the previous contents of what it writes, unless it overwrites them with a clear)
+		std::vector<bool> needed(m_Resources.size(), false);
+		for (size_t i = 0; i < m_Resources.size(); i++)
+		{
+			needed[i] = m_Resources[i].IsOutput;
+		}
+
+		m_CulledPassCount = 0;
+		for (auto iter = m_Passes.rbegin(); iter != m_Passes.rend(); ++iter)
+		{
+			RenderGraphPass &pass = *iter;
+
+			bool contributes = pass.m_HasSideEffects;
+			for (const RenderGraphResourceUse &use : pass.m_Uses)
+			{
+				if (ResourceStateTracker::GetAccessInfo(use.Access, GetShaderStages(pass.m_Type)).Write && needed[use.Resource.Index])
+					contributes = true;
+			}
+
+			pass.m_Culled = !contributes;
+			if (pass.m_Culled)
+			{
+				m_CulledPassCount++;
+				continue;
+			}
+
+			for (const RenderGraphResourceUse &use : pass.m_Uses)
+			{
+				bool write = ResourceStateTracker::GetAccessInfo(use.Access, GetShaderStages(pass.m_Type)).Write;
+				if (!write || !use.DiscardsContents)
+					needed[use.Resource.Index] = true;
+				else if (write && use.DiscardsContents)
+					needed[use.Resource.Index] = false; // Earlier writers are overwritten, they only stay alive if they are needed for something else
+			}
+		}
+	}
+
+	void RenderGraph::ComputeLifetimes()
+	{
+		for (const RenderGraphPass &pass : m_Passes)
+		{
+			if (pass.m_Culled)
+				continue;
+
+			for (const RenderGraphResourceUse &use : pass.m_Uses)
+			{
+				Resource &resource = m_Resources[use.Resource.Index];
+				ARC_ASSERT((resource.Type == ResourceType::IMPORTED_BUFFER) == (GetImageUsage(use.Access) == 0), "RenderGraph: Pass {0} uses {1} with an access that doesn't match the resource type",
+					pass.m_Name, resource.Name);
+
+				if (!resource.Used && resource.Type == ResourceType::TRANSIENT_TEXTURE && !ResourceStateTracker::GetAccessInfo(use.Access, GetShaderStages(pass.m_Type)).Write)
+				{
+					ARC_LOG_WARN("RenderGraph: Pass {0} reads transient texture {1} before anything writes it", pass.m_Name, resource.Name);
+				}
+
+				resource.Used = true;
+				resource.FirstPass = std::min(resource.FirstPass, pass.m_Index);
+				resource.LastPass = std::max(resource.LastPass, pass.m_Index);
+				resource.Usage |= GetImageUsage(use.Access);
+			}
+		}
+	}
+
+	void RenderGraph::CreateTransientTextures()
+	{
+		std::vector<uint32_t> transients;
+		std::vector<VkMemoryRequirements> requirements(m_Resources.size());
+		for (uint32_t i = 0; i < m_Resources.size(); i++)
+		{
+			Resource &resource = m_Resources[i];
+			if (resource.Type != ResourceType::TRANSIENT_TEXTURE || !resource.Used)
+				continue;
+
+			VkImageCreateInfo imageInfo = {};
+			imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.pNext = nullptr;
+			imageInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageInfo.extent.width = resource.TextureDesc.Width;
+			imageInfo.extent.height = resource.TextureDesc.Height;
+			imageInfo.extent.depth = 1;
+			imageInfo.mipLevels = 1;
+			imageInfo.arrayLayers = 1;
+			imageInfo.format = resource.TextureDesc.Format;
+			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			imageInfo.usage = resource.Usage;
+			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageInfo.flags = 0;
+
+			VkImage image;
+			VkResult result = vkCreateImage(m_Device, &imageInfo, nullptr, &image);
+			ARC_ASSERT(result == VK_SUCCESS, "RenderGraph: Failed to create transient texture {0}", resource.Name);
+			resource.Images.push_back(image);
+
+			vkGetImageMemoryRequirements(m_Device, image, &requirements[i]);
+			m_UnaliasedTransientMemorySize += requirements[i].size;
+			transients.push_back(i);
+		}
+
+		// Placing the largest textures first lets the smaller ones fill the gaps in their lifetimes. Every texture in a slot is bound at offset 0, so the slot only has to be as big as its largest texture
+		std::sort(transients.begin(), transients.end(), [&requirements](uint32_t a, uint32_t b)
+		{
+			return requirements[a].size > requirements[b].size;
+		});
+
+		for (uint32_t resourceIndex : transients)
+		{
+			Resource &resource = m_Resources[resourceIndex];
+			const VkMemoryRequirements &memoryRequirements = requirements[resourceIndex];
+
+			uint32_t slotIndex = 0;
+			for (; slotIndex < m_MemorySlots.size(); slotIndex++)
+			{
+				const MemorySlot &slot = m_MemorySlots[slotIndex];
+				if ((slot.MemoryTypeBits & memoryRequirements.memoryTypeBits) == 0)
+					continue;
+
+				bool overlaps = false;
+				for (uint32_t otherIndex : slot.Resources)
+				{
+					const Resource &other = m_Resources[otherIndex];
+					if (resource.FirstPass <= other.LastPass && other.FirstPass <= resource.LastPass)
+					{
+						overlaps = true;
+						break;
+					}
+				}
+				if (!overlaps)
+					break;
+			}
+			if (slotIndex == m_MemorySlots.size())
+				m_MemorySlots.emplace_back();
+
+			MemorySlot &slot = m_MemorySlots[slotIndex];
+			slot.Size = std::max(slot.Size, memoryRequirements.size);
+			slot.Alignment = std::max(slot.Alignment, memoryRequirements.alignment);
+			slot.MemoryTypeBits &= memoryRequirements.memoryTypeBits;
+			slot.Resources.push_back(resourceIndex);
+			resource.MemorySlot = slotIndex;
+		}
+
+		for (MemorySlot &slot : m_MemorySlots)
+		{
+			std::sort(slot.Resources.begin(), slot.Resources.end(), [this](uint32_t a, uint32_t b)
+			{
+				return m_Resources[a].FirstPass < m_Resources[b].FirstPass;
+			});
+
+			VkMemoryAllocateInfo allocInfo = {};
+			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocInfo.pNext = nullptr;
+			allocInfo.allocationSize = slot.Size;
+			allocInfo.memoryTypeIndex = m_Vulkan->FindMemoryType(slot.MemoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+			VkResult result = vkAllocateMemory(m_Device, &allocInfo, nullptr, &slot.Memory);
+			ARC_ASSERT(result == VK_SUCCESS, "RenderGraph: Failed to allocate transient texture memory");
+			m_TransientMemorySize += slot.Size;
+
+			for (uint32_t resourceIndex : slot.Resources)
+			{
+				Resource &resource = m_Resources[resourceIndex];
+				vkBindImageMemory(m_Device, resource.Images[0], slot.Memory, 0);
+				resource.ImageViews.push_back(m_Vulkan->CreateImageView(resource.Images[0], resource.TextureDesc.Format, resource.Aspect & ~VK_IMAGE_ASPECT_STENCIL_BIT));
+			}
+		}
+	}
+
+	void RenderGraph::ComputeBarriers()
+	{
+		// The first walk only finds the state every resource is left in at the end of the frame
+		std::vector<ResourceState> finalStates(m_Resources.size());
+		SimulatePasses(finalStates, nullptr);
+
+		// The first access of a frame has to wait on whatever touched the memory last, which is the previous texture in the same memory slot,
+		// or the last one of the previous frame (frames in flight share the transient textures)
+		for (const MemorySlot &slot : m_MemorySlots)
+		{
+			for (size_t i = 0; i < slot.Resources.size(); i++)
+			{
+				const ResourceState &previous = finalStates[slot.Resources[(i + slot.Resources.size() - 1) % slot.Resources.size()]];
+				ResourceState &initial = m_Resources[slot.Resources[i]].InitialState;
+				initial.Layout = VK_IMAGE_LAYOUT_UNDEFINED; // Contents are never kept between frames
+				initial.WriteStages = previous.WriteStages | previous.ReadStages;
+				initial.WriteAccess = previous.WriteAccess;
+			}
+		}
+		for (size_t i = 0; i < m_Resources.size(); i++)
+		{
+			Resource &resource = m_Resources[i];
+			if (resource.Type == ResourceType::SWAPCHAIN_TEXTURE)
+			{
+				// The image available semaphore is waited on at the colour attachment output stage, chaining to it makes the layout transition happen after the presentation engine is done
+				resource.InitialState.Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+				resource.InitialState.WriteStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+			}
+			else if (resource.Type == ResourceType::IMPORTED_BUFFER)
+			{
+				resource.InitialState.WriteStages = finalStates[i].WriteStages;
+				resource.InitialState.WriteAccess = finalStates[i].WriteAccess;
+			}
+		}
+
+		std::vector<ResourceState> states(m_Resources.size());
+		for (size_t i = 0; i < m_Resources.size(); i++)
+		{
+			states[i] = m_Resources[i].InitialState;
+		}
+		SimulatePasses(states, &m_PassBarriers);
+
+		for (uint32_t i = 0; i < m_Resources.size(); i++)
+		{
+			const Resource &resource = m_Resources[i];
+			if (resource.Type != ResourceType::SWAPCHAIN_TEXTURE || !resource.Used)
+				continue;
+
+			AddBarrier(&m_FinalBarriers, i, states[i], ResourceAccess::PRESENT, RenderGraphPassType::GRAPHICS);
+		}
+
+		m_BarrierCount = static_cast<uint32_t>(m_FinalBarriers.Barriers.size());
+		for (const BarrierBatch &batch : m_PassBarriers)
+		{
+			m_BarrierCount += static_cast<uint32_t>(batch.Barriers.size());
+		}
+	}
+
+	void RenderGraph::SimulatePasses(std::vector<ResourceState> &states, std::vector<BarrierBatch> *passBarriers) const
+	{
+		if (passBarriers)
+			passBarriers->assign(m_Passes.size(), BarrierBatch());
+
+		for (const RenderGraphPass &pass : m_Passes)
+		{
+			if (pass.m_Culled)
+				continue;
+
+			BarrierBatch *batch = passBarriers ? &(*passBarriers)[pass.m_Index] : nullptr;
+			for (const RenderGraphResourceUse &use : pass.m_Uses)
+			{
+				AddBarrier(batch, use.Resource.Index, states[use.Resource.Index], use.Access, pass.m_Type);
+			}
+		}
+	}
+
+	void RenderGraph::AddBarrier(BarrierBatch *batch, uint32_t resourceIndex, ResourceState &state, ResourceAccess access, RenderGraphPassType passType) const
+	{
+		const ResourceAccessInfo info = ResourceStateTracker::GetAccessInfo(access, GetShaderStages(passType));
+		const bool isImage = m_Resources[resourceIndex].Type != ResourceType::IMPORTED_BUFFER;
+
+		Barrier barrier;
+		barrier.Resource = resourceIndex;
+		barrier.OldLayout = state.Layout;
+		barrier.NewLayout = isImage ? info.Layout : VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.DstAccess = info.Access;
+
+		VkPipelineStageFlags srcStages;
+		if (ResourceStateTracker::ComputeTransition(state, info, isImage, srcStages, barrier.SrcAccess) && batch)
+		{
+			batch->SrcStages |= srcStages ? srcStages : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+			batch->DstStages |= info.Stages;
+			batch->Barriers.push_back(barrier);
+		}
+	}
+
+	void RenderGraph::CreateRenderPass(RenderGraphPass &pass)
+	{
+		std::vector<VkAttachmentDescription> attachments;
+		std::vector<VkAttachmentReference> colourReferences;
+		VkAttachmentReference depthReference = {};
+		pass.m_ClearValues.clear();
+		pass.m_Extent = {};
+
+		auto addAttachment = [this, &pass, &attachments](RenderGraphResource handle, VkImageLayout layout, bool cleared, const VkClearValue &clearValue)
+		{
+			const Resource &resource = m_Resources[handle.Index];
+			ARC_ASSERT(resource.Type != ResourceType::IMPORTED_BUFFER, "RenderGraph: Buffer {0} can't be an attachment of pass {1}", resource.Name, pass.m_Name);
+
+			VkExtent2D extent = { resource.TextureDesc.Width, resource.TextureDesc.Height };
+			ARC_ASSERT(attachments.empty() || (extent.width == pass.m_Extent.width && extent.height == pass.m_Extent.height), "RenderGraph: Attachments of pass {0} have different sizes", pass.m_Name);
+			pass.m_Extent = extent;
+
+			// Load the previous contents only if an earlier pass wrote them, and store them only if a later pass or the output needs them
+			VkAttachmentDescription attachment = {};
+			attachment.format = resource.TextureDesc.Format;
+			attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+			if (cleared)
+				attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+			else if (pass.m_Index > resource.FirstPass)
+				attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+			else
+				attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			attachment.storeOp = (pass.m_Index < resource.LastPass || resource.IsOutput) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			attachment.initialLayout = layout; // The graph transitions the attachments with its own barriers
+			attachment.finalLayout = layout;
+
+			attachments.push_back(attachment);
+			pass.m_ClearValues.push_back(clearValue);
+		};
+
+		for (size_t i = 0; i < pass.m_ColourOutputs.size(); i++)
+		{
+			VkAttachmentReference reference = {};
+			reference.attachment = static_cast<uint32_t>(attachments.size());
+			reference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+			colourReferences.push_back(reference);
+
+			addAttachment(pass.m_ColourOutputs[i], reference.layout, pass.m_ColourCleared[i], pass.m_ColourClearValues[i]);
+		}
+		if (pass.m_DepthAttachment.IsValid())
+		{
+			depthReference.attachment = static_cast<uint32_t>(attachments.size());
+			depthReference.layout = pass.m_DepthReadOnly ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+			addAttachment(pass.m_DepthAttachment, depthReference.layout, pass.m_DepthCleared, pass.m_DepthClearValue);
+		}
+		ARC_ASSERT(!attachments.empty(), "RenderGraph: Graphics pass {0} has no attachments", pass.m_Name);
+
+		VkSubpassDescription subpass = {};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = static_cast<uint32_t>(colourReferences.size());
+		subpass.pColorAttachments = colourReferences.data();
+		subpass.pDepthStencilAttachment = pass.m_DepthAttachment.IsValid() ? &depthReference : nullptr;
+
+		// No subpass dependencies, the barriers recorded before the pass already order it against everything before it
+		VkRenderPassCreateInfo renderPassCreateInfo = {};
+		renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassCreateInfo.pNext = nullptr;
+		renderPassCreateInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+		renderPassCreateInfo.pAttachments = attachments.data();
+		renderPassCreateInfo.subpassCount = 1;
+		renderPassCreateInfo.pSubpasses = &subpass;
+		renderPassCreateInfo.dependencyCount = 0;
+		renderPassCreateInfo.pDependencies = nullptr;
+
+		VkResult result = vkCreateRenderPass(m_Device, &renderPassCreateInfo, nullptr, &pass.m_RenderPass);
+		ARC_ASSERT(result == VK_SUCCESS, "RenderGraph: Failed to create the render pass of {0}", pass.m_Name);
+	}
+
+	void RenderGraph::CreateFramebuffers(RenderGraphPass &pass)
+	{
+		std::vector<RenderGraphResource> attachments = pass.m_ColourOutputs;
+		if (pass.m_DepthAttachment.IsValid())
+			attachments.push_back(pass.m_DepthAttachment);
+
+		// Passes that render to the swapchain need a framebuffer for each of its images
+		size_t framebufferCount = 1;
+		for (RenderGraphResource attachment : attachments)
+		{
+			framebufferCount = std::max(framebufferCount, m_Resources[attachment.Index].ImageViews.size());
+		}
+
+		pass.m_Framebuffers.resize(framebufferCount);
+		for (size_t i = 0; i < framebufferCount; i++)
+		{
+			std::vector<VkImageView> views;
+			for (RenderGraphResource attachment : attachments)
+			{
+				views.push_back(GetImageView(attachment, static_cast<uint32_t>(i)));
+			}
+
+			VkFramebufferCreateInfo framebufferInfo = {};
+			framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+			framebufferInfo.pNext = nullptr;
+			framebufferInfo.renderPass = pass.m_RenderPass;
+			framebufferInfo.attachmentCount = static_cast<uint32_t>(views.size());
+			framebufferInfo.pAttachments = views.data();
+			framebufferInfo.width = pass.m_Extent.width;
+			framebufferInfo.height = pass.m_Extent.height;
+			framebufferInfo.layers = 1;
+
+			VkResult result = vkCreateFramebuffer(m_Device, &framebufferInfo, nullptr, &pass.m_Framebuffers[i]);
+			ARC_ASSERT(result == VK_SUCCESS, "RenderGraph: Failed to create the framebuffer of {0}", pass.m_Name);
+		}
+	}
+
+	void RenderGraph::Execute(VkCommandBuffer commandBuffer, uint32_t swapchainImageIndex) const
+	{
+		ARC_ASSERT(m_Compiled, "RenderGraph: The graph needs to be compiled before it is executed");
+
+		for (const RenderGraphPass &pass : m_Passes)
+		{
+			if (pass.m_Culled)
+				continue;
+
+			RecordBarriers(commandBuffer, m_PassBarriers[pass.m_Index], swapchainImageIndex);
+
+			RenderGraphPassContext context;
+			context.CommandBuffer = commandBuffer;
+			context.SwapchainImageIndex = swapchainImageIndex;
+			context.Graph = this;
+
+			if (pass.m_Type == RenderGraphPassType::GRAPHICS)
+			{
+				context.RenderPass = pass.m_RenderPass;
+				context.Framebuffer = pass.m_Framebuffers[pass.m_Framebuffers.size() > 1 ? swapchainImageIndex : 0];
+				context.Extent = pass.m_Extent;
+
+				VkRenderPassBeginInfo renderPassBegin = {};
+				renderPassBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+				renderPassBegin.pNext = nullptr;
+				renderPassBegin.renderPass = context.RenderPass;
+				renderPassBegin.framebuffer = context.Framebuffer;
+				renderPassBegin.renderArea.offset = { 0, 0 };
+				renderPassBegin.renderArea.extent = context.Extent;
+				renderPassBegin.clearValueCount = static_cast<uint32_t>(pass.m_ClearValues.size());
+				renderPassBegin.pClearValues = pass.m_ClearValues.data();
+
+				vkCmdBeginRenderPass(commandBuffer, &renderPassBegin, pass.m_UsesSecondaryCommandBuffers ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+				if (pass.m_Execute)
+					pass.m_Execute(context);
+				vkCmdEndRenderPass(commandBuffer);
+			}
+			else if (pass.m_Execute)
+			{
+				pass.m_Execute(context);
+			}
+		}
+
+		RecordBarriers(commandBuffer, m_FinalBarriers, swapchainImageIndex);
+	}
+
+	void RenderGraph::RecordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch &batch, uint32_t swapchainImageIndex) const
+	{
+		if (batch.Barriers.empty())
+			return;
+
+		std::vector<VkImageMemoryBarrier> imageBarriers;
+		std::vector<VkBufferMemoryBarrier> bufferBarriers;
+		for (const Barrier &barrier : batch.Barriers)
+		{
+			const Resource &resource = m_Resources[barrier.Resource];
+			if (resource.Type == ResourceType::IMPORTED_BUFFER)
+			{
+				VkBufferMemoryBarrier bufferBarrier = {};
+				bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+				bufferBarrier.pNext = nullptr;
+				bufferBarrier.srcAccessMask = barrier.SrcAccess;
+				bufferBarrier.dstAccessMask = barrier.DstAccess;
+				bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				bufferBarrier.buffer = resource.Buffer;
+				bufferBarrier.offset = 0;
+				bufferBarrier.size = VK_WHOLE_SIZE;
+				bufferBarriers.push_back(bufferBarrier);
+			}
+			else
+			{
+				VkImageMemoryBarrier imageBarrier = {};
+				imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+				imageBarrier.pNext = nullptr;
+				imageBarrier.srcAccessMask = barrier.SrcAccess;
+				imageBarrier.dstAccessMask = barrier.DstAccess;
+				imageBarrier.oldLayout = barrier.OldLayout;
+				imageBarrier.newLayout = barrier.NewLayout;
+				imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				imageBarrier.image = GetImage({ barrier.Resource }, swapchainImageIndex);
+				imageBarrier.subresourceRange.aspectMask = resource.Aspect;
+				imageBarrier.subresourceRange.baseMipLevel = 0;
+				imageBarrier.subresourceRange.levelCount = 1;
+				imageBarrier.subresourceRange.baseArrayLayer = 0;
+				imageBarrier.subresourceRange.layerCount = 1;
+				imageBarriers.push_back(imageBarrier);
+			}
+		}
+
+		vkCmdPipelineBarrier(commandBuffer, batch.SrcStages, batch.DstStages, 0, 0, nullptr,
+			static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(), static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+	}
+
+	VkImage RenderGraph::GetImage(RenderGraphResource texture, uint32_t swapchainImageIndex) const
+	{
+		const Resource &resource = m_Resources[texture.Index];
+		ARC_ASSERT(!resource.Images.empty(), "RenderGraph: {0} has no image, it is either a buffer or was never used", resource.Name);
+		return resource.Images[resource.Type == ResourceType::SWAPCHAIN_TEXTURE ? swapchainImageIndex : 0];
+	}
+
+	VkImageView RenderGraph::GetImageView(RenderGraphResource texture, uint32_t swapchainImageIndex) const
+	{
+		const Resource &resource = m_Resources[texture.Index];
+		ARC_ASSERT(!resource.ImageViews.empty(), "RenderGraph: {0} has no image view, it is either a buffer or was never used", resource.Name);
+		return resource.ImageViews[resource.Type == ResourceType::SWAPCHAIN_TEXTURE ? swapchainImageIndex : 0];
+	}
+
+	VkBuffer RenderGraph::GetBuffer(RenderGraphResource buffer) const
+	{
+		return m_Resources[buffer.Index].Buffer;
+	}
+
+	void RenderGraph::Cleanup()
+	{
+		for (RenderGraphPass &pass : m_Passes)
+		{
+			for (VkFramebuffer framebuffer : pass.m_Framebuffers)
+			{
+				vkDestroyFramebuffer(m_Device, framebuffer, nullptr);
+			}
+			if (pass.m_RenderPass != VK_NULL_HANDLE)
+				vkDestroyRenderPass(m_Device, pass.m_RenderPass, nullptr);
+		}
+
+		// Imported resources are owned by whoever imported them
+		for (Resource &resource : m_Resources)
+		{
+			if (resource.Type != ResourceType::TRANSIENT_TEXTURE)
+				continue;
+
+			for (VkImageView imageView : resource.ImageViews)
+			{
+				vkDestroyImageView(m_Device, imageView, nullptr);
+			}
+			for (VkImage image : resource.Images)
+			{
+				vkDestroyImage(m_Device, image, nullptr);
+			}
+		}
+
+		for (MemorySlot &slot : m_MemorySlots)
+		{
+			vkFreeMemory(m_Device, slot.Memory, nullptr);
+		}
+	}
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "Graphics/Renderer/ResourceStateTracker.h"
+
+namespace Arcane
+{
+	class VulkanAPI;
+	class RenderGraph;
+
+	enum class RenderGraphPassType
+	{
+		GRAPHICS,
+		COMPUTE
+	};
+
+	// Handle to a resource of a render graph, only valid for the graph that created it
+	struct RenderGraphResource
+	{
+		uint32_t Index = ~0u;
+
+		inline bool IsValid() const { return Index != ~0u; }
+	};
+
+	// Transient textures are created by the graph and only live for the passes that use them. The usage flags are derived from the passes
+	struct RenderGraphTextureDesc
+	{
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		VkFormat Format = VK_FORMAT_UNDEFINED;
+	};
+
+	struct RenderGraphPassContext
+	{
+		VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+		VkRenderPass RenderPass = VK_NULL_HANDLE; // Graphics passes only, already begun when the pass executes
+		VkFramebuffer Framebuffer = VK_NULL_HANDLE;
+		VkExtent2D Extent = {};
+		uint32_t SwapchainImageIndex = 0;
+		const RenderGraph *Graph = nullptr;
+	};
+
+	struct RenderGraphResourceUse
+	{
+		RenderGraphResource Resource;
+		ResourceAccess Access;
+		bool DiscardsContents = false; // Cleared attachments overwrite everything, so the passes that wrote the previous contents aren't needed
+	};
+
+	class RenderGraphPass
+	{
+		friend class RenderGraph;
+	public:
+		RenderGraphPass(const std::string &name, RenderGraphPassType type, uint32_t index);
+
+		// Attachments are bound in the order they are added. A clear value means the previous contents are never loaded
+		void AddColourOutput(RenderGraphResource texture, const VkClearColorValue *clearValue = nullptr);
+		void SetDepthOutput(RenderGraphResource texture, const VkClearDepthStencilValue *clearValue = nullptr);
+		void SetDepthInput(RenderGraphResource texture);
+
+		void AddTextureInput(RenderGraphResource texture);
+		void AddStorageTexture(RenderGraphResource texture, bool write);
+		void AddBufferInput(RenderGraphResource buffer, ResourceAccess access);
+		void AddBufferOutput(RenderGraphResource buffer, ResourceAccess access);
+
+		// Passes with side effects are never culled, even if nothing reads what they write
+		inline void SetSideEffects() { m_HasSideEffects = true; }
+		// The render pass is begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS so the pass can execute secondaries recorded on other threads
+		inline void SetUsesSecondaryCommandBuffers(bool useSecondaries) { m_UsesSecondaryCommandBuffers = useSecondaries; }
+		inline void SetExecute(const std::function<void(const RenderGraphPassContext&)> &execute) { m_Execute = execute; }
+
+		// Getters
+		inline const std::string& GetName() const { return m_Name; }
+		inline RenderGraphPassType GetType() const { return m_Type; }
+		inline VkRenderPass GetRenderPass() const { return m_RenderPass; } // Valid after the graph is compiled
+		inline bool IsCulled() const { return m_Culled; }
+	private:
+		void AddUse(RenderGraphResource resource, ResourceAccess access, bool discardsContents = false);
+	private:
+		std::string m_Name;
+		RenderGraphPassType m_Type;
+		uint32_t m_Index;
+		std::vector<RenderGraphResourceUse> m_Uses;
+		std::vector<RenderGraphResource> m_ColourOutputs;
+		std::vector<VkClearValue> m_ColourClearValues;
+		std::vector<bool> m_ColourCleared;
+		RenderGraphResource m_DepthAttachment;
+		VkClearValue m_DepthClearValue;
+		bool m_DepthCleared = false;
+		bool m_DepthReadOnly = false;
+		bool m_HasSideEffects = false;
+		bool m_UsesSecondaryCommandBuffers = false;
+		std::function<void(const RenderGraphPassContext&)> m_Execute;
+
+		// Compiled
+		bool m_Culled = false;
+		VkRenderPass m_RenderPass = VK_NULL_HANDLE;
+		std::vector<VkFramebuffer> m_Framebuffers; // One per swapchain image if the swapchain is an attachment
+		VkExtent2D m_Extent = {};
+		std::vector<VkClearValue> m_ClearValues;
+	};
+
+	// Frame graph that owns the render passes, framebuffers, transient attachments and barriers of a frame. Passes declare which resources they read and write,
+	// Compile() then culls passes that don't contribute to an output, works out the layout transitions and the minimal set of barriers (batched into one
+	// vkCmdPipelineBarrier per pass), picks attachment load/store ops from how the contents are used and aliases the memory of transient textures whose lifetimes don't overlap.
+	// Passes execute in the order they were added, so a pass can only read what an earlier pass wrote. Rebuild the graph when the swapchain is recreated
+	class RenderGraph
+	{
+	public:
+		RenderGraph(const VulkanAPI *const vulkan);
+		~RenderGraph();
+
+		RenderGraphResource CreateTexture(const std::string &name, const RenderGraphTextureDesc &desc);
+		// The swapchain image is chosen per frame by the index passed to Execute(). Its contents are never loaded and it is transitioned for presentation at the end of the frame
+		RenderGraphResource ImportSwapchain(const std::string &name, const std::vector<VkImage> &images, const std::vector<VkImageView> &imageViews, VkFormat format, VkExtent2D extent);
+		// Imported buffers keep their contents across frames
+		RenderGraphResource ImportBuffer(const std::string &name, VkBuffer buffer, VkDeviceSize size);
+
+		RenderGraphPass& AddPass(const std::string &name, RenderGraphPassType type);
+		// Passes that (indirectly) contribute to an output are kept, every other pass is culled
+		void SetOutput(RenderGraphResource resource);
+
+		void Compile();
+		void Execute(VkCommandBuffer commandBuffer, uint32_t swapchainImageIndex) const;
+
+		VkImage GetImage(RenderGraphResource texture, uint32_t swapchainImageIndex = 0) const;
+		VkImageView GetImageView(RenderGraphResource texture, uint32_t swapchainImageIndex = 0) const;
+		VkBuffer GetBuffer(RenderGraphResource buffer) const;
+
+		// Stats, valid after the graph is compiled
+		inline uint32_t GetCulledPassCount() const { return m_CulledPassCount; }
+		inline uint32_t GetBarrierCount() const { return m_BarrierCount; }
+		inline VkDeviceSize GetTransientMemorySize() const { return m_TransientMemorySize; }
+		inline VkDeviceSize GetUnaliasedTransientMemorySize() const { return m_UnaliasedTransientMemorySize; }
+	private:
+		enum class ResourceType
+		{
+			TRANSIENT_TEXTURE,
+			SWAPCHAIN_TEXTURE,
+			IMPORTED_BUFFER
+		};
+
+		struct Resource
+		{
+			std::string Name;
+			ResourceType Type;
+			RenderGraphTextureDesc TextureDesc;
+			VkImageUsageFlags Usage = 0;
+			VkImageAspectFlags Aspect = 0;
+			std::vector<VkImage> Images; // One per swapchain image for the swapchain, otherwise a single image
+			std::vector<VkImageView> ImageViews;
+			VkBuffer Buffer = VK_NULL_HANDLE;
+			VkDeviceSize BufferSize = 0;
+			bool IsOutput = false;
+
+			// Compiled
+			bool Used = false;
+			uint32_t FirstPass = ~0u, LastPass = 0; // Lifetime in pass indices
+			uint32_t MemorySlot = ~0u;
+			ResourceState InitialState; // State at the start of every frame, what the previous user of the memory left behind
+		};
+
+		struct Barrier
+		{
+			uint32_t Resource;
+			VkAccessFlags SrcAccess, DstAccess;
+			VkImageLayout OldLayout, NewLayout;
+		};
+
+		struct BarrierBatch
+		{
+			VkPipelineStageFlags SrcStages = 0, DstStages = 0;
+			std::vector<Barrier> Barriers;
+		};
+
+		struct MemorySlot
+		{
+			VkDeviceSize Size = 0;
+			VkDeviceSize Alignment = 1;
+			uint32_t MemoryTypeBits = ~0u;
+			std::vector<uint32_t> Resources; // Sorted by first use
+			VkDeviceMemory Memory = VK_NULL_HANDLE;
+		};
+
+		void CullPasses();
+		void ComputeLifetimes();
+		void CreateTransientTextures();
+		void ComputeBarriers();
+		void CreateRenderPass(RenderGraphPass &pass);
+		void CreateFramebuffers(RenderGraphPass &pass);
+		void SimulatePasses(std::vector<ResourceState> &states, std::vector<BarrierBatch> *passBarriers) const;
+		void AddBarrier(BarrierBatch *batch, uint32_t resourceIndex, ResourceState &state, ResourceAccess access, RenderGraphPassType passType) const;
+		void RecordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch &batch, uint32_t swapchainImageIndex) const;
+		void Cleanup();
+	private:
+		const VulkanAPI *const m_Vulkan;
+		VkDevice m_Device;
+
+		std::deque<RenderGraphPass> m_Passes; // Deque so references returned by AddPass() stay valid
+		std::vector<Resource> m_Resources;
+		std::vector<MemorySlot> m_MemorySlots;
+		std::vector<BarrierBatch> m_PassBarriers; // Recorded before each pass
+		BarrierBatch m_FinalBarriers; // Recorded after the last pass, transitions the outputs (the swapchain for presentation)
+		bool m_Compiled = false;
+
+		uint32_t m_CulledPassCount = 0;
+		uint32_t m_BarrierCount = 0;
+		VkDeviceSize m_TransientMemorySize = 0;
+		VkDeviceSize m_UnaliasedTransientMemorySize = 0;
+	};
+}
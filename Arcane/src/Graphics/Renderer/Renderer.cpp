@@ -1,6 +1,288 @@
 #include "arcpch.h"
+#include "Renderer.h"
+
+#include "Core/Profiler.h"
+#include "Graphics/Buffer/InstanceBuffer.h"
 
 namespace Arcane
 {
-	
+	Renderer::Renderer(InstanceBuffer *instanceBuffer) : m_InstanceBuffer(instanceBuffer)
+	{
+
+	}
+
+	void Renderer::BeginFrame()
+	{
+		m_Draws.clear();
+		m_Instances.clear();
+		m_Packets.clear();
+		for (std::vector<DrawCommand> &sortedDraws : m_SortedDraws)
+		{
+			sortedDraws.clear();
+		}
+	}
+
+	void Renderer::Submit(DrawPass pass, const DrawCommand &draw, const InstanceData &instance, float viewDepth, bool transparent)
+	{
+		ARC_ASSERT(!transparent || pass != DrawPass::DEPTH_PREPASS, "Renderer: Transparent draws can't write the depth prepass, whatever is behind them would never be shaded");
+
+		uint32_t pipelineID = GetPipelineID(draw.Pipeline);
+		uint32_t materialID = GetMaterialID(draw.DescriptorSet);
+		uint32_t meshID = GetMeshID(draw);
+
+		uint64_t key = PackBits(static_cast<uint32_t>(pass), 4, PASS_SHIFT);
+		if (transparent)
+		{
+			key |= PackBits(1, 1, TRANSPARENT_SHIFT);
+			key |= PackBits(~QuantizeDepth(viewDepth, 24), 24, 35);
+			key |= PackBits(pipelineID, 12, 23);
+			key |= PackBits(materialID, 12, 11);
+			key |= PackBits(meshID, 11, 0);
+		}
+		else if (pass == DrawPass::DEPTH_PREPASS)
+		{
+			key |= PackBits(pipelineID, 12, 47);
+			key |= PackBits(QuantizeDepth(viewDepth, 8), 8, 39);
+			key |= PackBits(materialID, 12, 27);
+			key |= PackBits(meshID, 11, 16);
+			key |= PackBits(QuantizeDepth(viewDepth, 16), 16, 0);
+		}
+		else
+		{
+			key |= PackBits(pipelineID, 12, 47);
+			key |= PackBits(materialID, 16, 31);
+			key |= PackBits(meshID, 15, 16);
+			key |= PackBits(QuantizeDepth(viewDepth, 16), 16, 0);
+		}
+
+		DrawPacket packet;
+		packet.Key = key;
+		packet.DrawIndex = static_cast<uint32_t>(m_Draws.size());
+		m_Packets.push_back(packet);
+		m_Draws.push_back(draw);
+		m_Instances.push_back(instance);
+		if (draw.DequantizeTransform)
+		{
+			m_Instances.back().transform *= *draw.DequantizeTransform;
+		}
+	}
+
+	void Renderer::Sort()
+	{
+		double startTime = Profiler::GetTimeMs();
+
+		// Submission order is only meaningful inside a pass, so the draws are split by pass before counting what they would have cost unsorted
+		uint32_t unsortedBindCount = 0, sortedBindCount = 0;
+		for (const DrawPacket &packet : m_Packets)
+		{
+			m_SortedDraws[packet.Key >> PASS_SHIFT].push_back(m_Draws[packet.DrawIndex]);
+		}
+		for (std::vector<DrawCommand> &sortedDraws : m_SortedDraws)
+		{
+			unsortedBindCount += CountBinds(sortedDraws.data(), sortedDraws.size());
+			sortedDraws.clear();
+		}
+
+		RadixSort(m_Packets, m_ScratchPackets);
+		if (m_InstanceBuffer)
+		{
+			// The instances are written in sorted order, so every run of mergeable draws ends up with consecutive instances
+			uint32_t instanceCount = 0;
+			for (const DrawCommand &draw : m_Draws)
+			{
+				instanceCount += draw.Instances ? 0 : (draw.IndirectArguments ? 1 : draw.InstanceCount);
+			}
+
+			uint32_t firstInstance = 0;
+			InstanceData *instances = instanceCount > 0 ? m_InstanceBuffer->AllocateInstances(instanceCount, &firstInstance) : nullptr;
+			DrawCommand *mergedDraw = nullptr;
+			uint32_t mergedPass = 0;
+			for (const DrawPacket &packet : m_Packets)
+			{
+				uint32_t pass = static_cast<uint32_t>(packet.Key >> PASS_SHIFT);
+				const DrawCommand &draw = m_Draws[packet.DrawIndex];
+				if (draw.Instances)
+				{
+					m_SortedDraws[pass].push_back(draw);
+					mergedDraw = nullptr;
+					continue;
+				}
+
+				if (mergedDraw && mergedPass == pass && CanMerge(*mergedDraw, draw))
+				{
+					mergedDraw->InstanceCount += draw.InstanceCount;
+				}
+				else
+				{
+					m_SortedDraws[pass].push_back(draw);
+					mergedDraw = &m_SortedDraws[pass].back();
+					mergedDraw->Instances = m_InstanceBuffer;
+					mergedDraw->FirstInstance = firstInstance;
+					mergedPass = pass;
+				}
+
+				uint32_t drawInstanceCount = draw.IndirectArguments ? 1 : draw.InstanceCount;
+				std::fill(instances, instances + drawInstanceCount, m_Instances[packet.DrawIndex]);
+				instances += drawInstanceCount;
+				firstInstance += drawInstanceCount;
+			}
+		}
+		else
+		{
+			for (const DrawPacket &packet : m_Packets)
+			{
+				m_SortedDraws[packet.Key >> PASS_SHIFT].push_back(m_Draws[packet.DrawIndex]);
+			}
+		}
+		for (const std::vector<DrawCommand> &sortedDraws : m_SortedDraws)
+		{
+			sortedBindCount += CountBinds(sortedDraws.data(), sortedDraws.size());
+		}
+
+		FrameStats &stats = Profiler::GetInstance().GetCurrentFrameStats();
+		stats.DrawSortTime += Profiler::GetTimeMs() - startTime;
+		stats.SubmittedDrawCount += static_cast<uint32_t>(m_Draws.size());
+		stats.UnsortedBindCount += unsortedBindCount;
+		stats.SortedBindCount += sortedBindCount;
+	}
+
+	uint32_t Renderer::CountBinds(const DrawCommand *draws, size_t drawCount)
+	{
+		uint32_t bindCount = 0;
+		const PipelineDescription *boundPipeline = nullptr;
+		const VertexBuffer *boundVertexBuffer = nullptr;
+		const IndexBuffer *boundIndexBuffer = nullptr;
+		const GeometryPool *boundGeometryPool = nullptr;
+		const InstanceBuffer *boundInstanceBuffer = nullptr;
+		VkDescriptorSet boundDescriptorSet = VK_NULL_HANDLE;
+		for (size_t i = 0; i < drawCount; i++)
+		{
+			const DrawCommand &draw = draws[i];
+			bindCount += draw.Pipeline != boundPipeline ? 1 : 0;
+			if (draw.Geometry)
+			{
+				bindCount += draw.Geometry != boundGeometryPool ? 1 : 0;
+				boundGeometryPool = draw.Geometry;
+				boundVertexBuffer = nullptr;
+				boundIndexBuffer = nullptr;
+			}
+			else
+			{
+				bindCount += draw.Vertices != boundVertexBuffer ? 1 : 0;
+				bindCount += (draw.Indices && draw.Indices != boundIndexBuffer) ? 1 : 0;
+				boundGeometryPool = nullptr;
+				boundVertexBuffer = draw.Vertices;
+				boundIndexBuffer = draw.Indices ? draw.Indices : boundIndexBuffer;
+			}
+			bindCount += (draw.Instances && draw.Instances != boundInstanceBuffer) ? 1 : 0;
+			bindCount += draw.DescriptorSet != boundDescriptorSet ? 1 : 0;
+
+			boundPipeline = draw.Pipeline;
+			boundInstanceBuffer = draw.Instances ? draw.Instances : boundInstanceBuffer;
+			boundDescriptorSet = draw.DescriptorSet;
+		}
+		return bindCount;
+	}
+
+	void Renderer::RadixSort(std::vector<DrawPacket> &packets, std::vector<DrawPacket> &scratch)
+	{
+		// Least significant digit first with 8 bit digits, every histogram is built in a single pass over the keys
+		const size_t count = packets.size();
+		uint32_t histograms[8][256] = {};
+		for (const DrawPacket &packet : packets)
+		{
+			for (int digit = 0; digit < 8; digit++)
+			{
+				histograms[digit][(packet.Key >> (digit * 8)) & 0xFF]++;
+			}
+		}
+
+		scratch.resize(count);
+		DrawPacket *source = packets.data(), *destination = scratch.data();
+		for (int digit = 0; digit < 8; digit++)
+		{
+			// Most of the key is the same for every packet (unused pass bits, few pipelines), those digits wouldn't move anything
+			uint32_t *histogram = histograms[digit];
+			if (count == 0 || histogram[(source[0].Key >> (digit * 8)) & 0xFF] == count)
+				continue;
+
+			uint32_t offset = 0;
+			for (int bucket = 0; bucket < 256; bucket++)
+			{
+				uint32_t bucketCount = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketCount;
+			}
+
+			for (size_t i = 0; i < count; i++)
+			{
+				destination[histogram[(source[i].Key >> (digit * 8)) & 0xFF]++] = source[i];
+			}
+			std::swap(source, destination);
+		}
+
+		if (source != packets.data())
+			packets.swap(scratch);
+	}
+
+	bool Renderer::CanMerge(const DrawCommand &first, const DrawCommand &draw)
+	{
+		// Indirect draws take their instance counts from their commands
+		return !first.IndirectArguments && !draw.IndirectArguments && first.Pipeline == draw.Pipeline && first.Vertices == draw.Vertices &&
+			first.Indices == draw.Indices && first.Geometry == draw.Geometry && first.FirstIndex == draw.FirstIndex && first.IndexCount == draw.IndexCount &&
+			first.VertexOffset == draw.VertexOffset && first.DescriptorSet == draw.DescriptorSet;
+	}
+
+	uint32_t Renderer::QuantizeDepth(float viewDepth, uint32_t bits)
+	{
+		// Positive floats keep their order when their bits are compared as integers, so the top bits are a depth quantized relative to its own magnitude
+		float depth = std::max(viewDepth, 0.0f);
+		uint32_t depthBits;
+		memcpy(&depthBits, &depth, sizeof(float));
+		return depthBits >> (31 - bits);
+	}
+
+	uint64_t Renderer::PackBits(uint32_t value, uint32_t bits, uint32_t shift)
+	{
+		return static_cast<uint64_t>(value & ((1u << bits) - 1)) << shift;
+	}
+
+	uint32_t Renderer::GetPipelineID(const PipelineDescription *pipeline)
+	{
+		auto iter = m_PipelineIDs.find(pipeline);
+		if (iter != m_PipelineIDs.end())
+			return iter->second;
+
+		uint32_t id = static_cast<uint32_t>(m_PipelineIDs.size());
+		m_PipelineIDs.emplace(pipeline, id);
+		return id;
+	}
+
+	uint32_t Renderer::GetMaterialID(VkDescriptorSet descriptorSet)
+	{
+		auto iter = m_MaterialIDs.find(descriptorSet);
+		if (iter != m_MaterialIDs.end())
+			return iter->second;
+
+		uint32_t id = static_cast<uint32_t>(m_MaterialIDs.size());
+		m_MaterialIDs.emplace(descriptorSet, id);
+		return id;
+	}
+
+	uint32_t Renderer::GetMeshID(const DrawCommand &draw)
+	{
+		MeshKey key;
+		key.Buffers = draw.Geometry ? static_cast<const void*>(draw.Geometry) : static_cast<const void*>(draw.Vertices);
+		key.Indices = draw.Geometry ? nullptr : draw.Indices;
+		key.FirstIndex = draw.Geometry ? draw.FirstIndex : 0;
+		key.VertexOffset = draw.Geometry ? draw.VertexOffset : 0;
+
+		auto iter = m_MeshIDs.find(key);
+		if (iter != m_MeshIDs.end())
+			return iter->second;
+
+		uint32_t id = static_cast<uint32_t>(m_MeshIDs.size());
+		m_MeshIDs.emplace(key, id);
+		return id;
+	}
 }
@@ -1,9 +1,99 @@
 #pragma once
 
+#include "Graphics/Vertex.h"
+#include "Graphics/Renderer/ParallelCommandRecorder.h"
+
 namespace Arcane
 {
+	// Passes the render queue sorts draws into, draws of an earlier pass always come first
+	enum class DrawPass : uint32_t
+	{
+		DEPTH_PREPASS, // Depth only, the main pass then only shades the fragments that ended up visible
+		MAIN,
+		MAIN_LATE, // Objects that only became visible in the late occlusion culling phase
+		COUNT
+	};
+
+	// A draw waiting in the render queue, the key decides where it ends up in the command buffer
+	struct DrawPacket
+	{
+		uint64_t Key;
+		uint32_t DrawIndex; // Into the submitted draws
+	};
+
+	// Render queue that collects the draws of a frame and records them in an order that rebinds as little as possible instead of the order they were submitted in.
+	// Every draw gets a 64 bit key that packs, from the most significant bits down:
+	//   pass (4) | transparent (1) | opaque:      pipeline (12) | material (16) | mesh (15) | depth front to back (16)
+	//                                transparent: depth back to front (24) | pipeline (12) | material (12) | mesh (11)
+	//                                prepass:     pipeline (12) | coarse depth front to back (8) | material (12) | mesh (11) | depth front to back (16)
+	// Meshes of one geometry pool get consecutive IDs as long as they are first seen together, so they mostly stay grouped under a single pool bind.
+	// Opaque draws are grouped by state first and only sorted front to back inside a group, a pipeline or descriptor set change costs more than the overdraw it would save.
+	// Transparent draws have to blend in order, so depth comes first for them. Depth prepass draws are cheap to bind and only there to fill the depth buffer, so they
+	// go front to back by depth bucket (about a power of two of distance) before grouping by material and mesh, which makes the occluders go first. The keys are radix sorted, which is stable, so draws with the same key keep their submission order.
+	// With an instance buffer, runs of sorted draws that share the pipeline, mesh and material are merged into a single instanced draw and every draw's instance data is
+	// written to the buffer in sorted order. Without one the draws are only sorted and their instance data is dropped
 	class Renderer
 	{
+	public:
+		Renderer(InstanceBuffer *instanceBuffer = nullptr);
+
+		// Clears the queue, the IDs given to pipelines, materials and meshes are kept so the keys stay the same between frames
+		void BeginFrame();
+
+		// The view depth is the distance along the camera's forward axis, only its order matters. The draw is copied, anything it points to has to stay alive until the frame is recorded.
+		// Draws that already point at their own instances keep them and are never merged, every other instance of the draw gets the instance data.
+		// Draws of quantized meshes get the instance data with the mesh's dequantize transform applied first
+		void Submit(DrawPass pass, const DrawCommand &draw, const InstanceData &instance, float viewDepth, bool transparent = false);
+
+		// Sorts the queue, merges it into instanced draws and splits it by pass. Reports the binds the draws would have needed in submission order and the binds they need after sorting
+		void Sort();
+
+		// Getters
+		inline const std::vector<DrawCommand>& GetSortedDraws(DrawPass pass) const { return m_SortedDraws[static_cast<uint32_t>(pass)]; }
+		inline uint32_t GetSubmittedDrawCount() const { return static_cast<uint32_t>(m_Draws.size()); }
+
+		// Pipeline, vertex buffer, index buffer, geometry pool, instance buffer and descriptor set binds it takes to record the draws in order, the same binds ParallelCommandRecorder skips
+		static uint32_t CountBinds(const DrawCommand *draws, size_t drawCount);
+		static void RadixSort(std::vector<DrawPacket> &packets, std::vector<DrawPacket> &scratch);
+	private:
+		static uint32_t QuantizeDepth(float viewDepth, uint32_t bits);
+		static uint64_t PackBits(uint32_t value, uint32_t bits, uint32_t shift);
+		uint32_t GetPipelineID(const PipelineDescription *pipeline);
+		uint32_t GetMaterialID(VkDescriptorSet descriptorSet);
+		uint32_t GetMeshID(const DrawCommand &draw);
+		static bool CanMerge(const DrawCommand &first, const DrawCommand &draw);
+	private:
+		// A mesh is either its own vertex and index buffer or a range of a geometry pool, Buffers is the pool for the latter
+		struct MeshKey
+		{
+			const void *Buffers;
+			const void *Indices;
+			uint32_t FirstIndex;
+			int32_t VertexOffset;
+
+			inline bool operator==(const MeshKey &other) const { return Buffers == other.Buffers && Indices == other.Indices && FirstIndex == other.FirstIndex && VertexOffset == other.VertexOffset; }
+		};
+		struct MeshKeyHash
+		{
+			inline size_t operator()(const MeshKey &key) const
+			{
+				return std::hash<const void*>()(key.Buffers) ^ (std::hash<const void*>()(key.Indices) * 31) ^ (std::hash<uint64_t>()((static_cast<uint64_t>(key.FirstIndex) << 32) | static_cast<uint32_t>(key.VertexOffset)) * 961);
+			}
+		};
+
+		InstanceBuffer *m_InstanceBuffer;
+
+		std::vector<DrawCommand> m_Draws;
+		std::vector<InstanceData> m_Instances; // One per submitted draw
+		std::vector<DrawPacket> m_Packets, m_ScratchPackets;
+		std::vector<DrawCommand> m_SortedDraws[static_cast<uint32_t>(DrawPass::COUNT)];
+
+		// IDs are handed out in the order things are first seen, they wrap around if there are more than fit in their bits which only makes the grouping worse
+		std::unordered_map<const PipelineDescription*, uint32_t> m_PipelineIDs;
+		std::unordered_map<VkDescriptorSet, uint32_t> m_MaterialIDs;
+		std::unordered_map<MeshKey, uint32_t, MeshKeyHash> m_MeshIDs;
 
+		static const uint32_t PASS_SHIFT = 60;
+		static const uint32_t TRANSPARENT_SHIFT = 59;
 	};
 }
@@ -0,0 +1,290 @@
+#include "arcpch.h"
+#include "ResourceStateTracker.h"
+
+namespace Arcane
+{
+	void ResourceStateTracker::RegisterImage(VkImage image, VkImageAspectFlags aspect, uint32_t mipLevels, uint32_t arrayLayers, VkImageLayout currentLayout)
+	{
+		ImageState imageState;
+		imageState.Aspect = aspect;
+		imageState.MipLevels = mipLevels;
+		imageState.ArrayLayers = arrayLayers;
+		imageState.Subresources.resize(static_cast<size_t>(mipLevels) * arrayLayers);
+		for (ResourceState &state : imageState.Subresources)
+		{
+			state.Layout = currentLayout;
+		}
+
+		m_Images[image] = imageState;
+	}
+
+	void ResourceStateTracker::UnregisterImage(VkImage image)
+	{
+		m_Images.erase(image);
+	}
+
+	void ResourceStateTracker::RegisterBuffer(VkBuffer buffer)
+	{
+		m_Buffers[buffer] = ResourceState();
+	}
+
+	void ResourceStateTracker::UnregisterBuffer(VkBuffer buffer)
+	{
+		m_Buffers.erase(buffer);
+	}
+
+	void ResourceStateTracker::TransitionImage(VkImage image, ResourceAccess access, const VkImageSubresourceRange *range, VkPipelineStageFlags shaderStages)
+	{
+		auto iter = m_Images.find(image);
+		ARC_ASSERT(iter != m_Images.end(), "ResourceStateTracker: Transitioning an image that isn't registered");
+		ImageState &imageState = iter->second;
+
+		uint32_t baseMip = range ? range->baseMipLevel : 0;
+		uint32_t mipCount = (range && range->levelCount != VK_REMAINING_MIP_LEVELS) ? range->levelCount : imageState.MipLevels - baseMip;
+		uint32_t baseLayer = range ? range->baseArrayLayer : 0;
+		uint32_t layerCount = (range && range->layerCount != VK_REMAINING_ARRAY_LAYERS) ? range->layerCount : imageState.ArrayLayers - baseLayer;
+		ARC_ASSERT(baseMip + mipCount <= imageState.MipLevels && baseLayer + layerCount <= imageState.ArrayLayers, "ResourceStateTracker: Subresource range is out of the image's bounds");
+
+		const ResourceAccessInfo info = GetAccessInfo(access, shaderStages);
+		for (uint32_t layer = baseLayer; layer < baseLayer + layerCount; layer++)
+		{
+			for (uint32_t mip = baseMip; mip < baseMip + mipCount; mip++)
+			{
+				ResourceState &state = imageState.Subresources[static_cast<size_t>(layer) * imageState.MipLevels + mip];
+				VkImageLayout oldLayout = state.Layout;
+
+				VkPipelineStageFlags srcStages;
+				VkAccessFlags srcAccess;
+				if (!ComputeTransition(state, info, true, srcStages, srcAccess))
+					continue;
+
+				m_PendingSrcStages |= srcStages;
+				m_PendingDstStages |= info.Stages;
+
+				PendingImageBarrier *pending = nullptr;
+				for (PendingImageBarrier &barrier : m_PendingImageBarriers)
+				{
+					if (barrier.Image == image && barrier.MipLevel == mip && barrier.ArrayLayer == layer)
+					{
+						pending = &barrier;
+						break;
+					}
+				}
+
+				if (pending)
+				{
+					pending->NewLayout = info.Layout;
+					pending->DstAccess |= info.Access;
+				}
+				else
+				{
+					PendingImageBarrier barrier;
+					barrier.Image = image;
+					barrier.Aspect = imageState.Aspect;
+					barrier.MipLevel = mip;
+					barrier.ArrayLayer = layer;
+					barrier.OldLayout = oldLayout;
+					barrier.NewLayout = info.Layout;
+					barrier.SrcAccess = srcAccess;
+					barrier.DstAccess = info.Access;
+					m_PendingImageBarriers.push_back(barrier);
+				}
+			}
+		}
+	}
+
+	void ResourceStateTracker::TransitionBuffer(VkBuffer buffer, ResourceAccess access, VkPipelineStageFlags shaderStages)
+	{
+		auto iter = m_Buffers.find(buffer);
+		ARC_ASSERT(iter != m_Buffers.end(), "ResourceStateTracker: Transitioning a buffer that isn't registered");
+		ResourceState &state = iter->second;
+		const ResourceAccessInfo info = GetAccessInfo(access, shaderStages);
+
+		VkPipelineStageFlags srcStages;
+		VkAccessFlags srcAccess;
+		if (!ComputeTransition(state, info, false, srcStages, srcAccess))
+			return;
+
+		m_PendingSrcStages |= srcStages;
+		m_PendingDstStages |= info.Stages;
+
+		for (VkBufferMemoryBarrier &barrier : m_PendingBufferBarriers)
+		{
+			if (barrier.buffer == buffer)
+			{
+				barrier.dstAccessMask |= info.Access;
+				return;
+			}
+		}
+
+		VkBufferMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.pNext = nullptr;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstAccessMask = info.Access;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = buffer;
+		barrier.offset = 0;
+		barrier.size = VK_WHOLE_SIZE;
+		m_PendingBufferBarriers.push_back(barrier);
+	}
+
+	void ResourceStateTracker::FlushBarriers(VkCommandBuffer commandBuffer)
+	{
+		if (!HasPendingBarriers())
+			return;
+
+		// Subresources of the same image and layer with consecutive mips and the same transition share a single barrier
+		std::sort(m_PendingImageBarriers.begin(), m_PendingImageBarriers.end(), [](const PendingImageBarrier &a, const PendingImageBarrier &b)
+		{
+			if (a.Image != b.Image)
+				return a.Image < b.Image;
+			if (a.ArrayLayer != b.ArrayLayer)
+				return a.ArrayLayer < b.ArrayLayer;
+			return a.MipLevel < b.MipLevel;
+		});
+
+		std::vector<VkImageMemoryBarrier> imageBarriers;
+		const PendingImageBarrier *previous = nullptr;
+		for (const PendingImageBarrier &pending : m_PendingImageBarriers)
+		{
+			if (previous && previous->Image == pending.Image && previous->ArrayLayer == pending.ArrayLayer && previous->MipLevel + 1 == pending.MipLevel &&
+				previous->OldLayout == pending.OldLayout && previous->NewLayout == pending.NewLayout && previous->SrcAccess == pending.SrcAccess && previous->DstAccess == pending.DstAccess)
+			{
+				imageBarriers.back().subresourceRange.levelCount++;
+				previous = &pending;
+				continue;
+			}
+
+			VkImageMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.pNext = nullptr;
+			barrier.srcAccessMask = pending.SrcAccess;
+			barrier.dstAccessMask = pending.DstAccess;
+			barrier.oldLayout = pending.OldLayout;
+			barrier.newLayout = pending.NewLayout;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = pending.Image;
+			barrier.subresourceRange.aspectMask = pending.Aspect;
+			barrier.subresourceRange.baseMipLevel = pending.MipLevel;
+			barrier.subresourceRange.levelCount = 1;
+			barrier.subresourceRange.baseArrayLayer = pending.ArrayLayer;
+			barrier.subresourceRange.layerCount = 1;
+			imageBarriers.push_back(barrier);
+			previous = &pending;
+		}
+
+		vkCmdPipelineBarrier(commandBuffer, m_PendingSrcStages ? m_PendingSrcStages : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT), m_PendingDstStages, 0, 0, nullptr,
+			static_cast<uint32_t>(m_PendingBufferBarriers.size()), m_PendingBufferBarriers.data(), static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+
+		m_PendingImageBarriers.clear();
+		m_PendingBufferBarriers.clear();
+		m_PendingSrcStages = 0;
+		m_PendingDstStages = 0;
+	}
+
+	VkImageLayout ResourceStateTracker::GetImageLayout(VkImage image, uint32_t mipLevel, uint32_t arrayLayer) const
+	{
+		auto iter = m_Images.find(image);
+		if (iter == m_Images.end())
+			return VK_IMAGE_LAYOUT_UNDEFINED;
+
+		return iter->second.Subresources[static_cast<size_t>(arrayLayer) * iter->second.MipLevels + mipLevel].Layout;
+	}
+
+	ResourceAccessInfo ResourceStateTracker::GetAccessInfo(ResourceAccess access, VkPipelineStageFlags shaderStages)
+	{
+		VkPipelineStageFlags depthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+		switch (access)
+		{
+		case ResourceAccess::COLOUR_ATTACHMENT:
+			return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true };
+		case ResourceAccess::DEPTH_ATTACHMENT:
+			return { depthStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true };
+		case ResourceAccess::DEPTH_READ_ONLY:
+			return { depthStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, false };
+		case ResourceAccess::SAMPLED:
+			return { shaderStages, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+		case ResourceAccess::STORAGE_READ:
+			return { shaderStages, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false };
+		case ResourceAccess::STORAGE_WRITE:
+			return { shaderStages, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true };
+		case ResourceAccess::TRANSFER_READ:
+			return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false };
+		case ResourceAccess::TRANSFER_WRITE:
+			return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true };
+		case ResourceAccess::INDIRECT_READ:
+			return { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+		case ResourceAccess::VERTEX_READ:
+			return { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+		case ResourceAccess::UNIFORM_READ:
+			return { shaderStages, VK_ACCESS_UNIFORM_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+		case ResourceAccess::PRESENT:
+			return { VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false }; // Visibility to the presentation engine is handled by the semaphore
+		}
+
+		ARC_ASSERT(false, "ResourceStateTracker: Unknown resource access");
+		return { VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true };
+	}
+
+	bool ResourceStateTracker::ComputeTransition(ResourceState &state, const ResourceAccessInfo &info, bool isImage, VkPipelineStageFlags &outSrcStages, VkAccessFlags &outSrcAccess)
+	{
+		const bool layoutChange = isImage && state.Layout != info.Layout;
+		bool needsBarrier = false;
+		outSrcStages = 0;
+		outSrcAccess = 0;
+
+		if (layoutChange)
+		{
+			// Transitions write the image, so they wait on every earlier access and every later access waits on them
+			outSrcStages = state.WriteStages | state.ReadStages;
+			outSrcAccess = state.WriteAccess;
+			needsBarrier = true;
+		}
+		else if (!info.Write)
+		{
+			// Reads only wait on the last write, and only once per stage. Read after read never needs a barrier
+			bool alreadyVisible = (state.ReadStages & info.Stages) == info.Stages && (state.ReadAccess & info.Access) == info.Access;
+			if (state.WriteStages != 0 && !alreadyVisible)
+			{
+				outSrcStages = state.WriteStages;
+				outSrcAccess = state.WriteAccess;
+				needsBarrier = true;
+			}
+		}
+		else if (state.WriteStages != 0 || state.ReadStages != 0)
+		{
+			// Write after read only needs an execution dependency, write after write also makes the earlier write available
+			outSrcStages = state.WriteStages | state.ReadStages;
+			outSrcAccess = state.WriteAccess;
+			needsBarrier = true;
+		}
+
+		if (info.Write)
+		{
+			state.WriteStages = info.Stages;
+			state.WriteAccess = info.Access & (VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT);
+			state.ReadStages = 0;
+			state.ReadAccess = 0;
+		}
+		else if (layoutChange)
+		{
+			state.WriteStages = info.Stages;
+			state.WriteAccess = 0;
+			state.ReadStages = info.Stages;
+			state.ReadAccess = info.Access;
+		}
+		else
+		{
+			state.ReadStages |= info.Stages;
+			state.ReadAccess |= info.Access;
+		}
+		if (isImage)
+			state.Layout = info.Layout;
+
+		return needsBarrier;
+	}
+}
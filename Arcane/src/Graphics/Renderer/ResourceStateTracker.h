@@ -0,0 +1,92 @@
+#pragma once
+
+namespace Arcane
+{
+	// How a resource is about to be used, decides the pipeline stages, access masks and image layout that get synchronized with
+	enum class ResourceAccess
+	{
+		COLOUR_ATTACHMENT,
+		DEPTH_ATTACHMENT,
+		DEPTH_READ_ONLY, // Depth tested against but not written
+		SAMPLED,
+		STORAGE_READ,
+		STORAGE_WRITE,
+		TRANSFER_READ,
+		TRANSFER_WRITE,
+		INDIRECT_READ,
+		VERTEX_READ, // Vertex and index fetch
+		UNIFORM_READ,
+		PRESENT
+	};
+
+	struct ResourceAccessInfo
+	{
+		VkPipelineStageFlags Stages;
+		VkAccessFlags Access;
+		VkImageLayout Layout;
+		bool Write;
+	};
+
+	// Synchronization state of a buffer or of a single image subresource
+	struct ResourceState
+	{
+		VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkPipelineStageFlags WriteStages = 0; // Stages of the last write (or layout transition) that later accesses need to wait on
+		VkAccessFlags WriteAccess = 0;
+		VkPipelineStageFlags ReadStages = 0; // Stages that read the resource since the last write, and already see the write
+		VkAccessFlags ReadAccess = 0;
+	};
+
+	// Knows the current layout, access and stages of every subresource of the images (and of the buffers) it tracks. Callers only state the next usage,
+	// the tracker works out the minimal barrier and keeps it pending until FlushBarriers() records every pending barrier with a single vkCmdPipelineBarrier.
+	// The state is global, so command buffers have to be submitted in the order they were recorded in. Not thread safe
+	class ResourceStateTracker
+	{
+	public:
+		ResourceStateTracker() = default;
+
+		void RegisterImage(VkImage image, VkImageAspectFlags aspect, uint32_t mipLevels = 1, uint32_t arrayLayers = 1, VkImageLayout currentLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+		void UnregisterImage(VkImage image);
+		void RegisterBuffer(VkBuffer buffer);
+		void UnregisterBuffer(VkBuffer buffer);
+
+		// The range defaults to the whole image. Shader stages are the stages that read or write the resource for the shader accesses (sampled, storage and uniform)
+		void TransitionImage(VkImage image, ResourceAccess access, const VkImageSubresourceRange *range = nullptr,
+			VkPipelineStageFlags shaderStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+		void TransitionBuffer(VkBuffer buffer, ResourceAccess access, VkPipelineStageFlags shaderStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+		void FlushBarriers(VkCommandBuffer commandBuffer);
+
+		VkImageLayout GetImageLayout(VkImage image, uint32_t mipLevel = 0, uint32_t arrayLayer = 0) const;
+		inline bool HasPendingBarriers() const { return !m_PendingImageBarriers.empty() || !m_PendingBufferBarriers.empty(); }
+
+		static ResourceAccessInfo GetAccessInfo(ResourceAccess access, VkPipelineStageFlags shaderStages);
+		// Updates the state for the access and returns true if a barrier is needed, along with the stages and access it needs to wait on
+		static bool ComputeTransition(ResourceState &state, const ResourceAccessInfo &info, bool isImage, VkPipelineStageFlags &outSrcStages, VkAccessFlags &outSrcAccess);
+	private:
+		struct ImageState
+		{
+			VkImageAspectFlags Aspect;
+			uint32_t MipLevels;
+			uint32_t ArrayLayers;
+			std::vector<ResourceState> Subresources; // [arrayLayer * MipLevels + mipLevel]
+		};
+
+		struct PendingImageBarrier
+		{
+			VkImage Image;
+			VkImageAspectFlags Aspect;
+			uint32_t MipLevel, ArrayLayer;
+			VkImageLayout OldLayout, NewLayout;
+			VkAccessFlags SrcAccess, DstAccess;
+		};
+	private:
+		std::unordered_map<VkImage, ImageState> m_Images;
+		std::unordered_map<VkBuffer, ResourceState> m_Buffers;
+
+		// A subresource transitioned twice before a flush keeps a single barrier from its first old layout to its last new layout
+		std::vector<PendingImageBarrier> m_PendingImageBarriers;
+		std::vector<VkBufferMemoryBarrier> m_PendingBufferBarriers;
+		VkPipelineStageFlags m_PendingSrcStages = 0, m_PendingDstStages = 0;
+	};
+}
@@ -0,0 +1,324 @@
+#include "arcpch.h"
+#include "SoftwareOcclusion.h"
+
+#include "Core/JobSystem.h"
+#include "Core/Profiler.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define ARC_OCCLUSION_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Arcane
+{
+	SoftwareOcclusion::SoftwareOcclusion(uint32_t width, uint32_t height)
+		: m_Width(width), m_Height(height), m_TileCountX(width / TILE_WIDTH), m_TileCountY(height / TILE_HEIGHT), m_ViewProjection(1.0f), m_BinBatchCount(0)
+	{
+		ARC_ASSERT(width % TILE_WIDTH == 0 && height % TILE_HEIGHT == 0, "SoftwareOcclusion: {0}x{1} isn't a multiple of the tile size", width, height);
+
+		m_Depth.assign(m_Width * m_Height, 1.0f);
+		m_TileMaxDepth.assign(m_TileCountX * m_TileCountY, 1.0f);
+	}
+
+	void SoftwareOcclusion::AddOccluder(const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices, const glm::mat4 &transform)
+	{
+		uint32_t firstVertex = static_cast<uint32_t>(m_OccluderPositions.size());
+		for (const glm::vec3 &position : positions)
+		{
+			m_OccluderPositions.push_back(glm::vec3(transform * glm::vec4(position, 1.0f)));
+		}
+		for (uint32_t index : indices)
+		{
+			m_OccluderIndices.push_back(firstVertex + index);
+		}
+	}
+
+	void SoftwareOcclusion::ClearOccluders()
+	{
+		m_OccluderPositions.clear();
+		m_OccluderIndices.clear();
+	}
+
+	void SoftwareOcclusion::RasterizeOccluders(const glm::mat4 &viewProjection)
+	{
+		double startTime = Profiler::GetTimeMs();
+		m_ViewProjection = viewProjection;
+		std::fill(m_Depth.begin(), m_Depth.end(), 1.0f);
+
+		// Binning, every batch of triangles sorts its triangles into its own lists
+		const uint32_t triangleCount = GetOccluderTriangleCount();
+		const uint32_t tileCount = m_TileCountX * m_TileCountY;
+		m_Triangles.resize(triangleCount);
+		m_BinBatchCount = (triangleCount + TRIANGLE_BATCH_SIZE - 1) / TRIANGLE_BATCH_SIZE;
+		if (m_TileBins.size() < m_BinBatchCount * tileCount)
+			m_TileBins.resize(m_BinBatchCount * tileCount);
+
+		auto binTriangles = [this, tileCount](uint32_t begin, uint32_t end)
+		{
+			std::vector<uint32_t> *bins = &m_TileBins[(begin / TRIANGLE_BATCH_SIZE) * tileCount];
+			for (uint32_t tile = 0; tile < tileCount; tile++)
+			{
+				bins[tile].clear();
+			}
+
+			for (uint32_t triangle = begin; triangle < end; triangle++)
+			{
+				glm::vec4 clip[3];
+				for (int i = 0; i < 3; i++)
+				{
+					clip[i] = m_ViewProjection * glm::vec4(m_OccluderPositions[m_OccluderIndices[triangle * 3 + i]], 1.0f);
+				}
+
+				OcclusionTriangle &setup = m_Triangles[triangle];
+				if (!SetupTriangle(clip[0], clip[1], clip[2], setup))
+					continue;
+
+				for (int tileY = setup.MinY / static_cast<int>(TILE_HEIGHT); tileY <= setup.MaxY / static_cast<int>(TILE_HEIGHT); tileY++)
+				{
+					for (int tileX = setup.MinX / static_cast<int>(TILE_WIDTH); tileX <= setup.MaxX / static_cast<int>(TILE_WIDTH); tileX++)
+					{
+						bins[tileY * m_TileCountX + tileX].push_back(triangle);
+					}
+				}
+			}
+		};
+
+		// Rasterization, a tile is only ever touched by one job
+		auto rasterizeTiles = [this](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t tile = begin; tile < end; tile++)
+			{
+				RasterizeTile(tile);
+			}
+		};
+
+		if (JobSystem::IsInitialized())
+		{
+			JobSystem::ParallelFor(triangleCount, TRIANGLE_BATCH_SIZE, binTriangles);
+			JobSystem::ParallelFor(tileCount, 4, rasterizeTiles);
+		}
+		else
+		{
+			for (uint32_t begin = 0; begin < triangleCount; begin += TRIANGLE_BATCH_SIZE)
+			{
+				binTriangles(begin, std::min(triangleCount, begin + TRIANGLE_BATCH_SIZE));
+			}
+			rasterizeTiles(0, tileCount);
+		}
+
+		FrameStats &stats = Profiler::GetInstance().GetCurrentFrameStats();
+		stats.SoftwareOcclusionRasterTime += Profiler::GetTimeMs() - startTime;
+		stats.SoftwareOccluderTriangleCount += triangleCount;
+	}
+
+	bool SoftwareOcclusion::SetupTriangle(const glm::vec4 &clip0, const glm::vec4 &clip1, const glm::vec4 &clip2, OcclusionTriangle &outTriangle) const
+	{
+		// Triangles crossing the near plane would need clipping, dropping them only loses some occlusion
+		const glm::vec4 *clip[3] = { &clip0, &clip1, &clip2 };
+		glm::vec3 screen[3];
+		for (int i = 0; i < 3; i++)
+		{
+			if (clip[i]->w <= 0.0f || clip[i]->z < 0.0f)
+				return false;
+
+			glm::vec3 ndc = glm::vec3(*clip[i]) / clip[i]->w;
+			screen[i] = glm::vec3((ndc.x * 0.5f + 0.5f) * m_Width, (ndc.y * 0.5f + 0.5f) * m_Height, ndc.z);
+		}
+
+		// Both windings are drawn, occluders seen from behind still hide what is behind them
+		float area = (screen[1].x - screen[0].x) * (screen[2].y - screen[0].y) - (screen[2].x - screen[0].x) * (screen[1].y - screen[0].y);
+		if (std::abs(area) < 1e-6f)
+			return false;
+		if (area < 0.0f)
+		{
+			std::swap(screen[1], screen[2]);
+			area = -area;
+		}
+
+		float minX = std::min({ screen[0].x, screen[1].x, screen[2].x }), maxX = std::max({ screen[0].x, screen[1].x, screen[2].x });
+		float minY = std::min({ screen[0].y, screen[1].y, screen[2].y }), maxY = std::max({ screen[0].y, screen[1].y, screen[2].y });
+		outTriangle.MinX = std::max(0, static_cast<int>(std::floor(minX)));
+		outTriangle.MinY = std::max(0, static_cast<int>(std::floor(minY)));
+		outTriangle.MaxX = std::min(static_cast<int>(m_Width) - 1, static_cast<int>(std::ceil(maxX)));
+		outTriangle.MaxY = std::min(static_cast<int>(m_Height) - 1, static_cast<int>(std::ceil(maxY)));
+		if (outTriangle.MinX > outTriangle.MaxX || outTriangle.MinY > outTriangle.MaxY || std::min({ screen[0].z, screen[1].z, screen[2].z }) > 1.0f)
+			return false;
+
+		// Edge i is opposite vertex i, so its edge function divided by the area is that vertex's barycentric weight
+		for (int i = 0; i < 3; i++)
+		{
+			const glm::vec3 &a = screen[(i + 1) % 3], &b = screen[(i + 2) % 3];
+			outTriangle.EdgeA[i] = a.y - b.y;
+			outTriangle.EdgeB[i] = b.x - a.x;
+			outTriangle.EdgeC[i] = a.x * b.y - a.y * b.x;
+		}
+
+		outTriangle.DepthA = (outTriangle.EdgeA[0] * screen[0].z + outTriangle.EdgeA[1] * screen[1].z + outTriangle.EdgeA[2] * screen[2].z) / area;
+		outTriangle.DepthB = (outTriangle.EdgeB[0] * screen[0].z + outTriangle.EdgeB[1] * screen[1].z + outTriangle.EdgeB[2] * screen[2].z) / area;
+		outTriangle.DepthC = (outTriangle.EdgeC[0] * screen[0].z + outTriangle.EdgeC[1] * screen[1].z + outTriangle.EdgeC[2] * screen[2].z) / area;
+		return true;
+	}
+
+	void SoftwareOcclusion::RasterizeTile(uint32_t tile)
+	{
+		const int tileMinX = static_cast<int>((tile % m_TileCountX) * TILE_WIDTH), tileMinY = static_cast<int>((tile / m_TileCountX) * TILE_HEIGHT);
+		const int tileMaxX = tileMinX + static_cast<int>(TILE_WIDTH) - 1, tileMaxY = tileMinY + static_cast<int>(TILE_HEIGHT) - 1;
+		const uint32_t tileCount = m_TileCountX * m_TileCountY;
+
+		for (uint32_t batch = 0; batch < m_BinBatchCount; batch++)
+		{
+			for (uint32_t triangle : m_TileBins[batch * tileCount + tile])
+			{
+				const OcclusionTriangle &setup = m_Triangles[triangle];
+				RasterizeTriangle(setup, std::max(setup.MinX, tileMinX), std::max(setup.MinY, tileMinY), std::min(setup.MaxX, tileMaxX), std::min(setup.MaxY, tileMaxY));
+			}
+		}
+
+		float maxDepth = 0.0f;
+		for (int y = tileMinY; y <= tileMaxY; y++)
+		{
+			for (int x = tileMinX; x <= tileMaxX; x++)
+			{
+				maxDepth = std::max(maxDepth, m_Depth[y * m_Width + x]);
+			}
+		}
+		m_TileMaxDepth[tile] = maxDepth;
+	}
+
+	void SoftwareOcclusion::RasterizeTriangle(const OcclusionTriangle &triangle, int minX, int minY, int maxX, int maxY)
+	{
+		// Samples at the pixel centres. Rows are walked in groups of 4 aligned pixels, tiles are a multiple of 4 wide so groups never leave the tile
+		// and the pixels outside the bounds fail the edge tests
+		minX &= ~3;
+		for (int y = minY; y <= maxY; y++)
+		{
+			const float pixelY = y + 0.5f;
+			float *row = &m_Depth[y * m_Width];
+#ifdef ARC_OCCLUSION_SSE
+			const __m128 zero = _mm_setzero_ps();
+			__m128 edgeRow[3], edgeStepX[3];
+			for (int i = 0; i < 3; i++)
+			{
+				edgeRow[i] = _mm_set1_ps(triangle.EdgeB[i] * pixelY + triangle.EdgeC[i]);
+				edgeStepX[i] = _mm_set1_ps(triangle.EdgeA[i]);
+			}
+			const __m128 depthRow = _mm_set1_ps(triangle.DepthB * pixelY + triangle.DepthC), depthStepX = _mm_set1_ps(triangle.DepthA);
+
+			for (int x = minX; x <= maxX; x += 4)
+			{
+				const __m128 pixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f));
+				__m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeStepX[0], pixelX), edgeRow[0]), zero);
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeStepX[1], pixelX), edgeRow[1]), zero));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeStepX[2], pixelX), edgeRow[2]), zero));
+				if (_mm_movemask_ps(inside) == 0)
+					continue;
+
+				const __m128 depth = _mm_add_ps(_mm_mul_ps(depthStepX, pixelX), depthRow);
+				const __m128 previousDepth = _mm_loadu_ps(row + x);
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, _mm_min_ps(depth, previousDepth)), _mm_andnot_ps(inside, previousDepth)));
+			}
+#else
+			for (int x = minX; x <= maxX; x++)
+			{
+				const float pixelX = x + 0.5f;
+				bool inside = true;
+				for (int i = 0; i < 3; i++)
+				{
+					inside = inside && triangle.EdgeA[i] * pixelX + triangle.EdgeB[i] * pixelY + triangle.EdgeC[i] >= 0.0f;
+				}
+				if (inside)
+					row[x] = std::min(row[x], triangle.DepthA * pixelX + triangle.DepthB * pixelY + triangle.DepthC);
+			}
+#endif
+		}
+	}
+
+	bool SoftwareOcclusion::IsVisible(const glm::vec4 &sphere) const
+	{
+		// Projects the corners of the sphere's bounding box, boxes crossing the near plane are always visible
+		glm::vec3 minNDC(1.0f), maxNDC(-1.0f);
+		for (int i = 0; i < 8; i++)
+		{
+			glm::vec3 corner = glm::vec3(sphere) + sphere.w * glm::vec3((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+			glm::vec4 clip = m_ViewProjection * glm::vec4(corner, 1.0f);
+			if (clip.w <= 0.0f || clip.z < 0.0f)
+				return true;
+
+			glm::vec3 ndc = glm::vec3(clip) / clip.w;
+			minNDC = glm::min(minNDC, ndc);
+			maxNDC = glm::max(maxNDC, ndc);
+		}
+
+		// Every pixel the rectangle touches has to be covered by a nearer occluder
+		const float nearestDepth = minNDC.z;
+		const int minX = std::max(0, static_cast<int>(std::floor((minNDC.x * 0.5f + 0.5f) * m_Width)));
+		const int minY = std::max(0, static_cast<int>(std::floor((minNDC.y * 0.5f + 0.5f) * m_Height)));
+		const int maxX = std::min(static_cast<int>(m_Width) - 1, static_cast<int>(std::floor((maxNDC.x * 0.5f + 0.5f) * m_Width)));
+		const int maxY = std::min(static_cast<int>(m_Height) - 1, static_cast<int>(std::floor((maxNDC.y * 0.5f + 0.5f) * m_Height)));
+		if (minX > maxX || minY > maxY)
+			return false; // Off screen, frustum culling normally rejects these first
+
+		for (int tileY = minY / static_cast<int>(TILE_HEIGHT); tileY <= maxY / static_cast<int>(TILE_HEIGHT); tileY++)
+		{
+			for (int tileX = minX / static_cast<int>(TILE_WIDTH); tileX <= maxX / static_cast<int>(TILE_WIDTH); tileX++)
+			{
+				// Nearly every tile of an occluded object is entirely in front of it
+				if (m_TileMaxDepth[tileY * m_TileCountX + tileX] < nearestDepth)
+					continue;
+
+				const int pixelMinX = std::max(minX, tileX * static_cast<int>(TILE_WIDTH)), pixelMaxX = std::min(maxX, (tileX + 1) * static_cast<int>(TILE_WIDTH) - 1);
+				const int pixelMinY = std::max(minY, tileY * static_cast<int>(TILE_HEIGHT)), pixelMaxY = std::min(maxY, (tileY + 1) * static_cast<int>(TILE_HEIGHT) - 1);
+				for (int y = pixelMinY; y <= pixelMaxY; y++)
+				{
+					const float *row = &m_Depth[y * m_Width];
+					int x = pixelMinX;
+#ifdef ARC_OCCLUSION_SSE
+					const __m128 nearest = _mm_set1_ps(nearestDepth);
+					for (; x + 3 <= pixelMaxX; x += 4)
+					{
+						if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), nearest)) != 0)
+							return true;
+					}
+#endif
+					for (; x <= pixelMaxX; x++)
+					{
+						if (row[x] >= nearestDepth)
+							return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+	void SoftwareOcclusion::CullSpheres(const std::vector<glm::vec4> &spheres, const std::vector<uint32_t> &candidates, std::vector<uint32_t> &outVisible)
+	{
+		double startTime = Profiler::GetTimeMs();
+		const uint32_t candidateCount = static_cast<uint32_t>(candidates.size());
+		m_CandidateVisible.resize(candidateCount);
+
+		auto testCandidates = [this, &spheres, &candidates](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; i++)
+			{
+				m_CandidateVisible[i] = IsVisible(spheres[candidates[i]]) ? 1 : 0;
+			}
+		};
+		if (JobSystem::IsInitialized())
+			JobSystem::ParallelFor(candidateCount, TEST_BATCH_SIZE, testCandidates);
+		else
+			testCandidates(0, candidateCount);
+
+		outVisible.clear();
+		for (uint32_t i = 0; i < candidateCount; i++)
+		{
+			if (m_CandidateVisible[i])
+				outVisible.push_back(candidates[i]);
+		}
+
+		FrameStats &stats = Profiler::GetInstance().GetCurrentFrameStats();
+		stats.SoftwareOcclusionTestTime += Profiler::GetTimeMs() - startTime;
+		stats.SoftwareOcclusionTestedCount += candidateCount;
+		stats.SoftwareOcclusionCulledCount += candidateCount - static_cast<uint32_t>(outVisible.size());
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+namespace Arcane
+{
+	// Occluder triangle projected to the depth buffer's pixels, set up for edge function rasterization
+	struct OcclusionTriangle
+	{
+		float EdgeA[3], EdgeB[3], EdgeC[3]; // Edge functions A * x + B * y + C, positive inside
+		float DepthA, DepthB, DepthC; // Depth plane over the pixel coordinates
+		int MinX, MinY, MaxX, MaxY; // Inclusive pixel bounds, clamped to the buffer
+	};
+
+	// Rasterizes designated occluder meshes into a small depth buffer on the CPU every frame, so objects can be occlusion tested before any command recording and
+	// hidden objects never cost a draw call. Unlike the GPU depth pyramid there is no frame of latency and nothing has to be drawn indirectly.
+	// The buffer is split into tiles: the triangles are transformed and binned into the tiles they touch in parallel, then every tile is rasterized by a single job
+	// so no two threads write the same pixels. Pixels are shaded 4 at a time with SSE (scalar elsewhere), and each tile keeps its farthest depth so most of an
+	// object's tests are answered without looking at the pixels.
+	// Occluders only cover the pixels whose centre they cover, so they can hide an object that peeks through less than a pixel
+	class SoftwareOcclusion
+	{
+	public:
+		// The width has to be a multiple of TILE_WIDTH and the height a multiple of TILE_HEIGHT
+		SoftwareOcclusion(uint32_t width = 256, uint32_t height = 128);
+
+		// Occluders are stored in world space, they should be closed, simplified versions of large meshes that are fully inside the real ones
+		void AddOccluder(const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices, const glm::mat4 &transform);
+		void ClearOccluders();
+
+		// Clears the depth and rasterizes every occluder, the view projection has to use a zero to one depth range
+		void RasterizeOccluders(const glm::mat4 &viewProjection);
+
+		// Conservative test of a world space bounding sphere against the last rasterized occluders
+		bool IsVisible(const glm::vec4 &sphere) const;
+		// Tests the candidates (indices into spheres, for example the output of CpuCulling) on the job system and outputs the visible ones in the same order
+		void CullSpheres(const std::vector<glm::vec4> &spheres, const std::vector<uint32_t> &candidates, std::vector<uint32_t> &outVisible);
+
+		// Getters
+		inline uint32_t GetWidth() const { return m_Width; }
+		inline uint32_t GetHeight() const { return m_Height; }
+		inline uint32_t GetOccluderTriangleCount() const { return static_cast<uint32_t>(m_OccluderIndices.size() / 3); }
+		inline float GetDepth(uint32_t x, uint32_t y) const { return m_Depth[y * m_Width + x]; }
+
+		static const uint32_t TILE_WIDTH = 32;
+		static const uint32_t TILE_HEIGHT = 8;
+	private:
+		bool SetupTriangle(const glm::vec4 &clip0, const glm::vec4 &clip1, const glm::vec4 &clip2, OcclusionTriangle &outTriangle) const;
+		void RasterizeTile(uint32_t tile);
+		void RasterizeTriangle(const OcclusionTriangle &triangle, int minX, int minY, int maxX, int maxY);
+	private:
+		uint32_t m_Width, m_Height;
+		uint32_t m_TileCountX, m_TileCountY;
+		glm::mat4 m_ViewProjection;
+
+		std::vector<glm::vec3> m_OccluderPositions;
+		std::vector<uint32_t> m_OccluderIndices;
+
+		std::vector<float> m_Depth; // Nearest occluder depth, 1 where nothing was drawn
+		std::vector<float> m_TileMaxDepth; // Farthest depth of every tile
+
+		// Every binning job has its own list per tile so binning never needs a lock, [batch * tileCount + tile]
+		std::vector<OcclusionTriangle> m_Triangles;
+		std::vector<std::vector<uint32_t>> m_TileBins;
+		uint32_t m_BinBatchCount;
+
+		std::vector<uint8_t> m_CandidateVisible;
+
+		static const uint32_t TRIANGLE_BATCH_SIZE = 1024;
+		static const uint32_t TEST_BATCH_SIZE = 1024;
+	};
+}
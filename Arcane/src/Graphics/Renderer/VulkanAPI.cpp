@@ -6,20 +6,42 @@
 #include "Defs.h"
 #include "Core/Window.h"
 #include "Core/FileUtils.h"
+#include "Core/JobSystem.h"
+#include "Core/Profiler.h"
 #include "Graphics/Shader.h"
 #include "Graphics/ShaderLoader.h"
 #include "Graphics/Texture/Texture.h"
 #include "Graphics/Texture/TextureLoader.h"
-#include "Graphics/Buffer/VertexBuffer.h"
-#include "Graphics/Buffer/IndexBuffer.h"
+#include "Graphics/Buffer/IndirectDrawBuffer.h"
+#include "Graphics/Buffer/InstanceBuffer.h"
+#include "Graphics/Buffer/GeometryPool.h"
+#include "Graphics/Mesh/Mesh.h"
+#include "Graphics/Mesh/MeshletBuilder.h"
+#include "Graphics/Mesh/MeshOptimizer.h"
+#include "Graphics/Mesh/MeshSimplifier.h"
+#include "Graphics/Mesh/VertexQuantizer.h"
+#include "Graphics/Renderer/AsyncCompute.h"
+#include "Graphics/Renderer/ClusterCulling.h"
+#include "Graphics/Renderer/CpuCulling.h"
+#include "Graphics/Renderer/GpuTimer.h"
+#include "Graphics/Renderer/GpuCulling.h"
+#include "Graphics/Renderer/GpuPipelineStatistics.h"
+#include "Graphics/Renderer/OcclusionCulling.h"
+#include "Graphics/Renderer/Renderer.h"
+#include "Graphics/Renderer/SoftwareOcclusion.h"
 #include "Vendor/ImGui/imgui.h"
 
 namespace Arcane
 {
 	VulkanAPI::VulkanAPI(const Window *const window)
-		: m_Window(window), m_Instance(VK_NULL_HANDLE), m_PhysicalDevice(VK_NULL_HANDLE), m_Device(VK_NULL_HANDLE), m_Swapchain(VK_NULL_HANDLE), m_SwapchainImageFormat(VK_FORMAT_UNDEFINED),
-		m_SwapchainExtent(), m_Surface(VK_NULL_HANDLE), m_GraphicsQueue(VK_NULL_HANDLE), m_ComputeQueue(VK_NULL_HANDLE), m_CopyQueue(VK_NULL_HANDLE), m_PresentQueue(VK_NULL_HANDLE), m_GraphicsCommandPool(VK_NULL_HANDLE),
-		m_DebugMessenger(VK_NULL_HANDLE)
+		: m_Window(window), m_Instance(VK_NULL_HANDLE), m_PhysicalDevice(VK_NULL_HANDLE), m_Device(VK_NULL_HANDLE), m_ResourceStateTracker(nullptr), m_Swapchain(VK_NULL_HANDLE),
+		m_SwapchainImageFormat(VK_FORMAT_UNDEFINED), m_SwapchainExtent(), m_Surface(VK_NULL_HANDLE), m_RenderGraph(nullptr), m_MainPass(nullptr), m_DepthPrepassPass(nullptr),
+		m_FrameDraws(nullptr), m_FrameLateDraws(nullptr), m_FramePrepassDraws(nullptr), m_FrameRecordThreadCount(1), m_GraphicsQueue(VK_NULL_HANDLE), m_ComputeQueue(VK_NULL_HANDLE),
+		m_CopyQueue(VK_NULL_HANDLE), m_PresentQueue(VK_NULL_HANDLE), m_GraphicsCommandPool(VK_NULL_HANDLE), m_CommandRecorder(nullptr), m_RecordThreadCount(1), m_Renderer(nullptr),
+		m_InstanceBuffer(nullptr), m_IndirectDrawBuffer(nullptr), m_AsyncCompute(nullptr), m_GraphicsTimer(nullptr), m_GraphicsStatistics(nullptr), m_GpuCulling(nullptr),
+		m_GpuCullingWork(0), m_OcclusionCulling(nullptr), m_ClusterCulling(nullptr), m_PipelineCache(nullptr), m_DepthPrepassShader(nullptr), m_QuantizedShader(nullptr),
+		m_SceneMeshBoundingSphere(0.0f), m_SceneCulling(nullptr), m_SoftwareOcclusion(nullptr),
+		m_SoftwareOcclusionReference(nullptr), m_DebugMessenger(VK_NULL_HANDLE)
 	{
 	
 	}
@@ -49,19 +71,123 @@ namespace Arcane
 		}
 		m_ImagesInFlight[imageIndex] = m_InFlightFences[m_CurrentFrame];
 
-		VkSemaphore waitSemaphores[] = { m_ImageAvailableSemaphore[m_CurrentFrame] };
+		UpdateGpuFrameStats();
+
+		// Compute goes first so the compute queue is already busy while the CPU records the graphics work, graphics only waits for it where it reads the results
+		VkSemaphore computeFinishedSemaphore = m_AsyncCompute->Execute(static_cast<uint32_t>(m_CurrentFrame));
+
+		// The fence guarantees the GPU is done with everything allocated from this frame's pool, so all of its command buffers can be reset at once
+		double recordStartTime = Profiler::GetTimeMs();
+		vkResetCommandPool(m_Device, m_FrameCommandPools[m_CurrentFrame], 0);
+		m_CommandRecorder->BeginFrame(static_cast<uint32_t>(m_CurrentFrame));
+		m_IndirectDrawBuffer->BeginFrame(static_cast<uint32_t>(m_CurrentFrame));
+		m_InstanceBuffer->BeginFrame(static_cast<uint32_t>(m_CurrentFrame));
+
+		DrawCommand draw;
+		draw.Pipeline = m_SceneMesh->GetGeometryPool()->GetVertexLayout() == VertexLayout::MESH_QUANTIZED ? &m_QuantizedPipelineDescription : &m_PipelineDescription;
+		draw.DescriptorSet = m_DescriptorSets[imageIndex];
+		m_SceneMesh->SetupDraw(draw);
+		DrawCommand lateDraw;
+		if (m_OcclusionCulling)
+		{
+			// Same as GPU culling, but each phase has its own draw buffer
+			m_OcclusionCulling->BeginFrame(static_cast<uint32_t>(m_CurrentFrame), GetGpuCullView());
+			draw.IndirectArguments = m_OcclusionCulling->GetDrawBuffer(OcclusionCullPhase::EARLY);
+			draw.FirstIndirectDraw = 0;
+			draw.IndirectDrawCount = m_OcclusionCulling->GetObjectCount();
+			lateDraw = draw;
+			lateDraw.IndirectArguments = m_OcclusionCulling->GetDrawBuffer(OcclusionCullPhase::LATE);
+
+			if (m_ClusterCulling)
+			{
+				// The clusters take the place of the copies of the scene mesh in both phases. The scene mesh is at the origin, so its clusters are culled with the world space view
+				m_ClusterCulling->BeginFrame(static_cast<uint32_t>(m_CurrentFrame), GetGpuCullView());
+				draw.IndirectArguments = m_ClusterCulling->GetDrawBuffer(OcclusionCullPhase::EARLY);
+				draw.IndirectDrawCount = m_ClusterCulling->GetClusterCount();
+				lateDraw = draw;
+				lateDraw.IndirectArguments = m_ClusterCulling->GetDrawBuffer(OcclusionCullPhase::LATE);
+			}
+		}
+		else if (m_GpuCulling)
+		{
+			// The culling pass already wrote the commands and the draw count, the CPU only needs the upper bound
+			draw.IndirectArguments = m_GpuCulling->GetDrawBuffer();
+			draw.FirstIndirectDraw = 0;
+			draw.IndirectDrawCount = m_GpuCulling->GetObjectCount();
+		}
+		else if (m_IndirectDrawing)
+		{
+			VkDrawIndexedIndirectCommand command = {};
+			command.indexCount = m_SceneMesh->GetIndexCount();
+			command.instanceCount = 1;
+			command.firstIndex = m_SceneMesh->GetFirstIndex();
+			command.vertexOffset = m_SceneMesh->GetVertexOffset();
+			draw.IndirectArguments = m_IndirectDrawBuffer;
+			draw.FirstIndirectDraw = m_IndirectDrawBuffer->AddDraw(command);
+			draw.IndirectDrawCount = 1;
+		}
+
+		// The prepass draws the same objects with only their positions. The late draws weren't known yet when the prepass ran, so they keep the pipeline
+		// that tests and writes depth
+		DrawCommand prepassDraw = draw;
+		if (m_DepthPrepass)
+		{
+			prepassDraw.Pipeline = &m_DepthPrepassPipelineDescription;
+			draw.Pipeline = &m_EqualDepthPipelineDescription;
+		}
+
+		// Without scene instances the mesh is drawn once at the origin. None of the GPU culling paths draws the instances, so only the ones in the frustum
+		// (and in front of the software occluders) are submitted, each at the level of detail the GPU culling passes would pick for it. Each instance is
+		// sorted by how far its origin is in front of the camera
+		const glm::mat4 view = GetCameraView();
+		const bool drawSceneInstances = !m_SceneInstances.empty() && !draw.IndirectArguments;
+		if (drawSceneInstances)
+		{
+			const GpuCullView cullView = GetGpuCullView();
+			m_SceneCulling->Cull(cullView.ViewProjection, m_VisibleSceneInstances);
+			if (m_SoftwareOcclusion)
+				OcclusionCullSceneInstances(cullView.ViewProjection);
+			m_SceneLodSelection.Select(m_SceneInstanceSpheres, m_VisibleSceneInstances, m_SceneMesh->GetLods(), cullView.CameraPosition, cullView.LodErrorScale, m_LodSettings);
+		}
+		const size_t sceneInstanceCount = drawSceneInstances ? m_VisibleSceneInstances.size() : 1;
+		float viewDepth = -view[3].z; // The late draws are of the mesh at the origin
+		m_Renderer->BeginFrame();
+		for (size_t i = 0; i < sceneInstanceCount; i++)
+		{
+			const uint32_t object = drawSceneInstances ? m_VisibleSceneInstances[i] : 0;
+			const InstanceData instance = drawSceneInstances ? m_SceneInstances[object] : InstanceData();
+			float instanceViewDepth = -(view * instance.transform[3]).z;
+			if (drawSceneInstances)
+			{
+				// The levels are ranges of the same indices, so only the range changes
+				const uint32_t lod = m_SceneLodSelection.GetLod(object);
+				draw.FirstIndex = prepassDraw.FirstIndex = m_SceneMesh->GetFirstIndex(lod);
+				draw.IndexCount = prepassDraw.IndexCount = m_SceneMesh->GetIndexCount(lod);
+			}
+			if (m_DepthPrepass)
+				m_Renderer->Submit(DrawPass::DEPTH_PREPASS, prepassDraw, instance, instanceViewDepth);
+			m_Renderer->Submit(DrawPass::MAIN, draw, instance, instanceViewDepth);
+		}
+		if (m_OcclusionCulling)
+			m_Renderer->Submit(DrawPass::MAIN_LATE, lateDraw, InstanceData(), viewDepth);
+		m_Renderer->Sort();
+		RecordCommandBuffer(m_FrameCommandBuffers[m_CurrentFrame], imageIndex, m_Renderer->GetSortedDraws(DrawPass::MAIN), m_RecordThreadCount, &m_Renderer->GetSortedDraws(DrawPass::MAIN_LATE),
+			&m_Renderer->GetSortedDraws(DrawPass::DEPTH_PREPASS));
+		Profiler::GetInstance().GetCurrentFrameStats().CommandRecordTime += Profiler::GetTimeMs() - recordStartTime;
+
+		VkSemaphore waitSemaphores[] = { m_ImageAvailableSemaphore[m_CurrentFrame], computeFinishedSemaphore };
 		VkSemaphore signalSemaphores[] = { m_RenderFinishedSemaphore[m_CurrentFrame] };
-		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT }; // We need to wait on the semaphore at the stage where we write to the colour attachment (after pixel shader)
+		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, m_AsyncCompute->GetConsumerStages() }; // We need to wait on the semaphore at the stage where we write to the colour attachment (after pixel shader)
 
 		UpdateUniformBuffer(imageIndex);
 
 		VkSubmitInfo submitInfo = {};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.waitSemaphoreCount = computeFinishedSemaphore != VK_NULL_HANDLE ? 2 : 1;
 		submitInfo.pWaitSemaphores = waitSemaphores;
 		submitInfo.pWaitDstStageMask = waitStages;
 		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &m_GraphicsCommandBuffers[imageIndex];
+		submitInfo.pCommandBuffers = &m_FrameCommandBuffers[m_CurrentFrame];
 		submitInfo.signalSemaphoreCount = 1;
 		submitInfo.pSignalSemaphores = signalSemaphores;
 
@@ -95,6 +221,235 @@ namespace Arcane
 		m_CurrentFrame = (m_CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 	}
 
+	double VulkanAPI::RecordStressFrame(uint32_t drawCount, uint32_t threadCount, StressRecordMode mode)
+	{
+		ARC_ASSERT(!m_DepthPrepass, "Vulkan: Stress frames don't record a depth prepass, their draws would fail the equal depth test of the main pass");
+		vkDeviceWaitIdle(m_Device); // The frame's pools might still be in use by a frame that was submitted
+
+		DrawCommand draw;
+		draw.Pipeline = m_SceneMesh->GetGeometryPool()->GetVertexLayout() == VertexLayout::MESH_QUANTIZED ? &m_QuantizedPipelineDescription : &m_PipelineDescription;
+		draw.DescriptorSet = m_DescriptorSets[0];
+		m_SceneMesh->SetupDraw(draw);
+		std::vector<DrawCommand> draws;
+
+		double recordStartTime = Profiler::GetTimeMs();
+		vkResetCommandPool(m_Device, m_FrameCommandPools[m_CurrentFrame], 0);
+		m_CommandRecorder->BeginFrame(static_cast<uint32_t>(m_CurrentFrame));
+		m_InstanceBuffer->BeginFrame(static_cast<uint32_t>(m_CurrentFrame));
+		if (mode == StressRecordMode::INSTANCED)
+		{
+			// Submitting and sorting is part of the cost, the objects are laid out on a grid so every one has a transform of its own
+			ARC_ASSERT(drawCount <= MAX_INSTANCES, "Vulkan: Can't record more than {0} instances", MAX_INSTANCES);
+			uint32_t gridSize = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(drawCount))));
+			InstanceData instance;
+			m_Renderer->BeginFrame();
+			for (uint32_t i = 0; i < drawCount; i++)
+			{
+				instance.transform = glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(i % gridSize), 0.0f, -static_cast<float>(i / gridSize)) * 2.0f);
+				m_Renderer->Submit(DrawPass::MAIN, draw, instance, static_cast<float>(i / gridSize) * 2.0f);
+			}
+			m_Renderer->Sort();
+			RecordCommandBuffer(m_FrameCommandBuffers[m_CurrentFrame], 0, m_Renderer->GetSortedDraws(DrawPass::MAIN), threadCount);
+			return Profiler::GetTimeMs() - recordStartTime;
+		}
+
+		// Every draw shares a single identity instance
+		*m_InstanceBuffer->AllocateInstances(1, &draw.FirstInstance) = InstanceData();
+		draw.Instances = m_InstanceBuffer;
+		if (mode == StressRecordMode::INDIRECT)
+		{
+			// Writing the arguments is part of the cost, but it is a plain memory write per object instead of a recorded draw call
+			ARC_ASSERT(drawCount <= MAX_INDIRECT_DRAWS, "Vulkan: Can't record more than {0} indirect draws", MAX_INDIRECT_DRAWS);
+			m_IndirectDrawBuffer->BeginFrame(static_cast<uint32_t>(m_CurrentFrame));
+
+			VkDrawIndexedIndirectCommand command = {};
+			command.indexCount = m_SceneMesh->GetIndexCount();
+			command.instanceCount = 1;
+			command.firstIndex = m_SceneMesh->GetFirstIndex();
+			command.vertexOffset = m_SceneMesh->GetVertexOffset();
+			VkDrawIndexedIndirectCommand *commands = m_IndirectDrawBuffer->AllocateDraws(drawCount, &draw.FirstIndirectDraw);
+			std::fill(commands, commands + drawCount, command);
+
+			draw.IndirectArguments = m_IndirectDrawBuffer;
+			draw.IndirectDrawCount = drawCount;
+			draws.push_back(draw);
+		}
+		else
+		{
+			draws.resize(drawCount, draw);
+		}
+		RecordCommandBuffer(m_FrameCommandBuffers[m_CurrentFrame], 0, draws, threadCount);
+		return Profiler::GetTimeMs() - recordStartTime;
+	}
+
+	void VulkanAPI::EnableGpuCulling(const std::vector<glm::vec4> &boundingSpheres)
+	{
+		if (!m_GpuCulling)
+		{
+			m_GpuCulling = new GpuCulling(this, MAX_GPU_CULL_OBJECTS, static_cast<uint32_t>(m_FrameCommandPools.size()));
+			m_GpuCullingWork = m_AsyncCompute->AddWork([this](VkCommandBuffer commandBuffer, uint32_t frameIndex)
+			{
+				m_GpuCulling->Record(commandBuffer, frameIndex, GetGpuCullView());
+			}, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+		}
+
+		std::vector<GpuCullObject> objects;
+		std::vector<GpuMeshLod> lods;
+		BuildGpuCullObjects(boundingSpheres, objects, lods);
+		m_GpuCulling->SetObjects(objects, lods);
+	}
+
+	void VulkanAPI::DisableGpuCulling()
+	{
+		if (!m_GpuCulling)
+			return;
+
+		vkDeviceWaitIdle(m_Device);
+		m_AsyncCompute->RemoveWork(m_GpuCullingWork);
+		delete m_GpuCulling;
+		m_GpuCulling = nullptr;
+	}
+
+	void VulkanAPI::EnableOcclusionCulling(const std::vector<glm::vec4> &boundingSpheres)
+	{
+		if (!m_OcclusionCulling)
+		{
+			m_OcclusionCulling = new OcclusionCulling(this, MAX_GPU_CULL_OBJECTS, static_cast<uint32_t>(m_FrameCommandPools.size()));
+			RebuildRenderGraph();
+		}
+
+		std::vector<GpuCullObject> objects;
+		std::vector<GpuMeshLod> lods;
+		BuildGpuCullObjects(boundingSpheres, objects, lods);
+		m_OcclusionCulling->SetObjects(objects, lods);
+	}
+
+	void VulkanAPI::DisableOcclusionCulling()
+	{
+		if (!m_OcclusionCulling)
+			return;
+
+		vkDeviceWaitIdle(m_Device);
+		delete m_ClusterCulling;
+		m_ClusterCulling = nullptr;
+		delete m_OcclusionCulling;
+		m_OcclusionCulling = nullptr;
+		RebuildRenderGraph();
+	}
+
+	void VulkanAPI::EnableClusterCulling()
+	{
+		ARC_ASSERT(m_OcclusionCulling, "Vulkan: Cluster culling tests against the occlusion culling's depth pyramid, occlusion culling has to be enabled first");
+		if (m_ClusterCulling)
+			return;
+
+		const std::vector<Meshlet> &meshlets = m_SceneMesh->GetMeshlets();
+		std::vector<GpuCluster> clusters(meshlets.size());
+		for (uint32_t i = 0; i < meshlets.size(); i++)
+		{
+			clusters[i].BoundingSphere = meshlets[i].BoundingSphere;
+			clusters[i].Cone = meshlets[i].Cone;
+			clusters[i].FirstIndex = m_SceneMesh->GetMeshletFirstIndex(i);
+			clusters[i].IndexCount = meshlets[i].IndexCount;
+			clusters[i].VertexOffset = m_SceneMesh->GetVertexOffset();
+		}
+
+		m_ClusterCulling = new ClusterCulling(this, m_OcclusionCulling, std::max(static_cast<uint32_t>(clusters.size()), 1u), static_cast<uint32_t>(m_FrameCommandPools.size()));
+		m_ClusterCulling->SetClusters(clusters);
+		RebuildRenderGraph();
+	}
+
+	void VulkanAPI::DisableClusterCulling()
+	{
+		if (!m_ClusterCulling)
+			return;
+
+		vkDeviceWaitIdle(m_Device);
+		delete m_ClusterCulling;
+		m_ClusterCulling = nullptr;
+		RebuildRenderGraph();
+	}
+
+	void VulkanAPI::SetSceneInstances(const std::vector<InstanceData> &instances)
+	{
+		m_SceneInstances = instances;
+		UpdateSceneInstanceBounds();
+	}
+
+	void VulkanAPI::SetSoftwareOcclusion(bool softwareOcclusion, bool measureAccuracy)
+	{
+		delete m_SoftwareOcclusion;
+		delete m_SoftwareOcclusionReference;
+		m_SoftwareOcclusion = softwareOcclusion ? new SoftwareOcclusion() : nullptr;
+		m_SoftwareOcclusionReference = (softwareOcclusion && measureAccuracy) ? new SoftwareOcclusion(m_SoftwareOcclusion->GetWidth() * 8, m_SoftwareOcclusion->GetHeight() * 8) : nullptr;
+		if (softwareOcclusion && m_SceneMeshIndices.size() / 3 > MAX_SOFTWARE_OCCLUDER_TRIANGLES)
+		{
+			ARC_LOG_WARN("Vulkan: The scene mesh has more than {0} triangles, software occlusion has no occluders to cull with", MAX_SOFTWARE_OCCLUDER_TRIANGLES);
+		}
+	}
+
+	void VulkanAPI::SetSceneMesh(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices)
+	{
+		ARC_ASSERT(!m_GpuCulling && !m_OcclusionCulling, "Vulkan: The GPU culling paths copied the scene mesh's ranges, disable them before replacing it");
+
+		vkDeviceWaitIdle(m_Device);
+		delete m_SceneMesh;
+		m_SceneMesh = CreateSceneMesh(vertices, indices, false);
+		UpdateSceneInstanceBounds();
+	}
+
+	void VulkanAPI::SetQuantizedSceneMesh(const std::vector<MeshVertex> &vertices, const std::vector<uint32_t> &indices)
+	{
+		ARC_ASSERT(!m_GpuCulling && !m_OcclusionCulling, "Vulkan: The GPU culling paths copied the scene mesh's ranges, disable them before replacing it");
+		ARC_ASSERT(!m_DepthPrepass, "Vulkan: The depth prepass pipeline reads the standard vertex layout, it can't draw a quantized scene mesh");
+
+		vkDeviceWaitIdle(m_Device);
+		delete m_SceneMesh;
+
+		// Only loaded once a quantized mesh is first drawn, most runs never use them
+		if (!m_QuantizedShader)
+		{
+			m_QuantizedShader = ShaderLoader::LoadShader("res/Shaders/mesh_quantized_vert.spv", "res/Shaders/simple_frag.spv");
+			CreateQuantizedPipeline();
+		}
+
+		// The rest of the mesh optimizer only works on the standard layout, the triangle order doesn't depend on it
+		std::vector<uint32_t> optimizedIndices(indices);
+		MeshOptimizer::OptimizeVertexCache(optimizedIndices, static_cast<uint32_t>(vertices.size()));
+		std::vector<QuantizedMeshVertex> quantizedVertices(vertices.size());
+		glm::mat4 dequantizeTransform = VertexQuantizer::Quantize(vertices.data(), vertices.size(), quantizedVertices.data());
+		m_SceneMesh = new Mesh(GetGeometryPool(VertexLayout::MESH_QUANTIZED, static_cast<uint32_t>(vertices.size())), quantizedVertices.data(), static_cast<uint32_t>(quantizedVertices.size()), optimizedIndices.data(),
+			static_cast<uint32_t>(optimizedIndices.size()), std::vector<MeshLod>(), std::vector<Meshlet>(), dequantizeTransform);
+
+		// The instances are culled with the positions before quantization, the dequantize transform only maps the quantized positions back to them
+		std::vector<glm::vec3> positions(vertices.size());
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			positions[i] = vertices[i].position;
+		}
+		SetSceneMeshGeometry(positions, optimizedIndices);
+		UpdateSceneInstanceBounds();
+	}
+
+	void VulkanAPI::SetDepthPrepass(bool depthPrepass)
+	{
+		if (m_DepthPrepass == depthPrepass)
+			return;
+
+		m_DepthPrepass = depthPrepass;
+		if (m_Device == VK_NULL_HANDLE)
+			return; // InitVulkan() builds the graph and loads the prepass shader with the new setting
+
+		ARC_ASSERT(!m_DepthPrepass || m_SceneMesh->GetGeometryPool()->GetVertexLayout() != VertexLayout::MESH_QUANTIZED, "Vulkan: The depth prepass pipeline reads the standard vertex layout, it can't draw a quantized scene mesh");
+
+		// Only loaded once the prepass is first turned on, most runs never use it
+		if (m_DepthPrepass && !m_DepthPrepassShader)
+		{
+			m_DepthPrepassShader = ShaderLoader::LoadShader("res/Shaders/depth_vert.spv", "");
+		}
+		RebuildRenderGraph();
+	}
+
 	void VulkanAPI::InitVulkan()
 	{
 		CreateInstance();
@@ -104,13 +459,11 @@ namespace Arcane
 		CreateLogicalDeviceAndQueues();
 		CreateSwapchain();
 		CreateSwapchainImageViews();
-		CreateDepthResources();
-		CreateRenderPass();
-		CreateDescriptorSetLayout();
+		CreateRenderGraph();
 		CreateCommandPool();
 		CreateTemporaryResources();
+		CreateDescriptorSetLayout(); // Generated from the shader's reflection so the shader needs to be loaded first
 		CreateGraphicsPipeline();
-		CreateFramebuffers();
 		CreateTextureSamplers();
 		CreateUniformBuffers();
 		CreateDescriptorPool();
@@ -148,7 +501,7 @@ namespace Arcane
 
 	void VulkanAPI::CreateBuffer(VkDeviceSize bufferSize, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkSharingMode sharingMode, VkBuffer *outBuffer, VkDeviceMemory *outBufferMemory) const
 	{
-		std::array<uint32_t, 2> allowedQueues{ m_DeviceQueueIndices.graphicsQueue.value(), m_DeviceQueueIndices.copyQueue.value() };
+		std::array<uint32_t, 3> allowedQueues{ m_DeviceQueueIndices.graphicsQueue.value(), m_DeviceQueueIndices.computeQueue.value(), m_DeviceQueueIndices.copyQueue.value() };
 
 		VkBufferCreateInfo bufferInfo = {};
 		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -180,7 +533,7 @@ namespace Arcane
 		vkBindBufferMemory(m_Device, *outBuffer, *outBufferMemory, 0); // Associates the allocated memory with the buffer
 	}
 
-	void VulkanAPI::CreateImage2D(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkSharingMode sharingMode, VkImage *outImage, VkDeviceMemory *outTextureMemory) const
+	void VulkanAPI::CreateImage2D(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkSharingMode sharingMode, VkImage *outImage, VkDeviceMemory *outTextureMemory, uint32_t mipLevels) const
 	{
 		std::array<uint32_t, 2> allowedQueues{ m_DeviceQueueIndices.graphicsQueue.value(), m_DeviceQueueIndices.copyQueue.value() };
 
@@ -191,7 +544,7 @@ namespace Arcane
 		imageInfo.extent.width = static_cast<uint32_t>(width);
 		imageInfo.extent.height = static_cast<uint32_t>(height);
 		imageInfo.extent.depth = 1;
-		imageInfo.mipLevels = 1;
+		imageInfo.mipLevels = mipLevels;
 		imageInfo.arrayLayers = 1;
 		imageInfo.format = format;
 		imageInfo.tiling = tiling;
@@ -223,19 +576,38 @@ namespace Arcane
 		vkBindImageMemory(m_Device, *outImage, *outTextureMemory, 0);
 	}
 
-	void VulkanAPI::CopyBuffer(VkBuffer srcBuffer, VkBuffer destBuffer, VkDeviceSize size) const
+	void VulkanAPI::CopyBuffer(VkBuffer srcBuffer, VkBuffer destBuffer, VkDeviceSize size, VkDeviceSize srcOffset, VkDeviceSize destOffset) const
 	{
 		VkBufferCopy copyRegion = {};
 		copyRegion.size = size;
-		copyRegion.srcOffset = 0;
-		copyRegion.dstOffset = 0;
+		copyRegion.srcOffset = srcOffset;
+		copyRegion.dstOffset = destOffset;
 
 		VkCommandBuffer commandBuffer = BeginSingleUseCommands(m_CopyCommandPool);
 		vkCmdCopyBuffer(commandBuffer, srcBuffer, destBuffer, 1, &copyRegion);
 		EndSingleUseCommands(commandBuffer, m_CopyCommandPool, m_CopyQueue);
 	}
 
-	void VulkanAPI::CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) const
+	void VulkanAPI::UploadToBuffer(VkBuffer destBuffer, const void *data, VkDeviceSize size, VkDeviceSize destOffset) const
+	{
+		if (size == 0)
+			return;
+
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingBufferMemory;
+		CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_SHARING_MODE_CONCURRENT, &stagingBuffer, &stagingBufferMemory);
+
+		void *mappedMemory;
+		vkMapMemory(m_Device, stagingBufferMemory, 0, size, 0, &mappedMemory);
+		memcpy(mappedMemory, data, static_cast<size_t>(size));
+		vkUnmapMemory(m_Device, stagingBufferMemory);
+
+		CopyBuffer(stagingBuffer, destBuffer, size, 0, destOffset);
+		vkDestroyBuffer(m_Device, stagingBuffer, nullptr);
+		vkFreeMemory(m_Device, stagingBufferMemory, nullptr);
+	}
+
+	void VulkanAPI::CopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) const
 	{
 		VkBufferImageCopy copyRegion = {};
 		copyRegion.bufferOffset = 0;
@@ -248,68 +620,20 @@ namespace Arcane
 		copyRegion.imageOffset = { 0, 0, 0 };
 		copyRegion.imageExtent = { width, height, 1 };
 
-		VkCommandBuffer commandBuffer = BeginSingleUseCommands(m_CopyCommandPool);
 		vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
-		EndSingleUseCommands(commandBuffer, m_CopyCommandPool, m_CopyQueue);
 	}
 
-	void VulkanAPI::TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) const
+	VkCommandBuffer VulkanAPI::BeginUploadCommands() const
 	{
-		VkCommandBuffer commandBuffer = BeginSingleUseCommands(m_GraphicsCommandPool);
-
-		VkPipelineStageFlags sourceStage, destStage;
-
-		VkImageMemoryBarrier barrier = {};
-		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-		barrier.pNext = nullptr;
-		barrier.oldLayout = oldLayout;
-		barrier.newLayout = newLayout;
-		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.image = image;
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		barrier.subresourceRange.baseMipLevel = 0;
-		barrier.subresourceRange.levelCount = 1;
-		barrier.subresourceRange.baseArrayLayer = 0;
-		barrier.subresourceRange.layerCount = 1;
-		if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-		{
-			barrier.srcAccessMask = 0;
-			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT; // Transfer writes do not need to wait on anything
-			sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT; // Earliest possible stage
-			destStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-		}
-		else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-		{
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT; // Shader read should wait on transfer writes
-			sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-			destStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		}
-		else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
-		{
-			barrier.srcAccessMask = 0;
-			barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-			sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-			destStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-		}
-		else
-		{
-			ARC_ASSERT(false, "Vulkan: Image Layout Transition - NOT SUPPORTED { {0} -> {1} }", oldLayout, newLayout);
-		}
-
-		vkCmdPipelineBarrier(commandBuffer,
-			sourceStage, // Specifies in which pipeline stage the operations occur that should happen before the barrier (producer) (Slowest case is when this is set to VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT ie finish all work before proceeding)
-			destStage, // Specifies the pipeline stage in which operations will wait on the barrier (consumer) (Slowest case is when this is set to VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT and the source is set to VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, then it has to wait for the previous work to finish before doing any new work)
-			0,
-			0, nullptr,
-			0, nullptr,
-			1, &barrier);
+		return BeginSingleUseCommands(m_GraphicsCommandPool);
+	}
 
+	void VulkanAPI::SubmitUploadCommands(VkCommandBuffer commandBuffer) const
+	{
 		EndSingleUseCommands(commandBuffer, m_GraphicsCommandPool, m_GraphicsQueue);
 	}
 
-	VkImageView VulkanAPI::CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) const
+	VkImageView VulkanAPI::CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t baseMipLevel, uint32_t mipLevelCount) const
 	{
 		VkImageViewCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -321,8 +645,8 @@ namespace Arcane
 		createInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
 		createInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
 		createInfo.subresourceRange.aspectMask = aspectFlags;
-		createInfo.subresourceRange.baseMipLevel = 0;
-		createInfo.subresourceRange.levelCount = 1;
+		createInfo.subresourceRange.baseMipLevel = baseMipLevel;
+		createInfo.subresourceRange.levelCount = mipLevelCount;
 		createInfo.subresourceRange.baseArrayLayer = 0;
 		createInfo.subresourceRange.layerCount = 1;
 
@@ -348,13 +672,37 @@ namespace Arcane
 			vkDestroyFence(m_Device, m_InFlightFences[i], nullptr);
 		}
 
+		delete m_CommandRecorder;
+		delete m_Renderer;
+		delete m_InstanceBuffer;
+		delete m_IndirectDrawBuffer;
+		delete m_GpuCulling;
+		delete m_ClusterCulling;
+		delete m_OcclusionCulling;
+		delete m_AsyncCompute;
+		delete m_GraphicsTimer;
+		delete m_GraphicsStatistics;
+		for (size_t i = 0; i < m_FrameCommandPools.size(); i++)
+		{
+			vkDestroyCommandPool(m_Device, m_FrameCommandPools[i], nullptr);
+		}
 		vkDestroyCommandPool(m_Device, m_GraphicsCommandPool, nullptr);
 		vkDestroyCommandPool(m_Device, m_CopyCommandPool, nullptr);
 
+		delete m_PipelineCache;
+		delete m_ResourceStateTracker;
 		delete m_Shader;
+		delete m_DepthPrepassShader;
+		delete m_QuantizedShader;
 		delete m_Texture;
-		delete m_VertexBuffer;
-		delete m_IndexBuffer;
+		delete m_SceneMesh;
+		delete m_SceneCulling;
+		delete m_SoftwareOcclusion;
+		delete m_SoftwareOcclusionReference;
+		for (GeometryPool *geometryPool : m_GeometryPools)
+		{
+			delete geometryPool;
+		}
 		vkDestroySampler(m_Device, m_GenericTextureSampler, nullptr);
 
 		vkDestroyDevice(m_Device, nullptr);
@@ -371,11 +719,12 @@ namespace Arcane
 	{
 		vkDeviceWaitIdle(m_Device);
 
-		vkFreeCommandBuffers(m_Device, m_GraphicsCommandPool, static_cast<uint32_t>(m_GraphicsCommandBuffers.size()), m_GraphicsCommandBuffers.data());
-
-		vkDestroyPipeline(m_Device, m_GraphicsPipeline, nullptr);
+		m_PipelineCache->Clear(); // Pipelines are created against the render graph's render passes that get destroyed below
 		vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
-		vkDestroyRenderPass(m_Device, m_RenderPass, nullptr);
+		delete m_RenderGraph;
+		m_RenderGraph = nullptr;
+		m_MainPass = nullptr;
+		m_DepthPrepassPass = nullptr;
 
 		for (size_t i = 0; i < m_SwapchainImages.size(); i++)
 		{
@@ -385,13 +734,6 @@ namespace Arcane
 
 		vkDestroyDescriptorPool(m_Device, m_DescriptorPool, nullptr);
 
-		vkDestroyImageView(m_Device, m_DepthImageView, nullptr);
-		vkDestroyImage(m_Device, m_DepthImage, nullptr);
-		vkFreeMemory(m_Device, m_DepthImageMemory, nullptr);
-
-		for (size_t i = 0; i < m_SwapchainFramebuffers.size(); i++)
-			vkDestroyFramebuffer(m_Device, m_SwapchainFramebuffers[i], nullptr);
-
 		for (size_t i = 0; i < m_SwapchainImageViews.size(); i++)
 			vkDestroyImageView(m_Device, m_SwapchainImageViews[i], nullptr);
 
@@ -471,6 +813,7 @@ namespace Arcane
 		// Finish setting up information after a physical device has been chosen
 		m_DeviceQueueIndices = FindDeviceQueueIndices(m_PhysicalDevice);
 		vkGetPhysicalDeviceMemoryProperties(m_PhysicalDevice, &m_PhysicalDeviceMemoryProperties);
+		vkGetPhysicalDeviceProperties(m_PhysicalDevice, &m_PhysicalDeviceProperties);
 	}
 
 	void VulkanAPI::CreateLogicalDeviceAndQueues()
@@ -489,16 +832,59 @@ namespace Arcane
 			queueCreateInfo[i].pQueuePriorities = &queuePriority;
 		}
 
+		VkPhysicalDeviceFeatures supportedDeviceFeatures;
+		vkGetPhysicalDeviceFeatures(m_PhysicalDevice, &supportedDeviceFeatures);
+
+		// Multi draw indirect lets a single indirect call submit a whole bucket of draws, without it the indirect draws are submitted one call per draw
 		VkPhysicalDeviceFeatures deviceFeatures = {};
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
+		deviceFeatures.multiDrawIndirect = supportedDeviceFeatures.multiDrawIndirect;
+		deviceFeatures.drawIndirectFirstInstance = supportedDeviceFeatures.drawIndirectFirstInstance;
+		m_MultiDrawIndirectEnabled = supportedDeviceFeatures.multiDrawIndirect == VK_TRUE;
+
+		// Pipeline statistics count the frame's fragment shader invocations. The scene passes execute secondary command buffers, which need to inherit the query
+		deviceFeatures.pipelineStatisticsQuery = supportedDeviceFeatures.pipelineStatisticsQuery;
+		deviceFeatures.inheritedQueries = supportedDeviceFeatures.inheritedQueries;
+		m_PipelineStatisticsEnabled = supportedDeviceFeatures.pipelineStatisticsQuery == VK_TRUE && supportedDeviceFeatures.inheritedQueries == VK_TRUE;
+
+		std::vector<const char*> enabledExtensions(m_RequiredExtensions.begin(), m_RequiredExtensions.end());
+
+		// Draw indirect count lets the GPU decide how many draws a bucket has, without it GPU written buckets draw their unused commands with an instance count of 0
+		m_DrawIndirectCountEnabled = IsPhysicalDeviceExtensionAvailable(m_PhysicalDevice, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+		if (m_DrawIndirectCountEnabled)
+		{
+			enabledExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+		}
+
+		// Extended dynamic state is optional, without it every combination of RenderState gets baked into its own pipeline
+		VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extendedDynamicStateFeatures = {};
+		extendedDynamicStateFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+		extendedDynamicStateFeatures.pNext = nullptr;
+		if (IsPhysicalDeviceExtensionAvailable(m_PhysicalDevice, VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME))
+		{
+			VkPhysicalDeviceFeatures2 supportedFeatures = {};
+			supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			supportedFeatures.pNext = &extendedDynamicStateFeatures;
+			vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &supportedFeatures);
+
+			m_ExtendedDynamicStateEnabled = extendedDynamicStateFeatures.extendedDynamicState == VK_TRUE;
+		}
+		if (m_ExtendedDynamicStateEnabled)
+		{
+			enabledExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+		}
+		ARC_LOG_INFO("Vulkan: Extended dynamic state {0}", m_ExtendedDynamicStateEnabled ? "enabled" : "not supported, using baked pipeline variants");
+		ARC_LOG_INFO("Vulkan: Multi draw indirect {0}, draw indirect count {1}, pipeline statistics {2}", m_MultiDrawIndirectEnabled ? "enabled" : "not supported",
+			m_DrawIndirectCountEnabled ? "enabled" : "not supported", m_PipelineStatisticsEnabled ? "enabled" : "not supported");
 
 		VkDeviceCreateInfo deviceCreateInfo = {};
 		deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		deviceCreateInfo.pNext = m_ExtendedDynamicStateEnabled ? &extendedDynamicStateFeatures : nullptr;
 		deviceCreateInfo.pQueueCreateInfos = queueCreateInfo.data();
 		deviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfo.size());
 		deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
-		deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(m_RequiredExtensions.size());
-		deviceCreateInfo.ppEnabledExtensionNames = m_RequiredExtensions.data();
+		deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+		deviceCreateInfo.ppEnabledExtensionNames = enabledExtensions.data();
 		if (m_EnableValidationLayers)
 		{
 			deviceCreateInfo.enabledLayerCount = static_cast<uint32_t>(m_ValidationLayers.size());
@@ -517,19 +903,172 @@ namespace Arcane
 		vkGetDeviceQueue(m_Device, m_DeviceQueueIndices.copyQueue.value(), 0, &m_CopyQueue);
 		vkGetDeviceQueue(m_Device, m_DeviceQueueIndices.presentQueue.value(), 0, &m_PresentQueue); // Present queue will be one of the existing queues
 
+		LoadExtensionFunctions();
+
 		// Finally initialize things that depend on the logical device
 		ShaderLoader::Initialize(this);
 		TextureLoader::Initialize(this);
+		m_PipelineCache = new PipelineCache(this, m_ExtendedDynamicStateEnabled);
+		m_ResourceStateTracker = new ResourceStateTracker();
+	}
+
+	void VulkanAPI::LoadExtensionFunctions()
+	{
+		if (m_ExtendedDynamicStateEnabled)
+		{
+			m_ExtensionFunctions.CmdSetCullMode = reinterpret_cast<PFN_vkCmdSetCullModeEXT>(vkGetDeviceProcAddr(m_Device, "vkCmdSetCullModeEXT"));
+			m_ExtensionFunctions.CmdSetFrontFace = reinterpret_cast<PFN_vkCmdSetFrontFaceEXT>(vkGetDeviceProcAddr(m_Device, "vkCmdSetFrontFaceEXT"));
+			m_ExtensionFunctions.CmdSetPrimitiveTopology = reinterpret_cast<PFN_vkCmdSetPrimitiveTopologyEXT>(vkGetDeviceProcAddr(m_Device, "vkCmdSetPrimitiveTopologyEXT"));
+			m_ExtensionFunctions.CmdSetDepthTestEnable = reinterpret_cast<PFN_vkCmdSetDepthTestEnableEXT>(vkGetDeviceProcAddr(m_Device, "vkCmdSetDepthTestEnableEXT"));
+			m_ExtensionFunctions.CmdSetDepthWriteEnable = reinterpret_cast<PFN_vkCmdSetDepthWriteEnableEXT>(vkGetDeviceProcAddr(m_Device, "vkCmdSetDepthWriteEnableEXT"));
+			m_ExtensionFunctions.CmdSetDepthCompareOp = reinterpret_cast<PFN_vkCmdSetDepthCompareOpEXT>(vkGetDeviceProcAddr(m_Device, "vkCmdSetDepthCompareOpEXT"));
+			ARC_ASSERT(m_ExtensionFunctions.CmdSetCullMode && m_ExtensionFunctions.CmdSetFrontFace && m_ExtensionFunctions.CmdSetPrimitiveTopology &&
+				m_ExtensionFunctions.CmdSetDepthTestEnable && m_ExtensionFunctions.CmdSetDepthWriteEnable && m_ExtensionFunctions.CmdSetDepthCompareOp, "Vulkan: Failed to load VK_EXT_extended_dynamic_state functions");
+		}
+
+		if (m_DrawIndirectCountEnabled)
+		{
+			m_ExtensionFunctions.CmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(vkGetDeviceProcAddr(m_Device, "vkCmdDrawIndexedIndirectCountKHR"));
+			ARC_ASSERT(m_ExtensionFunctions.CmdDrawIndexedIndirectCount, "Vulkan: Failed to load VK_KHR_draw_indirect_count functions");
+		}
 	}
 
 	void VulkanAPI::CreateTemporaryResources()
 	{
 		m_Shader = ShaderLoader::LoadShader("res/Shaders/simple_vert.spv", "res/Shaders/simple_frag.spv");
+		if (m_DepthPrepass)
+		{
+			m_DepthPrepassShader = ShaderLoader::LoadShader("res/Shaders/depth_vert.spv", "");
+		}
 		TextureSettings texture;
 		texture.TextureFormat = VK_FORMAT_R8G8B8A8_SRGB;
 		m_Texture = TextureLoader::LoadTexture("res/Textures/rockstar.png", &texture);
-		m_VertexBuffer = new VertexBuffer(this, vertices.data(), vertices.size());
-		m_IndexBuffer = new IndexBuffer(this, indices.data(), indices.size());
+		m_SceneCulling = new CpuCulling();
+
+		const Vertex *firstVertex = reinterpret_cast<const Vertex*>(vertices.data());
+		m_SceneMesh = CreateSceneMesh(std::vector<Vertex>(firstVertex, firstVertex + vertices.size() * sizeof(float) / sizeof(Vertex)), indices, true);
+	}
+
+	GeometryPool* VulkanAPI::GetGeometryPool(VertexLayout vertexLayout, uint32_t vertexCount)
+	{
+		// Half the index memory and bandwidth for every mesh small enough, 0xFFFF is kept free since it restarts primitives when that is enabled
+		VkIndexType indexType = vertexCount <= 0xFFFF ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+		for (GeometryPool *geometryPool : m_GeometryPools)
+		{
+			if (geometryPool->GetVertexLayout() == vertexLayout && geometryPool->GetIndexType() == indexType)
+				return geometryPool;
+		}
+
+		m_GeometryPools.push_back(new GeometryPool(this, vertexLayout, VertexStreams::SPLIT, indexType, MAX_POOL_VERTICES, MAX_POOL_INDICES));
+		return m_GeometryPools.back();
+	}
+
+	Mesh* VulkanAPI::CreateSceneMesh(std::vector<Vertex> vertices, std::vector<uint32_t> indices, bool generateLods)
+	{
+		MeshOptimizer::Optimize(vertices, indices);
+		std::vector<Meshlet> meshlets = MeshletBuilder::Build(vertices, indices, 0, static_cast<uint32_t>(indices.size()));
+		std::vector<MeshLod> lods;
+		if (generateLods)
+		{
+			lods = MeshSimplifier::GenerateLods(vertices, indices);
+		}
+
+		std::vector<glm::vec3> positions(vertices.size());
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			positions[i] = vertices[i].pos;
+		}
+		Mesh *mesh = new Mesh(GetGeometryPool(VertexLayout::STANDARD, static_cast<uint32_t>(vertices.size())), vertices.data(), static_cast<uint32_t>(vertices.size()), indices.data(), static_cast<uint32_t>(indices.size()), lods, meshlets);
+		const MeshLod &fullDetail = mesh->GetLods()[0];
+		SetSceneMeshGeometry(positions, std::vector<uint32_t>(indices.begin() + fullDetail.FirstIndex, indices.begin() + fullDetail.FirstIndex + fullDetail.IndexCount));
+		return mesh;
+	}
+
+	void VulkanAPI::SetSceneMeshGeometry(const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices)
+	{
+		m_SceneMeshPositions = positions;
+		m_SceneMeshIndices = indices;
+
+		// Centred on the bounding box, not the smallest sphere but close enough for culling
+		glm::vec3 min(std::numeric_limits<float>::max()), max(std::numeric_limits<float>::lowest());
+		for (const glm::vec3 &position : positions)
+		{
+			min = glm::min(min, position);
+			max = glm::max(max, position);
+		}
+		glm::vec3 centre = positions.empty() ? glm::vec3(0.0f) : (min + max) * 0.5f;
+
+		float radiusSquared = 0.0f;
+		for (const glm::vec3 &position : positions)
+		{
+			radiusSquared = std::max(radiusSquared, glm::dot(position - centre, position - centre));
+		}
+		m_SceneMeshBoundingSphere = glm::vec4(centre, std::sqrt(radiusSquared));
+	}
+
+	void VulkanAPI::UpdateSceneInstanceBounds()
+	{
+		m_SceneInstanceSpheres.resize(m_SceneInstances.size());
+		m_SceneCulling->Clear();
+		m_SceneLodSelection.Clear();
+		for (size_t i = 0; i < m_SceneInstances.size(); i++)
+		{
+			// The radius grows with the largest scale of the transform's axes
+			const glm::mat4 &transform = m_SceneInstances[i].transform;
+			float scale = std::max(glm::length(glm::vec3(transform[0])), std::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+			glm::vec3 centre = glm::vec3(transform * glm::vec4(glm::vec3(m_SceneMeshBoundingSphere), 1.0f));
+			m_SceneInstanceSpheres[i] = glm::vec4(centre, m_SceneMeshBoundingSphere.w * scale);
+			m_SceneCulling->AddSphere(m_SceneInstanceSpheres[i]);
+		}
+	}
+
+	void VulkanAPI::OcclusionCullSceneInstances(const glm::mat4 &viewProjection)
+	{
+		// The largest instances in the frustum are the occluders, as many as fit in the triangle budget
+		const uint32_t occluderTriangleCount = std::max(static_cast<uint32_t>(m_SceneMeshIndices.size() / 3), 1u);
+		const uint32_t occluderCount = std::min({ MAX_SOFTWARE_OCCLUDERS, MAX_SOFTWARE_OCCLUDER_TRIANGLES / occluderTriangleCount, static_cast<uint32_t>(m_VisibleSceneInstances.size()) });
+		m_SoftwareOccluders = m_VisibleSceneInstances;
+		std::partial_sort(m_SoftwareOccluders.begin(), m_SoftwareOccluders.begin() + occluderCount, m_SoftwareOccluders.end(), [this](uint32_t a, uint32_t b)
+		{
+			return m_SceneInstanceSpheres[a].w > m_SceneInstanceSpheres[b].w;
+		});
+
+		m_SoftwareOcclusion->ClearOccluders();
+		for (uint32_t i = 0; i < occluderCount; i++)
+		{
+			m_SoftwareOcclusion->AddOccluder(m_SceneMeshPositions, m_SceneMeshIndices, m_SceneInstances[m_SoftwareOccluders[i]].transform);
+		}
+		m_SoftwareOcclusion->RasterizeOccluders(viewProjection);
+		m_SoftwareOcclusion->CullSpheres(m_SceneInstanceSpheres, m_VisibleSceneInstances, m_SoftwareOcclusionVisible);
+
+		if (m_SoftwareOcclusionReference)
+		{
+			// Instances the low resolution buffer can't hide cost a draw, instances it wrongly hides pop. The reference isn't part of the culling's cost
+			FrameStats &stats = Profiler::GetInstance().GetCurrentFrameStats();
+			const double rasterTime = stats.SoftwareOcclusionRasterTime;
+			const uint32_t triangleCount = stats.SoftwareOccluderTriangleCount;
+			m_SoftwareOcclusionReference->ClearOccluders();
+			for (uint32_t i = 0; i < occluderCount; i++)
+			{
+				m_SoftwareOcclusionReference->AddOccluder(m_SceneMeshPositions, m_SceneMeshIndices, m_SceneInstances[m_SoftwareOccluders[i]].transform);
+			}
+			m_SoftwareOcclusionReference->RasterizeOccluders(viewProjection);
+			stats.SoftwareOcclusionRasterTime = rasterTime;
+			stats.SoftwareOccluderTriangleCount = triangleCount;
+
+			uint32_t referenceOccludedCount = 0;
+			for (uint32_t instance : m_VisibleSceneInstances)
+			{
+				bool referenceVisible = m_SoftwareOcclusionReference->IsVisible(m_SceneInstanceSpheres[instance]);
+				bool visible = m_SoftwareOcclusion->IsVisible(m_SceneInstanceSpheres[instance]);
+				referenceOccludedCount += referenceVisible ? 0 : 1;
+				stats.SoftwareOcclusionFalseVisibleCount += (visible && !referenceVisible) ? 1 : 0;
+				stats.SoftwareOcclusionFalseOccludedCount += (!visible && referenceVisible) ? 1 : 0;
+			}
+			stats.SoftwareOcclusionAccuracy = referenceOccludedCount > 0 ? 100.0 - 100.0 * stats.SoftwareOcclusionFalseVisibleCount / referenceOccludedCount : 100.0;
+		}
+
+		std::swap(m_VisibleSceneInstances, m_SoftwareOcclusionVisible);
 	}
 
 	void VulkanAPI::CreateSwapchain()
@@ -600,99 +1139,127 @@ namespace Arcane
 		}
 	}
 
-	void VulkanAPI::CreateDepthResources()
-	{
-		VkFormat depthFormat = FindDepthFormat();
-
-		CreateImage2D(m_SwapchainExtent.width, m_SwapchainExtent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL, 
-			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_SHARING_MODE_EXCLUSIVE, &m_DepthImage, &m_DepthImageMemory);
-		m_DepthImageView = CreateImageView(m_DepthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
-	}
-
-	void VulkanAPI::CreateRenderPass()
-	{
-		VkAttachmentDescription colourAttachment = {};
-		colourAttachment.format = m_SwapchainImageFormat;
-		colourAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		colourAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		colourAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		colourAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		colourAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		colourAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		colourAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; // Images to be presented in the swapchain
-
-		VkAttachmentDescription depthAttachment = {};
-		depthAttachment.format = FindDepthFormat();
-		depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
-		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-		std::array<VkAttachmentDescription, 2> attachments = { colourAttachment, depthAttachment };
-
-		VkAttachmentReference colourAttachmentRef = {};
-		colourAttachmentRef.attachment = 0;
-		colourAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-		VkAttachmentReference depthAttachmentRef = {};
-		depthAttachmentRef.attachment = 1;
-		depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-		VkSubpassDescription subpass = {};
-		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS; // Vulkan can support compute subpass so graphics queue needs to be specified
-		subpass.colorAttachmentCount = 1;
-		subpass.pColorAttachments = &colourAttachmentRef;
-		subpass.pDepthStencilAttachment = &depthAttachmentRef;
-		//subpass.pInputAttachments // Attachments that are read from a shader
-		//subpass.pResolveAttachments // Attachments used for multisampling colour attachments
-		//subpass.pPreserveAttachments // Attachments that are not used by this subpass, but for which the data must be preserved
-
-		// TODO: Vulkan has auto defined sub passes before and after your subpass. Since the render pass sets up data in a certain way before and after
-		// If you don't specify, Vulkan spec says that they must be provided implicitly
-		// However on some Android drivers there is a bug where they will not, and you need to create subpass dependencies for these two implict stages
-		// 1. SrcSubpass=VK_SUBPASS_EXTERNAL & DstSubpass=indexToYourFirstSubpass
-		// 2. SrcSubpass=indexToYourLastSubpass & DstSubpass=VK_SUBPASS_EXTERNAL
-		VkSubpassDependency dependency = {};
-		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependency.dstSubpass = 0;
-		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT; // We need to wait for the swapchain to finish reading before we can access it
-		dependency.srcAccessMask = 0;
-		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT; // We need to wait on this stage and access
-		dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-		VkRenderPassCreateInfo renderPassCreateInfo = {};
-		renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		renderPassCreateInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-		renderPassCreateInfo.pAttachments = attachments.data();
-		renderPassCreateInfo.subpassCount = 1;
-		renderPassCreateInfo.pSubpasses = &subpass;
-		renderPassCreateInfo.dependencyCount = 1;
-		renderPassCreateInfo.pDependencies = &dependency;
-
-		VkResult result = vkCreateRenderPass(m_Device, &renderPassCreateInfo, nullptr, &m_RenderPass);
-		ARC_ASSERT(result == VK_SUCCESS, "Failed to create Vulkan RenderPass");
+	void VulkanAPI::CreateRenderGraph()
+	{
+		m_RenderGraph = new RenderGraph(this);
+
+		RenderGraphResource backbuffer = m_RenderGraph->ImportSwapchain("Backbuffer", m_SwapchainImages, m_SwapchainImageViews, m_SwapchainImageFormat, m_SwapchainExtent);
+
+		RenderGraphTextureDesc depthDesc;
+		depthDesc.Width = m_SwapchainExtent.width;
+		depthDesc.Height = m_SwapchainExtent.height;
+		depthDesc.Format = FindDepthFormat();
+		RenderGraphResource depth = m_RenderGraph->CreateTexture("Depth", depthDesc);
+
+		if (!m_OcclusionCulling)
+		{
+			// Nothing reads the depth after the main pass, so the graph doesn't store it
+			if (m_DepthPrepass)
+				m_DepthPrepassPass = &AddScenePass("DepthPrepass", RenderGraphResource(), depth, true, DrawPass::DEPTH_PREPASS);
+			m_MainPass = &AddScenePass("Main", backbuffer, depth, true, DrawPass::MAIN, m_DepthPrepass);
+		}
+		else
+		{
+			// The late pass continues the early pass's colour and depth. The early depth is reduced into the pyramid the late phase culls against,
+			// the prepass only draws the early draws so the depth it leaves is the same
+			// With cluster culling the occlusion culling only provides the pyramid and the scene passes draw the clusters instead of its objects
+			m_OcclusionCulling->SetupGraph(*m_RenderGraph, m_SwapchainExtent);
+			if (m_ClusterCulling)
+				m_ClusterCulling->SetupGraph(*m_RenderGraph);
+			RenderGraphResource earlyDraws = m_OcclusionCulling->GetDrawBufferResource(OcclusionCullPhase::EARLY);
+			RenderGraphResource lateDraws = m_OcclusionCulling->GetDrawBufferResource(OcclusionCullPhase::LATE);
+			if (m_ClusterCulling)
+			{
+				earlyDraws = m_ClusterCulling->GetDrawBufferResource(OcclusionCullPhase::EARLY);
+				lateDraws = m_ClusterCulling->GetDrawBufferResource(OcclusionCullPhase::LATE);
+			}
+
+			m_OcclusionCulling->AddCullPass(*m_RenderGraph, OcclusionCullPhase::EARLY);
+			if (m_ClusterCulling)
+				m_ClusterCulling->AddCullPass(*m_RenderGraph, OcclusionCullPhase::EARLY);
+			if (m_DepthPrepass)
+			{
+				m_DepthPrepassPass = &AddScenePass("DepthPrepass", RenderGraphResource(), depth, true, DrawPass::DEPTH_PREPASS);
+				m_DepthPrepassPass->AddBufferInput(earlyDraws, ResourceAccess::INDIRECT_READ);
+			}
+			m_MainPass = &AddScenePass("MainEarly", backbuffer, depth, true, DrawPass::MAIN, m_DepthPrepass);
+			m_MainPass->AddBufferInput(earlyDraws, ResourceAccess::INDIRECT_READ);
+			m_OcclusionCulling->AddDepthPyramidPass(*m_RenderGraph, depth);
+			m_OcclusionCulling->AddCullPass(*m_RenderGraph, OcclusionCullPhase::LATE);
+			if (m_ClusterCulling)
+				m_ClusterCulling->AddCullPass(*m_RenderGraph, OcclusionCullPhase::LATE);
+			RenderGraphPass &latePass = AddScenePass("MainLate", backbuffer, depth, false, DrawPass::MAIN_LATE);
+			latePass.AddBufferInput(lateDraws, ResourceAccess::INDIRECT_READ);
+		}
+
+		m_RenderGraph->SetOutput(backbuffer);
+		m_RenderGraph->Compile();
+	}
+
+	void VulkanAPI::RebuildRenderGraph()
+	{
+		vkDeviceWaitIdle(m_Device);
+
+		// Pipelines are created against the render passes of the graph
+		m_PipelineCache->Clear();
+		vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
+		delete m_RenderGraph;
+
+		CreateRenderGraph();
+		CreateGraphicsPipeline();
+	}
+
+	RenderGraphPass& VulkanAPI::AddScenePass(const std::string &name, RenderGraphResource backbuffer, RenderGraphResource depth, bool clear, DrawPass drawPass, bool depthPrepassed)
+	{
+		VkClearColorValue clearColour = { 0.0f, 0.0f, 0.0f, 1.0f };
+		VkClearDepthStencilValue clearDepth = { 1.0f, 0 };
+		RenderGraphPass &pass = m_RenderGraph->AddPass(name, RenderGraphPassType::GRAPHICS);
+		if (backbuffer.IsValid())
+			pass.AddColourOutput(backbuffer, clear ? &clearColour : nullptr);
+		// A prepassed pass keeps the depth attachment writable even though the equal test never writes it. Every scene pipeline is created against the main
+		// pass, including the one the late draws write depth with, and that isn't allowed against a read only depth attachment
+		pass.SetDepthOutput(depth, (clear && !depthPrepassed) ? &clearDepth : nullptr);
+		pass.SetUsesSecondaryCommandBuffers(true);
+		pass.SetExecute([this, drawPass](const RenderGraphPassContext &context)
+		{
+			const std::vector<DrawCommand> *draws = drawPass == DrawPass::DEPTH_PREPASS ? m_FramePrepassDraws : (drawPass == DrawPass::MAIN_LATE ? m_FrameLateDraws : m_FrameDraws);
+			if (!draws)
+				return;
+
+			VkViewport viewport = {};
+			viewport.x = 0.0f;
+			viewport.y = 0.0f;
+			viewport.width = static_cast<float>(context.Extent.width);
+			viewport.height = static_cast<float>(context.Extent.height);
+			viewport.minDepth = 0.0f;
+			viewport.maxDepth = 1.0f;
+
+			VkRect2D scissor = {};
+			scissor.offset = { 0, 0 };
+			scissor.extent = context.Extent;
+
+			// The secondary command buffers recorded for the draws continue this render pass
+			VkCommandBufferInheritanceInfo inheritanceInfo = {};
+			inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+			inheritanceInfo.pNext = nullptr;
+			inheritanceInfo.renderPass = context.RenderPass;
+			inheritanceInfo.subpass = 0;
+			inheritanceInfo.framebuffer = context.Framebuffer; // Optional, but lets the driver optimize the secondary command buffers
+			inheritanceInfo.occlusionQueryEnable = VK_FALSE;
+			inheritanceInfo.pipelineStatistics = m_GraphicsStatistics->GetInheritedStatistics(); // The frame's statistics query is active around the whole pass
+
+			m_CommandRecorder->Record(context.CommandBuffer, inheritanceInfo, viewport, scissor, *draws, m_FrameRecordThreadCount);
+		});
+		return pass;
 	}
 
 	void VulkanAPI::CreateDescriptorSetLayout()
 	{
-		VkDescriptorSetLayoutBinding uboLayoutBinding = {};
-		uboLayoutBinding.binding = 0;
-		uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		uboLayoutBinding.descriptorCount = 1; // number of resources with this layout binding (for non-arrays = 1)
-		uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; // What shader stages this resource will be used in
-		uboLayoutBinding.pImmutableSamplers = nullptr;
-
-		VkDescriptorSetLayoutBinding samplerLayoutBinding = {};
-		samplerLayoutBinding.binding = 1;
-		samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		samplerLayoutBinding.descriptorCount = 1; // number of resources with this layout binding (for non-arrays = 1)
-		samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT; // What shader stages this resource will be used in
-		samplerLayoutBinding.pImmutableSamplers = nullptr;
-
-		std::array<VkDescriptorSetLayoutBinding, 2> bindings = { uboLayoutBinding, samplerLayoutBinding };
+		// Bindings, descriptor types, array counts and the stages that use them all come from the shader's SPIR-V so they can't go out of sync with the GLSL
+		const ShaderReflection &reflection = m_Shader->GetReflection();
+		ARC_ASSERT(reflection.GetDescriptorSetCount() <= 1, "Vulkan: Only a single descriptor set is currently supported");
+
+		std::vector<VkDescriptorSetLayoutBinding> bindings = reflection.GetDescriptorSetLayoutBindings(0);
 		VkDescriptorSetLayoutCreateInfo layoutInfo = {};
 		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
 		layoutInfo.pNext = nullptr;
@@ -705,152 +1272,52 @@ namespace Arcane
 
 	void VulkanAPI::CreateGraphicsPipeline()
 	{
-		auto bindingDescription = Vertex::GetBindingDescription();
-		auto attributeDescription = Vertex::GetAttributeDescription();
-
-		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
-		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputInfo.vertexBindingDescriptionCount = 1;
-		vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescription.size());
-		vertexInputInfo.pVertexAttributeDescriptions = attributeDescription.data();
-
-		VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo = {};
-		inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-		inputAssemblyInfo.primitiveRestartEnable = VK_FALSE;
-
-		// Viewport can be dynamic but you must create a VkDynamicState and fill it and submit that. Then at render time you must specify
-		VkViewport viewport = {};
-		viewport.x = 0.0f;
-		viewport.y = 0.0f;
-		viewport.width = static_cast<float>(m_SwapchainExtent.width);
-		viewport.height = static_cast<float>(m_SwapchainExtent.height);
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
-
-		VkRect2D scissor = {};
-		scissor.offset = { 0, 0 };
-		scissor.extent = m_SwapchainExtent;
-
-		VkPipelineViewportStateCreateInfo viewportCreateInfo = {};
-		viewportCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		viewportCreateInfo.viewportCount = 1;
-		viewportCreateInfo.pViewports = &viewport;
-		viewportCreateInfo.scissorCount = 1;
-		viewportCreateInfo.pScissors = &scissor;
-
-		VkPipelineRasterizationStateCreateInfo rasterizationCreateInfo = {};
-		rasterizationCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		rasterizationCreateInfo.depthClampEnable = VK_FALSE; // TODO: Might be useful for shadowmaps?
-		rasterizationCreateInfo.rasterizerDiscardEnable = VK_FALSE;
-		rasterizationCreateInfo.polygonMode = VK_POLYGON_MODE_FILL; // TODO: This is where we can do wireframe
-		rasterizationCreateInfo.lineWidth = 1.0f;
-		rasterizationCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
-		rasterizationCreateInfo.frontFace = VK_FRONT_FACE_CLOCKWISE;
-		rasterizationCreateInfo.depthBiasEnable = VK_FALSE;
-		rasterizationCreateInfo.depthBiasConstantFactor = 0.0f;
-		rasterizationCreateInfo.depthBiasClamp = 0.0f;
-		rasterizationCreateInfo.depthBiasSlopeFactor = 0.0f;
-
-		VkPipelineMultisampleStateCreateInfo multisampleCreateInfo = {}; // Enabling MSAA requires enabling a GPU feature
-		multisampleCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-		multisampleCreateInfo.sampleShadingEnable = VK_FALSE;
-		multisampleCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-		multisampleCreateInfo.minSampleShading = 1.0f;
-		multisampleCreateInfo.pSampleMask = nullptr;
-		multisampleCreateInfo.alphaToCoverageEnable = VK_FALSE;
-		multisampleCreateInfo.alphaToOneEnable = VK_FALSE;
-
-		VkPipelineDepthStencilStateCreateInfo depthStencilCreateInfo = {};
-		depthStencilCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-		depthStencilCreateInfo.pNext = nullptr;
-		depthStencilCreateInfo.depthTestEnable = VK_TRUE;
-		depthStencilCreateInfo.depthWriteEnable = VK_TRUE;
-		depthStencilCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;
-		depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;
-		depthStencilCreateInfo.minDepthBounds = 0.0f;
-		depthStencilCreateInfo.maxDepthBounds = 1.0f;
-		depthStencilCreateInfo.stencilTestEnable = VK_FALSE;
-
-		VkPipelineColorBlendAttachmentState colourBlendState = {};
-		colourBlendState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-		colourBlendState.blendEnable = VK_FALSE;
-		colourBlendState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-		colourBlendState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-		colourBlendState.colorBlendOp = VK_BLEND_OP_ADD;
-		colourBlendState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-		colourBlendState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-		colourBlendState.alphaBlendOp = VK_BLEND_OP_ADD;
-
-		VkPipelineColorBlendStateCreateInfo colorBlendCreateInfo = {};
-		colorBlendCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-		colorBlendCreateInfo.logicOpEnable = VK_FALSE;
-		colorBlendCreateInfo.logicOp = VK_LOGIC_OP_COPY;
-		colorBlendCreateInfo.attachmentCount = 1;
-		colorBlendCreateInfo.pAttachments = &colourBlendState;
-		colorBlendCreateInfo.blendConstants[0] = 0.0f;
-		colorBlendCreateInfo.blendConstants[1] = 0.0f;
-		colorBlendCreateInfo.blendConstants[2] = 0.0f;
-		colorBlendCreateInfo.blendConstants[3] = 0.0f;
-
 		VkPipelineLayoutCreateInfo layoutCreateInfo = {};
 		layoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		layoutCreateInfo.setLayoutCount = 1;
 		layoutCreateInfo.pSetLayouts = &m_DescriptorSetLayout;
-		layoutCreateInfo.pushConstantRangeCount = 0;
-		layoutCreateInfo.pPushConstantRanges = nullptr;
+		layoutCreateInfo.pushConstantRangeCount = static_cast<uint32_t>(m_Shader->GetReflection().GetPushConstantRanges().size());
+		layoutCreateInfo.pPushConstantRanges = m_Shader->GetReflection().GetPushConstantRanges().data();
 
 		VkResult result = vkCreatePipelineLayout(m_Device, &layoutCreateInfo, nullptr, &m_PipelineLayout);
 		ARC_ASSERT(result == VK_SUCCESS, "Failed to create Vulkan Pipeline Layout");
 
-		VkGraphicsPipelineCreateInfo pipelineCreateInfo = {};
-		pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		pipelineCreateInfo.pNext = nullptr;
-		pipelineCreateInfo.stageCount = static_cast<uint32_t>(m_Shader->GetShaderStages().size());
-		pipelineCreateInfo.pStages = m_Shader->GetShaderStages().data();
-		pipelineCreateInfo.pVertexInputState = &vertexInputInfo;
-		pipelineCreateInfo.pInputAssemblyState = &inputAssemblyInfo;
-		pipelineCreateInfo.pViewportState = &viewportCreateInfo;
-		pipelineCreateInfo.pRasterizationState = &rasterizationCreateInfo;
-		pipelineCreateInfo.pMultisampleState = &multisampleCreateInfo;
-		pipelineCreateInfo.pDepthStencilState = &depthStencilCreateInfo;
-		pipelineCreateInfo.pColorBlendState = &colorBlendCreateInfo;
-		pipelineCreateInfo.pDynamicState = nullptr;
-		pipelineCreateInfo.layout = m_PipelineLayout;
-		pipelineCreateInfo.renderPass = m_RenderPass;
-		pipelineCreateInfo.subpass = 0; // index of the subpass
-		pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE; // Used to create a pipeline from an existing pipeline
-		pipelineCreateInfo.basePipelineIndex = -1; // Used to create a pipeline from an existing pipeline
-
-		result = vkCreateGraphicsPipelines(m_Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_GraphicsPipeline);
-		ARC_ASSERT(result == VK_SUCCESS, "Failed to create Vulkan Graphics Pipeline");
+		m_PipelineDescription.PipelineShader = m_Shader;
+		m_PipelineDescription.Layout = m_PipelineLayout;
+		m_PipelineDescription.RenderPass = m_MainPass->GetRenderPass();
+		m_PipelineDescription.Subpass = 0;
+		m_PipelineDescription.Streams = VertexStreams::SPLIT; // Matches the geometry pool, passes that only need positions can read the position stream alone
+
+		// The prepass writes the depth the main pass shades exactly once, the prepass pipeline doesn't need the attribute stream or any colour attachment
+		m_EqualDepthPipelineDescription = m_PipelineDescription;
+		m_EqualDepthPipelineDescription.State.DepthWriteEnable = false;
+		m_EqualDepthPipelineDescription.State.DepthCompareOp = VK_COMPARE_OP_EQUAL;
+		m_DepthPrepassPipelineDescription = m_PipelineDescription;
+		m_DepthPrepassPipelineDescription.PipelineShader = m_DepthPrepassShader;
+		m_DepthPrepassPipelineDescription.RenderPass = m_DepthPrepassPass ? m_DepthPrepassPass->GetRenderPass() : VK_NULL_HANDLE;
+		m_DepthPrepassPipelineDescription.ColourAttachmentCount = 0;
+		m_DepthPrepassPipelineDescription.Streams = VertexStreams::POSITION_ONLY;
+
+		// Create the pipelines up front instead of on the first draw that needs them, so they don't cause a hitch
+		m_PipelineCache->GetPipeline(m_PipelineDescription);
+		if (m_DepthPrepass)
+		{
+			m_PipelineCache->GetPipeline(m_EqualDepthPipelineDescription);
+			m_PipelineCache->GetPipeline(m_DepthPrepassPipelineDescription);
+		}
+		if (m_QuantizedShader)
+		{
+			CreateQuantizedPipeline();
+		}
 	}
 
-	void VulkanAPI::CreateFramebuffers()
+	void VulkanAPI::CreateQuantizedPipeline()
 	{
-		m_SwapchainFramebuffers.resize(m_SwapchainImageViews.size());
-
-		for (size_t i = 0; i < m_SwapchainFramebuffers.size(); i++)
-		{
-			std::array<VkImageView, 2> attachments =
-			{
-				m_SwapchainImageViews[i],
-				m_DepthImageView
-			};
-
-			VkFramebufferCreateInfo framebufferInfo = {};
-			framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			framebufferInfo.renderPass = m_RenderPass;
-			framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-			framebufferInfo.pAttachments = attachments.data();
-			framebufferInfo.width = m_SwapchainExtent.width;
-			framebufferInfo.height = m_SwapchainExtent.height;
-			framebufferInfo.layers = 1;
-
-			VkResult result = vkCreateFramebuffer(m_Device, &framebufferInfo, nullptr, &m_SwapchainFramebuffers[i]);
-			ARC_ASSERT(result == VK_SUCCESS, "Failed to create render pass with swapchain image views");
-		}
+		// Same descriptor set as the main pipeline, the vertex shader only decodes the quantized attributes
+		m_QuantizedPipelineDescription = m_PipelineDescription;
+		m_QuantizedPipelineDescription.PipelineShader = m_QuantizedShader;
+		m_QuantizedPipelineDescription.VertexInput = VertexLayout::MESH_QUANTIZED;
+		m_PipelineCache->GetPipeline(m_QuantizedPipelineDescription);
 	}
 
 	void VulkanAPI::CreateCommandPool()
@@ -872,69 +1339,113 @@ namespace Arcane
 
 		result = vkCreateCommandPool(m_Device, &copyCommandPoolInfo, nullptr, &m_CopyCommandPool);
 		ARC_ASSERT(result == VK_SUCCESS, "Vulkan: Failed to create copy command pool");
+
+		// Transient tells the driver the command buffers are short lived, they are recorded and thrown away every frame
+		VkCommandPoolCreateInfo frameCommandPoolInfo = {};
+		frameCommandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		frameCommandPoolInfo.pNext = nullptr;
+		frameCommandPoolInfo.queueFamilyIndex = m_DeviceQueueIndices.graphicsQueue.value();
+		frameCommandPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		m_FrameCommandPools.resize(MAX_FRAMES_IN_FLIGHT);
+		for (size_t i = 0; i < m_FrameCommandPools.size(); i++)
+		{
+			result = vkCreateCommandPool(m_Device, &frameCommandPoolInfo, nullptr, &m_FrameCommandPools[i]);
+			ARC_ASSERT(result == VK_SUCCESS, "Vulkan: Failed to create frame command pool");
+		}
 	}
 
 	void VulkanAPI::CreateCommandBuffers()
 	{
-		m_GraphicsCommandBuffers.resize(m_SwapchainFramebuffers.size());
+		m_FrameCommandBuffers.resize(m_FrameCommandPools.size());
 
-		// Allocate commands buffers from the command pool
+		// Allocate a command buffer from each frame's pool, they are recorded every frame in Render()
+		for (size_t i = 0; i < m_FrameCommandBuffers.size(); i++)
 		{
 			VkCommandBufferAllocateInfo allocateCreateInfo = {};
 			allocateCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 			allocateCreateInfo.pNext = nullptr;
-			allocateCreateInfo.commandPool = m_GraphicsCommandPool;
-			allocateCreateInfo.commandBufferCount = static_cast<uint32_t>(m_GraphicsCommandBuffers.size());
+			allocateCreateInfo.commandPool = m_FrameCommandPools[i];
+			allocateCreateInfo.commandBufferCount = 1;
 			allocateCreateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; // Secondary level can be reused in primary buffers. Good for re-use
 
-			VkResult result = vkAllocateCommandBuffers(m_Device, &allocateCreateInfo, m_GraphicsCommandBuffers.data());
+			VkResult result = vkAllocateCommandBuffers(m_Device, &allocateCreateInfo, &m_FrameCommandBuffers[i]);
 			ARC_ASSERT(result == VK_SUCCESS, "Failed to allocate Vulkan command buffers");
 		}
 
-		// Record commands into the command buffers
-		// We need a command buffer, one for each framebuffer we are rendering to (which will match our swapchain buffer count)
-		for (size_t i = 0; i < m_GraphicsCommandBuffers.size(); i++)
-		{
-			VkCommandBufferBeginInfo beginInfo = {};
-			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-			beginInfo.pNext = nullptr;
-			beginInfo.flags = 0;
-			beginInfo.pInheritanceInfo = nullptr;
-
-			VkResult result = vkBeginCommandBuffer(m_GraphicsCommandBuffers[i], &beginInfo);
-			ARC_ASSERT(result == VK_SUCCESS, "Failed to begin Vulkan command buffer recording");
-
-			VkRenderPassBeginInfo renderPassBegin = {};
-			renderPassBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-			renderPassBegin.pNext = nullptr;
-			renderPassBegin.renderPass = m_RenderPass;
-			renderPassBegin.framebuffer = m_SwapchainFramebuffers[i];
-			renderPassBegin.renderArea.offset = { 0, 0 };
-			renderPassBegin.renderArea.extent = m_SwapchainExtent;
-			std::array<VkClearValue, 2> clearValues;
-			clearValues[0].color = { 0.0f, 0.0f, 0.0f, 1.0f };
-			clearValues[1].depthStencil = { 1.0f, 0 };
-			renderPassBegin.clearValueCount = static_cast<uint32_t>(clearValues.size());
-			renderPassBegin.pClearValues = clearValues.data();
-
-			vkCmdBeginRenderPass(m_GraphicsCommandBuffers[i], &renderPassBegin, VK_SUBPASS_CONTENTS_INLINE); // Need to specify if you are using secondary command buffers here
-			vkCmdBindPipeline(m_GraphicsCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline); // PSO has which subpass we are using
-			m_VertexBuffer->Bind(m_GraphicsCommandBuffers[i]);
-			m_IndexBuffer->Bind(m_GraphicsCommandBuffers[i]);
-			vkCmdBindDescriptorSets(m_GraphicsCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &m_DescriptorSets[i], 0, nullptr);
-			if (m_IndexBuffer != nullptr)
-			{
-				vkCmdDrawIndexed(m_GraphicsCommandBuffers[i], m_IndexBuffer->GetCount(), 1, 0, 0, 0);
-			}
-			else
-			{
-				vkCmdDraw(m_GraphicsCommandBuffers[i], m_VertexBuffer->GetCount(), 1, 0, 0);
-			}
-			vkCmdEndRenderPass(m_GraphicsCommandBuffers[i]);
-			
-			result = vkEndCommandBuffer(m_GraphicsCommandBuffers[i]);
-			ARC_ASSERT(result == VK_SUCCESS, "Vulkan: Error occurred during command buffer recording");
+		m_RecordThreadCount = JobSystem::GetThreadCount();
+		m_CommandRecorder = new ParallelCommandRecorder(this, m_PipelineCache, static_cast<uint32_t>(m_FrameCommandPools.size()));
+		m_IndirectDrawBuffer = new IndirectDrawBuffer(this, MAX_INDIRECT_DRAWS, static_cast<uint32_t>(m_FrameCommandPools.size()), IndirectDrawSource::CPU);
+		m_InstanceBuffer = new InstanceBuffer(this, MAX_INSTANCES, static_cast<uint32_t>(m_FrameCommandPools.size()));
+		m_Renderer = new Renderer(m_InstanceBuffer);
+		m_AsyncCompute = new AsyncCompute(this, m_ComputeQueue, static_cast<uint32_t>(m_FrameCommandPools.size()));
+		m_GraphicsTimer = new GpuTimer(this, m_DeviceQueueIndices.graphicsQueue.value(), static_cast<uint32_t>(m_FrameCommandPools.size()));
+		m_GraphicsStatistics = new GpuPipelineStatistics(this, static_cast<uint32_t>(m_FrameCommandPools.size()));
+	}
+
+	void VulkanAPI::RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t swapchainImageIndex, const std::vector<DrawCommand> &draws, uint32_t threadCount,
+											const std::vector<DrawCommand> *lateDraws, const std::vector<DrawCommand> *prepassDraws)
+	{
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.pNext = nullptr;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT; // Recorded again next frame
+		beginInfo.pInheritanceInfo = nullptr;
+
+		VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		ARC_ASSERT(result == VK_SUCCESS, "Failed to begin Vulkan command buffer recording");
+		m_GraphicsTimer->Begin(commandBuffer, static_cast<uint32_t>(m_CurrentFrame));
+		m_GraphicsStatistics->Begin(commandBuffer, static_cast<uint32_t>(m_CurrentFrame));
+
+		// The render graph records the barriers, render passes and the pass callbacks, the main pass executes the draws through the command recorder
+		m_FrameDraws = &draws;
+		m_FrameLateDraws = lateDraws;
+		m_FramePrepassDraws = prepassDraws;
+		m_FrameRecordThreadCount = threadCount;
+		m_RenderGraph->Execute(commandBuffer, swapchainImageIndex);
+		m_FrameDraws = nullptr;
+		m_FrameLateDraws = nullptr;
+		m_FramePrepassDraws = nullptr;
+
+		m_GraphicsStatistics->End(commandBuffer, static_cast<uint32_t>(m_CurrentFrame));
+		m_GraphicsTimer->End(commandBuffer, static_cast<uint32_t>(m_CurrentFrame));
+		result = vkEndCommandBuffer(commandBuffer);
+		ARC_ASSERT(result == VK_SUCCESS, "Vulkan: Error occurred during command buffer recording");
+	}
+
+	void VulkanAPI::UpdateGpuFrameStats()
+	{
+		// The frame's fence has signaled so the timestamps of the last frame that used this slot are ready, GPU times lag MAX_FRAMES_IN_FLIGHT frames behind the CPU
+		FrameStats &stats = Profiler::GetInstance().GetCurrentFrameStats();
+		OcclusionCullingStats occlusionStats;
+		if (m_OcclusionCulling && m_OcclusionCulling->ReadStats(static_cast<uint32_t>(m_CurrentFrame), occlusionStats))
+		{
+			stats.OcclusionEarlyDrawCount = occlusionStats.EarlyDrawCount;
+			stats.OcclusionLateDrawCount = occlusionStats.LateDrawCount;
+			stats.FrustumCulledCount = occlusionStats.FrustumCulledCount;
+			stats.OcclusionCulledCount = occlusionStats.OcclusionCulledCount;
 		}
+		ClusterCullingStats clusterStats;
+		if (m_ClusterCulling && m_ClusterCulling->ReadStats(static_cast<uint32_t>(m_CurrentFrame), clusterStats))
+		{
+			stats.ClusterEarlyDrawCount = clusterStats.EarlyDrawCount;
+			stats.ClusterLateDrawCount = clusterStats.LateDrawCount;
+			stats.ClusterBackfaceCulledCount = clusterStats.BackfaceCulledCount;
+			stats.ClusterFrustumCulledCount = clusterStats.FrustumCulledCount;
+			stats.ClusterOcclusionCulledCount = clusterStats.OcclusionCulledCount;
+		}
+		m_GraphicsStatistics->ReadResult(static_cast<uint32_t>(m_CurrentFrame), stats.FragmentShaderInvocations);
+
+		double graphicsBegin, graphicsEnd;
+		if (!m_GraphicsTimer->ReadResult(static_cast<uint32_t>(m_CurrentFrame), graphicsBegin, graphicsEnd))
+			return;
+		stats.GraphicsGpuTime = graphicsEnd - graphicsBegin;
+
+		double computeBegin, computeEnd;
+		if (!m_AsyncCompute->GetTimer()->ReadResult(static_cast<uint32_t>(m_CurrentFrame), computeBegin, computeEnd))
+			return;
+		stats.AsyncComputeGpuTime = computeEnd - computeBegin;
+		stats.AsyncComputeOverlapTime = std::max(0.0, std::min(graphicsEnd, computeEnd) - std::max(graphicsBegin, computeBegin));
 	}
 
 	void VulkanAPI::CreateSyncObjects()
@@ -979,14 +1490,11 @@ namespace Arcane
 
 		CreateSwapchain();
 		CreateSwapchainImageViews();
-		CreateRenderPass();
+		CreateRenderGraph();
 		CreateGraphicsPipeline();
-		CreateDepthResources();
-		CreateFramebuffers();
 		CreateUniformBuffers();
 		CreateDescriptorPool();
 		CreateDescriptorSets();
-		CreateCommandBuffers();
 	}
 
 	void VulkanAPI::CreateUniformBuffers()
@@ -1011,9 +1519,8 @@ namespace Arcane
 
 		StandardMaterialUBO standardMatUBO;
 		standardMatUBO.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-		standardMatUBO.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-		standardMatUBO.projection = glm::perspective(glm::radians(45.0f), (float)m_SwapchainExtent.width / (float)m_SwapchainExtent.height, 0.1f, 1000.0f);
-		standardMatUBO.projection[1][1] *= -1.0f; // Y-Coord inverted in Vulkan when compared to OpenGL
+		standardMatUBO.view = GetCameraView();
+		standardMatUBO.projection = GetCameraProjection();
 
 		void *data;
 		vkMapMemory(m_Device, m_UniformBuffersMemory[currSwapchainImageIndex], 0, sizeof(standardMatUBO), 0, &data);
@@ -1021,13 +1528,64 @@ namespace Arcane
 		vkUnmapMemory(m_Device, m_UniformBuffersMemory[currSwapchainImageIndex]);
 	}
 
+	glm::mat4 VulkanAPI::GetCameraView() const
+	{
+		return glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	}
+
+	glm::mat4 VulkanAPI::GetCameraProjection() const
+	{
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)m_SwapchainExtent.width / (float)m_SwapchainExtent.height, 0.1f, 1000.0f);
+		projection[1][1] *= -1.0f; // Y-Coord inverted in Vulkan when compared to OpenGL
+		return projection;
+	}
+
+	GpuCullView VulkanAPI::GetGpuCullView() const
+	{
+		glm::mat4 projection = GetCameraProjection(), view = GetCameraView();
+
+		GpuCullView cullView;
+		cullView.ViewProjection = projection * view;
+		cullView.CameraPosition = glm::vec3(glm::inverse(view)[3]);
+		cullView.LodErrorScale = LodSelection::GetErrorScale(projection, static_cast<float>(m_SwapchainExtent.height), m_LodSettings);
+		cullView.LodHysteresis = m_LodSettings.Hysteresis;
+		return cullView;
+	}
+
+	void VulkanAPI::BuildGpuCullObjects(const std::vector<glm::vec4> &boundingSpheres, std::vector<GpuCullObject> &outObjects, std::vector<GpuMeshLod> &outLods) const
+	{
+		outLods.resize(m_SceneMesh->GetLodCount());
+		for (uint32_t lod = 0; lod < m_SceneMesh->GetLodCount(); lod++)
+		{
+			outLods[lod].FirstIndex = m_SceneMesh->GetFirstIndex(lod);
+			outLods[lod].IndexCount = m_SceneMesh->GetIndexCount(lod);
+			outLods[lod].Error = m_SceneMesh->GetLods()[lod].Error;
+		}
+
+		outObjects.resize(boundingSpheres.size());
+		for (size_t i = 0; i < boundingSpheres.size(); i++)
+		{
+			outObjects[i].BoundingSphere = boundingSpheres[i];
+			outObjects[i].VertexOffset = m_SceneMesh->GetVertexOffset();
+			outObjects[i].FirstLod = 0;
+			outObjects[i].LodCount = m_SceneMesh->GetLodCount();
+		}
+	}
+
 	void VulkanAPI::CreateDescriptorPool()
 	{
-		std::array<VkDescriptorPoolSize, 2> poolSizes = {};
-		poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		poolSizes[0].descriptorCount = static_cast<uint32_t>(m_SwapchainImages.size());
-		poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		poolSizes[1].descriptorCount = static_cast<uint32_t>(m_SwapchainImages.size());
+		// One descriptor set per swapchain image, sized from the shader's reflected bindings
+		std::vector<VkDescriptorPoolSize> poolSizes;
+		for (const ReflectedDescriptorBinding &binding : m_Shader->GetReflection().GetDescriptorBindings())
+		{
+			auto iter = std::find_if(poolSizes.begin(), poolSizes.end(), [&binding](const VkDescriptorPoolSize &poolSize) { return poolSize.type == binding.Type; });
+			if (iter == poolSizes.end())
+			{
+				poolSizes.push_back({ binding.Type, 0 });
+				iter = poolSizes.end() - 1;
+			}
+			iter->descriptorCount += binding.Count * static_cast<uint32_t>(m_SwapchainImages.size());
+		}
 
 		VkDescriptorPoolCreateInfo poolInfo = {};
 		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -1055,6 +1613,8 @@ namespace Arcane
 		VkResult result = vkAllocateDescriptorSets(m_Device, &allocateInfo, m_DescriptorSets.data());
 		ARC_ASSERT(result == VK_SUCCESS, "Vulkan: Failed to allocate descriptor sets");
 
+		// The shader's reflected bindings decide what goes where, its uniform buffer gets the frame's uniform buffer and its sampler the texture
+		const std::vector<ReflectedDescriptorBinding> &bindings = m_Shader->GetReflection().GetDescriptorBindings();
 		for (size_t i = 0; i < m_SwapchainImages.size(); i++)
 		{
 			VkDescriptorBufferInfo bufferInfo = {};
@@ -1067,26 +1627,36 @@ namespace Arcane
 			imageInfo.imageView = m_Texture->GetImageView();
 			imageInfo.sampler = m_Texture->GetTextureSampler();
 
-			std::array<VkWriteDescriptorSet, 2> descriptorWrites = {};
-			descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descriptorWrites[0].dstSet = m_DescriptorSets[i];
-			descriptorWrites[0].dstBinding = 0;
-			descriptorWrites[0].dstArrayElement = 0;
-			descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			descriptorWrites[0].descriptorCount = 1;
-			descriptorWrites[0].pBufferInfo = &bufferInfo;
-			descriptorWrites[0].pImageInfo = nullptr;
-			descriptorWrites[0].pTexelBufferView = nullptr;
-
-			descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descriptorWrites[1].dstSet = m_DescriptorSets[i];
-			descriptorWrites[1].dstBinding = 1;
-			descriptorWrites[1].dstArrayElement = 0;
-			descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			descriptorWrites[1].descriptorCount = 1;
-			descriptorWrites[1].pBufferInfo = nullptr;
-			descriptorWrites[1].pImageInfo = &imageInfo;
-			descriptorWrites[1].pTexelBufferView = nullptr;
+			std::vector<VkWriteDescriptorSet> descriptorWrites;
+			descriptorWrites.reserve(bindings.size());
+			for (const ReflectedDescriptorBinding &binding : bindings)
+			{
+				ARC_ASSERT(binding.Count == 1, "Vulkan: Descriptor {0} (binding {1}) is an array, the scene's descriptor sets only fill single descriptors", binding.Name, binding.Binding);
+
+				VkWriteDescriptorSet descriptorWrite = {};
+				descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				descriptorWrite.dstSet = m_DescriptorSets[i];
+				descriptorWrite.dstBinding = binding.Binding;
+				descriptorWrite.dstArrayElement = 0;
+				descriptorWrite.descriptorType = binding.Type;
+				descriptorWrite.descriptorCount = 1;
+				descriptorWrite.pBufferInfo = nullptr;
+				descriptorWrite.pImageInfo = nullptr;
+				descriptorWrite.pTexelBufferView = nullptr;
+				switch (binding.Type)
+				{
+				case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+					descriptorWrite.pBufferInfo = &bufferInfo;
+					break;
+				case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+					descriptorWrite.pImageInfo = &imageInfo;
+					break;
+				default:
+					ARC_ASSERT(false, "Vulkan: Descriptor {0} (binding {1}) is of a type the scene has no resource for", binding.Name, binding.Binding);
+					continue;
+				}
+				descriptorWrites.push_back(descriptorWrite);
+			}
 
 			vkUpdateDescriptorSets(m_Device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 		}
@@ -1227,6 +1797,22 @@ namespace Arcane
 		return requiredExtensions.empty();
 	}
 
+	bool VulkanAPI::IsPhysicalDeviceExtensionAvailable(const VkPhysicalDevice &physicalDevice, const char *extensionName)
+	{
+		uint32_t extensionCount;
+		vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+
+		for (const VkExtensionProperties &extension : availableExtensions)
+		{
+			if (strcmp(extension.extensionName, extensionName) == 0)
+				return true;
+		}
+
+		return false;
+	}
+
 	DeviceQueueIndices VulkanAPI::FindDeviceQueueIndices(const VkPhysicalDevice &physicalDevice)
 	{
 		DeviceQueueIndices queueIndices;
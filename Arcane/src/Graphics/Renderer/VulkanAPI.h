@@ -1,14 +1,42 @@
 #pragma once
 
 #include "Graphics/Vertex.h"
+#include "Graphics/Renderer/LodSelection.h"
+#include "Graphics/Renderer/PipelineCache.h"
+#include "Graphics/Renderer/ParallelCommandRecorder.h"
+#include "Graphics/Renderer/RenderGraph.h"
+#include "Graphics/Renderer/VulkanExtensions.h"
 
 namespace Arcane
 {
 	class Window;
 	class Shader;
 	class Texture;
-	class VertexBuffer;
-	class IndexBuffer;
+	class IndirectDrawBuffer;
+	class AsyncCompute;
+	class GpuTimer;
+	class GpuPipelineStatistics;
+	class GpuCulling;
+	class OcclusionCulling;
+	class ClusterCulling;
+	class CpuCulling;
+	class SoftwareOcclusion;
+	struct GpuCullObject;
+	struct GpuMeshLod;
+	struct GpuCullView;
+	class Renderer;
+	class InstanceBuffer;
+	class GeometryPool;
+	class Mesh;
+	enum class DrawPass : uint32_t;
+
+	// How RecordStressFrame() draws its objects
+	enum class StressRecordMode
+	{
+		DIRECT,   // A draw call per object
+		INDIRECT, // A draw command per object written to the indirect buffer, all submitted with a single indirect draw
+		INSTANCED // Every object is submitted to the render queue with its own transform and merged into instanced draws
+	};
 	struct TextureSettings;
 
 	struct DeviceQueueIndices
@@ -58,20 +86,77 @@ namespace Arcane
 		void InitVulkan();
 		void InitImGui();
 
+		// Records a frame that draws the scene drawCount times without submitting it and returns the CPU time it took in milliseconds. Used to benchmark command recording
+		double RecordStressFrame(uint32_t drawCount, uint32_t threadCount, StressRecordMode mode = StressRecordMode::DIRECT);
+
+		// Draws a copy of the scene mesh for every bounding sphere (world space centre and radius) that survives frustum culling on the GPU, instead of the single scene mesh.
+		// Each copy is drawn with the scene mesh's level of detail for its distance
+		void EnableGpuCulling(const std::vector<glm::vec4> &boundingSpheres);
+		void DisableGpuCulling();
+		// Same as GPU culling, but the copies are also occlusion culled against a depth pyramid with two phase culling on the graphics queue. Rebuilds the render graph
+		void EnableOcclusionCulling(const std::vector<glm::vec4> &boundingSpheres);
+		void DisableOcclusionCulling();
+		// Draws the scene mesh at the origin cluster by cluster in both occlusion culling phases instead of the occlusion culled copies, culling its meshlets by their
+		// normal cones, the frustum and the occlusion culling's depth pyramid. Needs occlusion culling, disabling that disables this too. Rebuilds the render graph
+		void EnableClusterCulling();
+		void DisableClusterCulling();
+		// Draws the early draws into a depth-only prepass front to back first, the main pass then tests for equal depth without writing it so every
+		// pixel is shaded once. Late occlusion culling draws aren't in the prepass and keep testing and writing depth. Rebuilds the render graph
+		void SetDepthPrepass(bool depthPrepass);
+		// Draws the scene mesh once per instance through the render queue instead of once at the origin, an empty list goes back to the single mesh.
+		// Only used by the direct draws, which frustum cull the instances and select their levels of detail on the CPU every frame. The GPU culling paths draw their own copies
+		void SetSceneInstances(const std::vector<InstanceData> &instances);
+		// Also occlusion culls the scene instances on the CPU before they are submitted, against the largest instances in the frustum (see SoftwareOcclusion).
+		// Measuring the accuracy rasterizes the same occluders at 8 times the resolution every frame to compare with, which costs far more than the culling saves
+		void SetSoftwareOcclusion(bool softwareOcclusion, bool measureAccuracy = false);
+		// Replaces the scene mesh with an optimized copy of the mesh, split into meshlets but without levels of detail so large meshes stay quick to load.
+		// Waits for the GPU, GPU and occlusion culling have to be disabled
+		void SetSceneMesh(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices);
+		// Same, but the mesh is quantized into VertexLayout::MESH_QUANTIZED and drawn from a pool and pipeline of that layout, only its triangles are reordered for the
+		// vertex cache. Only the direct draws can draw it, and the depth prepass has to be off
+		void SetQuantizedSceneMesh(const std::vector<MeshVertex> &vertices, const std::vector<uint32_t> &indices);
+
 		// Resource Creation Helpers
 		void CreateBuffer(VkDeviceSize bufferSize, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkSharingMode sharingMode, VkBuffer *outBuffer, VkDeviceMemory *outBufferMemory) const;
 		void CreateImage2D(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkSharingMode sharingMode,
-							VkImage *outImage, VkDeviceMemory *outTextureMemory) const;
-		void CopyBuffer(VkBuffer srcBuffer, VkBuffer destBuffer, VkDeviceSize size) const;
-		void CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) const;
-		void TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) const;
-		VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) const;
+							VkImage *outImage, VkDeviceMemory *outTextureMemory, uint32_t mipLevels = 1) const;
+		void CopyBuffer(VkBuffer srcBuffer, VkBuffer destBuffer, VkDeviceSize size, VkDeviceSize srcOffset = 0, VkDeviceSize destOffset = 0) const;
+		// Copies the data into a device local buffer through a temporary staging buffer and waits for the copy to finish
+		void UploadToBuffer(VkBuffer destBuffer, const void *data, VkDeviceSize size, VkDeviceSize destOffset = 0) const;
+		void CopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) const;
+		VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t baseMipLevel = 0, uint32_t mipLevelCount = 1) const;
+		uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+		// Single use command buffer on the graphics queue for uploads and the layout transitions around them, submitting it waits for it to finish
+		VkCommandBuffer BeginUploadCommands() const;
+		void SubmitUploadCommands(VkCommandBuffer commandBuffer) const;
 
 		// Getters
 		inline const VkDevice* GetDevice() const { return &m_Device; }
+		inline VkPhysicalDevice GetPhysicalDevice() const { return m_PhysicalDevice; }
+		inline const DeviceQueueIndices& GetDeviceQueueIndices() const { return m_DeviceQueueIndices; }
+		inline bool IsExtendedDynamicStateEnabled() const { return m_ExtendedDynamicStateEnabled; }
+		inline const VulkanExtensionFunctions& GetExtensionFunctions() const { return m_ExtensionFunctions; }
+		inline ResourceStateTracker* GetResourceStateTracker() const { return m_ResourceStateTracker; }
+		inline PipelineCache* GetPipelineCache() const { return m_PipelineCache; }
+		inline const VkPhysicalDeviceLimits& GetPhysicalDeviceLimits() const { return m_PhysicalDeviceProperties.limits; }
+		inline bool IsMultiDrawIndirectEnabled() const { return m_MultiDrawIndirectEnabled; }
+		inline bool IsDrawIndirectCountEnabled() const { return m_DrawIndirectCountEnabled; }
+		inline bool IsPipelineStatisticsEnabled() const { return m_PipelineStatisticsEnabled; }
+		inline bool IsIndirectDrawing() const { return m_IndirectDrawing; }
+		inline AsyncCompute* GetAsyncCompute() const { return m_AsyncCompute; }
+		inline bool IsOcclusionCulling() const { return m_OcclusionCulling != nullptr; }
+		inline bool IsClusterCulling() const { return m_ClusterCulling != nullptr; }
+		inline const Mesh* GetSceneMesh() const { return m_SceneMesh; }
+		inline bool IsDepthPrepass() const { return m_DepthPrepass; }
+		inline bool IsSoftwareOcclusion() const { return m_SoftwareOcclusion != nullptr; }
+		inline bool IsSoftwareOcclusionAccuracyMeasured() const { return m_SoftwareOcclusionReference != nullptr; }
+		inline const LodSettings& GetLodSettings() const { return m_LodSettings; }
 
 		// Setters
 		inline void NotifyWindowResized() { m_FramebufferResized = true; }
+		inline void SetIndirectDrawing(bool indirectDrawing) { m_IndirectDrawing = indirectDrawing; } // Submits every draw bucket with one indirect draw
+		inline void SetLodSettings(const LodSettings &settings) { m_LodSettings = settings; }
 	private:
 		void Cleanup();
 		void CleanupSwapchain();
@@ -82,15 +167,34 @@ namespace Arcane
 		void CreateLogicalDeviceAndQueues();
 		void CreateSwapchain();
 		void CreateSwapchainImageViews();
-		void CreateDepthResources();
-		void CreateRenderPass();
+		void CreateRenderGraph();
+		void RebuildRenderGraph();
+		// Without a backbuffer the pass only writes depth. A prepassed pass clears the colour as usual but keeps the depth the prepass wrote
+		RenderGraphPass& AddScenePass(const std::string &name, RenderGraphResource backbuffer, RenderGraphResource depth, bool clear, DrawPass drawPass, bool depthPrepassed = false);
 		void CreateDescriptorSetLayout();
 		void CreateGraphicsPipeline();
-		void CreateFramebuffers();
 		void CreateCommandPool();
 		void CreateCommandBuffers();
+		void RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t swapchainImageIndex, const std::vector<DrawCommand> &draws, uint32_t threadCount,
+									const std::vector<DrawCommand> *lateDraws = nullptr, const std::vector<DrawCommand> *prepassDraws = nullptr);
 		void CreateSyncObjects();
+		void UpdateGpuFrameStats();
+		glm::mat4 GetCameraView() const;
+		glm::mat4 GetCameraProjection() const;
+		GpuCullView GetGpuCullView() const;
+		// A culling object per bounding sphere drawing the scene mesh, and the scene mesh's levels of detail they point at
+		void BuildGpuCullObjects(const std::vector<glm::vec4> &boundingSpheres, std::vector<GpuCullObject> &outObjects, std::vector<GpuMeshLod> &outLods) const;
 		void CreateTemporaryResources();
+		// The pool for a scene mesh of the layout, meshes with fewer than 0xFFFF vertices go in a pool of 16-bit indices. Pools are created when first needed
+		GeometryPool* GetGeometryPool(VertexLayout vertexLayout, uint32_t vertexCount);
+		Mesh* CreateSceneMesh(std::vector<Vertex> vertices, std::vector<uint32_t> indices, bool generateLods);
+		// Keeps the positions and the full detail level's indices of the scene mesh on the CPU for the software occluders, and computes the mesh's bounds
+		void SetSceneMeshGeometry(const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices);
+		// Bounding spheres of the scene instances from their transforms and the scene mesh's bounds
+		void UpdateSceneInstanceBounds();
+		// Removes the occluded instances from the visible scene instances
+		void OcclusionCullSceneInstances(const glm::mat4 &viewProjection);
+		void CreateQuantizedPipeline();
 		void RecreateSwapchain();
 		void CreateUniformBuffers();
 		void UpdateUniformBuffer(uint32_t currSwapchainImageIndex);
@@ -100,10 +204,11 @@ namespace Arcane
 
 		VkCommandBuffer BeginSingleUseCommands(VkCommandPool pool) const;
 		void EndSingleUseCommands(VkCommandBuffer commandBuffer, VkCommandPool pool, VkQueue queue) const;
-		uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
 
 		int ScorePhysicalDeviceSuitability(const VkPhysicalDevice &device);
 		bool CheckPhysicalDeviceExtensionSupport(const VkPhysicalDevice &physicalDevice);
+		bool IsPhysicalDeviceExtensionAvailable(const VkPhysicalDevice &physicalDevice, const char *extensionName);
+		void LoadExtensionFunctions();
 		DeviceQueueIndices FindDeviceQueueIndices(const VkPhysicalDevice &physicalDevice);
 		SwapchainSupportDetails QuerySwapchainSupport(const VkPhysicalDevice &physicalDevice);
 		VkSurfaceFormatKHR ChooseSwapchainSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &availableFormats);
@@ -134,28 +239,78 @@ namespace Arcane
 		VkInstance m_Instance;
 		VkPhysicalDevice m_PhysicalDevice;
 		VkPhysicalDeviceMemoryProperties m_PhysicalDeviceMemoryProperties;
+		VkPhysicalDeviceProperties m_PhysicalDeviceProperties;
 		VkDevice m_Device;
 		DeviceQueueIndices m_DeviceQueueIndices;
+		bool m_ExtendedDynamicStateEnabled = false;
+		bool m_MultiDrawIndirectEnabled = false;
+		bool m_DrawIndirectCountEnabled = false;
+		bool m_PipelineStatisticsEnabled = false;
+		VulkanExtensionFunctions m_ExtensionFunctions;
+		ResourceStateTracker *m_ResourceStateTracker; // Layouts of the images created outside of the render graph
 
 		VkSwapchainKHR m_Swapchain;
 		std::vector<VkImage> m_SwapchainImages;
 		std::vector<VkImageView> m_SwapchainImageViews;
-		std::vector<VkFramebuffer> m_SwapchainFramebuffers;
 		VkFormat m_SwapchainImageFormat;
 		VkExtent2D m_SwapchainExtent;
 		VkSurfaceKHR m_Surface;
-		VkImage m_DepthImage;
-		VkDeviceMemory m_DepthImageMemory;
-		VkImageView m_DepthImageView;
+
+		// Owns the render passes, framebuffers and transient attachments of the frame, rebuilt with the swapchain
+		RenderGraph *m_RenderGraph;
+		RenderGraphPass *m_MainPass;
+		RenderGraphPass *m_DepthPrepassPass; // Only in the graph while the depth prepass is on
+		const std::vector<DrawCommand> *m_FrameDraws; // Draws of the frame being recorded, executed by the main pass
+		const std::vector<DrawCommand> *m_FrameLateDraws; // Draws of the late occlusion culling phase, executed by the second main pass
+		const std::vector<DrawCommand> *m_FramePrepassDraws; // Executed by the depth prepass
+		uint32_t m_FrameRecordThreadCount;
 
 		VkQueue m_GraphicsQueue;
 		VkQueue m_ComputeQueue;
 		VkQueue m_CopyQueue;
 		VkQueue m_PresentQueue;
 
-		VkCommandPool m_GraphicsCommandPool;
+		VkCommandPool m_GraphicsCommandPool; // Single use commands
 		VkCommandPool m_CopyCommandPool;
-		std::vector<VkCommandBuffer> m_GraphicsCommandBuffers;
+
+		// Command buffers are re-recorded every frame. Each frame in flight has its own transient pool that is reset in one call once the frame's fence has signaled
+		std::vector<VkCommandPool> m_FrameCommandPools;
+		std::vector<VkCommandBuffer> m_FrameCommandBuffers;
+		ParallelCommandRecorder *m_CommandRecorder;
+		uint32_t m_RecordThreadCount;
+
+		// Every draw of the frame goes through the render queue, which sorts them by pass and state before they are recorded
+		Renderer *m_Renderer;
+
+		// Instance data of every draw, written by the render queue every frame
+		InstanceBuffer *m_InstanceBuffer;
+		const uint32_t MAX_INSTANCES = 1 << 17;
+
+		// Draw arguments written by the CPU every frame when indirect drawing is on
+		IndirectDrawBuffer *m_IndirectDrawBuffer;
+		bool m_IndirectDrawing = false;
+		const uint32_t MAX_INDIRECT_DRAWS = 1 << 17;
+
+		// Compute work submitted to the compute queue every frame, graphics waits on it only at the stages that consume its results
+		AsyncCompute *m_AsyncCompute;
+		GpuTimer *m_GraphicsTimer;
+		GpuPipelineStatistics *m_GraphicsStatistics;
+
+		// Frustum culls the scene objects on the async compute queue, the main pass draws the survivors with one indirect count draw
+		GpuCulling *m_GpuCulling;
+		uint32_t m_GpuCullingWork;
+		const uint32_t MAX_GPU_CULL_OBJECTS = 1 << 20;
+
+		// Occlusion culls the scene objects between two main passes on the graphics queue, takes over from GPU culling while enabled
+		OcclusionCulling *m_OcclusionCulling;
+		// Culls the scene mesh's meshlets after the depth pyramid is built, the late main pass draws the survivors
+		ClusterCulling *m_ClusterCulling;
+
+		// Whether the main draws are drawn into a depth-only pass first
+		bool m_DepthPrepass = false;
+
+		// How the culling passes and the direct draws pick the scene objects' levels of detail
+		LodSettings m_LodSettings;
 
 		const int MAX_FRAMES_IN_FLIGHT = 3;
 		size_t m_CurrentFrame = 0;
@@ -169,11 +324,35 @@ namespace Arcane
 		std::vector<VkDescriptorSet> m_DescriptorSets;
 		VkDescriptorSetLayout m_DescriptorSetLayout;
 		VkPipelineLayout m_PipelineLayout;
-		VkPipeline m_GraphicsPipeline;
+		PipelineCache *m_PipelineCache;
+		PipelineDescription m_PipelineDescription;
+		PipelineDescription m_EqualDepthPipelineDescription; // The main pipeline testing against the depth prepass
+		PipelineDescription m_DepthPrepassPipelineDescription;
+		PipelineDescription m_QuantizedPipelineDescription; // The main pipeline for scene meshes in VertexLayout::MESH_QUANTIZED
 		Shader *m_Shader;
-		VkRenderPass m_RenderPass;
-		VertexBuffer *m_VertexBuffer;
-		IndexBuffer *m_IndexBuffer;
+		Shader *m_DepthPrepassShader;
+		Shader *m_QuantizedShader;
+		std::vector<GeometryPool*> m_GeometryPools; // Of the scene meshes, one per vertex layout and index type in use
+		Mesh *m_SceneMesh;
+		glm::vec4 m_SceneMeshBoundingSphere; // Mesh space centre and radius
+		std::vector<glm::vec3> m_SceneMeshPositions;
+		std::vector<uint32_t> m_SceneMeshIndices;
+		std::vector<InstanceData> m_SceneInstances;
+		std::vector<glm::vec4> m_SceneInstanceSpheres;
+		CpuCulling *m_SceneCulling; // Holds the scene instances' bounding spheres
+		std::vector<uint32_t> m_VisibleSceneInstances;
+		LodSelection m_SceneLodSelection; // Remembers the level of every scene instance
+
+		// Occlusion culls the scene instances after frustum culling while enabled, the occluders are copies of the whole scene mesh so only as many as fit
+		// in the triangle budget are rasterized
+		SoftwareOcclusion *m_SoftwareOcclusion;
+		SoftwareOcclusion *m_SoftwareOcclusionReference; // Same occluders at a higher resolution, only while the accuracy is measured
+		std::vector<uint32_t> m_SoftwareOccluders;
+		std::vector<uint32_t> m_SoftwareOcclusionVisible;
+		const uint32_t MAX_SOFTWARE_OCCLUDERS = 16;
+		const uint32_t MAX_SOFTWARE_OCCLUDER_TRIANGLES = 1 << 16;
+		const uint32_t MAX_POOL_VERTICES = 1 << 20;
+		const uint32_t MAX_POOL_INDICES = 1 << 22;
 		std::vector<VkBuffer> m_UniformBuffers;
 		std::vector<VkDeviceMemory> m_UniformBuffersMemory;
 		Texture *m_Texture;
@@ -0,0 +1,47 @@
+#pragma once
+
+// Declarations for device extensions that are newer than the Vulkan headers in Dependencies, the values match the Vulkan registry
+#ifndef VK_EXT_extended_dynamic_state
+#define VK_EXT_extended_dynamic_state 1
+#define VK_EXT_EXTENDED_DYNAMIC_STATE_SPEC_VERSION 1
+#define VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME "VK_EXT_extended_dynamic_state"
+
+static const VkStructureType VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT = static_cast<VkStructureType>(1000267000);
+static const VkDynamicState VK_DYNAMIC_STATE_CULL_MODE_EXT = static_cast<VkDynamicState>(1000267000);
+static const VkDynamicState VK_DYNAMIC_STATE_FRONT_FACE_EXT = static_cast<VkDynamicState>(1000267001);
+static const VkDynamicState VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT = static_cast<VkDynamicState>(1000267002);
+static const VkDynamicState VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT = static_cast<VkDynamicState>(1000267006);
+static const VkDynamicState VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT = static_cast<VkDynamicState>(1000267007);
+static const VkDynamicState VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT = static_cast<VkDynamicState>(1000267008);
+
+typedef struct VkPhysicalDeviceExtendedDynamicStateFeaturesEXT
+{
+	VkStructureType sType;
+	void *pNext;
+	VkBool32 extendedDynamicState;
+} VkPhysicalDeviceExtendedDynamicStateFeaturesEXT;
+
+typedef void (VKAPI_PTR *PFN_vkCmdSetCullModeEXT)(VkCommandBuffer commandBuffer, VkCullModeFlags cullMode);
+typedef void (VKAPI_PTR *PFN_vkCmdSetFrontFaceEXT)(VkCommandBuffer commandBuffer, VkFrontFace frontFace);
+typedef void (VKAPI_PTR *PFN_vkCmdSetPrimitiveTopologyEXT)(VkCommandBuffer commandBuffer, VkPrimitiveTopology primitiveTopology);
+typedef void (VKAPI_PTR *PFN_vkCmdSetDepthTestEnableEXT)(VkCommandBuffer commandBuffer, VkBool32 depthTestEnable);
+typedef void (VKAPI_PTR *PFN_vkCmdSetDepthWriteEnableEXT)(VkCommandBuffer commandBuffer, VkBool32 depthWriteEnable);
+typedef void (VKAPI_PTR *PFN_vkCmdSetDepthCompareOpEXT)(VkCommandBuffer commandBuffer, VkCompareOp depthCompareOp);
+#endif
+
+namespace Arcane
+{
+	// Device level entry points of optional extensions, they are left as nullptr when the extension isn't enabled
+	struct VulkanExtensionFunctions
+	{
+		PFN_vkCmdSetCullModeEXT CmdSetCullMode = nullptr;
+		PFN_vkCmdSetFrontFaceEXT CmdSetFrontFace = nullptr;
+		PFN_vkCmdSetPrimitiveTopologyEXT CmdSetPrimitiveTopology = nullptr;
+		PFN_vkCmdSetDepthTestEnableEXT CmdSetDepthTestEnable = nullptr;
+		PFN_vkCmdSetDepthWriteEnableEXT CmdSetDepthWriteEnable = nullptr;
+		PFN_vkCmdSetDepthCompareOpEXT CmdSetDepthCompareOp = nullptr;
+
+		// VK_KHR_draw_indirect_count
+		PFN_vkCmdDrawIndexedIndirectCountKHR CmdDrawIndexedIndirectCount = nullptr;
+	};
+}
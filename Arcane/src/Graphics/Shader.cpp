@@ -1,67 +1,80 @@
 #include "arcpch.h"
 #include "Shader.h"
 
-#include "Core/FileUtils.h"
-#include "Graphics/Renderer/VulkanAPI.h"
+#include "Core/HashUtils.h"
+#include "Graphics/ShaderModule.h"
+#include "Graphics/ShaderLoader.h"
 
 namespace Arcane
 {
-	Shader::Shader(const VulkanAPI *const vulkan, const std::string &vertBinaryPath, const std::string &fragBinaryPath)
-		: m_Vulkan(vulkan), m_VertexBinaryPath(vertBinaryPath), m_FragBinaryPath(fragBinaryPath)
+	Shader::Shader(ShaderModule *vertModule, ShaderModule *fragModule, const ShaderSpecialization &specialization)
+		: m_VertexModule(vertModule), m_FragmentModule(fragModule), m_Specialization(specialization),
+		m_PermutationKey(ComputePermutationKey(vertModule, fragModule, specialization)), m_SpecializationInfo()
 	{
 		Init();
 	}
 
 	Shader::~Shader()
 	{
-		// Can be freed after the PSO is created, but then you can't create new pipeline state objects using said shader at runtime
-		vkDestroyShaderModule(*m_Vulkan->GetDevice(), m_VertexShaderModule, nullptr);
-		vkDestroyShaderModule(*m_Vulkan->GetDevice(), m_FragmentShaderModule, nullptr);
+		ShaderLoader::EvictShader(m_PermutationKey);
+
+		// Modules can be shared with other shaders, so they are only destroyed once the last shader using them lets go
+		ShaderLoader::ReleaseShaderModule(m_VertexModule);
+		if (m_FragmentModule)
+			ShaderLoader::ReleaseShaderModule(m_FragmentModule);
 	}
 
 	void Shader::Init()
 	{
-		std::string vertShaderCode = FileUtils::ReadFile(m_VertexBinaryPath);
-		std::string fragShaderCode = FileUtils::ReadFile(m_FragBinaryPath);
+		ARC_ASSERT(m_VertexModule->GetStage() == VK_SHADER_STAGE_VERTEX_BIT, "Shader: {0} is not a vertex shader", m_VertexModule->GetBinaryPath());
+		ARC_ASSERT(!m_FragmentModule || m_FragmentModule->GetStage() == VK_SHADER_STAGE_FRAGMENT_BIT, "Shader: {0} is not a fragment shader", m_FragmentModule->GetBinaryPath());
+
+		m_Reflection = m_VertexModule->GetReflection();
+		if (m_FragmentModule)
+			m_Reflection.Merge(m_FragmentModule->GetReflection());
 
-		VkShaderModule vertModule = CreateShaderModule(vertShaderCode);
-		VkShaderModule fragModule = CreateShaderModule(fragShaderCode);
+		// Specialization constants are shared by all stages, map entries for constant IDs that a stage doesn't declare are ignored by Vulkan
+		const VkSpecializationInfo *specializationInfo = nullptr;
+		if (!m_Specialization.IsEmpty())
+		{
+			m_Specialization.GetSpecializationData(m_Reflection, m_SpecializationMapEntries, m_SpecializationData);
 
-		m_VertexShaderModule = vertModule;
-		m_FragmentShaderModule = fragModule;
+			m_SpecializationInfo.mapEntryCount = static_cast<uint32_t>(m_SpecializationMapEntries.size());
+			m_SpecializationInfo.pMapEntries = m_SpecializationMapEntries.data();
+			m_SpecializationInfo.dataSize = m_SpecializationData.size() * sizeof(uint32_t);
+			m_SpecializationInfo.pData = m_SpecializationData.data();
+			specializationInfo = &m_SpecializationInfo;
+		}
 
 		VkPipelineShaderStageCreateInfo vertCreateInfo = {};
 		vertCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		vertCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-		vertCreateInfo.module = m_VertexShaderModule;
+		vertCreateInfo.module = m_VertexModule->GetModule();
 		vertCreateInfo.pName = "main";
-		// Possible optimization if you use pSpecializationInfo to set constants at pipeline creation time instead of at render time (only works for constants)
-
-		VkPipelineShaderStageCreateInfo fragCreateInfo = {};
-		fragCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		fragCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		fragCreateInfo.module = m_FragmentShaderModule;
-		fragCreateInfo.pName = "main";
-		// Possible optimization if you use pSpecializationInfo to set constants at pipeline creation time instead of at render time (only works for constants)
+		vertCreateInfo.pSpecializationInfo = specializationInfo;
 
 		m_ShaderStages.reserve(2);
 		m_ShaderStages.push_back(vertCreateInfo);
-		m_ShaderStages.push_back(fragCreateInfo);
+
+		// Without a fragment stage the rasterizer only writes depth, no fragment shader is invoked at all
+		if (m_FragmentModule)
+		{
+			VkPipelineShaderStageCreateInfo fragCreateInfo = {};
+			fragCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			fragCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+			fragCreateInfo.module = m_FragmentModule->GetModule();
+			fragCreateInfo.pName = "main";
+			fragCreateInfo.pSpecializationInfo = specializationInfo;
+			m_ShaderStages.push_back(fragCreateInfo);
+		}
 	}
 
-	VkShaderModule Shader::CreateShaderModule(const std::string &shaderBinary)
+	uint64_t Shader::ComputePermutationKey(const ShaderModule *vertModule, const ShaderModule *fragModule, const ShaderSpecialization &specialization)
 	{
-		std::vector<char> shaderBinaryBuffer(shaderBinary.begin(), shaderBinary.end());
-
-		VkShaderModuleCreateInfo createInfo = {};
-		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		createInfo.codeSize = shaderBinaryBuffer.size();
-		createInfo.pCode = reinterpret_cast<const uint32_t*>(shaderBinaryBuffer.data());
-
-		VkShaderModule shaderModule = VK_NULL_HANDLE;
-		VkResult result = vkCreateShaderModule(*m_Vulkan->GetDevice(), &createInfo, nullptr, &shaderModule);
-		ARC_ASSERT(result == VK_SUCCESS, "Failed to create shader module");
+		uint64_t key = vertModule->GetContentHash();
+		HashUtils::Combine(key, fragModule ? fragModule->GetContentHash() : 0);
+		HashUtils::Combine(key, specialization.GetHash());
 
-		return shaderModule;
+		return key;
 	}
 }
@@ -1,25 +1,38 @@
 #pragma once
 
+#include "Graphics/ShaderSpecialization.h"
+#include "Graphics/ShaderReflection.h"
+
 namespace Arcane
 {
-	class VulkanAPI;
+	class ShaderModule;
 
+	// A set of shared stage modules plus the specialization constants they are pipelined with. Shaders without a fragment module are for depth-only passes
 	class Shader
 	{
 	public:
-		Shader(const VulkanAPI *const vulkan, const std::string &vertBinaryPath, const std::string &fragBinaryPath);
+		Shader(ShaderModule *vertModule, ShaderModule *fragModule, const ShaderSpecialization &specialization = ShaderSpecialization());
 		~Shader();
 
-		inline const std::vector<VkPipelineShaderStageCreateInfo>& GetShaderStages() { return m_ShaderStages; }
+		inline const std::vector<VkPipelineShaderStageCreateInfo>& GetShaderStages() const { return m_ShaderStages; }
+		inline const ShaderSpecialization& GetSpecialization() const { return m_Specialization; }
+		inline const ShaderReflection& GetReflection() const { return m_Reflection; } // Combined interface of all stages
+
+		// Uniquely identifies this permutation (stage binaries + specialization constants), pipelines created with this shader should include it in their key
+		inline uint64_t GetPermutationKey() const { return m_PermutationKey; }
+
+		static uint64_t ComputePermutationKey(const ShaderModule *vertModule, const ShaderModule *fragModule, const ShaderSpecialization &specialization);
 	private:
 		void Init();
-
-		VkShaderModule CreateShaderModule(const std::string &shaderCode);
 	private:
-		const VulkanAPI *const m_Vulkan;
-
-		const std::string m_VertexBinaryPath, m_FragBinaryPath; // TODO: Should probably be removed from release builds
-		VkShaderModule m_VertexShaderModule, m_FragmentShaderModule;
+		ShaderModule *m_VertexModule, *m_FragmentModule; // Owned by the ShaderLoader, this shader holds a reference to each. The fragment module can be null
 		std::vector<VkPipelineShaderStageCreateInfo> m_ShaderStages;
+		ShaderReflection m_Reflection;
+
+		const ShaderSpecialization m_Specialization;
+		const uint64_t m_PermutationKey;
+		std::vector<VkSpecializationMapEntry> m_SpecializationMapEntries;
+		std::vector<uint32_t> m_SpecializationData;
+		VkSpecializationInfo m_SpecializationInfo; // Referenced by m_ShaderStages so it needs to live as long as the shader
 	};
 }
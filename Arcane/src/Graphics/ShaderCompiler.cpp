@@ -0,0 +1,354 @@
+#include "arcpch.h"
+#include "ShaderCompiler.h"
+
+#include "Core/FileUtils.h"
+#include "Core/HashUtils.h"
+#include "Core/JobSystem.h"
+#include "Graphics/ShaderReflection.h"
+
+#include <filesystem>
+
+namespace Arcane
+{
+	namespace fs = std::filesystem;
+
+	static const char *s_ShaderSourceExtensions[] = { ".vert", ".frag", ".comp", ".geom", ".tesc", ".tese" };
+	static const char *s_BuildCacheFileName = "shader_build_cache.txt";
+	static const char *s_BuildCacheHeader = "ArcaneShaderBuildCache 1";
+
+	struct ShaderSourceFile
+	{
+		uint64_t ContentHash = 0;
+		std::vector<std::string> Includes;
+	};
+
+	struct ShaderBuildJob
+	{
+		fs::path SourcePath;
+		fs::path OutputPath;
+		std::string OutputName;
+		uint64_t BuildHash = 0;
+		bool Succeeded = false;
+	};
+
+	static bool IsShaderSource(const fs::path &path)
+	{
+		std::string extension = path.extension().string();
+		for (const char *sourceExtension : s_ShaderSourceExtensions)
+		{
+			if (extension == sourceExtension)
+				return true;
+		}
+
+		return false;
+	}
+
+	// simple.vert -> simple_vert.spv
+	static std::string GetOutputName(const fs::path &sourcePath)
+	{
+		return sourcePath.stem().string() + "_" + sourcePath.extension().string().substr(1) + ".spv";
+	}
+
+	static std::string Quote(const std::string &string)
+	{
+		return "\"" + string + "\"";
+	}
+
+	static int RunCommand(const std::string &command)
+	{
+#ifdef ARC_PLATFORM_WINDOWS
+		// cmd.exe strips the first and last quote of the command line, so the whole command gets wrapped in another pair
+		return std::system(Quote(command).c_str());
+#else
+		return std::system(command.c_str());
+#endif
+	}
+
+	static std::string FindTool(const std::string &toolName, const std::string &overridePath)
+	{
+		if (!overridePath.empty())
+		{
+			return fs::exists(overridePath) ? overridePath : std::string();
+		}
+
+#ifdef ARC_PLATFORM_WINDOWS
+		std::string executableName = toolName + ".exe";
+		const char *nullDevice = "NUL";
+#else
+		std::string executableName = toolName;
+		const char *nullDevice = "/dev/null";
+#endif
+
+		const char *sdkPath = std::getenv("VULKAN_SDK");
+		if (sdkPath)
+		{
+			for (const char *binDirectory : { "Bin", "Bin32", "bin" })
+			{
+				fs::path toolPath = fs::path(sdkPath) / binDirectory / executableName;
+				if (fs::exists(toolPath))
+					return toolPath.string();
+			}
+		}
+
+		if (RunCommand(executableName + " --version > " + nullDevice + " 2>&1") == 0)
+		{
+			return executableName;
+		}
+
+		return std::string();
+	}
+
+	static void ParseIncludes(const std::string &source, std::vector<std::string> &outIncludes)
+	{
+		std::istringstream stream(source);
+		std::string line;
+		while (std::getline(stream, line))
+		{
+			size_t pos = line.find_first_not_of(" \t");
+			if (pos == std::string::npos || line[pos] != '#')
+				continue;
+
+			pos = line.find_first_not_of(" \t", pos + 1);
+			if (pos == std::string::npos || line.compare(pos, 7, "include") != 0)
+				continue;
+
+			size_t start = line.find_first_of("\"<", pos + 7);
+			if (start == std::string::npos)
+				continue;
+
+			size_t end = line.find(line[start] == '"' ? '"' : '>', start + 1);
+			if (end == std::string::npos)
+				continue;
+
+			outIncludes.push_back(line.substr(start + 1, end - start - 1));
+		}
+	}
+
+	static const ShaderSourceFile* GetSourceFile(const fs::path &path, std::unordered_map<std::string, ShaderSourceFile> &sourceFiles)
+	{
+		std::string key = path.lexically_normal().string();
+		auto iter = sourceFiles.find(key);
+		if (iter != sourceFiles.end())
+		{
+			return &iter->second;
+		}
+
+		std::string source = FileUtils::ReadFile(key);
+
+		ShaderSourceFile sourceFile;
+		sourceFile.ContentHash = HashUtils::HashString(source);
+		ParseIncludes(source, sourceFile.Includes);
+
+		return &sourceFiles.insert(std::pair<std::string, ShaderSourceFile>(key, std::move(sourceFile))).first->second;
+	}
+
+	// Combines the content hash of a source file with everything it includes, directly or indirectly. Include files are searched
+	// for relative to the including file first and then in the shader source directory, same as the compiler does
+	static void HashSourceWithIncludes(const fs::path &path, const fs::path &includeDirectory, std::unordered_map<std::string, ShaderSourceFile> &sourceFiles,
+		std::set<std::string> &visited, uint64_t &inOutHash)
+	{
+		if (!visited.insert(path.lexically_normal().string()).second)
+			return;
+
+		const ShaderSourceFile *sourceFile = GetSourceFile(path, sourceFiles);
+		HashUtils::Combine(inOutHash, sourceFile->ContentHash);
+
+		for (const std::string &include : sourceFile->Includes)
+		{
+			fs::path includePath = path.parent_path() / include;
+			if (!fs::exists(includePath))
+				includePath = includeDirectory / include;
+
+			if (!fs::exists(includePath))
+			{
+				// Let the compiler report the missing file, hash the name so the shader is rebuilt once it exists
+				HashUtils::Combine(inOutHash, HashUtils::HashString(include));
+				continue;
+			}
+
+			HashSourceWithIncludes(includePath, includeDirectory, sourceFiles, visited, inOutHash);
+		}
+	}
+
+	static void ReadBuildCache(const fs::path &cachePath, std::unordered_map<std::string, uint64_t> &outEntries)
+	{
+		std::ifstream stream(cachePath);
+		if (!stream)
+			return;
+
+		std::string header;
+		if (!std::getline(stream, header) || header != s_BuildCacheHeader)
+			return;
+
+		std::string outputName;
+		uint64_t buildHash;
+		while (stream >> std::hex >> buildHash >> outputName)
+		{
+			outEntries[outputName] = buildHash;
+		}
+	}
+
+	static void WriteBuildCache(const fs::path &cachePath, const std::vector<ShaderBuildJob> &jobs)
+	{
+		std::ofstream stream(cachePath, std::ios::out | std::ios::trunc);
+		if (!stream)
+		{
+			ARC_LOG_WARN("ShaderCompiler: Could not write build cache {0}", cachePath.string());
+			return;
+		}
+
+		stream << s_BuildCacheHeader << "\n";
+		for (const ShaderBuildJob &job : jobs)
+		{
+			if (job.Succeeded)
+				stream << std::hex << job.BuildHash << " " << job.OutputName << "\n";
+		}
+	}
+
+	static bool CompileShader(const ShaderBuildJob &job, const ShaderCompileSettings &settings, const std::string &compilerPath, const std::string &compilerArguments,
+		const std::string &optimizerPath, const std::string &optimizerArguments)
+	{
+		bool runOptimizer = !optimizerPath.empty();
+		std::string compilerOutput = runOptimizer ? job.OutputPath.string() + ".unoptimized" : job.OutputPath.string();
+
+		std::string command = Quote(compilerPath) + " " + compilerArguments + " -I " + Quote(settings.SourceDirectory) + " " + Quote(job.SourcePath.string()) + " -o " + Quote(compilerOutput);
+		if (RunCommand(command) != 0)
+		{
+			return false;
+		}
+
+		if (!runOptimizer)
+		{
+			return true;
+		}
+
+		// Stripping the debug info removes every name from the binary, so reflect it beforehand and store the result in the reflection cache of the stripped binary
+		std::vector<uint32_t> code;
+		ShaderReflection reflection;
+		bool reflected = FileUtils::ReadSpirvFile(compilerOutput, code) && reflection.Reflect(code.data(), code.size());
+
+		command = Quote(optimizerPath) + " " + optimizerArguments + " " + Quote(compilerOutput) + " -o " + Quote(job.OutputPath.string());
+		bool optimized = RunCommand(command) == 0;
+
+		std::error_code error;
+		fs::remove(compilerOutput, error);
+
+		if (!optimized || !reflected || !FileUtils::ReadSpirvFile(job.OutputPath.string(), code))
+		{
+			return false;
+		}
+
+		reflection.SaveCache(job.OutputPath.string(), HashUtils::HashBytes(code.data(), code.size() * sizeof(uint32_t)));
+		return true;
+	}
+
+	bool ShaderCompiler::CompileShaders(const ShaderCompileSettings &settings, ShaderCompileStats *outStats)
+	{
+		ShaderCompileStats stats;
+		if (outStats)
+		{
+			*outStats = stats;
+		}
+
+		fs::path sourceDirectory(settings.SourceDirectory);
+		fs::path outputDirectory(settings.OutputDirectory);
+		if (!fs::is_directory(sourceDirectory))
+		{
+			ARC_LOG_ERROR("ShaderCompiler: Shader source directory {0} does not exist", settings.SourceDirectory);
+			return false;
+		}
+
+		std::string compilerPath = FindTool("glslc", settings.CompilerPath);
+		if (compilerPath.empty())
+		{
+			ARC_LOG_ERROR("ShaderCompiler: Could not find glslc, install the Vulkan SDK or set the compiler path");
+			return false;
+		}
+
+		std::string optimizerPath;
+		if (settings.Optimize)
+		{
+			optimizerPath = FindTool("spirv-opt", settings.OptimizerPath);
+			if (optimizerPath.empty())
+			{
+				ARC_LOG_WARN("ShaderCompiler: Could not find spirv-opt, release shaders will be optimized by glslc but keep their debug info");
+			}
+		}
+
+		// Everything that changes the output is part of the build hash, so switching between debug and release shaders rebuilds them
+		std::string compilerArguments = settings.Optimize ? "-O" : "-g";
+		std::string optimizerArguments = "-O --strip-debug";
+		uint64_t optionsHash = HashUtils::HashString(compilerArguments + "|" + (optimizerPath.empty() ? std::string() : optimizerArguments));
+
+		fs::create_directories(outputDirectory);
+		fs::path cachePath = outputDirectory / s_BuildCacheFileName;
+		std::unordered_map<std::string, uint64_t> cacheEntries;
+		if (!settings.ForceRebuild)
+		{
+			ReadBuildCache(cachePath, cacheEntries);
+		}
+
+		std::vector<ShaderBuildJob> jobs;
+		std::vector<ShaderBuildJob*> staleJobs;
+		std::unordered_map<std::string, ShaderSourceFile> sourceFiles;
+		for (const fs::directory_entry &entry : fs::directory_iterator(sourceDirectory))
+		{
+			if (entry.is_regular_file() && IsShaderSource(entry.path()))
+			{
+				ShaderBuildJob job;
+				job.SourcePath = entry.path();
+				job.OutputName = GetOutputName(entry.path());
+				job.OutputPath = outputDirectory / job.OutputName;
+				job.BuildHash = optionsHash;
+
+				std::set<std::string> visited;
+				HashSourceWithIncludes(job.SourcePath, sourceDirectory, sourceFiles, visited, job.BuildHash);
+
+				jobs.push_back(job);
+			}
+		}
+
+		for (ShaderBuildJob &job : jobs)
+		{
+			auto iter = cacheEntries.find(job.OutputName);
+			job.Succeeded = iter != cacheEntries.end() && iter->second == job.BuildHash && fs::exists(job.OutputPath);
+			if (!job.Succeeded)
+			{
+				staleJobs.push_back(&job);
+			}
+		}
+
+		// Each shader is compiled by its own compiler process, so the stale shaders are spread across every core
+		JobSystem::ParallelFor(static_cast<uint32_t>(staleJobs.size()), 1, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; i++)
+			{
+				ShaderBuildJob *job = staleJobs[i];
+				job->Succeeded = CompileShader(*job, settings, compilerPath, compilerArguments, optimizerPath, optimizerArguments);
+				if (!job->Succeeded)
+				{
+					ARC_LOG_ERROR("ShaderCompiler: Failed to compile {0}", job->SourcePath.string());
+				}
+			}
+		});
+
+		WriteBuildCache(cachePath, jobs);
+
+		stats.ShaderCount = static_cast<uint32_t>(jobs.size());
+		for (const ShaderBuildJob *job : staleJobs)
+		{
+			if (job->Succeeded)
+				stats.CompiledCount++;
+			else
+				stats.FailedCount++;
+		}
+
+		ARC_LOG_INFO("ShaderCompiler: {0} shaders, {1} compiled, {2} up to date, {3} failed", stats.ShaderCount, stats.CompiledCount, stats.ShaderCount - stats.CompiledCount - stats.FailedCount, stats.FailedCount);
+
+		if (outStats)
+		{
+			*outStats = stats;
+		}
+		return stats.FailedCount == 0;
+	}
+}
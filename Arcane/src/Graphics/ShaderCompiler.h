@@ -0,0 +1,30 @@
+#pragma once
+
+namespace Arcane
+{
+	struct ShaderCompileSettings
+	{
+		std::string SourceDirectory = "res/Shaders/";
+		std::string OutputDirectory = "res/Shaders/";
+		std::string CompilerPath; // Leave empty to look for glslc in the Vulkan SDK and then on the PATH
+		std::string OptimizerPath; // Leave empty to look for spirv-opt in the same places
+		bool Optimize = false; // Release builds, optimizes the SPIR-V and strips its debug info
+		bool ForceRebuild = false;
+	};
+
+	struct ShaderCompileStats
+	{
+		uint32_t ShaderCount = 0;
+		uint32_t CompiledCount = 0;
+		uint32_t FailedCount = 0;
+	};
+
+	// Incremental shader build step. Every shader source (.vert, .frag, .comp, ...) is keyed on the hash of its contents, the contents of
+	// every file it #includes and the compiler options, so only shaders that actually changed get recompiled
+	class ShaderCompiler
+	{
+	public:
+		// Returns false if any shader failed to compile or the compiler could not be found
+		static bool CompileShaders(const ShaderCompileSettings &settings, ShaderCompileStats *outStats = nullptr);
+	};
+}
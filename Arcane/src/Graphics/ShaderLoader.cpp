@@ -1,34 +1,145 @@
 #include "arcpch.h"
 #include "ShaderLoader.h"
 
+#include "Core/FileUtils.h"
+#include "Core/HashUtils.h"
 #include "Graphics/Renderer/VulkanAPI.h"
 #include "Graphics/Shader.h"
+#include "Graphics/ComputeShader.h"
+#include "Graphics/ShaderModule.h"
 
 namespace Arcane
 {
 	VulkanAPI* ShaderLoader::s_Vulkan = nullptr;
-	std::unordered_map<size_t, Shader*> ShaderLoader::s_ShaderCache;
-	std::hash<std::string> ShaderLoader::s_Hasher;
+	std::unordered_map<uint64_t, Shader*> ShaderLoader::s_ShaderCache;
+	std::unordered_map<uint64_t, ComputeShader*> ShaderLoader::s_ComputeShaderCache;
+	std::unordered_map<uint64_t, ShaderModule*> ShaderLoader::s_ModuleCache;
+	std::unordered_map<std::string, ShaderModule*> ShaderLoader::s_ModulePathCache;
 
 	void ShaderLoader::Initialize(VulkanAPI *vulkan)
 	{
 		s_Vulkan = vulkan;
 	}
 
-	Shader* ShaderLoader::LoadShader(const std::string &vertPath, const std::string &fragPath)
+	Shader* ShaderLoader::LoadShader(const std::string &vertPath, const std::string &fragPath, const ShaderSpecialization *specialization)
 	{
 		ARC_ASSERT(s_Vulkan, "Shader: Can't load shader when ShaderLoader is not initialized");
 
-		size_t hash = s_Hasher(vertPath + fragPath);
+		ShaderSpecialization defaultSpecialization;
+		if (!specialization)
+		{
+			specialization = &defaultSpecialization;
+		}
+
+		ShaderModule *vertModule = AcquireShaderModule(vertPath);
+		ShaderModule *fragModule = fragPath.empty() ? nullptr : AcquireShaderModule(fragPath);
+
+		uint64_t hash = Shader::ComputePermutationKey(vertModule, fragModule, *specialization);
 		auto iter = s_ShaderCache.find(hash);
 		if (iter != s_ShaderCache.end())
 		{
+			// The cached shader already holds its own references to these modules
+			ReleaseShaderModule(vertModule);
+			if (fragModule)
+				ReleaseShaderModule(fragModule);
 			return iter->second;
 		}
 
-		Shader *shader = new Shader(s_Vulkan, vertPath, fragPath);
+		Shader *shader = new Shader(vertModule, fragModule, *specialization);
 
-		s_ShaderCache.insert(std::pair<size_t, Shader*>(hash, shader));
+		s_ShaderCache.insert(std::pair<uint64_t, Shader*>(hash, shader));
 		return shader;
 	}
+
+	ComputeShader* ShaderLoader::LoadComputeShader(const std::string &compPath, const ShaderSpecialization *specialization)
+	{
+		ARC_ASSERT(s_Vulkan, "Shader: Can't load shader when ShaderLoader is not initialized");
+
+		ShaderSpecialization defaultSpecialization;
+		if (!specialization)
+		{
+			specialization = &defaultSpecialization;
+		}
+
+		ShaderModule *compModule = AcquireShaderModule(compPath);
+
+		uint64_t hash = ComputeShader::ComputePermutationKey(compModule, *specialization);
+		auto iter = s_ComputeShaderCache.find(hash);
+		if (iter != s_ComputeShaderCache.end())
+		{
+			ReleaseShaderModule(compModule);
+			return iter->second;
+		}
+
+		ComputeShader *shader = new ComputeShader(compModule, *specialization);
+
+		s_ComputeShaderCache.insert(std::pair<uint64_t, ComputeShader*>(hash, shader));
+		return shader;
+	}
+
+	void ShaderLoader::EvictShader(uint64_t permutationKey)
+	{
+		s_ShaderCache.erase(permutationKey);
+	}
+
+	void ShaderLoader::EvictComputeShader(uint64_t permutationKey)
+	{
+		s_ComputeShaderCache.erase(permutationKey);
+	}
+
+	ShaderModule* ShaderLoader::AcquireShaderModule(const std::string &binaryPath)
+	{
+		ARC_ASSERT(s_Vulkan, "Shader: Can't load shader module when ShaderLoader is not initialized");
+
+		ShaderModule *module = nullptr;
+		auto pathIter = s_ModulePathCache.find(binaryPath);
+		if (pathIter != s_ModulePathCache.end())
+		{
+			module = pathIter->second;
+		}
+		else
+		{
+			std::vector<uint32_t> code;
+			bool loaded = FileUtils::ReadSpirvFile(binaryPath, code);
+			ARC_ASSERT(loaded, "Shader: Failed to load SPIR-V binary {0}", binaryPath);
+
+			uint64_t contentHash = HashUtils::HashBytes(code.data(), code.size() * sizeof(uint32_t));
+			auto moduleIter = s_ModuleCache.find(contentHash);
+			if (moduleIter != s_ModuleCache.end())
+			{
+				module = moduleIter->second;
+			}
+			else
+			{
+				module = new ShaderModule(s_Vulkan, binaryPath, code, contentHash);
+				s_ModuleCache.insert(std::pair<uint64_t, ShaderModule*>(contentHash, module));
+			}
+
+			s_ModulePathCache.insert(std::pair<std::string, ShaderModule*>(binaryPath, module));
+		}
+
+		module->m_RefCount++;
+		return module;
+	}
+
+	void ShaderLoader::ReleaseShaderModule(ShaderModule *module)
+	{
+		ARC_ASSERT(module && module->m_RefCount > 0, "Shader: Releasing a shader module that has no references");
+
+		if (--module->m_RefCount > 0)
+		{
+			return;
+		}
+
+		for (auto iter = s_ModulePathCache.begin(); iter != s_ModulePathCache.end();)
+		{
+			if (iter->second == module)
+				iter = s_ModulePathCache.erase(iter);
+			else
+				++iter;
+		}
+		s_ModuleCache.erase(module->GetContentHash());
+
+		delete module;
+	}
 }
@@ -4,17 +4,33 @@ namespace Arcane
 {
 	class VulkanAPI;
 	class Shader;
+	class ComputeShader;
+	class ShaderModule;
+	class ShaderSpecialization;
 
 	class ShaderLoader
 	{
 	public:
 		static void Initialize(VulkanAPI *vulkan);
 
-		static Shader* LoadShader(const std::string &vertPath, const std::string &fragPath);
+		// Each unique set of specialization constants creates its own shader permutation, the SPIR-V binaries on disk are shared.
+		// An empty fragment path loads a vertex only shader for depth-only passes
+		static Shader* LoadShader(const std::string &vertPath, const std::string &fragPath, const ShaderSpecialization *specialization = nullptr);
+		static ComputeShader* LoadComputeShader(const std::string &compPath, const ShaderSpecialization *specialization = nullptr);
+
+		// Returns the module for a SPIR-V binary with a reference added. Binaries with identical contents share one module no matter what path they were loaded from
+		static ShaderModule* AcquireShaderModule(const std::string &binaryPath);
+		static void ReleaseShaderModule(ShaderModule *module);
+
+		// Called when a shader is deleted so the cache never hands it out again
+		static void EvictShader(uint64_t permutationKey);
+		static void EvictComputeShader(uint64_t permutationKey);
 	private:
 		static VulkanAPI *s_Vulkan;
 
-		static std::unordered_map<size_t, Shader*> s_ShaderCache;
-		static std::hash<std::string> s_Hasher;
+		static std::unordered_map<uint64_t, Shader*> s_ShaderCache;
+		static std::unordered_map<uint64_t, ComputeShader*> s_ComputeShaderCache;
+		static std::unordered_map<uint64_t, ShaderModule*> s_ModuleCache; // Keyed on the hash of the SPIR-V contents
+		static std::unordered_map<std::string, ShaderModule*> s_ModulePathCache; // Avoids re-reading and re-hashing binaries that are already loaded
 	};
 }
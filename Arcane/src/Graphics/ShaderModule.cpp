@@ -0,0 +1,29 @@
+#include "arcpch.h"
+#include "ShaderModule.h"
+
+#include "Graphics/Renderer/VulkanAPI.h"
+
+namespace Arcane
+{
+	ShaderModule::ShaderModule(const VulkanAPI *const vulkan, const std::string &binaryPath, const std::vector<uint32_t> &code, uint64_t contentHash)
+		: m_Vulkan(vulkan), m_BinaryPath(binaryPath), m_ContentHash(contentHash), m_RefCount(0), m_Module(VK_NULL_HANDLE), m_Stage(VK_SHADER_STAGE_ALL)
+	{
+		// The code is already stored as 32-bit words, so it can be handed straight to Vulkan without copying it into another buffer
+		VkShaderModuleCreateInfo createInfo = {};
+		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		createInfo.codeSize = code.size() * sizeof(uint32_t);
+		createInfo.pCode = code.data();
+
+		VkResult result = vkCreateShaderModule(*m_Vulkan->GetDevice(), &createInfo, nullptr, &m_Module);
+		ARC_ASSERT(result == VK_SUCCESS, "Failed to create shader module");
+
+		bool reflected = m_Reflection.LoadOrReflect(m_BinaryPath, code.data(), code.size(), m_ContentHash);
+		ARC_ASSERT(reflected, "ShaderModule: Failed to reflect {0}", m_BinaryPath);
+		m_Stage = static_cast<VkShaderStageFlagBits>(m_Reflection.GetStageFlags());
+	}
+
+	ShaderModule::~ShaderModule()
+	{
+		vkDestroyShaderModule(*m_Vulkan->GetDevice(), m_Module, nullptr);
+	}
+}
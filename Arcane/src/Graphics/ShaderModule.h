@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Graphics/ShaderReflection.h"
+
+namespace Arcane
+{
+	class VulkanAPI;
+	class ShaderLoader;
+
+	// A single compiled SPIR-V stage. Modules are cached by the ShaderLoader on the hash of their contents and ref-counted,
+	// so every shader that uses the same stage binary shares one VkShaderModule
+	class ShaderModule
+	{
+		friend ShaderLoader;
+	public:
+		ShaderModule(const VulkanAPI *const vulkan, const std::string &binaryPath, const std::vector<uint32_t> &code, uint64_t contentHash);
+		~ShaderModule();
+
+		inline VkShaderModule GetModule() const { return m_Module; }
+		inline VkShaderStageFlagBits GetStage() const { return m_Stage; }
+		inline uint64_t GetContentHash() const { return m_ContentHash; }
+		inline const std::string& GetBinaryPath() const { return m_BinaryPath; }
+		inline const ShaderReflection& GetReflection() const { return m_Reflection; }
+	private:
+		const VulkanAPI *const m_Vulkan;
+
+		const std::string m_BinaryPath; // Path of the binary that first created this module
+		const uint64_t m_ContentHash;
+		uint32_t m_RefCount;
+
+		VkShaderModule m_Module;
+		VkShaderStageFlagBits m_Stage;
+		ShaderReflection m_Reflection;
+	};
+}
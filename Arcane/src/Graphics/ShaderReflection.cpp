@@ -0,0 +1,772 @@
+#include "arcpch.h"
+#include "ShaderReflection.h"
+
+namespace Arcane
+{
+	// Subset of the SPIR-V spec that is needed for reflection - https://www.khronos.org/registry/spir-v/specs/unified1/SPIRV.html
+	static const uint32_t s_SpirvMagicNumber = 0x07230203;
+	static const uint32_t s_SpirvUnset = ~0u;
+
+	enum SpirvOp : uint32_t
+	{
+		SpirvOpName = 5,
+		SpirvOpEntryPoint = 15,
+		SpirvOpExecutionMode = 16,
+		SpirvOpTypeBool = 20,
+		SpirvOpTypeInt = 21,
+		SpirvOpTypeFloat = 22,
+		SpirvOpTypeVector = 23,
+		SpirvOpTypeMatrix = 24,
+		SpirvOpTypeImage = 25,
+		SpirvOpTypeSampler = 26,
+		SpirvOpTypeSampledImage = 27,
+		SpirvOpTypeArray = 28,
+		SpirvOpTypeRuntimeArray = 29,
+		SpirvOpTypeStruct = 30,
+		SpirvOpTypePointer = 32,
+		SpirvOpConstant = 43,
+		SpirvOpSpecConstantTrue = 48,
+		SpirvOpSpecConstantFalse = 49,
+		SpirvOpSpecConstant = 50,
+		SpirvOpFunction = 54,
+		SpirvOpVariable = 59,
+		SpirvOpDecorate = 71,
+		SpirvOpMemberDecorate = 72,
+	};
+
+	enum SpirvExecutionMode : uint32_t
+	{
+		SpirvExecutionModeLocalSize = 17,
+	};
+
+	enum SpirvDecoration : uint32_t
+	{
+		SpirvDecorationSpecId = 1,
+		SpirvDecorationBlock = 2,
+		SpirvDecorationBufferBlock = 3,
+		SpirvDecorationArrayStride = 6,
+		SpirvDecorationMatrixStride = 7,
+		SpirvDecorationBuiltIn = 11,
+		SpirvDecorationLocation = 30,
+		SpirvDecorationBinding = 33,
+		SpirvDecorationDescriptorSet = 34,
+		SpirvDecorationOffset = 35,
+	};
+
+	enum SpirvStorageClass : uint32_t
+	{
+		SpirvStorageClassUniformConstant = 0,
+		SpirvStorageClassInput = 1,
+		SpirvStorageClassUniform = 2,
+		SpirvStorageClassPushConstant = 9,
+		SpirvStorageClassStorageBuffer = 12,
+	};
+
+	enum SpirvDim : uint32_t
+	{
+		SpirvDimBuffer = 5,
+		SpirvDimSubpassData = 6,
+	};
+
+	// Everything we know about a single SPIR-V result id
+	struct SpirvId
+	{
+		uint32_t Opcode = 0;
+		std::vector<uint32_t> Operands; // Operands of the declaring instruction that come after the result id
+		std::string Name;
+
+		uint32_t StorageClass = s_SpirvUnset;
+		uint32_t TypeID = s_SpirvUnset; // Result type for variables and constants
+		uint32_t ConstantValue = 0;
+
+		uint32_t Set = s_SpirvUnset, Binding = s_SpirvUnset, Location = s_SpirvUnset, SpecID = s_SpirvUnset;
+		uint32_t ArrayStride = 0;
+		bool BuiltIn = false, Block = false, BufferBlock = false;
+
+		std::vector<uint32_t> MemberOffsets, MemberMatrixStrides;
+	};
+
+	static std::string ReadSpirvString(const uint32_t *words, uint32_t wordCount)
+	{
+		const char *chars = reinterpret_cast<const char*>(words);
+		size_t maxLength = static_cast<size_t>(wordCount) * sizeof(uint32_t);
+
+		size_t length = 0;
+		while (length < maxLength && chars[length] != '\0')
+			length++;
+
+		return std::string(chars, length);
+	}
+
+	static void SetMemberDecoration(std::vector<uint32_t> &memberValues, uint32_t member, uint32_t value)
+	{
+		if (memberValues.size() <= member)
+			memberValues.resize(member + 1, 0);
+		memberValues[member] = value;
+	}
+
+	static VkShaderStageFlagBits ExecutionModelToStage(uint32_t executionModel)
+	{
+		switch (executionModel)
+		{
+		case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+		case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+		case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+		case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+		case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+		case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+
+		ARC_LOG_WARN("ShaderReflection: Unsupported execution model {0}", executionModel);
+		return VK_SHADER_STAGE_ALL;
+	}
+
+	static uint32_t GetSpirvTypeSize(const std::vector<SpirvId> &ids, uint32_t typeID)
+	{
+		const SpirvId &type = ids[typeID];
+		switch (type.Opcode)
+		{
+		case SpirvOpTypeBool:
+			return 4;
+		case SpirvOpTypeInt:
+		case SpirvOpTypeFloat:
+			return type.Operands[0] / 8;
+		case SpirvOpTypeVector:
+		case SpirvOpTypeMatrix:
+			return GetSpirvTypeSize(ids, type.Operands[0]) * type.Operands[1];
+		case SpirvOpTypeArray:
+		{
+			uint32_t length = ids[type.Operands[1]].ConstantValue;
+			uint32_t stride = type.ArrayStride ? type.ArrayStride : GetSpirvTypeSize(ids, type.Operands[0]);
+			return stride * length;
+		}
+		case SpirvOpTypeStruct:
+		{
+			uint32_t size = 0;
+			for (uint32_t member = 0; member < type.Operands.size(); member++)
+			{
+				uint32_t memberTypeID = type.Operands[member];
+				uint32_t memberOffset = member < type.MemberOffsets.size() ? type.MemberOffsets[member] : 0;
+				uint32_t memberSize = GetSpirvTypeSize(ids, memberTypeID);
+
+				// Matrices inside of blocks are padded to their matrix stride (ie. a mat3 has vec4 columns with std140/std430)
+				if (ids[memberTypeID].Opcode == SpirvOpTypeMatrix && member < type.MemberMatrixStrides.size() && type.MemberMatrixStrides[member] != 0)
+				{
+					memberSize = type.MemberMatrixStrides[member] * ids[memberTypeID].Operands[1];
+				}
+
+				size = std::max(size, memberOffset + memberSize);
+			}
+			return size;
+		}
+		}
+
+		return 0;
+	}
+
+	static VkDescriptorType GetSpirvDescriptorType(const std::vector<SpirvId> &ids, uint32_t typeID, uint32_t storageClass)
+	{
+		const SpirvId &type = ids[typeID];
+		switch (storageClass)
+		{
+		case SpirvStorageClassUniformConstant:
+			if (type.Opcode == SpirvOpTypeSampler)
+			{
+				return VK_DESCRIPTOR_TYPE_SAMPLER;
+			}
+			else if (type.Opcode == SpirvOpTypeSampledImage)
+			{
+				const SpirvId &image = ids[type.Operands[0]];
+				return image.Operands[1] == SpirvDimBuffer ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			}
+			else if (type.Opcode == SpirvOpTypeImage)
+			{
+				// Operands: sampled type, dim, depth, arrayed, multisampled, sampled (1 = used with a sampler, 2 = storage image), format
+				uint32_t dim = type.Operands[1];
+				bool sampled = type.Operands[5] == 1;
+				if (dim == SpirvDimSubpassData)
+					return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+				if (dim == SpirvDimBuffer)
+					return sampled ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+				return sampled ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			}
+			break;
+		case SpirvStorageClassUniform:
+			if (type.BufferBlock)
+				return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER; // Pre SPIR-V 1.3 storage buffers
+			return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		case SpirvStorageClassStorageBuffer:
+			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		}
+
+		return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+	}
+
+	static VkFormat GetSpirvVertexFormat(const std::vector<SpirvId> &ids, uint32_t typeID)
+	{
+		uint32_t componentCount = 1;
+		const SpirvId *scalar = &ids[typeID];
+		if (scalar->Opcode == SpirvOpTypeVector)
+		{
+			componentCount = scalar->Operands[1];
+			scalar = &ids[scalar->Operands[0]];
+		}
+
+		if (scalar->Operands.empty() || scalar->Operands[0] != 32 || componentCount < 1 || componentCount > 4)
+		{
+			return VK_FORMAT_UNDEFINED;
+		}
+
+		static const VkFormat floatFormats[] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+		static const VkFormat intFormats[] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+		static const VkFormat uintFormats[] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+
+		if (scalar->Opcode == SpirvOpTypeFloat)
+			return floatFormats[componentCount - 1];
+		if (scalar->Opcode == SpirvOpTypeInt)
+			return scalar->Operands[1] ? intFormats[componentCount - 1] : uintFormats[componentCount - 1];
+
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	// Float inputs can be fed from normalized and half float formats, the vertex fetch converts them and fills in or drops components to match the input
+	static bool IsVertexFormatCompatible(VkFormat inputFormat, VkFormat attributeFormat)
+	{
+		if (inputFormat == attributeFormat)
+			return true;
+
+		bool floatInput = inputFormat == VK_FORMAT_R32_SFLOAT || inputFormat == VK_FORMAT_R32G32_SFLOAT || inputFormat == VK_FORMAT_R32G32B32_SFLOAT || inputFormat == VK_FORMAT_R32G32B32A32_SFLOAT;
+		if (!floatInput)
+			return false;
+
+		switch (attributeFormat)
+		{
+		case VK_FORMAT_R32_SFLOAT: case VK_FORMAT_R32G32_SFLOAT: case VK_FORMAT_R32G32B32_SFLOAT: case VK_FORMAT_R32G32B32A32_SFLOAT:
+		case VK_FORMAT_R16_SFLOAT: case VK_FORMAT_R16G16_SFLOAT: case VK_FORMAT_R16G16B16A16_SFLOAT:
+		case VK_FORMAT_R16_SNORM: case VK_FORMAT_R16G16_SNORM: case VK_FORMAT_R16G16B16A16_SNORM:
+		case VK_FORMAT_R16_UNORM: case VK_FORMAT_R16G16_UNORM: case VK_FORMAT_R16G16B16A16_UNORM:
+		case VK_FORMAT_R8_SNORM: case VK_FORMAT_R8G8_SNORM: case VK_FORMAT_R8G8B8A8_SNORM:
+		case VK_FORMAT_R8_UNORM: case VK_FORMAT_R8G8_UNORM: case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_A2B10G10R10_SNORM_PACK32: case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	bool ShaderReflection::Reflect(const uint32_t *code, size_t wordCount)
+	{
+		*this = ShaderReflection();
+
+		if (wordCount < 5 || code[0] != s_SpirvMagicNumber)
+		{
+			ARC_LOG_ERROR("ShaderReflection: Binary is not valid SPIR-V");
+			return false;
+		}
+
+		uint32_t idBound = code[3];
+		std::vector<SpirvId> ids(idBound);
+
+		VkShaderStageFlagBits stage = VK_SHADER_STAGE_ALL;
+		size_t wordIndex = 5; // Skip the header
+		while (wordIndex < wordCount)
+		{
+			uint32_t opcode = code[wordIndex] & 0xFFFF;
+			uint32_t instructionWordCount = code[wordIndex] >> 16;
+			if (instructionWordCount == 0 || wordIndex + instructionWordCount > wordCount)
+			{
+				ARC_LOG_ERROR("ShaderReflection: Malformed SPIR-V instruction at word {0}", wordIndex);
+				return false;
+			}
+
+			// Resource declarations are all done before the first function, so there is no need to parse any function bodies
+			if (opcode == SpirvOpFunction)
+				break;
+
+			const uint32_t *operands = code + wordIndex + 1;
+			uint32_t operandCount = instructionWordCount - 1;
+
+			// The operands each instruction below reads, and which of them are ids that index into ids. A truncated or malformed binary would read or write out of bounds
+			uint32_t requiredOperandCount = 0;
+			uint32_t idOperands[2] = { 0, 0 };
+			uint32_t idOperandCount = 0;
+			switch (opcode)
+			{
+			case SpirvOpEntryPoint: requiredOperandCount = 1; break;
+			case SpirvOpExecutionMode: requiredOperandCount = 2; break;
+			case SpirvOpName: requiredOperandCount = 1; idOperandCount = 1; break;
+			case SpirvOpDecorate: requiredOperandCount = 2; idOperandCount = 1; break;
+			case SpirvOpMemberDecorate: requiredOperandCount = 3; idOperandCount = 1; break;
+			case SpirvOpTypeBool: case SpirvOpTypeInt: case SpirvOpTypeFloat: case SpirvOpTypeVector: case SpirvOpTypeMatrix: case SpirvOpTypeImage: case SpirvOpTypeSampler:
+			case SpirvOpTypeSampledImage: case SpirvOpTypeArray: case SpirvOpTypeRuntimeArray: case SpirvOpTypeStruct:
+				requiredOperandCount = 1; idOperandCount = 1; break;
+			case SpirvOpTypePointer: requiredOperandCount = 3; idOperands[1] = 2; idOperandCount = 2; break;
+			case SpirvOpConstant: case SpirvOpSpecConstantTrue: case SpirvOpSpecConstantFalse: case SpirvOpSpecConstant: case SpirvOpVariable:
+				requiredOperandCount = opcode == SpirvOpVariable ? 3 : 2; idOperands[1] = 1; idOperandCount = 2; break;
+			}
+			if (operandCount < requiredOperandCount)
+			{
+				ARC_LOG_ERROR("ShaderReflection: Malformed SPIR-V instruction at word {0}", wordIndex);
+				*this = ShaderReflection();
+				return false;
+			}
+			for (uint32_t i = 0; i < idOperandCount; i++)
+			{
+				uint32_t id = operands[idOperands[i]];
+				ARC_ASSERT(id < idBound, "ShaderReflection: SPIR-V id {0} at word {1} is outside of the id bound {2}", id, wordIndex, idBound);
+				if (id >= idBound)
+				{
+					*this = ShaderReflection();
+					return false;
+				}
+			}
+
+			switch (opcode)
+			{
+			case SpirvOpEntryPoint:
+				if (stage == VK_SHADER_STAGE_ALL)
+					stage = ExecutionModelToStage(operands[0]);
+				break;
+			case SpirvOpExecutionMode:
+				if (operands[1] == SpirvExecutionModeLocalSize && operandCount >= 5)
+				{
+					m_WorkgroupSize = { operands[2], operands[3], operands[4] };
+				}
+				break;
+			case SpirvOpName:
+				ids[operands[0]].Name = ReadSpirvString(operands + 1, operandCount - 1);
+				break;
+			case SpirvOpDecorate:
+			{
+				SpirvId &target = ids[operands[0]];
+				uint32_t literal = operandCount > 2 ? operands[2] : 0;
+				switch (operands[1])
+				{
+				case SpirvDecorationSpecId: target.SpecID = literal; break;
+				case SpirvDecorationBlock: target.Block = true; break;
+				case SpirvDecorationBufferBlock: target.BufferBlock = true; break;
+				case SpirvDecorationArrayStride: target.ArrayStride = literal; break;
+				case SpirvDecorationBuiltIn: target.BuiltIn = true; break;
+				case SpirvDecorationLocation: target.Location = literal; break;
+				case SpirvDecorationBinding: target.Binding = literal; break;
+				case SpirvDecorationDescriptorSet: target.Set = literal; break;
+				}
+				break;
+			}
+			case SpirvOpMemberDecorate:
+			{
+				SpirvId &target = ids[operands[0]];
+				uint32_t literal = operandCount > 3 ? operands[3] : 0;
+				if (operands[2] == SpirvDecorationOffset)
+					SetMemberDecoration(target.MemberOffsets, operands[1], literal);
+				else if (operands[2] == SpirvDecorationMatrixStride)
+					SetMemberDecoration(target.MemberMatrixStrides, operands[1], literal);
+				break;
+			}
+			case SpirvOpTypeBool:
+			case SpirvOpTypeInt:
+			case SpirvOpTypeFloat:
+			case SpirvOpTypeVector:
+			case SpirvOpTypeMatrix:
+			case SpirvOpTypeImage:
+			case SpirvOpTypeSampler:
+			case SpirvOpTypeSampledImage:
+			case SpirvOpTypeArray:
+			case SpirvOpTypeRuntimeArray:
+			case SpirvOpTypeStruct:
+			{
+				SpirvId &type = ids[operands[0]];
+				type.Opcode = opcode;
+				type.Operands.assign(operands + 1, operands + operandCount);
+				break;
+			}
+			case SpirvOpTypePointer:
+			{
+				SpirvId &pointer = ids[operands[0]];
+				pointer.Opcode = opcode;
+				pointer.StorageClass = operands[1];
+				pointer.TypeID = operands[2];
+				break;
+			}
+			case SpirvOpConstant:
+			case SpirvOpSpecConstantTrue:
+			case SpirvOpSpecConstantFalse:
+			case SpirvOpSpecConstant:
+			{
+				SpirvId &constant = ids[operands[1]];
+				constant.Opcode = opcode;
+				constant.TypeID = operands[0];
+				constant.ConstantValue = operandCount > 2 ? operands[2] : (opcode == SpirvOpSpecConstantTrue ? 1 : 0);
+				break;
+			}
+			case SpirvOpVariable:
+			{
+				SpirvId &variable = ids[operands[1]];
+				variable.Opcode = opcode;
+				variable.TypeID = operands[0];
+				variable.StorageClass = operands[2];
+				break;
+			}
+			}
+
+			wordIndex += instructionWordCount;
+		}
+
+		m_StageFlags = stage;
+
+		for (uint32_t id = 0; id < idBound; id++)
+		{
+			const SpirvId &spirvId = ids[id];
+
+			if (spirvId.SpecID != s_SpirvUnset)
+			{
+				m_SpecializationConstants.push_back({ spirvId.Name, spirvId.SpecID });
+				continue;
+			}
+
+			if (spirvId.Opcode != SpirvOpVariable || spirvId.BuiltIn)
+				continue;
+
+			uint32_t typeID = ids[spirvId.TypeID].TypeID; // Variables are always pointers, so look through to the pointee type
+			switch (spirvId.StorageClass)
+			{
+			case SpirvStorageClassInput:
+			{
+				if (stage != VK_SHADER_STAGE_VERTEX_BIT || spirvId.Location == s_SpirvUnset)
+					break;
+
+				ReflectedVertexInput input;
+				input.Name = spirvId.Name;
+				input.Location = spirvId.Location;
+				input.Format = GetSpirvVertexFormat(ids, typeID);
+				m_VertexInputs.push_back(input);
+				break;
+			}
+			case SpirvStorageClassPushConstant:
+			{
+				const SpirvId &block = ids[typeID];
+				uint32_t offset = block.MemberOffsets.empty() ? 0 : *std::min_element(block.MemberOffsets.begin(), block.MemberOffsets.end());
+
+				VkPushConstantRange range = {};
+				range.stageFlags = stage;
+				range.offset = offset;
+				range.size = GetSpirvTypeSize(ids, typeID) - offset;
+				m_PushConstantRanges.push_back(range);
+				break;
+			}
+			case SpirvStorageClassUniformConstant:
+			case SpirvStorageClassUniform:
+			case SpirvStorageClassStorageBuffer:
+			{
+				ReflectedDescriptorBinding binding;
+				binding.Name = spirvId.Name.empty() ? ids[typeID].Name : spirvId.Name; // Uniform blocks without an instance name only have their block name
+				binding.Set = spirvId.Set != s_SpirvUnset ? spirvId.Set : 0;
+				binding.Binding = spirvId.Binding != s_SpirvUnset ? spirvId.Binding : 0;
+				binding.StageFlags = stage;
+
+				// Arrays of resources take up multiple descriptors in the same binding
+				while (ids[typeID].Opcode == SpirvOpTypeArray || ids[typeID].Opcode == SpirvOpTypeRuntimeArray)
+				{
+					if (ids[typeID].Opcode == SpirvOpTypeArray)
+						binding.Count *= ids[ids[typeID].Operands[1]].ConstantValue;
+					typeID = ids[typeID].Operands[0];
+				}
+
+				binding.Type = GetSpirvDescriptorType(ids, typeID, spirvId.StorageClass);
+				if (binding.Type == VK_DESCRIPTOR_TYPE_MAX_ENUM)
+				{
+					ARC_LOG_WARN("ShaderReflection: Unsupported resource type for {0} (set {1} binding {2})", binding.Name, binding.Set, binding.Binding);
+					break;
+				}
+				m_DescriptorBindings.push_back(binding);
+				break;
+			}
+			}
+		}
+
+		std::sort(m_DescriptorBindings.begin(), m_DescriptorBindings.end(), [](const ReflectedDescriptorBinding &a, const ReflectedDescriptorBinding &b) { return a.Set != b.Set ? a.Set < b.Set : a.Binding < b.Binding; });
+		std::sort(m_VertexInputs.begin(), m_VertexInputs.end(), [](const ReflectedVertexInput &a, const ReflectedVertexInput &b) { return a.Location < b.Location; });
+		return true;
+	}
+
+	bool ShaderReflection::LoadOrReflect(const std::string &binaryPath, const uint32_t *code, size_t wordCount, uint64_t binaryHash)
+	{
+		std::string cachePath = binaryPath + ".refl";
+
+		if (ReadCache(cachePath, binaryHash))
+		{
+			return true;
+		}
+
+		if (!Reflect(code, wordCount))
+		{
+			return false;
+		}
+
+		WriteCache(cachePath, binaryHash);
+		return true;
+	}
+
+	void ShaderReflection::SaveCache(const std::string &binaryPath, uint64_t binaryHash) const
+	{
+		WriteCache(binaryPath + ".refl", binaryHash);
+	}
+
+	void ShaderReflection::Merge(const ShaderReflection &other)
+	{
+		m_StageFlags |= other.m_StageFlags;
+		if (other.m_StageFlags & VK_SHADER_STAGE_COMPUTE_BIT)
+			m_WorkgroupSize = other.m_WorkgroupSize;
+
+		for (const ReflectedDescriptorBinding &otherBinding : other.m_DescriptorBindings)
+		{
+			auto iter = std::find_if(m_DescriptorBindings.begin(), m_DescriptorBindings.end(), [&otherBinding](const ReflectedDescriptorBinding &binding) { return binding.Set == otherBinding.Set && binding.Binding == otherBinding.Binding; });
+			if (iter == m_DescriptorBindings.end())
+			{
+				m_DescriptorBindings.push_back(otherBinding);
+				continue;
+			}
+
+			ARC_ASSERT(iter->Type == otherBinding.Type && iter->Count == otherBinding.Count, "ShaderReflection: Stages disagree on the resource at set {0} binding {1}", otherBinding.Set, otherBinding.Binding);
+			iter->StageFlags |= otherBinding.StageFlags;
+		}
+		std::sort(m_DescriptorBindings.begin(), m_DescriptorBindings.end(), [](const ReflectedDescriptorBinding &a, const ReflectedDescriptorBinding &b) { return a.Set != b.Set ? a.Set < b.Set : a.Binding < b.Binding; });
+
+		for (const VkPushConstantRange &otherRange : other.m_PushConstantRanges)
+		{
+			auto iter = std::find_if(m_PushConstantRanges.begin(), m_PushConstantRanges.end(), [&otherRange](const VkPushConstantRange &range) { return range.offset == otherRange.offset && range.size == otherRange.size; });
+			if (iter != m_PushConstantRanges.end())
+			{
+				iter->stageFlags |= otherRange.stageFlags;
+			}
+			else
+			{
+				m_PushConstantRanges.push_back(otherRange);
+			}
+		}
+
+		m_VertexInputs.insert(m_VertexInputs.end(), other.m_VertexInputs.begin(), other.m_VertexInputs.end());
+		std::sort(m_VertexInputs.begin(), m_VertexInputs.end(), [](const ReflectedVertexInput &a, const ReflectedVertexInput &b) { return a.Location < b.Location; });
+
+		for (const ReflectedSpecializationConstant &otherConstant : other.m_SpecializationConstants)
+		{
+			auto iter = std::find_if(m_SpecializationConstants.begin(), m_SpecializationConstants.end(), [&otherConstant](const ReflectedSpecializationConstant &constant) { return constant.ConstantID == otherConstant.ConstantID; });
+			if (iter == m_SpecializationConstants.end())
+			{
+				m_SpecializationConstants.push_back(otherConstant);
+			}
+		}
+	}
+
+	std::vector<VkDescriptorSetLayoutBinding> ShaderReflection::GetDescriptorSetLayoutBindings(uint32_t set) const
+	{
+		std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+		for (const ReflectedDescriptorBinding &binding : m_DescriptorBindings)
+		{
+			if (binding.Set != set)
+				continue;
+
+			VkDescriptorSetLayoutBinding layoutBinding = {};
+			layoutBinding.binding = binding.Binding;
+			layoutBinding.descriptorType = binding.Type;
+			layoutBinding.descriptorCount = binding.Count;
+			layoutBinding.stageFlags = binding.StageFlags;
+			layoutBinding.pImmutableSamplers = nullptr;
+			layoutBindings.push_back(layoutBinding);
+		}
+
+		return layoutBindings;
+	}
+
+	uint32_t ShaderReflection::GetDescriptorSetCount() const
+	{
+		return m_DescriptorBindings.empty() ? 0 : m_DescriptorBindings.back().Set + 1;
+	}
+
+	bool ShaderReflection::ValidateVertexInput(const std::vector<VkVertexInputAttributeDescription> &attributes) const
+	{
+		bool valid = true;
+		for (const ReflectedVertexInput &input : m_VertexInputs)
+		{
+			auto iter = std::find_if(attributes.begin(), attributes.end(), [&input](const VkVertexInputAttributeDescription &attribute) { return attribute.location == input.Location; });
+			if (iter == attributes.end())
+			{
+				ARC_LOG_ERROR("ShaderReflection: Vertex input {0} (location {1}) is not provided by the vertex layout", input.Name, input.Location);
+				valid = false;
+			}
+			else if (!IsVertexFormatCompatible(input.Format, iter->format))
+			{
+				ARC_LOG_ERROR("ShaderReflection: Vertex input {0} (location {1}) expects format {2} but the vertex layout provides {3}", input.Name, input.Location, input.Format, iter->format);
+				valid = false;
+			}
+		}
+
+		for (const VkVertexInputAttributeDescription &attribute : attributes)
+		{
+			auto iter = std::find_if(m_VertexInputs.begin(), m_VertexInputs.end(), [&attribute](const ReflectedVertexInput &input) { return input.Location == attribute.location; });
+			if (iter == m_VertexInputs.end())
+			{
+				ARC_LOG_WARN("ShaderReflection: Vertex attribute at location {0} is never read by the vertex shader", attribute.location);
+			}
+		}
+
+		return valid;
+	}
+
+	std::optional<uint32_t> ShaderReflection::FindSpecializationConstantID(const std::string &name) const
+	{
+		for (const ReflectedSpecializationConstant &constant : m_SpecializationConstants)
+		{
+			if (constant.Name == name)
+			{
+				return constant.ConstantID;
+			}
+		}
+
+		return std::nullopt;
+	}
+
+	// Reflection cache file format, bump the version whenever the layout changes so stale caches get regenerated
+	static const uint32_t s_ReflectionCacheMagic = 0x4C464552; // "REFL"
+	static const uint32_t s_ReflectionCacheVersion = 2;
+
+	template<typename T>
+	static void WriteCacheValue(std::ofstream &stream, const T &value)
+	{
+		stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	static void WriteCacheString(std::ofstream &stream, const std::string &string)
+	{
+		WriteCacheValue(stream, static_cast<uint32_t>(string.size()));
+		stream.write(string.data(), string.size());
+	}
+
+	template<typename T>
+	static bool ReadCacheValue(std::ifstream &stream, T &outValue)
+	{
+		stream.read(reinterpret_cast<char*>(&outValue), sizeof(T));
+		return stream.good();
+	}
+
+	static bool ReadCacheString(std::ifstream &stream, std::string &outString)
+	{
+		uint32_t length;
+		if (!ReadCacheValue(stream, length) || length > 4096)
+			return false;
+
+		outString.resize(length);
+		stream.read(&outString[0], length);
+		return stream.good();
+	}
+
+	bool ShaderReflection::ReadCache(const std::string &cachePath, uint64_t binaryHash)
+	{
+		std::ifstream stream(cachePath, std::ios::in | std::ios::binary);
+		if (!stream)
+			return false;
+
+		uint32_t magic, version;
+		uint64_t hash;
+		if (!ReadCacheValue(stream, magic) || !ReadCacheValue(stream, version) || !ReadCacheValue(stream, hash))
+			return false;
+		if (magic != s_ReflectionCacheMagic || version != s_ReflectionCacheVersion || hash != binaryHash)
+			return false; // Cache was generated from a different binary (or by a different version of the engine)
+
+		ShaderReflection reflection;
+		uint32_t count;
+		bool success = ReadCacheValue(stream, reflection.m_StageFlags) && ReadCacheValue(stream, reflection.m_WorkgroupSize);
+
+		success = success && ReadCacheValue(stream, count);
+		for (uint32_t i = 0; success && i < count; i++)
+		{
+			ReflectedDescriptorBinding binding;
+			success = ReadCacheString(stream, binding.Name) && ReadCacheValue(stream, binding.Set) && ReadCacheValue(stream, binding.Binding) &&
+				ReadCacheValue(stream, binding.Type) && ReadCacheValue(stream, binding.Count) && ReadCacheValue(stream, binding.StageFlags);
+			reflection.m_DescriptorBindings.push_back(binding);
+		}
+
+		success = success && ReadCacheValue(stream, count);
+		for (uint32_t i = 0; success && i < count; i++)
+		{
+			VkPushConstantRange range;
+			success = ReadCacheValue(stream, range.stageFlags) && ReadCacheValue(stream, range.offset) && ReadCacheValue(stream, range.size);
+			reflection.m_PushConstantRanges.push_back(range);
+		}
+
+		success = success && ReadCacheValue(stream, count);
+		for (uint32_t i = 0; success && i < count; i++)
+		{
+			ReflectedVertexInput input;
+			success = ReadCacheString(stream, input.Name) && ReadCacheValue(stream, input.Location) && ReadCacheValue(stream, input.Format);
+			reflection.m_VertexInputs.push_back(input);
+		}
+
+		success = success && ReadCacheValue(stream, count);
+		for (uint32_t i = 0; success && i < count; i++)
+		{
+			ReflectedSpecializationConstant constant;
+			success = ReadCacheString(stream, constant.Name) && ReadCacheValue(stream, constant.ConstantID);
+			reflection.m_SpecializationConstants.push_back(constant);
+		}
+
+		if (!success)
+		{
+			ARC_LOG_WARN("ShaderReflection: Reflection cache {0} is corrupt, regenerating it", cachePath);
+			return false;
+		}
+
+		*this = std::move(reflection);
+		return true;
+	}
+
+	void ShaderReflection::WriteCache(const std::string &cachePath, uint64_t binaryHash) const
+	{
+		std::ofstream stream(cachePath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!stream)
+		{
+			ARC_LOG_WARN("ShaderReflection: Could not write reflection cache {0}", cachePath);
+			return;
+		}
+
+		WriteCacheValue(stream, s_ReflectionCacheMagic);
+		WriteCacheValue(stream, s_ReflectionCacheVersion);
+		WriteCacheValue(stream, binaryHash);
+		WriteCacheValue(stream, m_StageFlags);
+		WriteCacheValue(stream, m_WorkgroupSize);
+
+		WriteCacheValue(stream, static_cast<uint32_t>(m_DescriptorBindings.size()));
+		for (const ReflectedDescriptorBinding &binding : m_DescriptorBindings)
+		{
+			WriteCacheString(stream, binding.Name);
+			WriteCacheValue(stream, binding.Set);
+			WriteCacheValue(stream, binding.Binding);
+			WriteCacheValue(stream, binding.Type);
+			WriteCacheValue(stream, binding.Count);
+			WriteCacheValue(stream, binding.StageFlags);
+		}
+
+		WriteCacheValue(stream, static_cast<uint32_t>(m_PushConstantRanges.size()));
+		for (const VkPushConstantRange &range : m_PushConstantRanges)
+		{
+			WriteCacheValue(stream, range.stageFlags);
+			WriteCacheValue(stream, range.offset);
+			WriteCacheValue(stream, range.size);
+		}
+
+		WriteCacheValue(stream, static_cast<uint32_t>(m_VertexInputs.size()));
+		for (const ReflectedVertexInput &input : m_VertexInputs)
+		{
+			WriteCacheString(stream, input.Name);
+			WriteCacheValue(stream, input.Location);
+			WriteCacheValue(stream, input.Format);
+		}
+
+		WriteCacheValue(stream, static_cast<uint32_t>(m_SpecializationConstants.size()));
+		for (const ReflectedSpecializationConstant &constant : m_SpecializationConstants)
+		{
+			WriteCacheString(stream, constant.Name);
+			WriteCacheValue(stream, constant.ConstantID);
+		}
+	}
+}
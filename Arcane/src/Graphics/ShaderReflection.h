@@ -0,0 +1,68 @@
+#pragma once
+
+namespace Arcane
+{
+	struct ReflectedDescriptorBinding
+	{
+		std::string Name;
+		uint32_t Set = 0;
+		uint32_t Binding = 0;
+		VkDescriptorType Type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+		uint32_t Count = 1; // Number of descriptors for arrays of resources (1 for non-arrays)
+		VkShaderStageFlags StageFlags = 0;
+	};
+
+	struct ReflectedVertexInput
+	{
+		std::string Name;
+		uint32_t Location = 0;
+		VkFormat Format = VK_FORMAT_UNDEFINED;
+	};
+
+	struct ReflectedSpecializationConstant
+	{
+		std::string Name;
+		uint32_t ConstantID = 0;
+	};
+
+	// Resource interface of one or more SPIR-V modules. Used to generate descriptor set layouts, push constant ranges and to validate the C++ vertex layout against the shader
+	class ShaderReflection
+	{
+	public:
+		// Parses the SPIR-V binary directly, the stage is taken from the module's entry point
+		bool Reflect(const uint32_t *code, size_t wordCount);
+
+		// Same as Reflect() but uses the reflection cache stored next to the binary (<binaryPath>.refl) when it was generated from the same SPIR-V (binaryHash is HashUtils::HashBytes of the code)
+		bool LoadOrReflect(const std::string &binaryPath, const uint32_t *code, size_t wordCount, uint64_t binaryHash);
+
+		// Writes the reflection cache for a binary, used by the shader compiler to keep names for binaries that have their debug info stripped
+		void SaveCache(const std::string &binaryPath, uint64_t binaryHash) const;
+
+		// Combines the interface of another stage into this one (bindings used by both stages get both stage flags)
+		void Merge(const ShaderReflection &other);
+
+		std::vector<VkDescriptorSetLayoutBinding> GetDescriptorSetLayoutBindings(uint32_t set) const;
+		uint32_t GetDescriptorSetCount() const;
+
+		// Logs every mismatch between the vertex shader inputs and the attribute descriptions, returns false if the layouts are incompatible
+		bool ValidateVertexInput(const std::vector<VkVertexInputAttributeDescription> &attributes) const;
+		std::optional<uint32_t> FindSpecializationConstantID(const std::string &name) const;
+
+		inline VkShaderStageFlags GetStageFlags() const { return m_StageFlags; }
+		inline const std::array<uint32_t, 3>& GetWorkgroupSize() const { return m_WorkgroupSize; } // Compute only, the literal local_size of the entry point
+		inline const std::vector<ReflectedDescriptorBinding>& GetDescriptorBindings() const { return m_DescriptorBindings; }
+		inline const std::vector<VkPushConstantRange>& GetPushConstantRanges() const { return m_PushConstantRanges; }
+		inline const std::vector<ReflectedVertexInput>& GetVertexInputs() const { return m_VertexInputs; }
+		inline const std::vector<ReflectedSpecializationConstant>& GetSpecializationConstants() const { return m_SpecializationConstants; }
+	private:
+		bool ReadCache(const std::string &cachePath, uint64_t binaryHash);
+		void WriteCache(const std::string &cachePath, uint64_t binaryHash) const;
+	private:
+		VkShaderStageFlags m_StageFlags = 0;
+		std::array<uint32_t, 3> m_WorkgroupSize = { 1, 1, 1 };
+		std::vector<ReflectedDescriptorBinding> m_DescriptorBindings; // Sorted by set then binding
+		std::vector<VkPushConstantRange> m_PushConstantRanges;
+		std::vector<ReflectedVertexInput> m_VertexInputs; // Sorted by location
+		std::vector<ReflectedSpecializationConstant> m_SpecializationConstants;
+	};
+}
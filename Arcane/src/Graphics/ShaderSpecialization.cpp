@@ -0,0 +1,76 @@
+#include "arcpch.h"
+#include "ShaderSpecialization.h"
+
+#include "Core/HashUtils.h"
+#include "Graphics/ShaderReflection.h"
+
+namespace Arcane
+{
+	void ShaderSpecialization::SetBool(const std::string &name, bool value)
+	{
+		SetConstant(name, SpecializationConstantType::BOOL, value ? VK_TRUE : VK_FALSE);
+	}
+
+	void ShaderSpecialization::SetInt(const std::string &name, int32_t value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		SetConstant(name, SpecializationConstantType::INT, bits);
+	}
+
+	void ShaderSpecialization::SetFloat(const std::string &name, float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		SetConstant(name, SpecializationConstantType::FLOAT, bits);
+	}
+
+	void ShaderSpecialization::GetSpecializationData(const ShaderReflection &reflection, std::vector<VkSpecializationMapEntry> &outMapEntries, std::vector<uint32_t> &outData) const
+	{
+		outMapEntries.clear();
+		outData.clear();
+		outMapEntries.reserve(m_Constants.size());
+		outData.reserve(m_Constants.size());
+
+		for (const SpecializationConstant &constant : m_Constants)
+		{
+			std::optional<uint32_t> constantID = reflection.FindSpecializationConstantID(constant.Name);
+			ARC_ASSERT(constantID.has_value(), "ShaderSpecialization: The shader has no specialization constant called {0}", constant.Name);
+			if (!constantID)
+				continue;
+
+			VkSpecializationMapEntry mapEntry;
+			mapEntry.constantID = *constantID;
+			mapEntry.offset = static_cast<uint32_t>(outData.size() * sizeof(uint32_t));
+			mapEntry.size = sizeof(uint32_t);
+			outMapEntries.push_back(mapEntry);
+			outData.push_back(constant.Value);
+		}
+	}
+
+	uint64_t ShaderSpecialization::GetHash() const
+	{
+		uint64_t hash = 0;
+		for (const SpecializationConstant &constant : m_Constants)
+		{
+			HashUtils::Combine(hash, HashUtils::HashString(constant.Name));
+			HashUtils::Combine(hash, static_cast<uint64_t>(constant.Type));
+			HashUtils::Combine(hash, constant.Value);
+		}
+
+		return hash;
+	}
+
+	void ShaderSpecialization::SetConstant(const std::string &name, SpecializationConstantType type, uint32_t value)
+	{
+		auto iter = std::lower_bound(m_Constants.begin(), m_Constants.end(), name, [](const SpecializationConstant &constant, const std::string &constantName) { return constant.Name < constantName; });
+		if (iter != m_Constants.end() && iter->Name == name)
+		{
+			iter->Type = type;
+			iter->Value = value;
+			return;
+		}
+
+		m_Constants.insert(iter, SpecializationConstant{ name, type, value });
+	}
+}
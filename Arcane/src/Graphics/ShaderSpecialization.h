@@ -0,0 +1,40 @@
+#pragma once
+
+namespace Arcane
+{
+	class ShaderReflection;
+
+	enum class SpecializationConstantType
+	{
+		BOOL,
+		INT,
+		FLOAT,
+	};
+
+	// Set of named specialization constants (layout(constant_id = X) in GLSL) that are baked into the pipeline at creation time
+	// The driver can then dead-code eliminate branches on these values, so feature permutations (alpha-test, skinning, light count etc) don't need their own SPIR-V binaries.
+	// Constants are set by their GLSL name, the constant IDs are looked up in the shader's reflection when the pipeline stages are built
+	class ShaderSpecialization
+	{
+	public:
+		void SetBool(const std::string &name, bool value);
+		void SetInt(const std::string &name, int32_t value);
+		void SetFloat(const std::string &name, float value);
+
+		// Every constant is 4 bytes (VkBool32, int32_t or float) so the data can be laid out as one word per constant. Asserts if the shader doesn't declare a constant
+		void GetSpecializationData(const ShaderReflection &reflection, std::vector<VkSpecializationMapEntry> &outMapEntries, std::vector<uint32_t> &outData) const;
+
+		uint64_t GetHash() const;
+		inline bool IsEmpty() const { return m_Constants.empty(); }
+	private:
+		void SetConstant(const std::string &name, SpecializationConstantType type, uint32_t value);
+	private:
+		struct SpecializationConstant
+		{
+			std::string Name;
+			SpecializationConstantType Type;
+			uint32_t Value; // Raw bits of the constant
+		};
+		std::vector<SpecializationConstant> m_Constants; // Sorted by name so the hash doesn't depend on the order the constants were set in
+	};
+}
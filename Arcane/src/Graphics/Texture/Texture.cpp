@@ -25,6 +25,7 @@ namespace Arcane
 
 	Texture::~Texture()
 	{
+		m_Vulkan->GetResourceStateTracker()->UnregisterImage(m_TextureImage);
 		vkDestroyImage(*m_Vulkan->GetDevice(), m_TextureImage, nullptr);
 		vkFreeMemory(*m_Vulkan->GetDevice(), m_TextureImageMemory, nullptr);
 		vkDestroyImageView(*m_Vulkan->GetDevice(), m_TextureImageView, nullptr);
@@ -62,11 +63,17 @@ namespace Arcane
 		m_Vulkan->CreateImage2D(m_Width, m_Height, m_TextureSettings.TextureFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_SHARING_MODE_CONCURRENT, &m_TextureImage, &m_TextureImageMemory);
 
-		// TODO: These should all be recorded by a single command buffer, instead of each function synchronously submitting its own command buffer
-		// Make a function SetupCommandBuffer() & FlushSetupCommandBuffer() or something and record all of these actions into one command buffer
-		m_Vulkan->TransitionImageLayout(m_TextureImage, m_TextureSettings.TextureFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL); // CreateImage2D sets the layout to VK_IMAGE_LAYOUT_UNDEFINED
-		m_Vulkan->CopyBufferToImage(stagingBuffer, m_TextureImage, static_cast<uint32_t>(m_Width), static_cast<uint32_t>(m_Height));
-		m_Vulkan->TransitionImageLayout(m_TextureImage, m_TextureSettings.TextureFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		// The transitions and the copy are recorded into one command buffer, the tracker only needs to be told how the image is used next
+		ResourceStateTracker *stateTracker = m_Vulkan->GetResourceStateTracker();
+		stateTracker->RegisterImage(m_TextureImage, VK_IMAGE_ASPECT_COLOR_BIT); // CreateImage2D sets the layout to VK_IMAGE_LAYOUT_UNDEFINED
+
+		VkCommandBuffer commandBuffer = m_Vulkan->BeginUploadCommands();
+		stateTracker->TransitionImage(m_TextureImage, ResourceAccess::TRANSFER_WRITE);
+		stateTracker->FlushBarriers(commandBuffer);
+		m_Vulkan->CopyBufferToImage(commandBuffer, stagingBuffer, m_TextureImage, static_cast<uint32_t>(m_Width), static_cast<uint32_t>(m_Height));
+		stateTracker->TransitionImage(m_TextureImage, ResourceAccess::SAMPLED, nullptr, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+		stateTracker->FlushBarriers(commandBuffer);
+		m_Vulkan->SubmitUploadCommands(commandBuffer);
 
 		vkDestroyBuffer(*m_Vulkan->GetDevice(), stagingBuffer, nullptr);
 		vkFreeMemory(*m_Vulkan->GetDevice(), stagingMemory, nullptr);
@@ -15,9 +15,7 @@ namespace Arcane
 			VkVertexInputBindingDescription bindingDescription = {};
 			bindingDescription.binding = 0;
 			bindingDescription.stride = sizeof(Vertex);
-			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // This is where you can use instance rendering
-
-			// TODO: Add another slot with binding = 1, that contains the instance data that will be fed to the vertex shader at a per instance rate
+			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
 			return bindingDescription;
 		}
@@ -41,7 +39,172 @@ namespace Arcane
 			attributesDescription[2].offset = offsetof(Vertex, uv);
 			attributesDescription[2].format = VK_FORMAT_R32G32_SFLOAT;
 
-			// TODO: Add instance bindings if needed
+			return attributesDescription;
+		}
+	};
+
+	// Vertex formats a pipeline can read from binding 0, every mesh in a geometry pool uses the pool's layout
+	enum class VertexLayout : uint32_t
+	{
+		STANDARD,       // Vertex
+		MESH,           // MeshVertex
+		MESH_QUANTIZED, // QuantizedMeshVertex
+		COUNT
+	};
+
+	// How the vertices of a layout are stored. Split puts the positions in a tightly packed stream of their own at binding 0 and every other attribute in a stream at binding 2
+	// (binding 1 is the instance data), so passes that only need positions fetch nothing else
+	enum class VertexStreams : uint32_t
+	{
+		INTERLEAVED,
+		SPLIT,
+		POSITION_ONLY // Pipelines that read only the position stream of split vertices
+	};
+
+	// Full precision mesh vertex, what meshes are imported as. Locations 0 to 2 line up with Vertex, the rest go after the instance data
+	struct MeshVertex
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec4 tangent; // w is the bitangent sign
+		glm::vec2 uv0;
+		glm::vec2 uv1;
+
+		static VkVertexInputBindingDescription GetBindingDescription()
+		{
+			VkVertexInputBindingDescription bindingDescription = {};
+			bindingDescription.binding = 0;
+			bindingDescription.stride = sizeof(MeshVertex);
+			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+			return bindingDescription;
+		}
+
+		static std::vector<VkVertexInputAttributeDescription> GetAttributeDescription()
+		{
+			std::vector<VkVertexInputAttributeDescription> attributesDescription(5);
+
+			attributesDescription[0].binding = 0;
+			attributesDescription[0].location = 0;
+			attributesDescription[0].offset = offsetof(MeshVertex, position);
+			attributesDescription[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+
+			attributesDescription[1].binding = 0;
+			attributesDescription[1].location = 1;
+			attributesDescription[1].offset = offsetof(MeshVertex, normal);
+			attributesDescription[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+
+			attributesDescription[2].binding = 0;
+			attributesDescription[2].location = 2;
+			attributesDescription[2].offset = offsetof(MeshVertex, uv0);
+			attributesDescription[2].format = VK_FORMAT_R32G32_SFLOAT;
+
+			attributesDescription[3].binding = 0;
+			attributesDescription[3].location = 9;
+			attributesDescription[3].offset = offsetof(MeshVertex, tangent);
+			attributesDescription[3].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+
+			attributesDescription[4].binding = 0;
+			attributesDescription[4].location = 10;
+			attributesDescription[4].offset = offsetof(MeshVertex, uv1);
+			attributesDescription[4].format = VK_FORMAT_R32G32_SFLOAT;
+
+			return attributesDescription;
+		}
+	};
+
+	// MeshVertex in 24 bytes instead of 56, see VertexQuantizer. Positions are snorm16 inside the mesh's bounds and need the mesh's dequantize transform,
+	// normals and tangents are octahedral snorm16 and UVs are half floats. The bitangent sign rides along in the position's w
+	struct QuantizedMeshVertex
+	{
+		int16_t position[4];
+		int16_t normal[2];
+		int16_t tangent[2];
+		uint16_t uv0[2];
+		uint16_t uv1[2];
+
+		static VkVertexInputBindingDescription GetBindingDescription()
+		{
+			VkVertexInputBindingDescription bindingDescription = {};
+			bindingDescription.binding = 0;
+			bindingDescription.stride = sizeof(QuantizedMeshVertex);
+			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+			return bindingDescription;
+		}
+
+		static std::vector<VkVertexInputAttributeDescription> GetAttributeDescription()
+		{
+			std::vector<VkVertexInputAttributeDescription> attributesDescription(5);
+
+			attributesDescription[0].binding = 0;
+			attributesDescription[0].location = 0;
+			attributesDescription[0].offset = offsetof(QuantizedMeshVertex, position);
+			attributesDescription[0].format = VK_FORMAT_R16G16B16A16_SNORM;
+
+			attributesDescription[1].binding = 0;
+			attributesDescription[1].location = 1;
+			attributesDescription[1].offset = offsetof(QuantizedMeshVertex, normal);
+			attributesDescription[1].format = VK_FORMAT_R16G16_SNORM;
+
+			attributesDescription[2].binding = 0;
+			attributesDescription[2].location = 2;
+			attributesDescription[2].offset = offsetof(QuantizedMeshVertex, uv0);
+			attributesDescription[2].format = VK_FORMAT_R16G16_SFLOAT;
+
+			attributesDescription[3].binding = 0;
+			attributesDescription[3].location = 9;
+			attributesDescription[3].offset = offsetof(QuantizedMeshVertex, tangent);
+			attributesDescription[3].format = VK_FORMAT_R16G16_SNORM;
+
+			attributesDescription[4].binding = 0;
+			attributesDescription[4].location = 10;
+			attributesDescription[4].offset = offsetof(QuantizedMeshVertex, uv1);
+			attributesDescription[4].format = VK_FORMAT_R16G16_SFLOAT;
+
+			return attributesDescription;
+		}
+	};
+
+	// Per instance data fed to the vertex shader from binding 1, so draws of the same mesh, material and pipeline can be merged into one instanced draw
+	struct InstanceData
+	{
+		glm::mat4 transform = glm::mat4(1.0f);
+		glm::vec4 tint = glm::vec4(1.0f);
+		glm::vec4 customData = glm::vec4(0.0f);
+
+		static VkVertexInputBindingDescription GetBindingDescription()
+		{
+			VkVertexInputBindingDescription bindingDescription = {};
+			bindingDescription.binding = 1;
+			bindingDescription.stride = sizeof(InstanceData);
+			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+			return bindingDescription;
+		}
+
+		// Follows the vertex attributes, the transform takes up one location per column
+		static std::vector<VkVertexInputAttributeDescription> GetAttributeDescription()
+		{
+			std::vector<VkVertexInputAttributeDescription> attributesDescription(6);
+
+			for (uint32_t column = 0; column < 4; column++)
+			{
+				attributesDescription[column].binding = 1;
+				attributesDescription[column].location = 3 + column;
+				attributesDescription[column].offset = offsetof(InstanceData, transform) + column * sizeof(glm::vec4);
+				attributesDescription[column].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+			}
+
+			attributesDescription[4].binding = 1;
+			attributesDescription[4].location = 7;
+			attributesDescription[4].offset = offsetof(InstanceData, tint);
+			attributesDescription[4].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+
+			attributesDescription[5].binding = 1;
+			attributesDescription[5].location = 8;
+			attributesDescription[5].offset = offsetof(InstanceData, customData);
+			attributesDescription[5].format = VK_FORMAT_R32G32B32A32_SFLOAT;
 
 			return attributesDescription;
 		}
@@ -0,0 +1,132 @@
+#include "arcpch.h"
+#include "VertexLayouts.h"
+
+namespace Arcane
+{
+	uint32_t VertexLayouts::GetStride(VertexLayout layout)
+	{
+		return GetInterleavedBindingDescription(layout).stride;
+	}
+
+	uint32_t VertexLayouts::GetPositionStride(VertexLayout layout)
+	{
+		for (const std::pair<VkVertexInputAttributeDescription, uint32_t> &attribute : GetAttributeSizes(layout))
+		{
+			if (attribute.first.location == 0)
+				return attribute.second;
+		}
+
+		ARC_ASSERT(false, "VertexLayouts: Layout {0} has no position at location 0", static_cast<uint32_t>(layout));
+		return 0;
+	}
+
+	std::vector<VkVertexInputBindingDescription> VertexLayouts::GetBindingDescriptions(VertexLayout layout, VertexStreams streams)
+	{
+		std::vector<VkVertexInputBindingDescription> bindingDescriptions(1, GetInterleavedBindingDescription(layout));
+		if (streams == VertexStreams::INTERLEAVED)
+			return bindingDescriptions;
+
+		bindingDescriptions[0].stride = GetPositionStride(layout);
+		if (streams == VertexStreams::SPLIT)
+		{
+			VkVertexInputBindingDescription attributeBinding = {};
+			attributeBinding.binding = ATTRIBUTE_STREAM_BINDING;
+			attributeBinding.stride = GetAttributeStride(layout);
+			attributeBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+			bindingDescriptions.push_back(attributeBinding);
+		}
+		return bindingDescriptions;
+	}
+
+	std::vector<VkVertexInputAttributeDescription> VertexLayouts::GetAttributeDescription(VertexLayout layout, VertexStreams streams)
+	{
+		if (streams == VertexStreams::INTERLEAVED)
+			return GetInterleavedAttributeDescription(layout);
+
+		std::vector<VkVertexInputAttributeDescription> attributesDescription;
+		uint32_t attributeOffset = 0;
+		for (const std::pair<VkVertexInputAttributeDescription, uint32_t> &attribute : GetAttributeSizes(layout))
+		{
+			VkVertexInputAttributeDescription description = attribute.first;
+			if (description.location == 0)
+			{
+				description.offset = 0;
+				attributesDescription.push_back(description);
+			}
+			else if (streams == VertexStreams::SPLIT)
+			{
+				description.binding = ATTRIBUTE_STREAM_BINDING;
+				description.offset = attributeOffset;
+				attributesDescription.push_back(description);
+				attributeOffset += attribute.second;
+			}
+		}
+		return attributesDescription;
+	}
+
+	bool VertexLayouts::CanRead(VertexStreams pipelineStreams, VertexStreams storedStreams)
+	{
+		return pipelineStreams == storedStreams || (pipelineStreams == VertexStreams::POSITION_ONLY && storedStreams == VertexStreams::SPLIT);
+	}
+
+	void VertexLayouts::SplitStreams(VertexLayout layout, const void *vertices, uint32_t vertexCount, void *outPositions, void *outAttributes)
+	{
+		const uint32_t stride = GetStride(layout), positionStride = GetPositionStride(layout), attributeStride = stride - positionStride;
+		const std::vector<std::pair<VkVertexInputAttributeDescription, uint32_t>> attributes = GetAttributeSizes(layout);
+
+		const uint8_t *source = static_cast<const uint8_t*>(vertices);
+		uint8_t *positions = static_cast<uint8_t*>(outPositions), *otherAttributes = static_cast<uint8_t*>(outAttributes);
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			const uint8_t *vertex = source + static_cast<size_t>(i) * stride;
+			uint8_t *attributeDestination = otherAttributes + static_cast<size_t>(i) * attributeStride;
+			for (const std::pair<VkVertexInputAttributeDescription, uint32_t> &attribute : attributes)
+			{
+				if (attribute.first.location == 0)
+				{
+					memcpy(positions + static_cast<size_t>(i) * positionStride, vertex + attribute.first.offset, attribute.second);
+				}
+				else
+				{
+					memcpy(attributeDestination, vertex + attribute.first.offset, attribute.second);
+					attributeDestination += attribute.second;
+				}
+			}
+		}
+	}
+
+	VkVertexInputBindingDescription VertexLayouts::GetInterleavedBindingDescription(VertexLayout layout)
+	{
+		switch (layout)
+		{
+		case VertexLayout::MESH: return MeshVertex::GetBindingDescription();
+		case VertexLayout::MESH_QUANTIZED: return QuantizedMeshVertex::GetBindingDescription();
+		default: return Vertex::GetBindingDescription();
+		}
+	}
+
+	std::vector<VkVertexInputAttributeDescription> VertexLayouts::GetInterleavedAttributeDescription(VertexLayout layout)
+	{
+		switch (layout)
+		{
+		case VertexLayout::MESH: return MeshVertex::GetAttributeDescription();
+		case VertexLayout::MESH_QUANTIZED: return QuantizedMeshVertex::GetAttributeDescription();
+		default: return Vertex::GetAttributeDescription();
+		}
+	}
+
+	std::vector<std::pair<VkVertexInputAttributeDescription, uint32_t>> VertexLayouts::GetAttributeSizes(VertexLayout layout)
+	{
+		std::vector<VkVertexInputAttributeDescription> attributesDescription = GetInterleavedAttributeDescription(layout);
+		std::sort(attributesDescription.begin(), attributesDescription.end(), [](const VkVertexInputAttributeDescription &a, const VkVertexInputAttributeDescription &b) { return a.offset < b.offset; });
+
+		const uint32_t stride = GetInterleavedBindingDescription(layout).stride;
+		std::vector<std::pair<VkVertexInputAttributeDescription, uint32_t>> attributes;
+		for (size_t i = 0; i < attributesDescription.size(); i++)
+		{
+			uint32_t end = i + 1 < attributesDescription.size() ? attributesDescription[i + 1].offset : stride;
+			attributes.push_back(std::make_pair(attributesDescription[i], end - attributesDescription[i].offset));
+		}
+		return attributes;
+	}
+}
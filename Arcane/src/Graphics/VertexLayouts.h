@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Graphics/Vertex.h"
+
+namespace Arcane
+{
+	// Looks up the description of a layout for code that only knows it at runtime. The split streams are derived from the interleaved layout, the position is
+	// always the attribute at location 0 and the attribute stream packs the rest in the order they appear in the vertex
+	class VertexLayouts
+	{
+	public:
+		static uint32_t GetStride(VertexLayout layout);
+		static uint32_t GetPositionStride(VertexLayout layout);
+		inline static uint32_t GetAttributeStride(VertexLayout layout) { return GetStride(layout) - GetPositionStride(layout); }
+
+		// Binding 0 and for split vertices binding 2, the instance binding isn't included
+		static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions(VertexLayout layout, VertexStreams streams);
+		static std::vector<VkVertexInputAttributeDescription> GetAttributeDescription(VertexLayout layout, VertexStreams streams);
+
+		// Whether a pipeline reading the streams can draw vertices stored as the other
+		static bool CanRead(VertexStreams pipelineStreams, VertexStreams storedStreams);
+
+		// Copies interleaved vertices of the layout into the two split streams
+		static void SplitStreams(VertexLayout layout, const void *vertices, uint32_t vertexCount, void *outPositions, void *outAttributes);
+
+		static const uint32_t ATTRIBUTE_STREAM_BINDING = 2;
+	private:
+		static VkVertexInputBindingDescription GetInterleavedBindingDescription(VertexLayout layout);
+		static std::vector<VkVertexInputAttributeDescription> GetInterleavedAttributeDescription(VertexLayout layout);
+		// The attributes sorted by offset with the size each takes up, the vertices have no padding so an attribute reaches the next one
+		static std::vector<std::pair<VkVertexInputAttributeDescription, uint32_t>> GetAttributeSizes(VertexLayout layout);
+	};
+}